@@ -7,6 +7,40 @@ use XML::Writer;
 my %time_zones = ();
 my %countries = ();
 
+# Binary geodata (geodata.bin), which is memory mapped by Astrognome at
+# startup. See src/ag-geodata.c for the format description.
+my $bin_magic = 'AGGEODAT';
+my $bin_version = 1;
+my $bin_header_size = 40;
+my $bin_country_size = 8;
+my $bin_city_size = 48;
+my $bin_nan = pack('H16', '000000000000f87f');
+my $bin_strings = '';
+my %bin_string_offsets = ();
+my $bin_countries = '';
+my $bin_cities = '';
+my $bin_n_countries = 0;
+my $bin_n_cities = 0;
+
+sub bin_string {
+    my ($string) = @_;
+
+    if (!exists($bin_string_offsets{$string})) {
+        $bin_string_offsets{$string} = length($bin_strings);
+        $bin_strings .= $string . "\0";
+    }
+
+    return $bin_string_offsets{$string};
+}
+
+sub bin_double {
+    my ($value) = @_;
+
+    return $bin_nan if (!defined($value) || $value eq '');
+
+    return pack('d<', $value);
+}
+
 open(TIMEZONES, 'timeZones.txt') or die("Cannot open timeZones.txt: $!\n");
 while (<TIMEZONES>) {
     my ($country_code, $timezone_id, $gmt_offset_january, $gmt_offset_july, $gmt_offset_raw) = split(/\t/, $_);
@@ -36,6 +70,9 @@ while (<COUNTRIES>) {
     if ($country_code =~ /^[A-Z]{2}$/) {
         $countries{$country_code} = $name;
     }
+
+    $bin_countries .= pack('V2', bin_string($country_code), bin_string($name));
+    $bin_n_countries++;
 }
 close(COUNTRIES);
 
@@ -68,6 +105,14 @@ while (<GEONAMES>) {
             'tzd' => $time_zones{$timezone}->{dst_offset}
         );
 
+    $bin_cities .= pack('V2', bin_string($name), bin_string($country_code))
+        . bin_double($latitude)
+        . bin_double($longitude)
+        . bin_double($elevation)
+        . bin_double($time_zones{$timezone}->{offset})
+        . bin_double($time_zones{$timezone}->{dst_offset});
+    $bin_n_cities++;
+
     print $., "\n" if ($. % 19083 == 0);
 }
 
@@ -78,3 +123,25 @@ $xml_file->close();
 
 close GEONAMES;
 
+# Both record tables have sizes divisible by 8, so they stay aligned
+my $bin_countries_offset = $bin_header_size;
+my $bin_cities_offset = $bin_countries_offset + $bin_n_countries * $bin_country_size;
+my $bin_strings_offset = $bin_cities_offset + $bin_n_cities * $bin_city_size;
+my $bin_file = IO::File->new('>geodata.bin') or die("Cannot open geodata.bin: $!\n");
+
+binmode($bin_file);
+print $bin_file pack('a8 V8',
+        $bin_magic,
+        $bin_version,
+        $bin_n_countries,
+        $bin_n_cities,
+        $bin_countries_offset,
+        $bin_cities_offset,
+        $bin_strings_offset,
+        length($bin_strings),
+        0
+    );
+print $bin_file $bin_countries;
+print $bin_file $bin_cities;
+print $bin_file $bin_strings;
+$bin_file->close();
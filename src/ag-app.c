@@ -17,15 +17,41 @@
  * <http://www.gnu.org/licenses/>.
  */
 #include <glib/gi18n.h>
-#include <webkit2/webkit2.h>
 
 #include "ag-app.h"
 #include "ag-window.h"
 #include "ag-chart.h"
 #include "ag-preferences.h"
+#include "ag-trace.h"
 #include "config.h"
 #include "astrognome.h"
 
+#define AG_APP_IMPORT_BATCH_INTERVAL 100
+
+typedef struct {
+    AgApp           *app;
+    AgAppImportType type;
+    AgDb            *db;
+    GThreadPool     *pool;
+    GAsyncQueue     *results;
+    GCancellable    *cancellable;
+    // Weak pointers, as the dialog is destroyed with its parent window
+    GtkWidget       *dialog;
+    GtkProgressBar  *progress;
+    guint           batch_id;
+    guint           n_files;
+    guint           n_done;
+    guint           n_imported;
+    GString         *errors;
+    gboolean        db_failed;
+} AgAppImport;
+
+typedef struct {
+    GFile         *file;
+    AgDbChartSave *save_data;
+    GError        *err;
+} AgAppImportItem;
+
 G_DEFINE_TYPE(AgApp, ag_app, GTK_TYPE_APPLICATION);
 
 GtkWindow *
@@ -221,6 +247,328 @@ ag_app_import_file(AgApp *app, GFile *file, AgAppImportType type)
     gtk_window_present(GTK_WINDOW(window));
 }
 
+static void
+ag_app_import_item_free(AgAppImportItem *item)
+{
+    g_object_unref(item->file);
+    ag_db_chart_save_unref(item->save_data);
+    g_clear_error(&(item->err));
+    g_free(item);
+}
+
+/*
+ * ag_app_import_worker:
+ *
+ * Runs in a worker thread. Parses one file, and queues the result for the
+ * main thread, which does the actual saving.
+ */
+static void
+ag_app_import_worker(AgAppImportItem *item, AgAppImport *import)
+{
+    AgChart *chart = NULL;
+
+    if (!g_cancellable_is_cancelled(import->cancellable)) {
+        switch (import->type) {
+            case AG_APP_IMPORT_AGC:
+                chart = ag_chart_load_from_agc(item->file, &(item->err));
+
+                break;
+
+            case AG_APP_IMPORT_HOR:
+                chart = ag_chart_load_from_placidus_file(
+                        item->file,
+                        &(item->err)
+                    );
+
+                break;
+
+            default:
+                g_error("Unknown import type!");
+
+                break;
+        }
+    }
+
+    if (chart != NULL) {
+        item->save_data        = ag_chart_get_db_save(chart);
+        item->save_data->db_id = -1;
+        g_object_unref(chart);
+    }
+
+    g_async_queue_push(import->results, item);
+}
+
+static void
+ag_app_import_finish(AgApp *app, AgAppImport *import)
+{
+    GtkWindow *parent = gtk_application_get_active_window(
+            GTK_APPLICATION(app)
+        );
+
+    g_thread_pool_free(import->pool, FALSE, TRUE);
+    g_async_queue_unref(import->results);
+
+    if (import->dialog != NULL) {
+        g_object_remove_weak_pointer(
+                G_OBJECT(import->progress),
+                (gpointer *)&(import->progress)
+            );
+        g_object_remove_weak_pointer(
+                G_OBJECT(import->dialog),
+                (gpointer *)&(import->dialog)
+            );
+        gtk_widget_destroy(import->dialog);
+    }
+
+    if (import->errors->len > 0) {
+        ag_app_message_dialog(
+                parent,
+                GTK_MESSAGE_WARNING,
+                _("%u of %u charts imported. Errors:\n%s"),
+                import->n_imported,
+                import->n_files,
+                import->errors->str
+            );
+    }
+
+    // The chart lists receive the new charts through the chart-inserted
+    // signals emitted by the commit
+
+    g_debug(
+            "Import finished, %u of %u charts imported",
+            import->n_imported,
+            import->n_files
+        );
+
+    g_object_unref(import->cancellable);
+    g_object_unref(import->db);
+    g_string_free(import->errors, TRUE);
+    g_free(import);
+
+    g_application_release(G_APPLICATION(app));
+}
+
+/*
+ * ag_app_import_add_error:
+ *
+ * Add the message of @err to the errors of @import, and clear @err.
+ */
+static void
+ag_app_import_add_error(AgAppImport *import, GError **err)
+{
+    g_string_append_printf(
+            import->errors,
+            "%s\n",
+            (*err) ? (*err)->message : _("Reason unknown")
+        );
+    g_clear_error(err);
+}
+
+/*
+ * ag_app_import_save_batch:
+ *
+ * Runs in the main thread. Saves every parsed chart waiting in the result
+ * queue, and updates the progress bar.
+ *
+ * Each batch is saved in its own transaction, which is committed before
+ * returning to the main loop, so saves from the windows never end up in an
+ * import transaction. If saving fails, the current batch is rolled back,
+ * and the rest of the charts are skipped.
+ */
+static gboolean
+ag_app_import_save_batch(AgAppImport *import)
+{
+    AgAppImportItem *item;
+    gchar           *progress_text;
+    GError          *err           = NULL;
+    gboolean        in_transaction = FALSE;
+    guint           n_batch_saved  = 0;
+
+    while ((item = g_async_queue_try_pop(import->results)) != NULL) {
+        import->n_done++;
+
+        if ((item->save_data != NULL) && !import->db_failed) {
+            if (
+                        !in_transaction
+                        && !(in_transaction = ag_db_begin_transaction(
+                                import->db,
+                                &err
+                            ))
+                    ) {
+                ag_app_import_add_error(import, &err);
+                import->db_failed = TRUE;
+            } else if (ag_db_chart_save(import->db, item->save_data, &err)) {
+                n_batch_saved++;
+            } else {
+                ag_app_import_add_error(import, &err);
+                import->db_failed = TRUE;
+            }
+        } else if (item->err != NULL) {
+            gchar *name = g_file_get_parse_name(item->file);
+
+            g_string_append_printf(
+                    import->errors,
+                    "%s: %s\n",
+                    name,
+                    item->err->message
+                );
+            g_free(name);
+        }
+
+        ag_app_import_item_free(item);
+    }
+
+    if (in_transaction) {
+        if (import->db_failed) {
+            ag_db_rollback_transaction(import->db, NULL);
+        } else if (ag_db_commit_transaction(import->db, &err)) {
+            import->n_imported += n_batch_saved;
+        } else {
+            ag_app_import_add_error(import, &err);
+            import->db_failed = TRUE;
+        }
+    }
+
+    if (import->progress != NULL) {
+        gtk_progress_bar_set_fraction(
+                import->progress,
+                (gdouble)import->n_done / (gdouble)import->n_files
+            );
+        progress_text = g_strdup_printf(
+                _("%u of %u"),
+                import->n_done,
+                import->n_files
+            );
+        gtk_progress_bar_set_text(import->progress, progress_text);
+        g_free(progress_text);
+    }
+
+    if (import->n_done < import->n_files) {
+        return G_SOURCE_CONTINUE;
+    }
+
+    import->batch_id = 0;
+    ag_app_import_finish(import->app, import);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+ag_app_import_dialog_response_cb(GtkDialog   *dialog,
+                                 gint        response_id,
+                                 AgAppImport *import)
+{
+    // Files not yet parsed will be skipped; the import finishes (and
+    // everything parsed so far is saved) when the workers are done
+    if (response_id == GTK_RESPONSE_CANCEL) {
+        g_cancellable_cancel(import->cancellable);
+        gtk_dialog_set_response_sensitive(dialog, GTK_RESPONSE_CANCEL, FALSE);
+    }
+}
+
+/**
+ * ag_app_import_files:
+ * @app: the #AgApp object
+ * @uris: (element-type utf8): the list of file URIs to import
+ * @type: the type of the files
+ *
+ * Import many charts at once. Files are parsed by a pool of worker threads,
+ * and the charts are saved in batches, each in its own database transaction.
+ * No windows are opened for the imported charts; a summary is displayed if
+ * there were errors. The application is kept running until the import
+ * finishes, even if the window it was started from is closed.
+ */
+void
+ag_app_import_files(AgApp *app, GSList *uris, AgAppImportType type)
+{
+    AgAppImport *import;
+    GtkWidget   *content_area;
+    GSList      *l;
+
+    g_application_hold(G_APPLICATION(app));
+
+    import = g_new0(AgAppImport, 1);
+    import->app         = app;
+    import->type        = type;
+    import->db          = ag_db_get();
+    import->errors      = g_string_new(NULL);
+    import->cancellable = g_cancellable_new();
+    import->results     = g_async_queue_new();
+    import->pool        = g_thread_pool_new(
+            (GFunc)ag_app_import_worker,
+            import,
+            g_get_num_processors(),
+            FALSE,
+            NULL
+        );
+
+    import->dialog = gtk_dialog_new_with_buttons(
+            _("Importing charts"),
+            gtk_application_get_active_window(GTK_APPLICATION(app)),
+            GTK_DIALOG_DESTROY_WITH_PARENT,
+            _("_Cancel"), GTK_RESPONSE_CANCEL,
+            NULL
+        );
+    g_signal_connect(
+            import->dialog,
+            "response",
+            G_CALLBACK(ag_app_import_dialog_response_cb),
+            import
+        );
+    g_signal_connect(
+            import->dialog,
+            "delete-event",
+            G_CALLBACK(gtk_true),
+            NULL
+        );
+
+    import->progress = GTK_PROGRESS_BAR(gtk_progress_bar_new());
+    gtk_progress_bar_set_show_text(import->progress, TRUE);
+    content_area = gtk_dialog_get_content_area(GTK_DIALOG(import->dialog));
+    gtk_container_set_border_width(GTK_CONTAINER(content_area), 12);
+    gtk_box_pack_start(
+            GTK_BOX(content_area),
+            GTK_WIDGET(import->progress),
+            TRUE, TRUE, 0
+        );
+    gtk_widget_show_all(import->dialog);
+
+    g_object_add_weak_pointer(
+            G_OBJECT(import->dialog),
+            (gpointer *)&(import->dialog)
+        );
+    g_object_add_weak_pointer(
+            G_OBJECT(import->progress),
+            (gpointer *)&(import->progress)
+        );
+
+    for (l = uris; l; l = g_slist_next(l)) {
+        AgAppImportItem *item;
+
+        if (l->data == NULL) {
+            continue;
+        }
+
+        item       = g_new0(AgAppImportItem, 1);
+        item->file = g_file_new_for_commandline_arg(l->data);
+
+        import->n_files++;
+        g_thread_pool_push(import->pool, item, NULL);
+    }
+
+    if (import->n_files == 0) {
+        ag_app_import_finish(app, import);
+
+        return;
+    }
+
+    import->batch_id = g_timeout_add(
+            AG_APP_IMPORT_BATCH_INTERVAL,
+            (GSourceFunc)ag_app_import_save_batch,
+            import
+        );
+}
+
 static void
 ag_app_import_cb(GSimpleAction *action, GVariant *parameter, gpointer user_data)
 {
@@ -263,23 +611,12 @@ ag_app_import_cb(GSimpleAction *action, GVariant *parameter, gpointer user_data)
         filenames = gtk_file_chooser_get_uris(GTK_FILE_CHOOSER(fs));
     }
 
-    if (filenames != NULL) {
-        GSList *l;
-
-        for (l = filenames; l; l = g_slist_next(l)) {
-            GFile *file;
-            char  *data = l->data;
-
-            if (data == NULL) {
-                continue;
-            }
+    gtk_widget_destroy(fs);
 
-            file = g_file_new_for_commandline_arg(data);
-            ag_app_import_file(AG_APP(user_data), file, type);
-        }
+    if (filenames != NULL) {
+        ag_app_import_files(app, filenames, type);
+        g_slist_free_full(filenames, g_free);
     }
-
-    gtk_widget_destroy(fs);
 }
 
 static void
@@ -329,6 +666,65 @@ help_cb(GSimpleAction *action, GVariant *parameter, gpointer user_data)
     show_help(NULL, NULL);
 }
 
+/*
+ * dump_trace_cb:
+ *
+ * Debug action to print the histograms of the traced rendering stages, the
+ * hit rate of the ephemeris cache, and how many chart redraws each window
+ * merged. If tracing is off, it is turned on, so the next dump has something
+ * to show.
+ */
+static void
+dump_trace_cb(GSimpleAction *action, GVariant *parameter, gpointer user_data)
+{
+    gchar *histograms;
+    GList *l;
+    guint hits,
+          misses;
+
+    if (!g_atomic_int_get(&ag_trace_enabled)) {
+        g_printerr("Tracing was disabled; it is enabled from now on\n");
+        ag_trace_set_enabled(TRUE);
+
+        return;
+    }
+
+    histograms = ag_trace_get_histograms();
+    g_printerr("%s", histograms);
+    g_free(histograms);
+
+    ag_chart_get_ephemeris_cache_stats(&hits, &misses);
+    g_printerr(
+            "\nEphemeris cache: %u hits, %u misses (%.1f%% hit rate)\n",
+            hits,
+            misses,
+            (hits + misses == 0) ? 0.0 : 100.0 * hits / (hits + misses)
+        );
+
+    for (
+                l = gtk_application_get_windows(GTK_APPLICATION(user_data));
+                l;
+                l = g_list_next(l)
+            ) {
+        guint done,
+              skipped;
+
+        if (!AG_IS_WINDOW(l->data)) {
+            continue;
+        }
+
+        ag_window_get_redraw_stats(AG_WINDOW(l->data), &done, &skipped);
+        g_printerr(
+                "\nChart redraws in window %u: %u done, %u skipped\n",
+                gtk_application_window_get_id(
+                        GTK_APPLICATION_WINDOW(l->data)
+                    ),
+                done,
+                skipped
+            );
+    }
+}
+
 static GActionEntry app_entries[] = {
     { "new-window",  new_window_cb,    NULL, NULL, NULL },
     { "preferences", preferences_cb,   NULL, NULL, NULL },
@@ -337,6 +733,7 @@ static GActionEntry app_entries[] = {
     { "raise",       raise_cb,         NULL, NULL, NULL },
     { "import",      ag_app_import_cb, "s",  NULL, NULL },
     { "help",        help_cb,          NULL, NULL, NULL },
+    { "dump-trace",  dump_trace_cb,    NULL, NULL, NULL },
 };
 
 static void
@@ -356,6 +753,7 @@ const gchar *action_accels[] = {
     "win.export",              "<Primary><Shift>E", NULL,
     "win.gear-menu",           "F10",               NULL,
     "app.help",                "F1",                NULL,
+    "app.dump-trace",          "<Primary><Shift>T", NULL,
     "win.change-tab::chart",   "F5",                NULL,
     "win.change-tab::aspects", "F6",                NULL,
     "win.change-tab::points",  "F7",                NULL,
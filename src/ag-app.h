@@ -67,6 +67,10 @@ void ag_app_quit(AgApp *self);
 
 void ag_app_raise(AgApp *self);
 
+void ag_app_import_files(AgApp           *app,
+                         GSList          *uris,
+                         AgAppImportType type);
+
 void ag_app_run_action(AgApp                   *app,
                        gboolean                is_remote,
                        const AstrognomeOptions *options);
@@ -0,0 +1,870 @@
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+#include "ag-aspect-grid.h"
+
+// The grid is a lower triangle: the planets label the rows on the left and
+// the diagonal, and the aspect between the planets of row i and j (j < i) is
+// in the cell at column j + 1 of row i. Nothing is allocated when the
+// aspects change; the labels are created once, and reused until the planets
+// or the symbol settings change.
+
+#define AG_ASPECT_GRID_CELL_PADDING 4
+
+typedef struct _AgAspectGridPrivate {
+    gboolean    planets_char;
+    gboolean    aspects_char;
+    guint       n_planets;
+    GswePlanet  *planets;
+    PangoLayout **planet_labels;
+    GdkPixbuf   *sun_icon;
+    GsweAspect  *aspects;
+    GHashTable  *aspect_labels;
+    gint        cell_size;
+} AgAspectGridPrivate;
+
+enum {
+    PROP_0,
+    PROP_PLANETS_CHAR,
+    PROP_ASPECTS_CHAR,
+    PROP_LAST
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE(AgAspectGrid, ag_aspect_grid, GTK_TYPE_DRAWING_AREA);
+
+static GParamSpec *properties[PROP_LAST];
+
+static const gchar *
+ag_aspect_grid_planet_character(GswePlanet planet)
+{
+    switch (planet) {
+        case GSWE_PLANET_ASCENDANT:
+            return "AC";
+
+        case GSWE_PLANET_MC:
+            return "MC";
+
+        case GSWE_PLANET_VERTEX:
+            return "Vx";
+
+        case GSWE_PLANET_SUN:
+            return "☉";
+
+        case GSWE_PLANET_MOON:
+            return "☽";
+
+        case GSWE_PLANET_MOON_NODE:
+            return "☊";
+
+        case GSWE_PLANET_MERCURY:
+            return "☿";
+
+        case GSWE_PLANET_VENUS:
+            return "♀";
+
+        case GSWE_PLANET_MARS:
+            return "♂";
+
+        case GSWE_PLANET_JUPITER:
+            return "♃";
+
+        case GSWE_PLANET_SATURN:
+            return "♄";
+
+        case GSWE_PLANET_URANUS:
+            return "♅";
+
+        case GSWE_PLANET_NEPTUNE:
+            return "♆";
+
+        case GSWE_PLANET_PLUTO:
+            return "♇";
+
+        case GSWE_PLANET_CERES:
+            return "⚳";
+
+        case GSWE_PLANET_PALLAS:
+            return "⚴";
+
+        case GSWE_PLANET_JUNO:
+            return "⚵";
+
+        case GSWE_PLANET_VESTA:
+            return "⚶";
+
+        case GSWE_PLANET_CHIRON:
+            return "⚷";
+
+        case GSWE_PLANET_MOON_APOGEE:
+            return "⚸";
+
+        default:
+            return NULL;
+    }
+}
+
+static const gchar *
+ag_aspect_grid_aspect_character(GsweAspect aspect)
+{
+    switch (aspect) {
+        case GSWE_ASPECT_CONJUCTION:
+            return "☌";
+
+        case GSWE_ASPECT_OPPOSITION:
+            return "☍";
+
+        case GSWE_ASPECT_QUINTILE:
+            return "Q";
+
+        case GSWE_ASPECT_BIQUINTILE:
+            return "BQ";
+
+        case GSWE_ASPECT_SQUARE:
+            return "◽";
+
+        case GSWE_ASPECT_TRINE:
+            return "▵";
+
+        case GSWE_ASPECT_SEXTILE:
+            return "⚹";
+
+        case GSWE_ASPECT_SEMISEXTILE:
+            return "⚺";
+
+        case GSWE_ASPECT_QUINCUNX:
+            return "⚻";
+
+        case GSWE_ASPECT_SESQUISQUARE:
+            return "⚼";
+
+        default:
+            return NULL;
+    }
+}
+
+static const gchar *
+ag_aspect_grid_planet_name(GswePlanet planet)
+{
+    GswePlanetInfo *planet_info;
+
+    if ((planet_info = gswe_find_planet_info_by_id(planet, NULL)) == NULL) {
+        return NULL;
+    }
+
+    return gswe_planet_info_get_name(planet_info);
+}
+
+static const gchar *
+ag_aspect_grid_aspect_name(GsweAspect aspect)
+{
+    GsweAspectInfo *aspect_info;
+
+    if ((aspect_info = gswe_find_aspect_info_by_id(aspect, NULL)) == NULL) {
+        return NULL;
+    }
+
+    return gswe_aspect_info_get_name(aspect_info);
+}
+
+static void
+ag_aspect_grid_measure(AgAspectGrid *aspect_grid, PangoLayout *layout)
+{
+    AgAspectGridPrivate *priv = ag_aspect_grid_get_instance_private(
+            aspect_grid
+        );
+    gint                width,
+                        height;
+
+    pango_layout_get_pixel_size(layout, &width, &height);
+
+    priv->cell_size = MAX(
+            priv->cell_size,
+            MAX(width, height) + 2 * AG_ASPECT_GRID_CELL_PADDING
+        );
+}
+
+static gint
+ag_aspect_grid_get_cell_size(AgAspectGrid *aspect_grid)
+{
+    AgAspectGridPrivate *priv = ag_aspect_grid_get_instance_private(
+            aspect_grid
+        );
+    GHashTableIter      iter;
+    PangoLayout         *layout;
+    guint               i;
+
+    if (priv->cell_size != 0) {
+        return priv->cell_size;
+    }
+
+    if (priv->sun_icon) {
+        priv->cell_size = MAX(
+                gdk_pixbuf_get_width(priv->sun_icon),
+                gdk_pixbuf_get_height(priv->sun_icon)
+            ) + 2 * AG_ASPECT_GRID_CELL_PADDING;
+    }
+
+    for (i = 0; i < priv->n_planets; i++) {
+        if (priv->planet_labels[i]) {
+            ag_aspect_grid_measure(aspect_grid, priv->planet_labels[i]);
+        }
+    }
+
+    g_hash_table_iter_init(&iter, priv->aspect_labels);
+
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&layout)) {
+        ag_aspect_grid_measure(aspect_grid, layout);
+    }
+
+    return priv->cell_size;
+}
+
+static void
+ag_aspect_grid_clear_planet_labels(AgAspectGrid *aspect_grid)
+{
+    AgAspectGridPrivate *priv = ag_aspect_grid_get_instance_private(
+            aspect_grid
+        );
+    guint               i;
+
+    for (i = 0; i < priv->n_planets; i++) {
+        g_clear_object(&(priv->planet_labels[i]));
+    }
+
+    g_clear_object(&(priv->sun_icon));
+}
+
+static void
+ag_aspect_grid_create_planet_labels(AgAspectGrid *aspect_grid)
+{
+    AgAspectGridPrivate *priv = ag_aspect_grid_get_instance_private(
+            aspect_grid
+        );
+    guint               i;
+
+    for (i = 0; i < priv->n_planets; i++) {
+        GswePlanet  planet = priv->planets[i];
+        const gchar *text  = (priv->planets_char)
+                ? ag_aspect_grid_planet_character(planet)
+                : NULL;
+
+        if (text == NULL) {
+            if (planet == GSWE_PLANET_SUN) {
+                if (priv->sun_icon == NULL) {
+                    priv->sun_icon = gdk_pixbuf_new_from_resource(
+                            "/eu/polonkai/gergely"
+                            "/Astrognome/default-icons/planet-sun.svg",
+                            NULL
+                        );
+                }
+
+                continue;
+            }
+
+            if ((text = ag_aspect_grid_planet_name(planet)) == NULL) {
+                continue;
+            }
+        }
+
+        priv->planet_labels[i] = gtk_widget_create_pango_layout(
+                GTK_WIDGET(aspect_grid),
+                text
+            );
+    }
+
+    priv->cell_size = 0;
+    gtk_widget_queue_resize(GTK_WIDGET(aspect_grid));
+}
+
+static PangoLayout *
+ag_aspect_grid_get_aspect_label(AgAspectGrid *aspect_grid, GsweAspect aspect)
+{
+    AgAspectGridPrivate *priv = ag_aspect_grid_get_instance_private(
+            aspect_grid
+        );
+    PangoLayout         *layout;
+    const gchar         *text;
+
+    if ((layout = g_hash_table_lookup(
+                priv->aspect_labels,
+                GINT_TO_POINTER(aspect)
+            )) != NULL) {
+        return layout;
+    }
+
+    if (
+                !priv->aspects_char
+                || ((text = ag_aspect_grid_aspect_character(aspect)) == NULL)
+            ) {
+        if ((text = ag_aspect_grid_aspect_name(aspect)) == NULL) {
+            return NULL;
+        }
+    }
+
+    layout = gtk_widget_create_pango_layout(GTK_WIDGET(aspect_grid), text);
+    g_hash_table_insert(priv->aspect_labels, GINT_TO_POINTER(aspect), layout);
+
+    // A new label may be larger than the others
+    if (priv->cell_size != 0) {
+        gint old_size = priv->cell_size;
+
+        ag_aspect_grid_measure(aspect_grid, layout);
+
+        if (priv->cell_size != old_size) {
+            gtk_widget_queue_resize(GTK_WIDGET(aspect_grid));
+        }
+    }
+
+    return layout;
+}
+
+/**
+ * ag_aspect_grid_set_planets:
+ * @aspect_grid: the #AgAspectGrid to operate on
+ * @planets: (element-type GswePlanet): the planets to show, as returned by
+ *           ag_chart_get_planets()
+ *
+ * Set the planets in the rows of the grid. If they are the same as the
+ * current ones, nothing happens; otherwise every aspect is cleared.
+ */
+void
+ag_aspect_grid_set_planets(AgAspectGrid *aspect_grid, GList *planets)
+{
+    AgAspectGridPrivate *priv = ag_aspect_grid_get_instance_private(
+            aspect_grid
+        );
+    GList               *planet;
+    guint               i,
+                        n_planets = g_list_length(planets);
+
+    if (n_planets == priv->n_planets) {
+        for (
+                    planet = planets, i = 0;
+                    planet;
+                    planet = g_list_next(planet), i++
+                ) {
+            if (priv->planets[i] != GPOINTER_TO_INT(planet->data)) {
+                break;
+            }
+        }
+
+        if (planet == NULL) {
+            return;
+        }
+    }
+
+    ag_aspect_grid_clear_planet_labels(aspect_grid);
+
+    priv->n_planets     = n_planets;
+    priv->planets       = g_renew(GswePlanet, priv->planets, n_planets);
+    priv->planet_labels = g_renew(
+            PangoLayout *,
+            priv->planet_labels,
+            n_planets
+        );
+    priv->aspects       = g_renew(
+            GsweAspect,
+            priv->aspects,
+            n_planets * n_planets
+        );
+
+    for (planet = planets, i = 0; planet; planet = g_list_next(planet), i++) {
+        priv->planets[i]       = GPOINTER_TO_INT(planet->data);
+        priv->planet_labels[i] = NULL;
+    }
+
+    for (i = 0; i < n_planets * n_planets; i++) {
+        priv->aspects[i] = GSWE_ASPECT_NONE;
+    }
+
+    ag_aspect_grid_create_planet_labels(aspect_grid);
+}
+
+/**
+ * ag_aspect_grid_set_aspect:
+ * @aspect_grid: the #AgAspectGrid to operate on
+ * @planet1: the index of the first planet in the list given to
+ *           ag_aspect_grid_set_planets()
+ * @planet2: the index of the second planet
+ * @aspect: the aspect between the two planets
+ *
+ * Set the aspect between two planets. The grid is only redrawn if the
+ * aspect is different from the one already shown.
+ */
+void
+ag_aspect_grid_set_aspect(AgAspectGrid *aspect_grid,
+                          guint        planet1,
+                          guint        planet2,
+                          GsweAspect   aspect)
+{
+    AgAspectGridPrivate *priv = ag_aspect_grid_get_instance_private(
+            aspect_grid
+        );
+    guint               cell;
+
+    g_return_if_fail(planet1 < priv->n_planets);
+    g_return_if_fail(planet2 < priv->n_planets);
+    g_return_if_fail(planet1 != planet2);
+
+    cell = MAX(planet1, planet2) * priv->n_planets + MIN(planet1, planet2);
+
+    if (priv->aspects[cell] == aspect) {
+        return;
+    }
+
+    priv->aspects[cell] = aspect;
+
+    if (aspect != GSWE_ASPECT_NONE) {
+        ag_aspect_grid_get_aspect_label(aspect_grid, aspect);
+    }
+
+    gtk_widget_queue_draw(GTK_WIDGET(aspect_grid));
+}
+
+/**
+ * ag_aspect_grid_set_planets_char:
+ * @aspect_grid: the #AgAspectGrid to operate on
+ * @planets_char: %TRUE to show the symbols of the planets instead of their
+ *                names
+ */
+void
+ag_aspect_grid_set_planets_char(AgAspectGrid *aspect_grid,
+                                gboolean     planets_char)
+{
+    AgAspectGridPrivate *priv = ag_aspect_grid_get_instance_private(
+            aspect_grid
+        );
+
+    if (priv->planets_char == planets_char) {
+        return;
+    }
+
+    priv->planets_char = planets_char;
+    ag_aspect_grid_clear_planet_labels(aspect_grid);
+    ag_aspect_grid_create_planet_labels(aspect_grid);
+
+    g_object_notify_by_pspec(
+            G_OBJECT(aspect_grid),
+            properties[PROP_PLANETS_CHAR]
+        );
+}
+
+/**
+ * ag_aspect_grid_set_aspects_char:
+ * @aspect_grid: the #AgAspectGrid to operate on
+ * @aspects_char: %TRUE to show the symbols of the aspects instead of their
+ *                names
+ */
+void
+ag_aspect_grid_set_aspects_char(AgAspectGrid *aspect_grid,
+                                gboolean     aspects_char)
+{
+    AgAspectGridPrivate *priv = ag_aspect_grid_get_instance_private(
+            aspect_grid
+        );
+
+    if (priv->aspects_char == aspects_char) {
+        return;
+    }
+
+    priv->aspects_char = aspects_char;
+
+    // Labels are recreated as they are drawn
+    g_hash_table_remove_all(priv->aspect_labels);
+    priv->cell_size = 0;
+    gtk_widget_queue_resize(GTK_WIDGET(aspect_grid));
+
+    g_object_notify_by_pspec(
+            G_OBJECT(aspect_grid),
+            properties[PROP_ASPECTS_CHAR]
+        );
+}
+
+static void
+ag_aspect_grid_draw_layout(GtkStyleContext *context,
+                           cairo_t         *cr,
+                           PangoLayout     *layout,
+                           gint            cell_size,
+                           guint           column,
+                           guint           row)
+{
+    gint width,
+         height;
+
+    pango_layout_get_pixel_size(layout, &width, &height);
+    gtk_render_layout(
+            context,
+            cr,
+            column * cell_size + (cell_size - width) / 2,
+            row * cell_size + (cell_size - height) / 2,
+            layout
+        );
+}
+
+static void
+ag_aspect_grid_draw_planet(AgAspectGrid    *aspect_grid,
+                           GtkStyleContext *context,
+                           cairo_t         *cr,
+                           gint            cell_size,
+                           guint           planet,
+                           guint           column,
+                           guint           row)
+{
+    AgAspectGridPrivate *priv = ag_aspect_grid_get_instance_private(
+            aspect_grid
+        );
+
+    if (priv->planet_labels[planet]) {
+        ag_aspect_grid_draw_layout(
+                context,
+                cr,
+                priv->planet_labels[planet],
+                cell_size,
+                column, row
+            );
+    } else if (
+                (priv->planets[planet] == GSWE_PLANET_SUN)
+                && priv->sun_icon
+            ) {
+        gtk_render_icon(
+                context,
+                cr,
+                priv->sun_icon,
+                column * cell_size
+                    + (cell_size - gdk_pixbuf_get_width(priv->sun_icon)) / 2,
+                row * cell_size
+                    + (cell_size - gdk_pixbuf_get_height(priv->sun_icon)) / 2
+            );
+    }
+}
+
+static gboolean
+ag_aspect_grid_draw(GtkWidget *widget, cairo_t *cr)
+{
+    AgAspectGrid        *aspect_grid = AG_ASPECT_GRID(widget);
+    AgAspectGridPrivate *priv        = ag_aspect_grid_get_instance_private(
+            aspect_grid
+        );
+    GtkStyleContext     *context     = gtk_widget_get_style_context(widget);
+    gint                cell_size    = ag_aspect_grid_get_cell_size(
+            aspect_grid
+        );
+    guint               i,
+                        j;
+
+    for (i = 0; i < priv->n_planets; i++) {
+        if (i > 0) {
+            ag_aspect_grid_draw_planet(
+                    aspect_grid,
+                    context,
+                    cr,
+                    cell_size,
+                    i,
+                    0, i
+                );
+        }
+
+        ag_aspect_grid_draw_planet(
+                aspect_grid,
+                context,
+                cr,
+                cell_size,
+                i,
+                i + 1, i
+            );
+
+        for (j = 0; j < i; j++) {
+            GsweAspect  aspect = priv->aspects[i * priv->n_planets + j];
+            PangoLayout *layout;
+
+            if (aspect == GSWE_ASPECT_NONE) {
+                continue;
+            }
+
+            if ((layout = ag_aspect_grid_get_aspect_label(
+                        aspect_grid,
+                        aspect
+                    )) != NULL) {
+                ag_aspect_grid_draw_layout(
+                        context,
+                        cr,
+                        layout,
+                        cell_size,
+                        j + 1, i
+                    );
+            }
+        }
+    }
+
+    return FALSE;
+}
+
+static gboolean
+ag_aspect_grid_query_tooltip(GtkWidget  *widget,
+                             gint       x,
+                             gint       y,
+                             gboolean   keyboard_mode,
+                             GtkTooltip *tooltip)
+{
+    AgAspectGrid        *aspect_grid = AG_ASPECT_GRID(widget);
+    AgAspectGridPrivate *priv        = ag_aspect_grid_get_instance_private(
+            aspect_grid
+        );
+    gint                cell_size    = ag_aspect_grid_get_cell_size(
+            aspect_grid
+        );
+    guint               column,
+                        row;
+    gchar               *text;
+    GdkRectangle        area;
+
+    if (keyboard_mode || (cell_size == 0) || (x < 0) || (y < 0)) {
+        return FALSE;
+    }
+
+    column = x / cell_size;
+    row    = y / cell_size;
+
+    if ((row >= priv->n_planets) || (column > row + 1)) {
+        return FALSE;
+    }
+
+    if ((column == row + 1) || ((column == 0) && (row > 0))) {
+        text = g_strdup(ag_aspect_grid_planet_name(priv->planets[row]));
+    } else if (column > 0) {
+        GsweAspect aspect = priv->aspects[
+                row * priv->n_planets + column - 1
+            ];
+
+        if (aspect == GSWE_ASPECT_NONE) {
+            return FALSE;
+        }
+
+        text = g_strdup_printf(
+                "%s %s %s",
+                ag_aspect_grid_planet_name(priv->planets[row]),
+                ag_aspect_grid_aspect_name(aspect),
+                ag_aspect_grid_planet_name(priv->planets[column - 1])
+            );
+    } else {
+        return FALSE;
+    }
+
+    area.x      = column * cell_size;
+    area.y      = row * cell_size;
+    area.width  = cell_size;
+    area.height = cell_size;
+
+    gtk_tooltip_set_text(tooltip, text);
+    gtk_tooltip_set_tip_area(tooltip, &area);
+    g_free(text);
+
+    return TRUE;
+}
+
+static void
+ag_aspect_grid_get_preferred_width(GtkWidget *widget,
+                                   gint      *minimum_width,
+                                   gint      *natural_width)
+{
+    AgAspectGrid        *aspect_grid = AG_ASPECT_GRID(widget);
+    AgAspectGridPrivate *priv        = ag_aspect_grid_get_instance_private(
+            aspect_grid
+        );
+
+    *minimum_width = *natural_width = (priv->n_planets + 1)
+        * ag_aspect_grid_get_cell_size(aspect_grid);
+}
+
+static void
+ag_aspect_grid_get_preferred_height(GtkWidget *widget,
+                                    gint      *minimum_height,
+                                    gint      *natural_height)
+{
+    AgAspectGrid        *aspect_grid = AG_ASPECT_GRID(widget);
+    AgAspectGridPrivate *priv        = ag_aspect_grid_get_instance_private(
+            aspect_grid
+        );
+
+    *minimum_height = *natural_height = priv->n_planets
+        * ag_aspect_grid_get_cell_size(aspect_grid);
+}
+
+static void
+ag_aspect_grid_style_updated(GtkWidget *widget)
+{
+    AgAspectGrid        *aspect_grid = AG_ASPECT_GRID(widget);
+    AgAspectGridPrivate *priv        = ag_aspect_grid_get_instance_private(
+            aspect_grid
+        );
+    GHashTableIter      iter;
+    PangoLayout         *layout;
+    guint               i;
+
+    GTK_WIDGET_CLASS(ag_aspect_grid_parent_class)->style_updated(widget);
+
+    // The font may have changed
+    for (i = 0; i < priv->n_planets; i++) {
+        if (priv->planet_labels[i]) {
+            pango_layout_context_changed(priv->planet_labels[i]);
+        }
+    }
+
+    g_hash_table_iter_init(&iter, priv->aspect_labels);
+
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&layout)) {
+        pango_layout_context_changed(layout);
+    }
+
+    priv->cell_size = 0;
+    gtk_widget_queue_resize(widget);
+}
+
+static void
+ag_aspect_grid_set_property(GObject      *gobject,
+                            guint        prop_id,
+                            const GValue *value,
+                            GParamSpec   *param_spec)
+{
+    switch (prop_id) {
+        case PROP_PLANETS_CHAR:
+            ag_aspect_grid_set_planets_char(
+                    AG_ASPECT_GRID(gobject),
+                    g_value_get_boolean(value)
+                );
+
+            break;
+
+        case PROP_ASPECTS_CHAR:
+            ag_aspect_grid_set_aspects_char(
+                    AG_ASPECT_GRID(gobject),
+                    g_value_get_boolean(value)
+                );
+
+            break;
+
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(gobject, prop_id, param_spec);
+
+            break;
+    }
+}
+
+static void
+ag_aspect_grid_get_property(GObject    *gobject,
+                            guint      prop_id,
+                            GValue     *value,
+                            GParamSpec *param_spec)
+{
+    AgAspectGridPrivate *priv = ag_aspect_grid_get_instance_private(
+            AG_ASPECT_GRID(gobject)
+        );
+
+    switch (prop_id) {
+        case PROP_PLANETS_CHAR:
+            g_value_set_boolean(value, priv->planets_char);
+
+            break;
+
+        case PROP_ASPECTS_CHAR:
+            g_value_set_boolean(value, priv->aspects_char);
+
+            break;
+
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(gobject, prop_id, param_spec);
+
+            break;
+    }
+}
+
+static void
+ag_aspect_grid_finalize(GObject *gobject)
+{
+    AgAspectGrid        *aspect_grid = AG_ASPECT_GRID(gobject);
+    AgAspectGridPrivate *priv        = ag_aspect_grid_get_instance_private(
+            aspect_grid
+        );
+
+    ag_aspect_grid_clear_planet_labels(aspect_grid);
+    g_free(priv->planets);
+    g_free(priv->planet_labels);
+    g_free(priv->aspects);
+    g_hash_table_destroy(priv->aspect_labels);
+
+    G_OBJECT_CLASS(ag_aspect_grid_parent_class)->finalize(gobject);
+}
+
+static void
+ag_aspect_grid_class_init(AgAspectGridClass *klass)
+{
+    GObjectClass   *gobject_class = G_OBJECT_CLASS(klass);
+    GtkWidgetClass *widget_class  = GTK_WIDGET_CLASS(klass);
+
+    gobject_class->finalize             = ag_aspect_grid_finalize;
+    gobject_class->set_property         = ag_aspect_grid_set_property;
+    gobject_class->get_property         = ag_aspect_grid_get_property;
+    widget_class->draw                  = ag_aspect_grid_draw;
+    widget_class->query_tooltip         = ag_aspect_grid_query_tooltip;
+    widget_class->get_preferred_width   = ag_aspect_grid_get_preferred_width;
+    widget_class->get_preferred_height  = ag_aspect_grid_get_preferred_height;
+    widget_class->style_updated         = ag_aspect_grid_style_updated;
+
+    properties[PROP_PLANETS_CHAR] = g_param_spec_boolean(
+            "planets-char",
+            "Planets char",
+            "Show the symbols of the planets instead of their names",
+            TRUE,
+            G_PARAM_STATIC_NAME
+                | G_PARAM_STATIC_NICK
+                | G_PARAM_STATIC_BLURB
+                | G_PARAM_READABLE
+                | G_PARAM_WRITABLE
+        );
+    g_object_class_install_property(
+            gobject_class,
+            PROP_PLANETS_CHAR,
+            properties[PROP_PLANETS_CHAR]
+        );
+
+    properties[PROP_ASPECTS_CHAR] = g_param_spec_boolean(
+            "aspects-char",
+            "Aspects char",
+            "Show the symbols of the aspects instead of their names",
+            TRUE,
+            G_PARAM_STATIC_NAME
+                | G_PARAM_STATIC_NICK
+                | G_PARAM_STATIC_BLURB
+                | G_PARAM_READABLE
+                | G_PARAM_WRITABLE
+        );
+    g_object_class_install_property(
+            gobject_class,
+            PROP_ASPECTS_CHAR,
+            properties[PROP_ASPECTS_CHAR]
+        );
+}
+
+static void
+ag_aspect_grid_init(AgAspectGrid *aspect_grid)
+{
+    AgAspectGridPrivate *priv = ag_aspect_grid_get_instance_private(
+            aspect_grid
+        );
+
+    priv->planets_char  = TRUE;
+    priv->aspects_char  = TRUE;
+    priv->aspect_labels = g_hash_table_new_full(
+            NULL,
+            NULL,
+            NULL,
+            g_object_unref
+        );
+
+    gtk_widget_set_has_tooltip(GTK_WIDGET(aspect_grid), TRUE);
+}
+
+GtkWidget *
+ag_aspect_grid_new(void)
+{
+    return GTK_WIDGET(g_object_new(AG_TYPE_ASPECT_GRID, NULL));
+}
@@ -0,0 +1,62 @@
+#ifndef __AG_ASPECT_GRID_H__
+#define __AG_ASPECT_GRID_H__
+
+#include <gtk/gtk.h>
+#include <swe-glib.h>
+
+G_BEGIN_DECLS
+
+#define AG_TYPE_ASPECT_GRID                                             \
+   (ag_aspect_grid_get_type())
+#define AG_ASPECT_GRID(obj)                                             \
+   (G_TYPE_CHECK_INSTANCE_CAST ((obj),                                  \
+                                AG_TYPE_ASPECT_GRID,                    \
+                                AgAspectGrid))
+#define AG_ASPECT_GRID_CLASS(klass)                                     \
+   (G_TYPE_CHECK_CLASS_CAST ((klass),                                   \
+                             AG_TYPE_ASPECT_GRID,                       \
+                             AgAspectGridClass))
+#define IS_AG_ASPECT_GRID(obj)                                          \
+   (G_TYPE_CHECK_INSTANCE_TYPE ((obj),                                  \
+                                AG_TYPE_ASPECT_GRID))
+#define IS_AG_ASPECT_GRID_CLASS(klass)                                  \
+   (G_TYPE_CHECK_CLASS_TYPE ((klass),                                   \
+                             AG_TYPE_ASPECT_GRID))
+#define AG_ASPECT_GRID_GET_CLASS(obj)                                   \
+   (G_TYPE_INSTANCE_GET_CLASS ((obj),                                   \
+                               AG_TYPE_ASPECT_GRID,                     \
+                               AgAspectGridClass))
+
+typedef struct _AgAspectGrid      AgAspectGrid;
+typedef struct _AgAspectGridClass AgAspectGridClass;
+
+struct _AgAspectGridClass
+{
+    GtkDrawingAreaClass parent_class;
+};
+
+struct _AgAspectGrid
+{
+    GtkDrawingArea parent;
+};
+
+GType ag_aspect_grid_get_type (void) G_GNUC_CONST;
+
+GtkWidget *ag_aspect_grid_new(void);
+
+void ag_aspect_grid_set_planets(AgAspectGrid *aspect_grid, GList *planets);
+
+void ag_aspect_grid_set_aspect(AgAspectGrid *aspect_grid,
+                               guint        planet1,
+                               guint        planet2,
+                               GsweAspect   aspect);
+
+void ag_aspect_grid_set_planets_char(AgAspectGrid *aspect_grid,
+                                     gboolean     planets_char);
+
+void ag_aspect_grid_set_aspects_char(AgAspectGrid *aspect_grid,
+                                     gboolean     aspects_char);
+
+G_END_DECLS
+
+#endif /* __AG_ASPECT_GRID_H__ */
@@ -0,0 +1,1146 @@
+/* ag-chart-cairo.c - Native cairo chart renderer for Astrognome
+ *
+ * Copyright (C) 2014 Polonkai Gergely
+ *
+ * Astrognome is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Astrognome is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <math.h>
+#include <string.h>
+#include <gio/gio.h>
+#include <libxml/parser.h>
+#include <libxml/tree.h>
+#include <cairo.h>
+#include <swe-glib.h>
+
+#include "astrognome.h"
+#include "ag-chart.h"
+#include "ag-chart-cairo.h"
+#include "ag-chart-geometry.h"
+
+// This renderer draws the same image as ui/chart-default.xsl with
+// ui/chart-default.css applied, without building an SVG document first.
+// The main sizes come from AgChartGeometry, the rest are taken from the
+// stylesheet; if you change one of them, change the other, too.
+
+#define AG_CHART_CAIRO_FONT_FACE        "serif"
+
+#define DEG_TO_RAD(d) ((d) * G_PI / 180.0)
+
+typedef struct {
+    gdouble       width;
+    guint32       color;
+    gdouble       alpha;
+    const gdouble *dashes;
+    gint          n_dashes;
+} AgChartCairoLineStyle;
+
+static const gchar *sign_names[] = {
+    "aries",
+    "taurus",
+    "gemini",
+    "cancer",
+    "leo",
+    "virgo",
+    "libra",
+    "scorpio",
+    "sagittarius",
+    "capricorn",
+    "aquarius",
+    "pisces",
+};
+
+// Fire, earth, air and water, in the order of the signs
+static const guint32 sign_element_colors[] = {
+    0xcc2222,
+    0x22cc22,
+    0xcccc22,
+    0x2222cc,
+};
+
+static const gdouble dash_dotted[] = { 1.0, 2.0 };
+static const gdouble dash_dashed[] = { 5.0, 5.0 };
+static const gdouble dash_long[]   = { 9.0, 3.0 };
+static const gdouble dash_antiscion[] = { 20.0, 10.0 };
+
+static GMutex     symbol_cache_lock;
+static GHashTable *symbol_cache = NULL;
+
+static void
+ag_chart_cairo_set_color(cairo_t *cr, guint32 color, gdouble alpha)
+{
+    cairo_set_source_rgba(
+            cr,
+            ((color >> 16) & 0xff) / 255.0,
+            ((color >> 8) & 0xff) / 255.0,
+            (color & 0xff) / 255.0,
+            alpha
+        );
+}
+
+static gboolean
+ag_chart_cairo_read_number(const gchar **data, gdouble *value)
+{
+    gchar *end;
+
+    while (g_ascii_isspace(**data) || (**data == ',')) {
+        (*data)++;
+    }
+
+    *value = g_ascii_strtod(*data, &end);
+
+    if (end == *data) {
+        return FALSE;
+    }
+
+    *data = end;
+
+    return TRUE;
+}
+
+/*
+ * ag_chart_cairo_append_svg_path:
+ * @cr: the cairo context to draw on
+ * @data: the d attribute of an SVG path element
+ *
+ * Append an SVG path to the current path of @cr. Only the commands used by
+ * the default icons (moveto, lineto, horizontal and vertical lineto,
+ * curveto and closepath, both absolute and relative) are supported.
+ *
+ * Returns: %FALSE if @data contains an unsupported command or a parse error
+ */
+static gboolean
+ag_chart_cairo_append_svg_path(cairo_t *cr, const gchar *data)
+{
+    gchar   command = 0;
+    gdouble v[6],
+            x,
+            y;
+    gint    i,
+            n_args;
+
+    while (TRUE) {
+        while (g_ascii_isspace(*data) || (*data == ',')) {
+            data++;
+        }
+
+        if (*data == 0) {
+            return TRUE;
+        }
+
+        if (g_ascii_isalpha(*data)) {
+            command = *(data++);
+
+            if ((command == 'z') || (command == 'Z')) {
+                cairo_close_path(cr);
+
+                continue;
+            }
+        } else if (command == 0) {
+            return FALSE;
+        }
+
+        switch (command) {
+            case 'M':
+            case 'm':
+            case 'L':
+            case 'l':
+                n_args = 2;
+
+                break;
+
+            case 'H':
+            case 'h':
+            case 'V':
+            case 'v':
+                n_args = 1;
+
+                break;
+
+            case 'C':
+            case 'c':
+                n_args = 6;
+
+                break;
+
+            default:
+                return FALSE;
+        }
+
+        for (i = 0; i < n_args; i++) {
+            if (!ag_chart_cairo_read_number(&data, &(v[i]))) {
+                return FALSE;
+            }
+        }
+
+        switch (command) {
+            case 'M':
+                cairo_move_to(cr, v[0], v[1]);
+                // Subsequent coordinate pairs are implicit lineto commands
+                command = 'L';
+
+                break;
+
+            case 'm':
+                if (cairo_has_current_point(cr)) {
+                    cairo_rel_move_to(cr, v[0], v[1]);
+                } else {
+                    cairo_move_to(cr, v[0], v[1]);
+                }
+
+                command = 'l';
+
+                break;
+
+            case 'L':
+                cairo_line_to(cr, v[0], v[1]);
+
+                break;
+
+            case 'l':
+                cairo_rel_line_to(cr, v[0], v[1]);
+
+                break;
+
+            case 'H':
+                cairo_get_current_point(cr, &x, &y);
+                cairo_line_to(cr, v[0], y);
+
+                break;
+
+            case 'h':
+                cairo_rel_line_to(cr, v[0], 0.0);
+
+                break;
+
+            case 'V':
+                cairo_get_current_point(cr, &x, &y);
+                cairo_line_to(cr, x, v[0]);
+
+                break;
+
+            case 'v':
+                cairo_rel_line_to(cr, 0.0, v[0]);
+
+                break;
+
+            case 'C':
+                cairo_curve_to(cr, v[0], v[1], v[2], v[3], v[4], v[5]);
+
+                break;
+
+            case 'c':
+                cairo_rel_curve_to(cr, v[0], v[1], v[2], v[3], v[4], v[5]);
+
+                break;
+        }
+    }
+}
+
+static cairo_path_t *
+ag_chart_cairo_load_symbol(const gchar *name)
+{
+    gchar           *resource_path;
+    GBytes          *data;
+    const gchar     *content;
+    gsize           length;
+    xmlDocPtr       doc;
+    xmlChar         *path_data = NULL;
+    cairo_surface_t *surface;
+    cairo_t         *cr;
+    cairo_path_t    *path      = NULL;
+
+    resource_path = g_strdup_printf(
+            "/eu/polonkai/gergely/Astrognome/default-icons/%s.xml",
+            name
+        );
+    data = g_resources_lookup_data(
+            resource_path,
+            G_RESOURCE_LOOKUP_FLAGS_NONE,
+            NULL
+        );
+    g_free(resource_path);
+
+    if (data == NULL) {
+        g_warning("No chart symbol for ‘%s’", name);
+
+        return NULL;
+    }
+
+    content = g_bytes_get_data(data, &length);
+
+    if ((doc = xmlReadMemory(content, length, NULL, "UTF-8", 0)) != NULL) {
+        path_data = xmlGetProp(xmlDocGetRootElement(doc), BAD_CAST "d");
+        xmlFreeDoc(doc);
+    }
+
+    g_bytes_unref(data);
+
+    if (path_data == NULL) {
+        g_warning("Chart symbol ‘%s’ is not a valid SVG path", name);
+
+        return NULL;
+    }
+
+    // The path is built with an identity matrix, so it can be appended to
+    // any context later, transformed by its current matrix
+    surface = cairo_image_surface_create(CAIRO_FORMAT_A1, 1, 1);
+    cr      = cairo_create(surface);
+
+    if (ag_chart_cairo_append_svg_path(cr, (const gchar *)path_data)) {
+        path = cairo_copy_path(cr);
+    } else {
+        g_warning("Chart symbol ‘%s’ can not be parsed", name);
+    }
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    xmlFree(path_data);
+
+    return path;
+}
+
+/*
+ * ag_chart_cairo_get_symbol:
+ * @name: the name of the symbol, like sign-aries or planet-moon-node
+ *
+ * Get the path of a chart symbol. Symbols are parsed from the icon
+ * resources on first use, and kept until
+ * ag_chart_cairo_clear_symbol_cache() is called.
+ *
+ * Returns: (transfer none): the path of the symbol, or %NULL if it can not
+ *          be loaded
+ */
+static const cairo_path_t *
+ag_chart_cairo_get_symbol(const gchar *name)
+{
+    cairo_path_t *path;
+
+    g_mutex_lock(&symbol_cache_lock);
+
+    if (symbol_cache == NULL) {
+        symbol_cache = g_hash_table_new_full(
+                g_str_hash,
+                g_str_equal,
+                g_free,
+                (GDestroyNotify)cairo_path_destroy
+            );
+    }
+
+    // Symbols that failed to load are cached as NULL, so the warning is
+    // printed only once
+    if (!g_hash_table_lookup_extended(
+                symbol_cache,
+                name,
+                NULL,
+                (gpointer *)&path
+            )) {
+        path = ag_chart_cairo_load_symbol(name);
+        g_hash_table_insert(symbol_cache, g_strdup(name), path);
+    }
+
+    g_mutex_unlock(&symbol_cache_lock);
+
+    return path;
+}
+
+/**
+ * ag_chart_cairo_clear_symbol_cache:
+ *
+ * Free the parsed chart symbols. This must not be called while a chart is
+ * being drawn.
+ */
+void
+ag_chart_cairo_clear_symbol_cache(void)
+{
+    g_mutex_lock(&symbol_cache_lock);
+    g_clear_pointer(&symbol_cache, g_hash_table_destroy);
+    g_mutex_unlock(&symbol_cache_lock);
+}
+
+static void
+ag_chart_cairo_get_geometry(const AgChartLayout *layout,
+                            guint               image_size,
+                            guint               icon_size,
+                            AgChartGeometry     *geometry)
+{
+    ag_chart_geometry_init(
+            geometry,
+            layout->ascendant,
+            layout->max_dist,
+            image_size,
+            icon_size
+        );
+}
+
+/**
+ * ag_chart_cairo_get_image_size:
+ * @layout: the chart layout to draw
+ * @image_size: the requested image size, or 0 to use the default chart size
+ * @icon_size: the requested icon size, or 0 to use the default icon size
+ *
+ * Get the size of the image ag_chart_cairo_draw() will draw with the same
+ * parameters. If @image_size is not 0, this is @image_size; otherwise it
+ * depends on how many planets have to be moved outwards so they don’t
+ * overlap.
+ *
+ * Returns: the width and height of the image, in pixels
+ */
+gint
+ag_chart_cairo_get_image_size(const AgChartLayout *layout,
+                              guint               image_size,
+                              guint               icon_size)
+{
+    AgChartGeometry geometry;
+
+    ag_chart_cairo_get_geometry(layout, image_size, icon_size, &geometry);
+
+    return (gint)ceil(geometry.image_size);
+}
+
+static void
+ag_chart_cairo_radial_line(cairo_t *cr,
+                           gdouble degree,
+                           gdouble r1,
+                           gdouble r2)
+{
+    gdouble x,
+            y;
+
+    ag_chart_geometry_polar(degree, r1, &x, &y);
+    cairo_move_to(cr, x, y);
+    ag_chart_geometry_polar(degree, r2, &x, &y);
+    cairo_line_to(cr, x, y);
+}
+
+/*
+ * ag_chart_cairo_rotate_around:
+ *
+ * The equivalent of the SVG transformation rotate(@degree, @x, @y)
+ */
+static void
+ag_chart_cairo_rotate_around(cairo_t *cr,
+                             gdouble degree,
+                             gdouble x,
+                             gdouble y)
+{
+    cairo_translate(cr, x, y);
+    cairo_rotate(cr, DEG_TO_RAD(degree));
+    cairo_translate(cr, -x, -y);
+}
+
+static void
+ag_chart_cairo_draw_symbol(cairo_t     *cr,
+                           const gchar *name,
+                           guint32     color,
+                           gdouble     scale)
+{
+    const cairo_path_t *path;
+
+    if ((path = ag_chart_cairo_get_symbol(name)) == NULL) {
+        return;
+    }
+
+    cairo_save(cr);
+    cairo_scale(cr, scale, scale);
+    cairo_new_path(cr);
+    cairo_append_path(cr, path);
+    ag_chart_cairo_set_color(cr, color, 1.0);
+    cairo_set_line_width(cr, 2.0);
+    cairo_stroke(cr);
+    cairo_restore(cr);
+}
+
+static void
+ag_chart_cairo_draw_base(cairo_t                    *cr,
+                         const AgChartGeometry      *geometry)
+{
+    gint i;
+
+    ag_chart_cairo_set_color(cr, 0x0000cc, 1.0);
+
+    cairo_new_path(cr);
+    cairo_arc(cr, 0.0, 0.0, geometry->r_outer, 0.0, 2 * G_PI);
+    cairo_new_sub_path(cr);
+    cairo_arc(cr, 0.0, 0.0, geometry->r_aspect, 0.0, 2 * G_PI);
+    cairo_set_line_width(cr, 2.5);
+    cairo_stroke(cr);
+
+    cairo_arc(cr, 0.0, 0.0, geometry->r_signs, 0.0, 2 * G_PI);
+    cairo_new_sub_path(cr);
+    cairo_arc(cr, 0.0, 0.0, geometry->r_houses, 0.0, 2 * G_PI);
+    cairo_set_line_width(cr, 1.0);
+    cairo_stroke(cr);
+
+    // Sign boundaries
+    for (i = 0; i < 360; i += 30) {
+        ag_chart_cairo_radial_line(
+                cr,
+                i,
+                geometry->r_aspect,
+                geometry->r_outer
+            );
+    }
+
+    cairo_set_line_width(cr, 2.0);
+    cairo_stroke(cr);
+
+    // Degree marks
+    for (i = 1; i < 360; i++) {
+        gdouble length;
+
+        if (i % 30 == 0) {
+            continue;
+        } else if (i % 10 == 0) {
+            length = geometry->r_signs - geometry->r_aspect;
+        } else if (i % 5 == 0) {
+            length = geometry->deg5_len;
+        } else {
+            length = geometry->deg1_len;
+        }
+
+        ag_chart_cairo_radial_line(
+                cr,
+                i,
+                geometry->r_aspect,
+                geometry->r_aspect + length
+            );
+    }
+
+    cairo_set_line_width(cr, 1.0);
+    cairo_stroke(cr);
+
+    cairo_set_line_cap(cr, CAIRO_LINE_CAP_BUTT);
+    cairo_set_line_join(cr, CAIRO_LINE_JOIN_BEVEL);
+
+    for (i = 0; i < G_N_ELEMENTS(sign_names); i++) {
+        gchar *name = g_strdup_printf("sign-%s", sign_names[i]);
+
+        cairo_save(cr);
+        cairo_rotate(cr, DEG_TO_RAD(-(15 + 30 * i)));
+        cairo_translate(
+                cr,
+                geometry->sign_pos,
+                -geometry->icon_size / 2
+            );
+        ag_chart_cairo_rotate_around(
+                cr,
+                90.0,
+                geometry->icon_size / 2,
+                geometry->icon_size / 2
+            );
+        ag_chart_cairo_draw_symbol(
+                cr,
+                name,
+                sign_element_colors[i % G_N_ELEMENTS(sign_element_colors)],
+                geometry->icon_scale
+            );
+        cairo_restore(cr);
+
+        g_free(name);
+    }
+
+    cairo_set_line_join(cr, CAIRO_LINE_JOIN_MITER);
+}
+
+static void
+ag_chart_cairo_draw_axis(cairo_t                    *cr,
+                         const AgChartGeometry      *geometry,
+                         gdouble                    degree)
+{
+    gdouble chart_size = geometry->chart_size,
+            x1         = chart_size * 0.533333,
+            ref_x      = chart_size * 0.005833,
+            arrow[4][2] = {
+                { 0.0, 0.0 },
+                { chart_size * 0.011666, -chart_size * 0.003333 },
+                { chart_size * 0.008333, 0.0 },
+                { chart_size * 0.011666, chart_size * 0.003333 },
+            };
+    gint    i;
+
+    cairo_save(cr);
+    cairo_rotate(cr, DEG_TO_RAD(-degree));
+
+    cairo_set_source_rgb(cr, 0.0, 0.0, 0.0);
+    cairo_set_line_width(cr, 3.0);
+
+    cairo_move_to(cr, -x1, 0.0);
+    cairo_line_to(cr, -chart_size * 0.083333, 0.0);
+    cairo_move_to(cr, x1, 0.0);
+    cairo_line_to(cr, chart_size * 0.083333, 0.0);
+    cairo_stroke(cr);
+
+    // The arrow marker at the outer end of the line. It is oriented along
+    // the line (which points inwards) and scaled by the stroke width
+    for (i = 0; i < G_N_ELEMENTS(arrow); i++) {
+        gdouble x = x1 - 3.0 * (arrow[i][0] - ref_x),
+                y = -3.0 * arrow[i][1];
+
+        if (i == 0) {
+            cairo_move_to(cr, x, y);
+        } else {
+            cairo_line_to(cr, x, y);
+        }
+    }
+
+    cairo_close_path(cr);
+    cairo_fill(cr);
+
+    cairo_restore(cr);
+}
+
+static void
+ag_chart_cairo_draw_houses(cairo_t                    *cr,
+                           const AgChartLayout        *layout,
+                           const AgChartGeometry      *geometry)
+{
+    guint   i;
+    gdouble chart_size = geometry->chart_size;
+
+    cairo_select_font_face(
+            cr,
+            AG_CHART_CAIRO_FONT_FACE,
+            CAIRO_FONT_SLANT_NORMAL,
+            CAIRO_FONT_WEIGHT_NORMAL
+        );
+    cairo_set_font_size(cr, chart_size * 0.016666);
+    cairo_set_source_rgb(cr, 0.0, 0.0, 0.0);
+
+    for (i = 0; i < layout->n_houses; i++) {
+        gdouble              degree = layout->houses[i],
+                             next   = layout->houses[
+                                     (i + 1) % layout->n_houses
+                                 ],
+                             mid;
+        gchar                number[4];
+        cairo_text_extents_t extents;
+
+        if (next < degree) {
+            next += 360.0;
+        }
+
+        if ((mid = (degree + next) / 2) > 360.0) {
+            mid -= 360.0;
+        }
+
+        g_snprintf(number, sizeof(number), "%u", i + 1);
+        cairo_text_extents(cr, number, &extents);
+
+        cairo_save(cr);
+        cairo_rotate(cr, DEG_TO_RAD(-mid));
+        cairo_translate(cr, chart_size * 0.091666, 0.0);
+        cairo_rotate(cr, G_PI / 2);
+        cairo_move_to(cr, -extents.x_advance / 2, 0.0);
+        cairo_show_text(cr, number);
+        cairo_restore(cr);
+    }
+
+    cairo_new_path(cr);
+
+    for (i = 0; i < layout->n_houses; i++) {
+        ag_chart_cairo_radial_line(
+                cr,
+                layout->houses[i],
+                chart_size * 0.083333,
+                chart_size * 0.4
+            );
+        ag_chart_cairo_radial_line(
+                cr,
+                layout->houses[i],
+                chart_size * 0.5,
+                chart_size * 0.55
+            );
+    }
+
+    ag_chart_cairo_set_color(cr, 0x0000cc, 1.0);
+    cairo_set_line_width(cr, 1.0);
+    cairo_stroke(cr);
+
+    ag_chart_cairo_draw_axis(cr, geometry, layout->ascendant);
+    ag_chart_cairo_draw_axis(cr, geometry, layout->mc);
+}
+
+static void
+ag_chart_cairo_draw_planet(cairo_t                    *cr,
+                           const AgChartGeometry      *geometry,
+                           const gchar                *symbol,
+                           gdouble                    degree,
+                           guint                      dist,
+                           gboolean                   retrograde,
+                           gboolean                   upside_down)
+{
+    gdouble icon_size = geometry->icon_size;
+
+    cairo_save(cr);
+    cairo_rotate(cr, DEG_TO_RAD(-degree));
+
+    cairo_move_to(cr, geometry->r_aspect - geometry->planet_marker_len, 0.0);
+    cairo_line_to(cr, geometry->r_aspect, 0.0);
+    cairo_move_to(cr, geometry->r_outer, 0.0);
+    cairo_line_to(cr, geometry->r_outer + geometry->planet_marker_len, 0.0);
+    ag_chart_cairo_set_color(cr, 0x555555, 1.0);
+    cairo_set_line_width(cr, 1.5);
+    cairo_stroke(cr);
+
+    // Move the symbol outwards, and turn it back upright
+    cairo_translate(
+            cr,
+            ag_chart_geometry_get_planet_pos(geometry, dist),
+            -icon_size / 2
+        );
+    ag_chart_cairo_rotate_around(
+            cr,
+            degree - geometry->asc_rotate,
+            icon_size / 2,
+            icon_size / 2
+        );
+
+    if (retrograde) {
+        cairo_save(cr);
+        cairo_translate(cr, icon_size, icon_size * 1.5);
+        cairo_set_font_size(cr, icon_size / 2);
+        cairo_set_source_rgb(cr, 0.0, 0.0, 0.0);
+        cairo_move_to(cr, 0.0, 0.0);
+        cairo_show_text(cr, "R");
+        cairo_restore(cr);
+    }
+
+    if (upside_down) {
+        ag_chart_cairo_rotate_around(cr, 180.0, icon_size / 2, icon_size / 2);
+    }
+
+    ag_chart_cairo_draw_symbol(cr, symbol, 0x000080, geometry->icon_scale);
+
+    cairo_restore(cr);
+}
+
+static void
+ag_chart_cairo_draw_planets(cairo_t                    *cr,
+                            const AgChartLayout        *layout,
+                            const AgChartGeometry      *geometry,
+                            AgDisplayTheme             *theme)
+{
+    guint i;
+
+    cairo_select_font_face(
+            cr,
+            AG_CHART_CAIRO_FONT_FACE,
+            CAIRO_FONT_SLANT_NORMAL,
+            CAIRO_FONT_WEIGHT_NORMAL
+        );
+
+    if (ag_display_theme_shows_planet(theme, GSWE_PLANET_VERTEX)) {
+        ag_chart_cairo_draw_planet(
+                cr,
+                geometry,
+                "point-vertex",
+                layout->vertex,
+                layout->vertex_dist,
+                FALSE,
+                FALSE
+            );
+    }
+
+    for (i = 0; i < layout->n_bodies; i++) {
+        const AgChartLayoutBody *body = &(layout->bodies[i]);
+        gchar                   *symbol;
+
+        if (!ag_display_theme_shows_planet(theme, body->planet)) {
+            continue;
+        }
+
+        symbol = g_strdup_printf(
+                "planet-%s",
+                ag_planet_id_to_nick(body->planet)
+            );
+
+        ag_chart_cairo_draw_planet(
+                cr,
+                geometry,
+                symbol,
+                body->position,
+                body->dist,
+                body->retrograde,
+                FALSE
+            );
+
+        // The descending node is drawn opposite to the ascending one
+        if (body->planet == GSWE_PLANET_MOON_NODE) {
+            ag_chart_cairo_draw_planet(
+                    cr,
+                    geometry,
+                    symbol,
+                    body->position + 180.0,
+                    body->dist,
+                    body->retrograde,
+                    TRUE
+                );
+        }
+
+        g_free(symbol);
+    }
+}
+
+static void
+ag_chart_cairo_get_aspect_style(GsweAspect            aspect,
+                                AgChartCairoLineStyle *style)
+{
+    style->width    = 1.0;
+    style->color    = 0x000000;
+    style->alpha    = 1.0;
+    style->dashes   = dash_dotted;
+    style->n_dashes = G_N_ELEMENTS(dash_dotted);
+
+    switch (aspect) {
+        case GSWE_ASPECT_CONJUCTION:
+            style->width = 5.0;
+            style->color = 0x00cc00;
+            style->alpha = 0.5;
+
+            break;
+
+        case GSWE_ASPECT_SEXTILE:
+            style->color    = 0x00cc00;
+            style->n_dashes = 0;
+
+            break;
+
+        case GSWE_ASPECT_SQUARE:
+            style->color    = 0xc00000;
+            style->n_dashes = 0;
+
+            break;
+
+        case GSWE_ASPECT_TRINE:
+            style->color    = 0x000080;
+            style->n_dashes = 0;
+
+            break;
+
+        case GSWE_ASPECT_OPPOSITION:
+            style->color    = 0xc00000;
+            style->dashes   = dash_dashed;
+            style->n_dashes = G_N_ELEMENTS(dash_dashed);
+
+            break;
+
+        case GSWE_ASPECT_SEMISEXTILE:
+        case GSWE_ASPECT_BIQUINTILE:
+            style->color = 0x00cc00;
+
+            break;
+
+        case GSWE_ASPECT_SEMISQUARE:
+            style->color    = 0xcc0000;
+            style->dashes   = dash_long;
+            style->n_dashes = G_N_ELEMENTS(dash_long);
+
+            break;
+
+        case GSWE_ASPECT_QUINTILE:
+            style->color    = 0x00cc00;
+            style->dashes   = dash_long;
+            style->n_dashes = G_N_ELEMENTS(dash_long);
+
+            break;
+
+        case GSWE_ASPECT_QUINCUNX:
+            style->color = 0xcc0000;
+
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void
+ag_chart_cairo_draw_aspects(cairo_t                    *cr,
+                            const AgChartLayout        *layout,
+                            const AgChartGeometry      *geometry,
+                            AgDisplayTheme             *theme)
+{
+    guint   i;
+    gdouble x,
+            y;
+
+    for (i = 0; i < layout->n_aspects; i++) {
+        const AgChartLayoutAspect *aspect = &(layout->aspects[i]);
+        AgChartCairoLineStyle     style;
+
+        if (
+                    !ag_display_theme_shows_aspect(theme, aspect->aspect)
+                    || !ag_display_theme_shows_planet(theme, aspect->planet1)
+                    || !ag_display_theme_shows_planet(theme, aspect->planet2)
+                ) {
+            continue;
+        }
+
+        ag_chart_cairo_get_aspect_style(aspect->aspect, &style);
+
+        ag_chart_geometry_polar(aspect->position1, geometry->r_aspect, &x, &y);
+        cairo_move_to(cr, x, y);
+        ag_chart_geometry_polar(aspect->position2, geometry->r_aspect, &x, &y);
+        cairo_line_to(cr, x, y);
+        ag_chart_cairo_set_color(cr, style.color, style.alpha);
+        cairo_set_line_width(cr, style.width);
+        cairo_set_dash(cr, style.dashes, style.n_dashes, 0.0);
+        cairo_stroke(cr);
+    }
+
+    cairo_set_dash(cr, NULL, 0, 0.0);
+}
+
+static void
+ag_chart_cairo_draw_antiscia(cairo_t                    *cr,
+                             const AgChartLayout        *layout,
+                             const AgChartGeometry      *geometry,
+                             AgDisplayTheme             *theme)
+{
+    guint   i;
+    gdouble x,
+            y;
+
+    for (i = 0; i < layout->n_antiscia; i++) {
+        const AgChartLayoutAntiscion *antiscion = &(layout->antiscia[i]);
+
+        if (
+                    !ag_display_theme_shows_antiscion_axis(
+                            theme,
+                            antiscion->axis
+                        )
+                    || !ag_display_theme_shows_planet(theme, antiscion->planet1)
+                    || !ag_display_theme_shows_planet(theme, antiscion->planet2)
+                ) {
+            continue;
+        }
+
+        ag_chart_geometry_polar(
+                antiscion->position1,
+                geometry->r_aspect,
+                &x, &y
+            );
+        cairo_move_to(cr, x, y);
+        ag_chart_geometry_polar(
+                antiscion->position2,
+                geometry->r_aspect,
+                &x, &y
+            );
+        cairo_line_to(cr, x, y);
+    }
+
+    ag_chart_cairo_set_color(cr, 0x000000, 1.0);
+    cairo_set_line_width(cr, 1.0);
+    cairo_set_dash(cr, dash_antiscion, G_N_ELEMENTS(dash_antiscion), 0.0);
+    cairo_stroke(cr);
+    cairo_set_dash(cr, NULL, 0, 0.0);
+}
+
+/*
+ * ag_chart_cairo_svg_arc:
+ *
+ * Add a circular arc to the current path, from the current point to
+ * (@x2, @y2), like the SVG path command A does. See the endpoint to center
+ * conversion in the SVG 1.1 specification, appendix F.6.5.
+ */
+static void
+ag_chart_cairo_svg_arc(cairo_t  *cr,
+                       gdouble  r,
+                       gboolean large_arc,
+                       gboolean sweep,
+                       gdouble  x2,
+                       gdouble  y2)
+{
+    gdouble x1,
+            y1,
+            hx,
+            hy,
+            d2,
+            coef,
+            cx,
+            cy,
+            angle1,
+            angle2;
+
+    cairo_get_current_point(cr, &x1, &y1);
+
+    hx = (x1 - x2) / 2;
+    hy = (y1 - y2) / 2;
+    d2 = hx * hx + hy * hy;
+
+    if (d2 == 0.0) {
+        return;
+    }
+
+    // Radii too small to reach the end point are scaled up
+    r = MAX(r, sqrt(d2));
+    coef = sqrt(MAX(0.0, (r * r - d2) / d2));
+
+    if (large_arc == sweep) {
+        coef = -coef;
+    }
+
+    cx     = coef * hy + (x1 + x2) / 2;
+    cy     = -coef * hx + (y1 + y2) / 2;
+    angle1 = atan2(y1 - cy, x1 - cx);
+    angle2 = atan2(y2 - cy, x2 - cx);
+
+    if (sweep) {
+        cairo_arc(cr, cx, cy, r, angle1, angle2);
+    } else {
+        cairo_arc_negative(cr, cx, cy, r, angle1, angle2);
+    }
+}
+
+static void
+ag_chart_cairo_draw_moon(cairo_t                    *cr,
+                         const AgChartLayout        *layout,
+                         const AgChartGeometry      *geometry)
+{
+    GEnumClass  *moon_phase_class;
+    GEnumValue  *enum_value;
+    const gchar *phase;
+    gdouble     r          = geometry->r_moon,
+                illum      = layout->moon_illumination,
+                r2;
+    gboolean    waning;
+
+    moon_phase_class = g_type_class_ref(GSWE_TYPE_MOON_PHASE);
+    enum_value       = g_enum_get_value(
+            moon_phase_class,
+            layout->moon_phase
+        );
+    phase            = (enum_value) ? enum_value->value_nick : "";
+    g_type_class_unref(moon_phase_class);
+
+    ag_chart_cairo_set_color(cr, 0xc0c0c0, 1.0);
+
+    if (strcmp(phase, "full") == 0) {
+        cairo_arc(cr, 0.0, 0.0, r, 0.0, 2 * G_PI);
+        cairo_fill(cr);
+
+        return;
+    }
+
+    if (strncmp(phase, "wa", 2) != 0) {
+        return;
+    }
+
+    waning = (strncmp(phase, "wan", 3) == 0);
+    r2     = ag_chart_geometry_get_moon_arc_radius(geometry, illum);
+
+    // The lit half of the disc, then the terminator back to the start
+    cairo_move_to(cr, 0.0, r);
+    ag_chart_cairo_svg_arc(cr, r, FALSE, waning, 0.0, -r);
+
+    if (illum == 50.0) {
+        cairo_line_to(cr, 0.0, r);
+    } else {
+        ag_chart_cairo_svg_arc(
+                cr,
+                r2,
+                FALSE,
+                (illum > 50.0) == waning,
+                0.0,
+                r
+            );
+    }
+
+    cairo_close_path(cr);
+    cairo_fill(cr);
+}
+
+/**
+ * ag_chart_cairo_draw:
+ * @layout: the chart layout to draw
+ * @cr: the cairo context to draw on
+ * @theme: (allow-none): the display theme to use
+ * @image_size: the image size, or 0 to use the default chart size
+ * @icon_size: the icon size, or 0 to use the default icon size
+ *
+ * Draw the chart onto @cr, at (0, 0), with the same look the built in
+ * stylesheet gives. The image is ag_chart_cairo_get_image_size() pixels
+ * wide and high. As @layout doesn’t reference the chart, this can be called
+ * from any thread.
+ */
+void
+ag_chart_cairo_draw(const AgChartLayout *layout,
+                    cairo_t             *cr,
+                    AgDisplayTheme      *theme,
+                    guint               image_size,
+                    guint               icon_size)
+{
+    ag_chart_cairo_draw_full(
+            layout,
+            cr,
+            theme,
+            image_size,
+            icon_size,
+            AG_CHART_CAIRO_CONNECTION_ASPECTS
+        );
+}
+
+/**
+ * ag_chart_cairo_draw_full:
+ * @layout: the chart layout to draw
+ * @cr: the cairo context to draw on
+ * @theme: (allow-none): the display theme to use
+ * @image_size: the image size, or 0 to use the default chart size
+ * @icon_size: the icon size, or 0 to use the default icon size
+ * @connection: the connections to draw between the planets
+ *
+ * Like ag_chart_cairo_draw(), but the antiscia can be drawn instead of the
+ * aspects, like the chart view does when switched to antiscia.
+ */
+void
+ag_chart_cairo_draw_full(const AgChartLayout    *layout,
+                         cairo_t                *cr,
+                         AgDisplayTheme         *theme,
+                         guint                  image_size,
+                         guint                  icon_size,
+                         AgChartCairoConnection connection)
+{
+    AgChartGeometry geometry;
+
+    ag_chart_cairo_get_geometry(layout, image_size, icon_size, &geometry);
+
+    cairo_save(cr);
+    cairo_set_miter_limit(cr, 4.0);
+
+    cairo_rectangle(cr, 0.0, 0.0, geometry.image_size, geometry.image_size);
+    cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+    cairo_fill(cr);
+
+    cairo_translate(cr, geometry.image_size / 2, geometry.image_size / 2);
+
+    cairo_save(cr);
+    cairo_rotate(cr, DEG_TO_RAD(geometry.asc_rotate));
+
+    ag_chart_cairo_draw_base(cr, &geometry);
+    ag_chart_cairo_draw_houses(cr, layout, &geometry);
+    ag_chart_cairo_draw_planets(cr, layout, &geometry, theme);
+
+    if (connection == AG_CHART_CAIRO_CONNECTION_ANTISCIA) {
+        ag_chart_cairo_draw_antiscia(cr, layout, &geometry, theme);
+    } else {
+        ag_chart_cairo_draw_aspects(cr, layout, &geometry, theme);
+    }
+
+    cairo_restore(cr);
+
+    ag_chart_cairo_draw_moon(cr, layout, &geometry);
+
+    cairo_restore(cr);
+}
@@ -0,0 +1,56 @@
+/* ag-chart-cairo.h - Native cairo chart renderer for Astrognome
+ *
+ * Copyright (C) 2014 Polonkai Gergely
+ *
+ * Astrognome is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Astrognome is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef __AG_CHART_CAIRO_H__
+#define __AG_CHART_CAIRO_H__
+
+#include <glib.h>
+#include <cairo.h>
+
+#include "ag-chart.h"
+#include "ag-display-theme.h"
+
+G_BEGIN_DECLS
+
+typedef enum {
+    AG_CHART_CAIRO_CONNECTION_ASPECTS,
+    AG_CHART_CAIRO_CONNECTION_ANTISCIA
+} AgChartCairoConnection;
+
+gint ag_chart_cairo_get_image_size(const AgChartLayout *layout,
+                                   guint               image_size,
+                                   guint               icon_size);
+
+void ag_chart_cairo_draw(const AgChartLayout *layout,
+                         cairo_t             *cr,
+                         AgDisplayTheme      *theme,
+                         guint               image_size,
+                         guint               icon_size);
+
+void ag_chart_cairo_draw_full(const AgChartLayout    *layout,
+                              cairo_t                *cr,
+                              AgDisplayTheme         *theme,
+                              guint                  image_size,
+                              guint                  icon_size,
+                              AgChartCairoConnection connection);
+
+void ag_chart_cairo_clear_symbol_cache(void);
+
+G_END_DECLS
+
+#endif /* __AG_CHART_CAIRO_H__ */
@@ -30,6 +30,7 @@ typedef struct {
     gchar              *selected_country;
 
     GtkEntryCompletion *city_comp;
+    GtkListStore       *city_matches;
     gchar              *selected_city;
 
     GtkTextBuffer      *note_buffer;
@@ -58,6 +59,9 @@ struct cc_search {
     gchar       *ret_code;
 };
 
+#define AG_CHART_EDIT_CITY_COMPLETION_MAX 50
+#define AG_CHART_EDIT_CITY_COMPLETION_MIN_KEY 3
+
 G_DEFINE_TYPE_WITH_PRIVATE(AgChartEdit, ag_chart_edit, GTK_TYPE_GRID);
 
 static GParamSpec *properties[PROP_COUNT];
@@ -402,6 +406,10 @@ ag_chart_edit_get_to_timestamp(AgChartEdit   *chart_edit,
 static void
 ag_chart_edit_dispose(GObject *gobject)
 {
+    GET_PRIV(AG_CHART_EDIT(gobject));
+
+    g_clear_object(&(priv->city_matches));
+
     G_OBJECT_CLASS(ag_chart_edit_parent_class)->dispose(gobject);
 }
 
@@ -504,75 +512,37 @@ ag_chart_edit_get_property(GObject    *gobject,
     }
 }
 
-static gboolean
-ag_chart_edit_find_city(GtkTreeModel     *model,
-                        GtkTreePath      *path,
-                        GtkTreeIter      *iter,
-                        struct cc_search *search)
-{
-    gchar    *name,
-             *ccode;
-    gboolean found = FALSE;
-
-    gtk_tree_model_get(
-            model, iter,
-            AG_CITY_NAME, &name,
-            AG_CITY_COUNTRY, &ccode,
-            -1
-        );
-
-    if (g_utf8_collate(search->target, name) == 0) {
-        found            = TRUE;
-        search->ret_iter = gtk_tree_iter_copy(iter);
-        search->ret_code = ccode;
-    } else {
-        g_free(ccode);
-    }
-
-    return found;
-}
-
 static void
 ag_chart_edit_city_changed_cb(GtkSearchEntry *city, AgChartEdit *chart_edit)
 {
-    struct cc_search search;
+    gint found;
     GET_PRIV(chart_edit);
 
-    search.target   = gtk_entry_get_text(GTK_ENTRY(city));
-    search.ret_iter = NULL;
-
-    gtk_tree_model_foreach(
-            city_list,
-            (GtkTreeModelForeachFunc)ag_chart_edit_find_city,
-            &search
+    found = ag_geodata_lookup_city(
+            geodata,
+            priv->selected_country,
+            gtk_entry_get_text(GTK_ENTRY(city))
         );
 
     g_free(priv->selected_city);
 
-    if (search.ret_iter != NULL) {
-        gdouble longitude,
-                latitude,
-                altitude;
-        gchar   *name,
-                *ccode;
-
-        gtk_tree_model_get(
-                city_list, search.ret_iter,
-                AG_CITY_COUNTRY, &ccode,
-                AG_CITY_NAME,    &name,
-                AG_CITY_LAT,     &latitude,
-                AG_CITY_LONG,    &longitude,
-                AG_CITY_ALT,     &altitude,
-                -1
+    if (found >= 0) {
+        gdouble     longitude,
+                    latitude,
+                    altitude;
+        const gchar *name  = ag_geodata_city_get_name(geodata, found),
+                    *ccode = ag_geodata_city_get_country(geodata, found);
+
+        ag_geodata_city_get_position(
+                geodata,
+                found,
+                &latitude,
+                &longitude,
+                &altitude,
+                NULL,
+                NULL
             );
 
-        if (
-                    (priv->selected_country != NULL)
-                    && (strcmp(priv->selected_country, ccode) != 0)
-                ) {
-            return;
-        }
-
         if (latitude < 0.0) {
             gtk_toggle_button_set_active(
                     GTK_TOGGLE_BUTTON(priv->south_lat),
@@ -615,10 +585,8 @@ ag_chart_edit_city_changed_cb(GtkSearchEntry *city, AgChartEdit *chart_edit)
 
         // TODO: implement setting altitude maybe? Is that really necessary?
 
-        g_debug("City (entry-changed): %s (%s); %.6f, %.6f, %.6f", name, search.ret_code, longitude, latitude, altitude);
-        g_free(name);
-        gtk_tree_iter_free(search.ret_iter);
-        priv->selected_city = search.ret_code;
+        g_debug("City (entry-changed): %s (%s); %.6f, %.6f, %.6f", name, ccode, longitude, latitude, altitude);
+        priv->selected_city = g_strdup(name);
     } else {
         priv->selected_city = NULL;
     }
@@ -890,47 +858,86 @@ ag_chart_edit_class_init(AgChartEditClass *klass)
         );
 }
 
-static gboolean
-ag_chart_edit_city_matches(GtkEntryCompletion *city_comp,
-                           const gchar        *key,
-                           GtkTreeIter        *iter,
-                           AgChartEdit        *chart_edit)
+/**
+ * ag_chart_edit_city_text_changed_cb:
+ * @city: the #GtkEntry for city search
+ * @chart_edit: the #AgChartEdit in which the event happens
+ *
+ * Refills the city completion model with the cities matching the text
+ * typed so far. The matches are looked up in the geodata prefix index, so
+ * the completion never has to go through the whole city list.
+ */
+static void
+ag_chart_edit_city_text_changed_cb(GtkEntry *city, AgChartEdit *chart_edit)
 {
+    const gchar *text = gtk_entry_get_text(city);
+    guint       matches[AG_CHART_EDIT_CITY_COMPLETION_MAX],
+                n_matches = 0,
+                i;
     GET_PRIV(chart_edit);
-    gchar           *ccode,
-                    *name,
-                    *normalized_name,
-                    *case_normalized_name;
-    gboolean        ret = FALSE;
 
-    gtk_tree_model_get(
-            gtk_entry_completion_get_model(city_comp), iter,
-            AG_CITY_NAME,    &name,
-            AG_CITY_COUNTRY, &ccode,
-            -1
-        );
+    if (priv->city_matches == NULL) {
+        return;
+    }
 
-    if (
-                (priv->selected_country == NULL)
-                || (strcmp(priv->selected_country, ccode) == 0)
-            ) {
-        normalized_name = g_utf8_normalize(name, -1, G_NORMALIZE_ALL);
+    if (g_utf8_strlen(text, -1) >= AG_CHART_EDIT_CITY_COMPLETION_MIN_KEY) {
+        n_matches = ag_geodata_find_cities(
+                geodata,
+                priv->selected_country,
+                text,
+                AG_CHART_EDIT_CITY_COMPLETION_MAX,
+                matches
+            );
+    }
 
-        if (normalized_name) {
-            case_normalized_name = g_utf8_casefold(normalized_name, -1);
-            if (strncmp(key, case_normalized_name, strlen(key)) == 0) {
-                ret = TRUE;
-            }
+    gtk_list_store_clear(priv->city_matches);
+
+    for (i = 0; i < n_matches; i++) {
+        GtkTreeIter iter;
+        gdouble     latitude,
+                    longitude,
+                    altitude,
+                    tz_offset,
+                    tz_dst_offset;
+
+        ag_geodata_city_get_position(
+                geodata,
+                matches[i],
+                &latitude,
+                &longitude,
+                &altitude,
+                &tz_offset,
+                &tz_dst_offset
+            );
 
-            g_free(case_normalized_name);
-            g_free(normalized_name);
-        }
+        gtk_list_store_insert_with_values(
+                priv->city_matches, &iter, -1,
+                AG_CITY_COUNTRY, ag_geodata_city_get_country(
+                        geodata,
+                        matches[i]
+                    ),
+                AG_CITY_NAME,    ag_geodata_city_get_name(
+                        geodata,
+                        matches[i]
+                    ),
+                AG_CITY_LAT,     latitude,
+                AG_CITY_LONG,    longitude,
+                AG_CITY_ALT,     altitude,
+                AG_CITY_TZO,     tz_offset,
+                AG_CITY_TZD,     tz_dst_offset,
+                -1
+            );
     }
+}
 
-    g_free(name);
-    g_free(ccode);
-
-    return ret;
+static gboolean
+ag_chart_edit_city_matches(GtkEntryCompletion *city_comp,
+                           const gchar        *key,
+                           GtkTreeIter        *iter,
+                           AgChartEdit        *chart_edit)
+{
+    // The completion model contains only matching cities
+    return TRUE;
 }
 
 static void
@@ -951,9 +958,35 @@ ag_chart_edit_init(AgChartEdit *chart_edit)
     gtk_entry_completion_set_text_column(priv->country_comp, AG_COUNTRY_NAME);
     gtk_entry_set_completion(GTK_ENTRY(priv->country), priv->country_comp);
 
-    gtk_entry_completion_set_model(priv->city_comp, city_list);
+    priv->city_matches = gtk_list_store_new(
+            AG_CITY_COLCOUNT,
+            G_TYPE_STRING,
+            G_TYPE_STRING,
+            G_TYPE_DOUBLE,
+            G_TYPE_DOUBLE,
+            G_TYPE_DOUBLE,
+            G_TYPE_DOUBLE,
+            G_TYPE_DOUBLE
+        );
+
+    // This must be connected before the completion is set, so the matches
+    // are updated before the completion refilters them
+    g_signal_connect(
+            priv->city,
+            "changed",
+            G_CALLBACK(ag_chart_edit_city_text_changed_cb),
+            chart_edit
+        );
+
+    gtk_entry_completion_set_model(
+            priv->city_comp,
+            GTK_TREE_MODEL(priv->city_matches)
+        );
     gtk_entry_completion_set_text_column(priv->city_comp, AG_CITY_NAME);
-    gtk_entry_completion_set_minimum_key_length(priv->city_comp, 3);
+    gtk_entry_completion_set_minimum_key_length(
+            priv->city_comp,
+            AG_CHART_EDIT_CITY_COMPLETION_MIN_KEY
+        );
     gtk_entry_set_completion(GTK_ENTRY(priv->city), priv->city_comp);
     gtk_entry_completion_set_match_func(
             priv->city_comp,
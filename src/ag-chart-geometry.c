@@ -0,0 +1,219 @@
+/* ag-chart-geometry.c - Chart image geometry for Astrognome
+ *
+ * Copyright (C) 2014 Polonkai Gergely
+ *
+ * Astrognome is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Astrognome is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <math.h>
+#include <glib.h>
+
+#include "ag-chart.h"
+#include "ag-chart-geometry.h"
+
+// The sizes of the chart image, shared by the SVG (ui/chart-default.xsl) and
+// the cairo renderers, so the two draw the same image.
+
+// Sine values for every whole degree; values in between are interpolated
+// linearly. With one degree steps, the error is below 4e-5, which is less
+// than a hundredth of a pixel even on the largest chart images.
+static gdouble sin_table[361];
+
+static void
+ag_chart_geometry_init_sin_table(void)
+{
+    static gsize initialized = 0;
+
+    if (g_once_init_enter(&initialized)) {
+        guint i;
+
+        for (i = 0; i < G_N_ELEMENTS(sin_table); i++) {
+            sin_table[i] = sin(i * G_PI / 180.0);
+        }
+
+        g_once_init_leave(&initialized, 1);
+    }
+}
+
+/**
+ * ag_chart_geometry_sin:
+ * @degree: an angle, in degrees
+ *
+ * Returns: the sine of @degree, looked up from a table
+ */
+gdouble
+ag_chart_geometry_sin(gdouble degree)
+{
+    guint   index;
+    gdouble fraction;
+
+    ag_chart_geometry_init_sin_table();
+
+    degree = fmod(degree, 360.0);
+
+    if (degree < 0.0) {
+        degree += 360.0;
+    }
+
+    // Adding 360 to a tiny negative number may round up to 360
+    if (degree >= 360.0) {
+        degree = 0.0;
+    }
+
+    index    = (guint)degree;
+    fraction = degree - index;
+
+    return sin_table[index]
+        + (sin_table[index + 1] - sin_table[index]) * fraction;
+}
+
+/**
+ * ag_chart_geometry_cos:
+ * @degree: an angle, in degrees
+ *
+ * Returns: the cosine of @degree, looked up from a table
+ */
+gdouble
+ag_chart_geometry_cos(gdouble degree)
+{
+    return ag_chart_geometry_sin(degree + 90.0);
+}
+
+/**
+ * ag_chart_geometry_polar:
+ * @degree: the ecliptic position of the point
+ * @r: the distance of the point from the chart center
+ * @x: (out): the horizontal coordinate of the point
+ * @y: (out): the vertical coordinate of the point
+ *
+ * Convert a chart position to image coordinates. Degrees grow
+ * counter-clockwise on the chart, while the vertical axis of the image
+ * points down.
+ */
+void
+ag_chart_geometry_polar(gdouble degree, gdouble r, gdouble *x, gdouble *y)
+{
+    *x = r * ag_chart_geometry_cos(degree);
+    *y = -r * ag_chart_geometry_sin(degree);
+}
+
+/**
+ * ag_chart_geometry_init:
+ * @geometry: the #AgChartGeometry to fill
+ * @ascendant: the position of the ascendant
+ * @max_dist: the highest distance level of the planets
+ * @image_size: the requested image size, or 0 to use the default chart size
+ * @icon_size: the requested icon size, or 0 to use the default icon size
+ *
+ * Calculate the sizes of a chart image. If @image_size is 0, the chart ring
+ * has the default size, and the image is as large as it needs to be;
+ * otherwise the ring is shrunk so everything fits into @image_size. If only
+ * @image_size is given, the icons are scaled with it, so the image looks
+ * like the default sized one.
+ */
+void
+ag_chart_geometry_init(AgChartGeometry *geometry,
+                       gdouble         ascendant,
+                       guint           max_dist,
+                       guint           image_size,
+                       guint           icon_size)
+{
+    gdouble planets_size;
+
+    if (icon_size != 0) {
+        geometry->icon_size = icon_size;
+    } else if (image_size != 0) {
+        geometry->icon_size = AG_CHART_GEOMETRY_LOADED_ICON_SIZE * image_size
+            / (AG_CHART_DEFAULT_RING_SIZE
+                + 2.82 * AG_CHART_GEOMETRY_LOADED_ICON_SIZE * (max_dist + 2));
+    } else {
+        geometry->icon_size = AG_CHART_GEOMETRY_LOADED_ICON_SIZE;
+    }
+
+    geometry->icon_scale = geometry->icon_size
+            / AG_CHART_GEOMETRY_LOADED_ICON_SIZE;
+
+    // Room for the planets outside the outer circle
+    planets_size = 2.82 * geometry->icon_size * (max_dist + 2);
+
+    if (image_size == 0) {
+        geometry->chart_size = AG_CHART_DEFAULT_RING_SIZE;
+        geometry->image_size = geometry->chart_size + planets_size;
+    } else {
+        geometry->image_size = image_size;
+        geometry->chart_size = image_size - planets_size;
+    }
+
+    geometry->asc_rotate        = ascendant - 180.0;
+    geometry->r_outer           = geometry->chart_size * 0.5;
+    geometry->r_signs           = geometry->r_outer
+            - (geometry->icon_size * 1.5);
+    geometry->r_aspect          = geometry->r_signs
+            - (geometry->icon_size * 0.5);
+    geometry->r_houses          = geometry->chart_size * 0.116666;
+    geometry->r_moon            = geometry->chart_size * 0.083333;
+    geometry->sign_pos          = geometry->r_signs
+            + (geometry->icon_size * 0.25);
+    geometry->deg5_len          = (geometry->r_signs - geometry->r_aspect)
+            * 0.75;
+    geometry->deg1_len          = (geometry->r_signs - geometry->r_aspect)
+            * 0.3;
+    geometry->planet_marker_len = geometry->icon_size / 2;
+}
+
+/**
+ * ag_chart_geometry_get_planet_pos:
+ * @geometry: an #AgChartGeometry
+ * @dist: the distance level of a planet
+ *
+ * Returns: the distance of the planet symbol from the chart center
+ */
+gdouble
+ag_chart_geometry_get_planet_pos(const AgChartGeometry *geometry, guint dist)
+{
+    return geometry->chart_size * 0.55
+        + dist * (geometry->icon_size * 1.1666666);
+}
+
+/**
+ * ag_chart_geometry_get_moon_arc_radius:
+ * @geometry: an #AgChartGeometry
+ * @illumination: the illumination of the Moon, in percents
+ *
+ * Get the radius of the arc separating the lit and the dark part of the
+ * Moon. The arc goes through the top and bottom of the Moon circle, and
+ * crosses the horizontal axis at a distance proportional to the dark part.
+ *
+ * Returns: the radius of the arc, or 0 at half Moon, where the arc is a
+ *          straight line
+ */
+gdouble
+ag_chart_geometry_get_moon_arc_radius(const AgChartGeometry *geometry,
+                                      gdouble               illumination)
+{
+    gdouble r = geometry->r_moon,
+            percent,
+            x;
+
+    percent = ((illumination > 50.0) ? 100.0 - illumination : illumination)
+            * 2.0 / 100.0;
+    x       = r * (1.0 - percent);
+
+    if (x == 0.0) {
+        return 0.0;
+    }
+
+    // The circle through (0, ±r) and (x, 0)
+    return (r * r + x * x) / (2.0 * x);
+}
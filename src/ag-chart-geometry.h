@@ -0,0 +1,68 @@
+/* ag-chart-geometry.h - Chart image geometry for Astrognome
+ *
+ * Copyright (C) 2014 Polonkai Gergely
+ *
+ * Astrognome is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Astrognome is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef __AG_CHART_GEOMETRY_H__
+#define __AG_CHART_GEOMETRY_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define AG_CHART_GEOMETRY_LOADED_ICON_SIZE 30.0
+
+typedef struct _AgChartGeometry {
+    gdouble image_size;
+    gdouble chart_size;
+    gdouble icon_size;
+    gdouble icon_scale;
+    gdouble asc_rotate;
+    gdouble r_outer;
+    gdouble r_signs;
+    gdouble r_aspect;
+    gdouble r_houses;
+    gdouble r_moon;
+    gdouble sign_pos;
+    gdouble deg5_len;
+    gdouble deg1_len;
+    gdouble planet_marker_len;
+} AgChartGeometry;
+
+void ag_chart_geometry_init(AgChartGeometry *geometry,
+                            gdouble         ascendant,
+                            guint           max_dist,
+                            guint           image_size,
+                            guint           icon_size);
+
+gdouble ag_chart_geometry_get_planet_pos(const AgChartGeometry *geometry,
+                                         guint                 dist);
+
+gdouble ag_chart_geometry_get_moon_arc_radius(const AgChartGeometry *geometry,
+                                              gdouble               illumination);
+
+gdouble ag_chart_geometry_sin(gdouble degree);
+
+gdouble ag_chart_geometry_cos(gdouble degree);
+
+void ag_chart_geometry_polar(gdouble degree,
+                             gdouble r,
+                             gdouble *x,
+                             gdouble *y);
+
+G_END_DECLS
+
+#endif /* __AG_CHART_GEOMETRY_H__ */
@@ -0,0 +1,361 @@
+#include <glib/gi18n.h>
+#include <cairo.h>
+
+#include "ag-enumtypes.h"
+#include "ag-chart-view.h"
+#include "ag-chart-cairo.h"
+
+// Below this size the planets would not fit around the chart ring
+#define AG_CHART_VIEW_MIN_SIZE 200
+
+typedef struct _AgChartViewPrivate {
+    AgChart                *chart;
+    gulong                 chart_changed_handler;
+    AgChartLayout          *layout;
+    AgDisplayTheme         *theme;
+    AgChartCairoConnection connection;
+} AgChartViewPrivate;
+
+enum {
+    PROP_0,
+    PROP_CHART,
+    PROP_CONNECTION,
+    PROP_LAST
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE(AgChartView, ag_chart_view, GTK_TYPE_DRAWING_AREA);
+
+static GParamSpec *properties[PROP_LAST];
+
+/**
+ * ag_chart_view_refresh:
+ * @chart_view: the #AgChartView to operate on
+ *
+ * Drop the cached chart layout, and redraw the chart at the next frame. The
+ * layout is recalculated only once, no matter how many times this is called
+ * before the chart gets drawn.
+ */
+void
+ag_chart_view_refresh(AgChartView *chart_view)
+{
+    AgChartViewPrivate *priv = ag_chart_view_get_instance_private(chart_view);
+
+    if (priv->layout) {
+        ag_chart_layout_free(priv->layout);
+        priv->layout = NULL;
+    }
+
+    gtk_widget_queue_draw(GTK_WIDGET(chart_view));
+}
+
+static void
+ag_chart_view_chart_changed_cb(AgChart *chart, AgChartView *chart_view)
+{
+    ag_chart_view_refresh(chart_view);
+}
+
+/**
+ * ag_chart_view_set_chart:
+ * @chart_view: the #AgChartView to operate on
+ * @chart: (allow-none): the chart to display
+ *
+ * Set the chart to display. The view follows the changes of @chart, so it
+ * doesn’t have to be set again after a recalculation.
+ */
+void
+ag_chart_view_set_chart(AgChartView *chart_view, AgChart *chart)
+{
+    AgChartViewPrivate *priv = ag_chart_view_get_instance_private(chart_view);
+
+    if (priv->chart == chart) {
+        return;
+    }
+
+    if (priv->chart) {
+        g_signal_handler_disconnect(priv->chart, priv->chart_changed_handler);
+        g_clear_object(&(priv->chart));
+    }
+
+    if (chart) {
+        priv->chart = g_object_ref(chart);
+        priv->chart_changed_handler = g_signal_connect(
+                chart,
+                "changed",
+                G_CALLBACK(ag_chart_view_chart_changed_cb),
+                chart_view
+            );
+    }
+
+    ag_chart_view_refresh(chart_view);
+
+    g_object_notify_by_pspec(G_OBJECT(chart_view), properties[PROP_CHART]);
+}
+
+AgChart *
+ag_chart_view_get_chart(AgChartView *chart_view)
+{
+    AgChartViewPrivate *priv = ag_chart_view_get_instance_private(chart_view);
+
+    return priv->chart;
+}
+
+/**
+ * ag_chart_view_set_theme:
+ * @chart_view: the #AgChartView to operate on
+ * @theme: (allow-none): the display theme to use
+ *
+ * Set the display theme of the chart. The view doesn’t copy @theme, so it
+ * must be kept alive until another theme is set.
+ */
+void
+ag_chart_view_set_theme(AgChartView *chart_view, AgDisplayTheme *theme)
+{
+    AgChartViewPrivate *priv = ag_chart_view_get_instance_private(chart_view);
+
+    priv->theme = theme;
+
+    // Themes only hide parts of the chart, so the layout is still valid
+    gtk_widget_queue_draw(GTK_WIDGET(chart_view));
+}
+
+/**
+ * ag_chart_view_set_connection:
+ * @chart_view: the #AgChartView to operate on
+ * @connection: the connections to draw between the planets
+ *
+ * Select if the aspects or the antiscia are drawn on the chart.
+ */
+void
+ag_chart_view_set_connection(AgChartView            *chart_view,
+                             AgChartCairoConnection connection)
+{
+    AgChartViewPrivate *priv = ag_chart_view_get_instance_private(chart_view);
+
+    if (priv->connection == connection) {
+        return;
+    }
+
+    priv->connection = connection;
+    gtk_widget_queue_draw(GTK_WIDGET(chart_view));
+
+    g_object_notify_by_pspec(
+            G_OBJECT(chart_view),
+            properties[PROP_CONNECTION]
+        );
+}
+
+AgChartCairoConnection
+ag_chart_view_get_connection(AgChartView *chart_view)
+{
+    AgChartViewPrivate *priv = ag_chart_view_get_instance_private(chart_view);
+
+    return priv->connection;
+}
+
+static void
+ag_chart_view_draw_empty(GtkWidget *widget,
+                         cairo_t   *cr,
+                         gint      width,
+                         gint      height)
+{
+    PangoLayout     *text;
+    gint            text_height;
+    GtkStyleContext *context = gtk_widget_get_style_context(widget);
+
+    text = gtk_widget_create_pango_layout(
+            widget,
+            _("No chart is loaded. Create one on the edit view, or open one "
+              "from the application menu!")
+        );
+    pango_layout_set_width(text, width * PANGO_SCALE);
+    pango_layout_set_alignment(text, PANGO_ALIGN_CENTER);
+    pango_layout_set_wrap(text, PANGO_WRAP_WORD);
+    pango_layout_get_pixel_size(text, NULL, &text_height);
+
+    gtk_render_layout(context, cr, 0, (height - text_height) / 2, text);
+
+    g_object_unref(text);
+}
+
+static gboolean
+ag_chart_view_draw(GtkWidget *widget, cairo_t *cr)
+{
+    AgChartViewPrivate *priv = ag_chart_view_get_instance_private(
+            AG_CHART_VIEW(widget)
+        );
+    gint               width  = gtk_widget_get_allocated_width(widget),
+                       height = gtk_widget_get_allocated_height(widget),
+                       size;
+
+    gtk_render_background(
+            gtk_widget_get_style_context(widget),
+            cr,
+            0, 0,
+            width, height
+        );
+
+    if (priv->chart == NULL) {
+        ag_chart_view_draw_empty(widget, cr, width, height);
+
+        return FALSE;
+    }
+
+    if (priv->layout == NULL) {
+        priv->layout = ag_chart_get_layout(priv->chart);
+    }
+
+    // The chart is drawn with its geometry calculated for the actual size
+    // instead of scaling the default sized image, so lines stay as wide as
+    // on the SVG image. cr already has the scale factor of the monitor set,
+    // so the chart is sharp on HiDPI screens, too.
+    size = MAX(AG_CHART_VIEW_MIN_SIZE, MIN(width, height));
+
+    cairo_save(cr);
+    cairo_translate(cr, (width - size) / 2, (height - size) / 2);
+    ag_chart_cairo_draw_full(
+            priv->layout,
+            cr,
+            priv->theme,
+            size,
+            0,
+            priv->connection
+        );
+    cairo_restore(cr);
+
+    return FALSE;
+}
+
+static void
+ag_chart_view_set_property(GObject      *gobject,
+                           guint        prop_id,
+                           const GValue *value,
+                           GParamSpec   *param_spec)
+{
+    switch (prop_id) {
+        case PROP_CHART:
+            ag_chart_view_set_chart(
+                    AG_CHART_VIEW(gobject),
+                    g_value_get_object(value)
+                );
+
+            break;
+
+        case PROP_CONNECTION:
+            ag_chart_view_set_connection(
+                    AG_CHART_VIEW(gobject),
+                    g_value_get_enum(value)
+                );
+
+            break;
+
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(gobject, prop_id, param_spec);
+
+            break;
+    }
+}
+
+static void
+ag_chart_view_get_property(GObject    *gobject,
+                           guint      prop_id,
+                           GValue     *value,
+                           GParamSpec *param_spec)
+{
+    AgChartViewPrivate *priv = ag_chart_view_get_instance_private(
+            AG_CHART_VIEW(gobject)
+        );
+
+    switch (prop_id) {
+        case PROP_CHART:
+            g_value_set_object(value, priv->chart);
+
+            break;
+
+        case PROP_CONNECTION:
+            g_value_set_enum(value, priv->connection);
+
+            break;
+
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(gobject, prop_id, param_spec);
+
+            break;
+    }
+}
+
+static void
+ag_chart_view_dispose(GObject *gobject)
+{
+    AgChartView *chart_view = AG_CHART_VIEW(gobject);
+
+    ag_chart_view_set_chart(chart_view, NULL);
+
+    G_OBJECT_CLASS(ag_chart_view_parent_class)->dispose(gobject);
+}
+
+static void
+ag_chart_view_class_init(AgChartViewClass *klass)
+{
+    GObjectClass   *gobject_class = G_OBJECT_CLASS(klass);
+    GtkWidgetClass *widget_class  = GTK_WIDGET_CLASS(klass);
+
+    gobject_class->dispose      = ag_chart_view_dispose;
+    gobject_class->set_property = ag_chart_view_set_property;
+    gobject_class->get_property = ag_chart_view_get_property;
+    widget_class->draw          = ag_chart_view_draw;
+
+    properties[PROP_CHART] = g_param_spec_object(
+            "chart",
+            "Chart",
+            "The chart to display",
+            AG_TYPE_CHART,
+            G_PARAM_STATIC_NAME
+                | G_PARAM_STATIC_NICK
+                | G_PARAM_STATIC_BLURB
+                | G_PARAM_READABLE
+                | G_PARAM_WRITABLE
+        );
+    g_object_class_install_property(
+            gobject_class,
+            PROP_CHART,
+            properties[PROP_CHART]
+        );
+
+    properties[PROP_CONNECTION] = g_param_spec_enum(
+            "connection",
+            "Connection",
+            "The connections drawn between the planets",
+            AG_TYPE_CHART_CAIRO_CONNECTION,
+            AG_CHART_CAIRO_CONNECTION_ASPECTS,
+            G_PARAM_STATIC_NAME
+                | G_PARAM_STATIC_NICK
+                | G_PARAM_STATIC_BLURB
+                | G_PARAM_READABLE
+                | G_PARAM_WRITABLE
+        );
+    g_object_class_install_property(
+            gobject_class,
+            PROP_CONNECTION,
+            properties[PROP_CONNECTION]
+        );
+}
+
+static void
+ag_chart_view_init(AgChartView *chart_view)
+{
+    AgChartViewPrivate *priv = ag_chart_view_get_instance_private(chart_view);
+
+    priv->connection = AG_CHART_CAIRO_CONNECTION_ASPECTS;
+
+    gtk_widget_set_size_request(
+            GTK_WIDGET(chart_view),
+            AG_CHART_VIEW_MIN_SIZE,
+            AG_CHART_VIEW_MIN_SIZE
+        );
+}
+
+GtkWidget *
+ag_chart_view_new(void)
+{
+    return GTK_WIDGET(g_object_new(AG_TYPE_CHART_VIEW, NULL));
+}
@@ -0,0 +1,66 @@
+#ifndef __AG_CHART_VIEW_H__
+#define __AG_CHART_VIEW_H__
+
+#include <gtk/gtk.h>
+
+#include "ag-chart.h"
+#include "ag-chart-cairo.h"
+#include "ag-display-theme.h"
+
+G_BEGIN_DECLS
+
+#define AG_TYPE_CHART_VIEW                                              \
+   (ag_chart_view_get_type())
+#define AG_CHART_VIEW(obj)                                              \
+   (G_TYPE_CHECK_INSTANCE_CAST ((obj),                                  \
+                                AG_TYPE_CHART_VIEW,                     \
+                                AgChartView))
+#define AG_CHART_VIEW_CLASS(klass)                                      \
+   (G_TYPE_CHECK_CLASS_CAST ((klass),                                   \
+                             AG_TYPE_CHART_VIEW,                        \
+                             AgChartViewClass))
+#define IS_AG_CHART_VIEW(obj)                                           \
+   (G_TYPE_CHECK_INSTANCE_TYPE ((obj),                                  \
+                                AG_TYPE_CHART_VIEW))
+#define IS_AG_CHART_VIEW_CLASS(klass)                                   \
+   (G_TYPE_CHECK_CLASS_TYPE ((klass),                                   \
+                             AG_TYPE_CHART_VIEW))
+#define AG_CHART_VIEW_GET_CLASS(obj)                                    \
+   (G_TYPE_INSTANCE_GET_CLASS ((obj),                                   \
+                               AG_TYPE_CHART_VIEW,                      \
+                               AgChartViewClass))
+
+typedef struct _AgChartView      AgChartView;
+typedef struct _AgChartViewClass AgChartViewClass;
+
+struct _AgChartViewClass
+{
+    GtkDrawingAreaClass parent_class;
+};
+
+struct _AgChartView
+{
+    GtkDrawingArea parent;
+};
+
+GType ag_chart_view_get_type (void) G_GNUC_CONST;
+
+GtkWidget *ag_chart_view_new(void);
+
+void ag_chart_view_set_chart(AgChartView *chart_view, AgChart *chart);
+
+AgChart *ag_chart_view_get_chart(AgChartView *chart_view);
+
+void ag_chart_view_set_theme(AgChartView    *chart_view,
+                             AgDisplayTheme *theme);
+
+void ag_chart_view_set_connection(AgChartView            *chart_view,
+                                  AgChartCairoConnection connection);
+
+AgChartCairoConnection ag_chart_view_get_connection(AgChartView *chart_view);
+
+void ag_chart_view_refresh(AgChartView *chart_view);
+
+G_END_DECLS
+
+#endif /* __AG_CHART_VIEW_H__ */
@@ -17,11 +17,14 @@
  * <http://www.gnu.org/licenses/>.
  */
 #include <errno.h>
+#include <stdarg.h>
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 #include <libxml/parser.h>
 #include <libxml/xpath.h>
 #include <libxml/tree.h>
 #include <libxml/xinclude.h>
+#include <libxml/xmlsave.h>
 #include <libxslt/xsltInternals.h>
 #include <libxslt/transform.h>
 #include <swe-glib.h>
@@ -38,6 +41,20 @@
 #include "ag-chart.h"
 #include "placidus.h"
 #include "ag-settings.h"
+#include "ag-chart-cairo.h"
+#include "ag-chart-geometry.h"
+#include "ag-trace.h"
+
+// The local time of a chart, to check if an edit changed the time
+typedef struct {
+    gint    year;
+    guint   month;
+    guint   day;
+    guint   hour;
+    guint   minute;
+    guint   second;
+    gdouble timezone;
+} AgChartTimeKey;
 
 typedef struct _AgChartPrivate {
     gchar *name;
@@ -49,6 +66,20 @@ typedef struct _AgChartPrivate {
     gint  db_id;
 } AgChartPrivate;
 
+// The bodies, the aspects and antiscia between them and the Moon phase
+// depend on the time, the location and the set of bodies, but not on the
+// house system. They are shared by all charts through the ephemeris cache,
+// so previews and exports of the same chart, and house system changes,
+// calculate them only once.
+typedef struct {
+    gchar         *key;
+    AgChartLayout *layout;
+} AgEphemerisCacheEntry;
+
+// The number of moments kept in the ephemeris cache. An entry is a few
+// kilobytes, so this keeps the cache well below a megabyte.
+#define AG_CHART_EPHEMERIS_CACHE_SIZE 256
+
 enum {
     PROP_0,
     PROP_NAME,
@@ -59,6 +90,18 @@ enum {
     PROP_LAST
 };
 
+// Everything a rendering needs besides the chart itself. It is read only
+// once created, so any number of threads may use it at the same time.
+typedef struct {
+    xsltStylesheetPtr stylesheet;
+    locale_t          c_locale;
+    GEnumClass        *planets_class;
+    GEnumClass        *aspects_class;
+    GEnumClass        *antiscia_class;
+    GEnumClass        *moon_phase_class;
+    volatile gint     ref_count;
+} AgRenderContext;
+
 typedef enum {
     XML_CONVERT_STRING,
     XML_CONVERT_DOUBLE,
@@ -69,12 +112,42 @@ typedef enum {
 # error "We need RSVG CSS support to export charts as images!"
 #endif
 
+// Bump this whenever the look of rendered images changes, so cached
+// previews get rendered again
+#define AG_CHART_RENDERER_VERSION PACKAGE_VERSION "-cairo-1"
+
+// Previews not used for this many days are removed from the cache. The
+// cache key ignores the chart names, so this is what removes the previews
+// of deleted charts, and of charts whose time or place was changed.
+#define AG_CHART_PREVIEW_CACHE_MAX_AGE 30
+
+// The number of previews kept in the cache. A preview tile is a few ten
+// kilobytes, so this keeps the cache below about a hundred megabytes.
+#define AG_CHART_PREVIEW_CACHE_SIZE 2048
+
 G_DEFINE_QUARK(ag_chart_error_quark, ag_chart_error);
 
 G_DEFINE_TYPE_WITH_PRIVATE(AgChart, ag_chart, GSWE_TYPE_MOMENT);
 
 static GParamSpec *properties[PROP_LAST];
 
+// The Swiss Ephemeris, which calculates the data for us, uses global state,
+// so only one thread may calculate chart data at a time
+static GRecMutex         ephemeris_lock;
+static GMutex            stylesheet_cache_lock;
+static AgRenderContext   *render_context_cache   = NULL;
+static guint             stylesheet_cache_hits   = 0,
+                         stylesheet_cache_misses = 0;
+// Maps the keys of the ephemeris cache to their links in the LRU queue; the
+// most recently used entry is at the head of the queue
+static GMutex            ephemeris_cache_lock;
+static GHashTable        *ephemeris_cache        = NULL;
+static GQueue            ephemeris_cache_lru     = G_QUEUE_INIT;
+static guint             ephemeris_cache_hits    = 0,
+                         ephemeris_cache_misses  = 0;
+static gboolean          use_flat_stylesheet     = TRUE;
+static gint              prune_hidden_elements   = TRUE;
+
 #define ag_g_variant_unref(v) \
     if ((v) != NULL) { \
         g_variant_unref((v)); \
@@ -293,6 +366,8 @@ ag_chart_add_planets(AgChart          *chart,
     int i;
     AgChartPrivate *priv = ag_chart_get_instance_private(chart);
 
+    g_rec_mutex_lock(&ephemeris_lock);
+
     for (i = 0; i < planet_count; i++) {
         gswe_moment_add_planet(GSWE_MOMENT(chart), planets[i], NULL);
         priv->planet_list = g_list_prepend(
@@ -301,6 +376,8 @@ ag_chart_add_planets(AgChart          *chart,
             );
     }
 
+    g_rec_mutex_unlock(&ephemeris_lock);
+
     priv->planet_list = g_list_reverse(priv->planet_list);
 }
 
@@ -318,11 +395,13 @@ ag_chart_new_generic(GsweTimestamp   *timestamp,
     coords->latitude  = latitude;
     coords->altitude  = altitude;
 
+    g_rec_mutex_lock(&ephemeris_lock);
     chart = AG_CHART(g_object_new(AG_TYPE_CHART,
                                   "timestamp",    timestamp,
                                   "coordinates",  coords,
                                   "house-system", house_system,
                                   NULL));
+    g_rec_mutex_unlock(&ephemeris_lock);
 
     g_free(coords);
 
@@ -603,18 +682,30 @@ get_by_xpath(xmlXPathContextPtr xpath_context,
     return ret;
 }
 
+/**
+ * ag_chart_load_from_agc_data:
+ * @xml: the contents of an Astrognome save file
+ * @length: the length of @xml
+ * @uri: the name of the data source, used in error messages
+ * @err: a #GError
+ *
+ * Load a chart from the contents of a save file, for when the data doesn’t
+ * come from a #GFile, like the standard input of the command line renderer.
+ *
+ * Returns: (transfer full): the loaded chart, or %NULL on error
+ */
 AgChart *
-ag_chart_load_from_agc(GFile *file, GError **err)
+ag_chart_load_from_agc_data(const gchar *xml,
+                            gsize       length,
+                            const gchar *uri,
+                            GError      **err)
 {
     AgChart            *chart = NULL;
-    gchar              *uri,
-                       *xml = NULL,
-                       *name,
+    gchar              *name,
                        *country_name,
                        *city_name,
                        *house_system_name,
                        *house_system_enum_name;
-    gsize              length;
     xmlDocPtr          doc;
     xmlXPathContextPtr xpath_context;
     GVariant           *chart_name,
@@ -637,14 +728,6 @@ ag_chart_load_from_agc(GFile *file, GError **err)
     GEnumValue         *enum_value;
     gboolean           found_error = FALSE;
 
-    uri = g_file_get_uri(file);
-
-    if (!g_file_load_contents(file, NULL, &xml, &length, NULL, err)) {
-        g_free(uri);
-
-        return NULL;
-    }
-
     if ((doc = xmlReadMemory(xml, length, "chart.xml", NULL, 0)) == NULL) {
         g_set_error(
                 err,
@@ -653,8 +736,6 @@ ag_chart_load_from_agc(GFile *file, GError **err)
                 "Maybe it is corrupt, or not a save file at all",
                 uri
             );
-        g_free(xml);
-        g_free(uri);
 
         return NULL;
     }
@@ -667,8 +748,6 @@ ag_chart_load_from_agc(GFile *file, GError **err)
                 uri
             );
         xmlFreeDoc(doc);
-        g_free(xml);
-        g_free(uri);
 
         return NULL;
     }
@@ -853,8 +932,6 @@ ag_chart_load_from_agc(GFile *file, GError **err)
         ag_g_variant_unref(second);
         ag_g_variant_unref(timezone);
         xmlFreeDoc(doc);
-        g_free(xml);
-        g_free(uri);
 
         return NULL;
     }
@@ -941,14 +1018,32 @@ ag_chart_load_from_agc(GFile *file, GError **err)
         ag_chart_set_note(chart, note_text);
     }
 
-    g_free(xml);
-    g_free(uri);
     xmlXPathFreeContext(xpath_context);
     xmlFreeDoc(doc);
 
     return chart;
 }
 
+AgChart *
+ag_chart_load_from_agc(GFile *file, GError **err)
+{
+    AgChart *chart;
+    gchar   *uri,
+            *xml;
+    gsize   length;
+
+    if (!g_file_load_contents(file, NULL, &xml, &length, NULL, err)) {
+        return NULL;
+    }
+
+    uri   = g_file_get_uri(file);
+    chart = ag_chart_load_from_agc_data(xml, length, uri, err);
+    g_free(xml);
+    g_free(uri);
+
+    return chart;
+}
+
 AgChart *ag_chart_load_from_placidus_file(GFile  *file,
                                           GError **err)
 {
@@ -1263,15 +1358,27 @@ AgChart *ag_chart_load_from_placidus_file(GFile  *file,
     return chart;
 }
 
+/**
+ * ag_chart_new_from_db_save_with_house_system:
+ * @save_data: the chart data to calculate
+ * @preview: %TRUE to calculate only what a preview needs
+ * @house_system: the house system to use
+ * @err: a #GError
+ *
+ * Like ag_chart_new_from_db_save(), but with the house system given
+ * explicitly instead of reading it from the settings, so it is safe to call
+ * from worker threads.
+ *
+ * Returns: (transfer full): the new chart, or %NULL on error
+ */
 AgChart *
-ag_chart_new_from_db_save(AgDbChartSave *save_data,
-                          gboolean preview,
-                          GError **err)
+ag_chart_new_from_db_save_with_house_system(AgDbChartSave   *save_data,
+                                            gboolean        preview,
+                                            GsweHouseSystem house_system,
+                                            GError          **err)
 {
     GsweTimestamp   *timestamp;
-    GsweHouseSystem house_system;
     AgChart         *chart;
-    AgSettings      *settings;
 
     if (save_data == NULL) {
         g_set_error(
@@ -1283,10 +1390,6 @@ ag_chart_new_from_db_save(AgDbChartSave *save_data,
         return NULL;
     }
 
-    settings = ag_settings_get();
-    house_system = ag_settings_get_house_system(settings);
-    g_object_unref(settings);
-
     timestamp = gswe_timestamp_new_from_gregorian_full(
             save_data->year, save_data->month, save_data->day,
             save_data->hour, save_data->minute, save_data->second, 0,
@@ -1320,6 +1423,26 @@ ag_chart_new_from_db_save(AgDbChartSave *save_data,
     return chart;
 }
 
+AgChart *
+ag_chart_new_from_db_save(AgDbChartSave *save_data,
+                          gboolean preview,
+                          GError **err)
+{
+    GsweHouseSystem house_system;
+    AgSettings      *settings;
+
+    settings = ag_settings_get();
+    house_system = ag_settings_get_house_system(settings);
+    g_object_unref(settings);
+
+    return ag_chart_new_from_db_save_with_house_system(
+            save_data,
+            preview,
+            house_system,
+            err
+        );
+}
+
 static xmlDocPtr
 create_save_doc(AgChart *chart)
 {
@@ -1493,151 +1616,50 @@ ag_chart_sort_planets_by_position(GswePlanetData *planet1,
     }
 }
 
-gchar *
-ag_chart_create_svg(AgChart        *chart,
-                    gsize          *length,
-                    gboolean       rendering,
-                    AgDisplayTheme *theme,
-                    guint          image_size,
-                    guint          icon_size,
-                    GError         **err)
+/*
+ * ag_chart_get_bodies:
+ * @chart: an #AgChart
+ * @n_bodies: (out): the number of bodies returned
+ * @max_dist: (out) (allow-none): the highest distance level of the bodies
+ *
+ * Collect the planets of @chart, except the ascendant, the MC and the
+ * vertex, sorted by position. Planets that are too close to the previous
+ * ones get a higher distance level, so they can be drawn further from the
+ * chart without overlapping each other.
+ *
+ * The caller must hold ephemeris_lock.
+ *
+ * Returns: (transfer full): the array of bodies. Free it with g_free().
+ */
+static AgChartLayoutBody *
+ag_chart_get_bodies(AgChart *chart, guint *n_bodies, guint *max_dist)
 {
-    xmlDocPtr         doc = create_save_doc(chart),
-                      xslt_doc,
-                      svg_doc;
-    xmlNodePtr        root_node     = NULL,
-                      ascmcs_node   = NULL,
-                      houses_node   = NULL,
-                      bodies_node   = NULL,
-                      aspects_node  = NULL,
-                      antiscia_node = NULL,
-                      node          = NULL;
-    gchar             *value,
-                      *css,
-                      *save_content = NULL,
-                      **params;
-    const gchar       *xslt_content;
-    GList             *houses,
-                      *house,
-                      *planet,
-                      *aspect,
-                      *antiscion,
-                      *sorted_planets;
-    GswePlanetData    *planet_data;
-    GsweAspectData    *aspect_data;
-    GEnumClass        *planets_class,
-                      *aspects_class,
-                      *antiscia_class,
-                      *moon_phase_class;
-    gint              save_length;
-    xsltStylesheetPtr xslt_proc;
-    locale_t          current_locale;
-    GBytes            *xslt_data;
-    gsize             xslt_length;
-    gdouble           asc_position,
-                      prev_position;
-    gboolean          first;
-    guint             dist;
-    gdouble           first_pos;
-    GsweMoonPhaseData *moon_phase_data;
-    GEnumValue        *enum_value;
-
-    root_node = xmlDocGetRootElement(doc);
-
-    // gswe_moment_get_house_cusps() also calculates ascmcs data, so call it
-    // this early
-    houses = gswe_moment_get_house_cusps(GSWE_MOMENT(chart), NULL);
-
-    // Begin <ascmcs> node
-    g_debug("Generating theoretical points table");
-    ascmcs_node = xmlNewChild(root_node, NULL, BAD_CAST "ascmcs", NULL);
-
-    node = xmlNewChild(ascmcs_node, NULL, BAD_CAST "ascendant", NULL);
-
-    planet_data = gswe_moment_get_planet(
-            GSWE_MOMENT(chart),
-            GSWE_PLANET_ASCENDANT,
-            NULL
-        );
-    asc_position = gswe_planet_data_get_position(planet_data);
-    value        = g_malloc0(12);
-    g_ascii_dtostr(value, 12, asc_position);
-    xmlNewProp(node, BAD_CAST "degree_ut", BAD_CAST value);
-    g_free(value);
-
-    node = xmlNewChild(ascmcs_node, NULL, BAD_CAST "mc", NULL);
-
-    planet_data = gswe_moment_get_planet(
-            GSWE_MOMENT(chart),
-            GSWE_PLANET_MC,
-            NULL
-        );
-    value       = g_malloc0(12);
-    g_ascii_dtostr(value, 12, gswe_planet_data_get_position(planet_data));
-    xmlNewProp(node, BAD_CAST "degree_ut", BAD_CAST value);
-    g_free(value);
-
-    node = xmlNewChild(ascmcs_node, NULL, BAD_CAST "vertex", NULL);
-
-    planet_data = gswe_moment_get_planet(
-            GSWE_MOMENT(chart),
-            GSWE_PLANET_VERTEX,
-            NULL
-        );
-    value       = g_malloc0(12);
-    g_ascii_dtostr(value, 12, gswe_planet_data_get_position(planet_data));
-    xmlNewProp(node, BAD_CAST "degree_ut", BAD_CAST value);
-    g_free(value);
-
-    // Begin <houses> node
-    g_debug("Generating houses table");
-    houses_node = xmlNewChild(root_node, NULL, BAD_CAST "houses", NULL);
-
-    for (house = houses; house; house = g_list_next(house)) {
-        GsweHouseData *house_data = house->data;
-
-        node = xmlNewChild(houses_node, NULL, BAD_CAST "house", NULL);
-
-        value = g_malloc0(3);
-        g_ascii_dtostr(value, 3, gswe_house_data_get_house(house_data));
-        xmlNewProp(node, BAD_CAST "number", BAD_CAST value);
-        g_free(value);
-
-        value = g_malloc0(12);
-        g_ascii_dtostr(
-                value, 12,
-                gswe_house_data_get_cusp_position(house_data)
-            );
-        xmlNewProp(node, BAD_CAST "degree", BAD_CAST value);
-        g_free(value);
-    }
-
-    // Begin <bodies> node
-    g_debug("Generating bodies table");
-    bodies_node = xmlNewChild(root_node, NULL, BAD_CAST "bodies", NULL);
+    GList             *sorted_planets,
+                      *planet;
+    AgChartLayoutBody *bodies;
+    guint             n     = 0,
+                      dist  = 0,
+                      max   = 0;
+    gboolean          first = TRUE;
+    gdouble           prev_position = -360.0,
+                      first_pos     = 0.0;
 
-    planets_class = g_type_class_ref(GSWE_TYPE_PLANET);
     sorted_planets = g_list_sort(
             g_list_copy(gswe_moment_get_all_planets(GSWE_MOMENT(chart))),
             (GCompareFunc)ag_chart_sort_planets_by_position
         );
+    bodies = g_new0(AgChartLayoutBody, g_list_length(sorted_planets));
 
-    for (
-                planet = sorted_planets,
-                     dist = 0,
-                     prev_position = -360.0,
-                     first = TRUE;
-                planet;
-                planet = g_list_next(planet)
-            ) {
-        planet_data = planet->data;
-        gdouble    position;
+    for (planet = sorted_planets; planet; planet = g_list_next(planet)) {
+        GswePlanetData *planet_data = planet->data;
+        GswePlanet     planet_id    = gswe_planet_data_get_planet(planet_data);
+        gdouble        position;
 
         if (
-            (gswe_planet_data_get_planet(planet_data) == GSWE_PLANET_ASCENDANT)
-            || (gswe_planet_data_get_planet(planet_data) == GSWE_PLANET_MC)
-            || (gswe_planet_data_get_planet(planet_data) == GSWE_PLANET_VERTEX)
-           ) {
+                    (planet_id == GSWE_PLANET_ASCENDANT)
+                    || (planet_id == GSWE_PLANET_MC)
+                    || (planet_id == GSWE_PLANET_VERTEX)
+                ) {
             continue;
         }
 
@@ -1658,91 +1680,130 @@ ag_chart_create_svg(AgChart        *chart,
         }
 
         prev_position = position;
+        max           = MAX(max, dist);
 
-        node = xmlNewChild(bodies_node, NULL, BAD_CAST "body", NULL);
-
-        enum_value = g_enum_get_value(
-                G_ENUM_CLASS(planets_class),
-                gswe_planet_data_get_planet(planet_data)
-            );
-        xmlNewProp(node, BAD_CAST "name", BAD_CAST enum_value->value_nick);
+        bodies[n].planet     = planet_id;
+        bodies[n].position   = position;
+        bodies[n].retrograde = gswe_planet_data_get_retrograde(planet_data);
+        bodies[n].dist       = dist;
+        n++;
+    }
 
-        value = g_malloc0(12);
-        g_ascii_dtostr(value, 12, gswe_planet_data_get_position(planet_data));
-        xmlNewProp(node, BAD_CAST "degree", BAD_CAST value);
-        g_free(value);
+    g_list_free(sorted_planets);
 
-        xmlNewProp(
-                node,
-                BAD_CAST "retrograde",
-                BAD_CAST (
-                        gswe_planet_data_get_retrograde(planet_data)
-                            ? "True"
-                            : "False"
-                        )
-            );
+    *n_bodies = n;
 
-        value = g_strdup_printf("%d", dist);
-        xmlNewProp(node, BAD_CAST "dist", BAD_CAST value);
-        g_free(value);
+    if (max_dist != NULL) {
+        *max_dist = max;
     }
 
-    // Begin <aspects> node
-    g_debug("Generating aspects table");
-    aspects_node = xmlNewChild(root_node, NULL, BAD_CAST "aspects", NULL);
+    return bodies;
+}
 
-    aspects_class = g_type_class_ref(GSWE_TYPE_ASPECT);
+static gboolean
+ag_chart_is_angle(GswePlanet planet)
+{
+    return (planet == GSWE_PLANET_ASCENDANT)
+        || (planet == GSWE_PLANET_MC)
+        || (planet == GSWE_PLANET_VERTEX);
+}
 
-    for (
-                aspect = gswe_moment_get_all_aspects(GSWE_MOMENT(chart));
-                aspect;
-                aspect = g_list_next(aspect)
-            ) {
-        GswePlanetData *planet_data;
+static void
+ag_chart_get_time_key(AgChart *chart, AgChartTimeKey *key)
+{
+    GsweTimestamp *timestamp = gswe_moment_get_timestamp(GSWE_MOMENT(chart));
+
+    key->year     = gswe_timestamp_get_gregorian_year(timestamp, NULL);
+    key->month    = gswe_timestamp_get_gregorian_month(timestamp, NULL);
+    key->day      = gswe_timestamp_get_gregorian_day(timestamp, NULL);
+    key->hour     = gswe_timestamp_get_gregorian_hour(timestamp, NULL);
+    key->minute   = gswe_timestamp_get_gregorian_minute(timestamp, NULL);
+    key->second   = gswe_timestamp_get_gregorian_second(timestamp, NULL);
+    key->timezone = gswe_timestamp_get_gregorian_timezone(timestamp);
+}
+
+/*
+ * ag_chart_add_layout_aspects:
+ * @chart: an #AgChart
+ * @layout: the layout to add the aspects to
+ *
+ * Add the aspects between the bodies of @chart to @layout. The aspects of
+ * the ascendant, the MC and the vertex are left out, as they depend on the
+ * location; see ag_chart_add_angle_connections().
+ *
+ * The caller must hold ephemeris_lock.
+ */
+static void
+ag_chart_add_layout_aspects(AgChart *chart, AgChartLayout *layout)
+{
+    GList *l = gswe_moment_get_all_aspects(GSWE_MOMENT(chart));
 
-        aspect_data = aspect->data;
+    layout->aspects = g_renew(
+            AgChartLayoutAspect,
+            layout->aspects,
+            layout->n_aspects + g_list_length(l)
+        );
+
+    for (; l; l = g_list_next(l)) {
+        GsweAspectData      *aspect_data = l->data;
+        AgChartLayoutAspect *aspect;
+        GswePlanet          planet1,
+                            planet2;
 
         if (gswe_aspect_data_get_aspect(aspect_data) == GSWE_ASPECT_NONE) {
             continue;
         }
 
-        node = xmlNewChild(aspects_node, NULL, BAD_CAST "aspect", NULL);
-
-        planet_data = gswe_aspect_data_get_planet1(aspect_data);
-        enum_value  = g_enum_get_value(
-                G_ENUM_CLASS(planets_class),
-                gswe_planet_data_get_planet(planet_data)
+        planet1 = gswe_planet_data_get_planet(
+                gswe_aspect_data_get_planet1(aspect_data)
             );
-        xmlNewProp(node, BAD_CAST "body1", BAD_CAST enum_value->value_nick);
-
-        planet_data = gswe_aspect_data_get_planet2(aspect_data);
-        enum_value  = g_enum_get_value(
-                G_ENUM_CLASS(planets_class),
-                gswe_planet_data_get_planet(planet_data)
+        planet2 = gswe_planet_data_get_planet(
+                gswe_aspect_data_get_planet2(aspect_data)
             );
-        xmlNewProp(node, BAD_CAST "body2", BAD_CAST enum_value->value_nick);
 
-        enum_value = g_enum_get_value(
-                G_ENUM_CLASS(aspects_class),
-                gswe_aspect_data_get_aspect(aspect_data)
+        if (ag_chart_is_angle(planet1) || ag_chart_is_angle(planet2)) {
+            continue;
+        }
+
+        aspect = &(layout->aspects[layout->n_aspects++]);
+        aspect->planet1   = planet1;
+        aspect->position1 = gswe_planet_data_get_position(
+                gswe_aspect_data_get_planet1(aspect_data)
             );
-        xmlNewProp(node, BAD_CAST "type", BAD_CAST enum_value->value_nick);
+        aspect->planet2   = planet2;
+        aspect->position2 = gswe_planet_data_get_position(
+                gswe_aspect_data_get_planet2(aspect_data)
+            );
+        aspect->aspect    = gswe_aspect_data_get_aspect(aspect_data);
     }
+}
 
-    g_type_class_unref(aspects_class);
+/*
+ * ag_chart_add_layout_antiscia:
+ * @chart: an #AgChart
+ * @layout: the layout to add the antiscia to
+ *
+ * Add the antiscia between the bodies of @chart to @layout, leaving out the
+ * ascendant, the MC and the vertex, like ag_chart_add_layout_aspects().
+ *
+ * The caller must hold ephemeris_lock.
+ */
+static void
+ag_chart_add_layout_antiscia(AgChart *chart, AgChartLayout *layout)
+{
+    GList *l = gswe_moment_get_all_antiscia(GSWE_MOMENT(chart));
 
-    // Begin <antiscia> node
-    g_debug("Generating antiscia table");
-    antiscia_node  = xmlNewChild(root_node, NULL, BAD_CAST "antiscia", NULL);
-    antiscia_class = g_type_class_ref(GSWE_TYPE_ANTISCION_AXIS);
+    layout->antiscia = g_renew(
+            AgChartLayoutAntiscion,
+            layout->antiscia,
+            layout->n_antiscia + g_list_length(l)
+        );
 
-    for (
-                antiscion = gswe_moment_get_all_antiscia(GSWE_MOMENT(chart));
-                antiscion;
-                antiscion = g_list_next(antiscion)
-            ) {
-        GswePlanetData    *planet_data;
-        GsweAntiscionData *antiscion_data = antiscion->data;
+    for (; l; l = g_list_next(l)) {
+        GsweAntiscionData      *antiscion_data = l->data;
+        AgChartLayoutAntiscion *antiscion;
+        GswePlanet             planet1,
+                               planet2;
 
         if (gswe_antiscion_data_get_axis(
                     antiscion_data) == GSWE_ANTISCION_AXIS_NONE
@@ -1750,133 +1811,1473 @@ ag_chart_create_svg(AgChart        *chart,
             continue;
         }
 
-        node = xmlNewChild(antiscia_node, NULL, BAD_CAST "antiscia", NULL);
-
-        planet_data = gswe_antiscion_data_get_planet1(antiscion_data);
-        enum_value  = g_enum_get_value(
-                G_ENUM_CLASS(planets_class),
-                gswe_planet_data_get_planet(planet_data)
+        planet1 = gswe_planet_data_get_planet(
+                gswe_antiscion_data_get_planet1(antiscion_data)
             );
-        xmlNewProp(node, BAD_CAST "body1", BAD_CAST enum_value->value_nick);
-
-        planet_data = gswe_antiscion_data_get_planet2(antiscion_data);
-        enum_value  = g_enum_get_value(
-                G_ENUM_CLASS(planets_class),
-                gswe_planet_data_get_planet(planet_data)
+        planet2 = gswe_planet_data_get_planet(
+                gswe_antiscion_data_get_planet2(antiscion_data)
             );
-        xmlNewProp(node, BAD_CAST "body2", BAD_CAST enum_value->value_nick);
 
-        enum_value = g_enum_get_value(
-                G_ENUM_CLASS(antiscia_class),
-                gswe_antiscion_data_get_axis(antiscion_data)
+        if (ag_chart_is_angle(planet1) || ag_chart_is_angle(planet2)) {
+            continue;
+        }
+
+        antiscion = &(layout->antiscia[layout->n_antiscia++]);
+        antiscion->planet1   = planet1;
+        antiscion->position1 = gswe_planet_data_get_position(
+                gswe_antiscion_data_get_planet1(antiscion_data)
             );
-        xmlNewProp(node, BAD_CAST "axis", BAD_CAST enum_value->value_nick);
+        antiscion->planet2   = planet2;
+        antiscion->position2 = gswe_planet_data_get_position(
+                gswe_antiscion_data_get_planet2(antiscion_data)
+            );
+        antiscion->axis      = gswe_antiscion_data_get_axis(antiscion_data);
     }
+}
 
-    g_debug("Getting Moon phase");
+/*
+ * ag_chart_add_layout_connection:
+ * @layout: the layout to add the connection to
+ * @planet1: the data of the first planet
+ * @planet2: the data of the second planet
+ *
+ * Let swe-glib find the aspect and the antiscion between two planets, and
+ * add them to @layout. The arrays of @layout must have room for them.
+ */
+static void
+ag_chart_add_layout_connection(AgChartLayout  *layout,
+                               GswePlanetData *planet1,
+                               GswePlanetData *planet2)
+{
+    GsweAspectData    *aspect_data;
+    GsweAntiscionData *antiscion_data;
 
-    moon_phase_data = gswe_moment_get_moon_phase(GSWE_MOMENT(chart), NULL);
+    if ((aspect_data = gswe_aspect_data_new_with_planets(
+                planet1,
+                planet2,
+                NULL
+            )) != NULL) {
+        if (gswe_aspect_data_get_aspect(aspect_data) != GSWE_ASPECT_NONE) {
+            AgChartLayoutAspect *aspect;
+
+            aspect = &(layout->aspects[layout->n_aspects++]);
+            aspect->planet1   = gswe_planet_data_get_planet(planet1);
+            aspect->position1 = gswe_planet_data_get_position(planet1);
+            aspect->planet2   = gswe_planet_data_get_planet(planet2);
+            aspect->position2 = gswe_planet_data_get_position(planet2);
+            aspect->aspect    = gswe_aspect_data_get_aspect(aspect_data);
+        }
 
-    moon_phase_class = g_type_class_ref(GSWE_TYPE_MOON_PHASE);
-    enum_value = g_enum_get_value(G_ENUM_CLASS(moon_phase_class), gswe_moon_phase_data_get_phase(moon_phase_data));
-    value = g_malloc0(12);
-    g_ascii_dtostr(value, 12, gswe_moon_phase_data_get_illumination(moon_phase_data));
+        gswe_aspect_data_unref(aspect_data);
+    }
 
-    node = xmlNewChild(root_node, NULL, BAD_CAST "moonphase", NULL);
+    if ((antiscion_data = gswe_antiscion_data_new_with_planets(
+                planet1,
+                planet2,
+                NULL
+            )) != NULL) {
+        if (gswe_antiscion_data_get_axis(
+                    antiscion_data) != GSWE_ANTISCION_AXIS_NONE
+                ) {
+            AgChartLayoutAntiscion *antiscion;
+
+            antiscion = &(layout->antiscia[layout->n_antiscia++]);
+            antiscion->planet1   = gswe_planet_data_get_planet(planet1);
+            antiscion->position1 = gswe_planet_data_get_position(planet1);
+            antiscion->planet2   = gswe_planet_data_get_planet(planet2);
+            antiscion->position2 = gswe_planet_data_get_position(planet2);
+            antiscion->axis      = gswe_antiscion_data_get_axis(
+                    antiscion_data
+                );
+        }
 
-    xmlNewProp(node, BAD_CAST "phase", BAD_CAST enum_value->value_nick);
-    xmlNewProp(node, BAD_CAST "illumination", BAD_CAST value);
+        gswe_antiscion_data_unref(antiscion_data);
+    }
+}
 
-    g_free(value);
-    g_type_class_unref(moon_phase_class);
-    gswe_moon_phase_data_unref(moon_phase_data);
+/*
+ * ag_chart_add_angle_connections:
+ * @chart: an #AgChart
+ * @layout: a layout that already has the bodies of @chart
+ *
+ * Add the aspects and antiscia of the ascendant, the MC and the vertex to
+ * @layout. The other ends are taken from the body positions in @layout, so
+ * swe-glib only has to calculate the angles, which come with the houses.
+ * gswe_moment_get_all_aspects() would calculate every planet of the chart
+ * again instead.
+ *
+ * The caller must hold ephemeris_lock.
+ */
+static void
+ag_chart_add_angle_connections(AgChart *chart, AgChartLayout *layout)
+{
+    AgChartPrivate *priv    = ag_chart_get_instance_private(chart);
+    GPtrArray      *angles  = g_ptr_array_new(),
+                   *bodies  = g_ptr_array_new_with_free_func(
+            (GDestroyNotify)gswe_planet_data_unref
+        );
+    GList          *l;
+    guint          i,
+                   j,
+                   n_pairs;
+
+    for (l = priv->planet_list; l; l = g_list_next(l)) {
+        if (ag_chart_is_angle(GPOINTER_TO_INT(l->data))) {
+            g_ptr_array_add(
+                    angles,
+                    gswe_moment_get_planet(
+                            GSWE_MOMENT(chart),
+                            GPOINTER_TO_INT(l->data),
+                            NULL
+                        )
+                );
+        }
+    }
 
-    g_type_class_unref(planets_class);
+    for (i = 0; i < layout->n_bodies; i++) {
+        GswePlanetData *planet_data = gswe_planet_data_new();
 
-    // Now, doc contains the generated XML tree
+        gswe_planet_data_set_planet(
+                planet_data,
+                layout->bodies[i].planet,
+                NULL
+            );
+        gswe_planet_data_set_position(
+                planet_data,
+                layout->bodies[i].position
+            );
+        g_ptr_array_add(bodies, planet_data);
+    }
 
-    xslt_data = g_resources_lookup_data(
-            "/eu/polonkai/gergely/Astrognome/ui/chart-default.xsl",
-            G_RESOURCE_LOOKUP_FLAGS_NONE,
-            NULL
-        );
+    // Every angle with the angles after it, and with every body
+    n_pairs = angles->len * bodies->len;
+
+    if (angles->len > 1) {
+        n_pairs += angles->len * (angles->len - 1) / 2;
+    }
+
+    layout->aspects  = g_renew(
+            AgChartLayoutAspect,
+            layout->aspects,
+            layout->n_aspects + n_pairs
+        );
+    layout->antiscia = g_renew(
+            AgChartLayoutAntiscion,
+            layout->antiscia,
+            layout->n_antiscia + n_pairs
+        );
+
+    for (i = 0; i < angles->len; i++) {
+        GswePlanetData *angle = g_ptr_array_index(angles, i);
+
+        if (angle == NULL) {
+            continue;
+        }
+
+        for (j = i + 1; j < angles->len; j++) {
+            if (g_ptr_array_index(angles, j) != NULL) {
+                ag_chart_add_layout_connection(
+                        layout,
+                        angle,
+                        g_ptr_array_index(angles, j)
+                    );
+            }
+        }
+
+        for (j = 0; j < bodies->len; j++) {
+            ag_chart_add_layout_connection(
+                    layout,
+                    angle,
+                    g_ptr_array_index(bodies, j)
+                );
+        }
+    }
+
+    g_ptr_array_unref(angles);
+    g_ptr_array_unref(bodies);
+}
+
+/*
+ * ag_chart_get_time_layout:
+ * @chart: an #AgChart
+ *
+ * Collect the parts of the chart layout that only depend on the time: the
+ * bodies, the aspects and antiscia between them, and the Moon phase.
+ *
+ * The caller must hold ephemeris_lock.
+ *
+ * Returns: (transfer full): a partial chart layout
+ */
+static AgChartLayout *
+ag_chart_get_time_layout(AgChart *chart)
+{
+    AgChartLayout     *layout = g_new0(AgChartLayout, 1);
+    GsweMoonPhaseData *moon_phase_data;
+
+    layout->bodies = ag_chart_get_bodies(
+            chart,
+            &(layout->n_bodies),
+            &(layout->max_dist)
+        );
+
+    ag_chart_add_layout_aspects(chart, layout);
+    ag_chart_add_layout_antiscia(chart, layout);
+
+    moon_phase_data = gswe_moment_get_moon_phase(GSWE_MOMENT(chart), NULL);
+    layout->moon_phase        = gswe_moon_phase_data_get_phase(
+            moon_phase_data
+        );
+    layout->moon_illumination = gswe_moon_phase_data_get_illumination(
+            moon_phase_data
+        );
+    gswe_moon_phase_data_unref(moon_phase_data);
+
+    return layout;
+}
+
+static AgChartLayout *
+ag_chart_time_layout_copy(const AgChartLayout *time_layout)
+{
+    AgChartLayout *layout = g_new0(AgChartLayout, 1);
+
+    layout->n_bodies          = time_layout->n_bodies;
+    layout->bodies            = g_new(AgChartLayoutBody, layout->n_bodies);
+    memcpy(
+            layout->bodies,
+            time_layout->bodies,
+            layout->n_bodies * sizeof(AgChartLayoutBody)
+        );
+    layout->max_dist          = time_layout->max_dist;
+    layout->n_aspects         = time_layout->n_aspects;
+    layout->aspects           = g_new(AgChartLayoutAspect, layout->n_aspects);
+    memcpy(
+            layout->aspects,
+            time_layout->aspects,
+            layout->n_aspects * sizeof(AgChartLayoutAspect)
+        );
+    layout->n_antiscia        = time_layout->n_antiscia;
+    layout->antiscia          = g_new(
+            AgChartLayoutAntiscion,
+            layout->n_antiscia
+        );
+    memcpy(
+            layout->antiscia,
+            time_layout->antiscia,
+            layout->n_antiscia * sizeof(AgChartLayoutAntiscion)
+        );
+    layout->moon_phase        = time_layout->moon_phase;
+    layout->moon_illumination = time_layout->moon_illumination;
+
+    return layout;
+}
+
+static void
+ag_ephemeris_cache_entry_free(AgEphemerisCacheEntry *entry)
+{
+    g_free(entry->key);
+    ag_chart_layout_free(entry->layout);
+    g_free(entry);
+}
+
+/*
+ * ag_chart_get_ephemeris_cache_key:
+ * @chart: an #AgChart
+ *
+ * Generate the ephemeris cache key of @chart from the Julian day (UT) of its
+ * moment, its coordinates and the list of its bodies. Positions are
+ * calculated topocentrically, so the same moment at a different place is a
+ * different entry. The numbers are printed in hex float format, so only the
+ * very same instant and place matches, whatever the time zone of the chart
+ * is.
+ *
+ * The caller must hold ephemeris_lock.
+ *
+ * Returns: (transfer full): the cache key
+ */
+static gchar *
+ag_chart_get_ephemeris_cache_key(AgChart *chart)
+{
+    AgChartPrivate  *priv = ag_chart_get_instance_private(chart);
+    GString         *key  = g_string_new(NULL);
+    GsweCoordinates *coordinates;
+    GList           *l;
+
+    coordinates = gswe_moment_get_coordinates(GSWE_MOMENT(chart));
+
+    g_string_append_printf(
+            key,
+            "%a@%a,%a,%a",
+            gswe_timestamp_get_julian_day_ut(
+                    gswe_moment_get_timestamp(GSWE_MOMENT(chart)),
+                    NULL
+                ),
+            coordinates->longitude,
+            coordinates->latitude,
+            coordinates->altitude
+        );
+
+    g_free(coordinates);
+
+    for (l = priv->planet_list; l; l = g_list_next(l)) {
+        g_string_append_printf(key, ":%d", GPOINTER_TO_INT(l->data));
+    }
+
+    return g_string_free(key, FALSE);
+}
+
+/*
+ * ag_chart_get_shared_time_layout:
+ * @chart: an #AgChart
+ *
+ * Get the time and location dependent parts of the layout of @chart from
+ * the ephemeris cache. If the moment and place of @chart is not cached yet,
+ * it is calculated and added to the cache, dropping the least recently used
+ * entry if the cache is full.
+ *
+ * The caller must hold ephemeris_lock.
+ *
+ * Returns: (transfer full): a partial chart layout
+ */
+static AgChartLayout *
+ag_chart_get_shared_time_layout(AgChart *chart)
+{
+    AgEphemerisCacheEntry *entry;
+    AgChartLayout         *layout;
+    GList                 *link;
+    gchar                 *key = ag_chart_get_ephemeris_cache_key(chart);
+
+    g_mutex_lock(&ephemeris_cache_lock);
+
+    if (ephemeris_cache == NULL) {
+        ephemeris_cache = g_hash_table_new(g_str_hash, g_str_equal);
+    }
+
+    if ((link = g_hash_table_lookup(ephemeris_cache, key)) != NULL) {
+        ephemeris_cache_hits++;
+
+        g_queue_unlink(&ephemeris_cache_lru, link);
+        g_queue_push_head_link(&ephemeris_cache_lru, link);
+        layout = ag_chart_time_layout_copy(
+                ((AgEphemerisCacheEntry *)link->data)->layout
+            );
+
+        g_mutex_unlock(&ephemeris_cache_lock);
+        g_free(key);
+
+        return layout;
+    }
+
+    ephemeris_cache_misses++;
+    g_mutex_unlock(&ephemeris_cache_lock);
+
+    // The calculation is done without the cache lock held, so reading the
+    // statistics doesn’t wait for swe-glib. Only one thread may calculate at
+    // a time anyway, so no one else may add the same entry meanwhile.
+    entry         = g_new0(AgEphemerisCacheEntry, 1);
+    entry->key    = key;
+    entry->layout = ag_chart_get_time_layout(chart);
+    layout        = ag_chart_time_layout_copy(entry->layout);
+
+    g_mutex_lock(&ephemeris_cache_lock);
+
+    if (ephemeris_cache == NULL) {
+        ephemeris_cache = g_hash_table_new(g_str_hash, g_str_equal);
+    }
+
+    g_queue_push_head(&ephemeris_cache_lru, entry);
+    g_hash_table_insert(ephemeris_cache, entry->key, ephemeris_cache_lru.head);
+
+    while (ephemeris_cache_lru.length > AG_CHART_EPHEMERIS_CACHE_SIZE) {
+        AgEphemerisCacheEntry *oldest = g_queue_pop_tail(&ephemeris_cache_lru);
+
+        g_hash_table_remove(ephemeris_cache, oldest->key);
+        ag_ephemeris_cache_entry_free(oldest);
+    }
+
+    g_mutex_unlock(&ephemeris_cache_lock);
+
+    return layout;
+}
+
+/*
+ * ag_chart_get_vertex_dist:
+ * @layout: a layout with the bodies and the vertex already set
+ *
+ * Get the distance level of the vertex. It goes one level above the bodies
+ * closer than 5° to it, so its symbol doesn’t overlap theirs.
+ *
+ * Returns: the distance level of the vertex
+ */
+static guint
+ag_chart_get_vertex_dist(const AgChartLayout *layout)
+{
+    guint i,
+          dist = 0;
+
+    for (i = 0; i < layout->n_bodies; i++) {
+        gdouble diff = fabs(layout->bodies[i].position - layout->vertex);
+
+        if (diff > 180.0) {
+            diff = 360.0 - diff;
+        }
+
+        if (diff < 5.0) {
+            dist = MAX(dist, layout->bodies[i].dist + 1);
+        }
+    }
+
+    return dist;
+}
+
+/**
+ * ag_chart_get_layout:
+ * @chart: an #AgChart
+ *
+ * Get a snapshot of everything that is drawn on the chart image: the
+ * ascendant, MC and vertex, the house cusps, the planets with their
+ * distance levels, the aspects, the antiscia and the Moon phase. The
+ * snapshot doesn’t reference @chart, so it can be drawn from any thread.
+ *
+ * The parts that don’t depend on the house system are taken from the
+ * ephemeris cache shared by all charts. For a moment and place already in
+ * the cache, swe-glib only calculates the houses and the angles; the aspects
+ * and antiscia of the angles are found using the cached body positions.
+ *
+ * Returns: (transfer full): the chart layout. Free it with
+ *          ag_chart_layout_free().
+ */
+AgChartLayout *
+ag_chart_get_layout(AgChart *chart)
+{
+    AgChartLayout *layout = g_new0(AgChartLayout, 1),
+                  *time_layout;
+    GList         *houses,
+                  *l;
+    gint64        trace   = ag_trace_begin();
+
+    g_rec_mutex_lock(&ephemeris_lock);
+
+    // gswe_moment_get_house_cusps() also calculates ascmcs data, so call it
+    // this early
+    houses = gswe_moment_get_house_cusps(GSWE_MOMENT(chart), NULL);
+
+    layout->ascendant = gswe_planet_data_get_position(
+            gswe_moment_get_planet(
+                    GSWE_MOMENT(chart),
+                    GSWE_PLANET_ASCENDANT,
+                    NULL
+                )
+        );
+    layout->mc = gswe_planet_data_get_position(
+            gswe_moment_get_planet(GSWE_MOMENT(chart), GSWE_PLANET_MC, NULL)
+        );
+    layout->vertex = gswe_planet_data_get_position(
+            gswe_moment_get_planet(
+                    GSWE_MOMENT(chart),
+                    GSWE_PLANET_VERTEX,
+                    NULL
+                )
+        );
+
+    for (l = houses; l; l = g_list_next(l)) {
+        GsweHouseData *house_data = l->data;
+        guint         house       = gswe_house_data_get_house(house_data);
+
+        if ((house < 1) || (house > G_N_ELEMENTS(layout->houses))) {
+            continue;
+        }
+
+        layout->houses[house - 1] = gswe_house_data_get_cusp_position(
+                house_data
+            );
+        layout->n_houses = MAX(layout->n_houses, house);
+    }
+
+    // The time dependent parts are moved from the cached copy, so only the
+    // copy itself has to be freed
+    time_layout = ag_chart_get_shared_time_layout(chart);
+
+    layout->n_bodies          = time_layout->n_bodies;
+    layout->bodies            = time_layout->bodies;
+    layout->max_dist          = time_layout->max_dist;
+    layout->n_aspects         = time_layout->n_aspects;
+    layout->aspects           = time_layout->aspects;
+    layout->n_antiscia        = time_layout->n_antiscia;
+    layout->antiscia          = time_layout->antiscia;
+    layout->moon_phase        = time_layout->moon_phase;
+    layout->moon_illumination = time_layout->moon_illumination;
+
+    g_free(time_layout);
+
+    layout->vertex_dist = ag_chart_get_vertex_dist(layout);
+    layout->max_dist    = MAX(layout->max_dist, layout->vertex_dist);
+
+    // Only the connections of the ascendant, the MC and the vertex depend on
+    // the location
+    ag_chart_add_angle_connections(chart, layout);
+
+    g_rec_mutex_unlock(&ephemeris_lock);
+    ag_trace_end(AG_TRACE_CHART_LAYOUT, trace);
+
+    return layout;
+}
+
+/**
+ * ag_chart_layout_free:
+ * @layout: (allow-none): an #AgChartLayout
+ *
+ * Free a chart layout returned by ag_chart_get_layout().
+ */
+void
+ag_chart_layout_free(AgChartLayout *layout)
+{
+    if (layout == NULL) {
+        return;
+    }
+
+    g_free(layout->bodies);
+    g_free(layout->aspects);
+    g_free(layout->antiscia);
+    g_free(layout);
+}
+
+/**
+ * ag_chart_layout_get_position:
+ * @layout: an #AgChartLayout
+ * @planet: the planet to look up
+ * @position: (out): the position of @planet
+ *
+ * Look up the position of a planet, or of the ascendant, the MC or the
+ * vertex, in @layout.
+ *
+ * Returns: %TRUE if @planet is on the chart, %FALSE otherwise
+ */
+gboolean
+ag_chart_layout_get_position(const AgChartLayout *layout,
+                             GswePlanet          planet,
+                             gdouble             *position)
+{
+    guint i;
+
+    switch (planet) {
+        case GSWE_PLANET_ASCENDANT:
+            *position = layout->ascendant;
+
+            return TRUE;
+
+        case GSWE_PLANET_MC:
+            *position = layout->mc;
+
+            return TRUE;
+
+        case GSWE_PLANET_VERTEX:
+            *position = layout->vertex;
+
+            return TRUE;
+
+        default:
+            break;
+    }
+
+    for (i = 0; i < layout->n_bodies; i++) {
+        if (layout->bodies[i].planet == planet) {
+            *position = layout->bodies[i].position;
+
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+static void
+ag_render_context_unref(AgRenderContext *context)
+{
+    if (g_atomic_int_dec_and_test(&(context->ref_count))) {
+        xsltFreeStylesheet(context->stylesheet);
+        freelocale(context->c_locale);
+        g_type_class_unref(context->planets_class);
+        g_type_class_unref(context->aspects_class);
+        g_type_class_unref(context->antiscia_class);
+        g_type_class_unref(context->moon_phase_class);
+        g_free(context);
+    }
+}
+
+static AgRenderContext *
+ag_render_context_new(GError **err)
+{
+    xmlDocPtr         xslt_doc;
+    xsltStylesheetPtr xslt_proc;
+    GBytes            *xslt_data;
+    const gchar       *xslt_content;
+    gsize             xslt_length;
+    locale_t          c_locale;
+    AgRenderContext   *context;
+    gint64            start = ag_trace_begin();
+
+    // libxslt formats numbers according to the current locale, which may
+    // use something else than a dot as the decimal separator. Transformations
+    // run with this locale instead.
+    if ((c_locale = newlocale(LC_ALL_MASK, "C", (locale_t)0)) == (locale_t)0) {
+        g_set_error(
+                err,
+                AG_CHART_ERROR, AG_CHART_ERROR_RENDERING_ERROR,
+                "The C locale can not be loaded: %s",
+                g_strerror(errno)
+            );
+
+        return NULL;
+    }
+
+    // The flattened stylesheet has its XIncludes resolved at build time
+    xslt_data = g_resources_lookup_data(
+            (use_flat_stylesheet)
+                ? "/eu/polonkai/gergely/Astrognome/ui/chart-default-flat.xsl"
+                : "/eu/polonkai/gergely/Astrognome/ui/chart-default.xsl",
+            G_RESOURCE_LOOKUP_FLAGS_NONE,
+            NULL
+        );
     xslt_content = g_bytes_get_data(xslt_data, &xslt_length);
 
-    if ((xslt_doc = xmlReadMemory(
-                xslt_content,
-                xslt_length,
-                "file://" PKGDATADIR "/astrognome",
-                "UTF-8",
-                0
-            )) == NULL) {
-        g_set_error(
-                err,
-                AG_CHART_ERROR, AG_CHART_ERROR_CORRUPT_FILE,
-                "Built in style sheet can not be parsed as a stylesheet file."
+    if ((xslt_doc = xmlReadMemory(
+                xslt_content,
+                xslt_length,
+                "file://" PKGDATADIR "/astrognome",
+                "UTF-8",
+                0
+            )) == NULL) {
+        g_set_error(
+                err,
+                AG_CHART_ERROR, AG_CHART_ERROR_CORRUPT_FILE,
+                "Built in style sheet can not be parsed as a stylesheet file."
+            );
+        g_bytes_unref(xslt_data);
+        freelocale(c_locale);
+
+        return NULL;
+    }
+
+    g_bytes_unref(xslt_data);
+
+    if (!use_flat_stylesheet) {
+#if LIBXML_VERSION >= 20603
+        xmlXIncludeProcessFlags(xslt_doc, XSLT_PARSE_OPTIONS);
+#else
+        xmlXIncludeProcess(xslt_doc);
+#endif
+    }
+
+    if ((xslt_proc = xsltParseStylesheetDoc(xslt_doc)) == NULL) {
+        g_set_error(
+                err,
+                AG_CHART_ERROR, AG_CHART_ERROR_CORRUPT_FILE,
+                "Built in style sheet can not be parsed as a stylesheet file."
+            );
+        xmlFreeDoc(xslt_doc);
+        freelocale(c_locale);
+
+        return NULL;
+    }
+
+    context                   = g_new0(AgRenderContext, 1);
+    context->stylesheet       = xslt_proc;
+    context->c_locale         = c_locale;
+    context->planets_class    = g_type_class_ref(GSWE_TYPE_PLANET);
+    context->aspects_class    = g_type_class_ref(GSWE_TYPE_ASPECT);
+    context->antiscia_class   = g_type_class_ref(GSWE_TYPE_ANTISCION_AXIS);
+    context->moon_phase_class = g_type_class_ref(GSWE_TYPE_MOON_PHASE);
+    context->ref_count        = 1;
+
+    ag_trace_end(AG_TRACE_CHART_STYLESHEET, start);
+
+    return context;
+}
+
+/*
+ * ag_render_context_get:
+ * @err: a #GError
+ *
+ * Get the render context shared by all renderings. The stylesheet is parsed
+ * (and its XIncludes resolved) only on the first call, or on the first call
+ * after ag_chart_invalidate_stylesheet_cache().
+ *
+ * Returns: (transfer full): the render context. Release it with
+ *          ag_render_context_unref().
+ */
+static AgRenderContext *
+ag_render_context_get(GError **err)
+{
+    AgRenderContext *context;
+
+    g_mutex_lock(&stylesheet_cache_lock);
+
+    if (render_context_cache == NULL) {
+        stylesheet_cache_misses++;
+        g_debug("Stylesheet cache miss, parsing chart stylesheet");
+
+        render_context_cache = ag_render_context_new(err);
+    } else {
+        stylesheet_cache_hits++;
+    }
+
+    if ((context = render_context_cache) != NULL) {
+        g_atomic_int_inc(&(context->ref_count));
+    }
+
+    g_mutex_unlock(&stylesheet_cache_lock);
+
+    return context;
+}
+
+/**
+ * ag_chart_invalidate_stylesheet_cache:
+ *
+ * Drop the compiled chart stylesheet, so the next rendering parses it
+ * again. Renderings already in progress keep using the old stylesheet
+ * until they finish.
+ */
+void
+ag_chart_invalidate_stylesheet_cache(void)
+{
+    AgRenderContext *context;
+
+    g_mutex_lock(&stylesheet_cache_lock);
+    context              = render_context_cache;
+    render_context_cache = NULL;
+    g_mutex_unlock(&stylesheet_cache_lock);
+
+    if (context != NULL) {
+        g_debug("Invalidating chart stylesheet cache");
+        ag_render_context_unref(context);
+    }
+}
+
+/**
+ * ag_chart_set_flat_stylesheet:
+ * @flat: %TRUE to use the stylesheet flattened at build time, %FALSE to
+ *        resolve the XIncludes of the original stylesheet at runtime
+ *
+ * Select the chart stylesheet source. The flattened stylesheet is the
+ * default; the other one is useful when working on the stylesheet or the
+ * icons without rebuilding.
+ */
+void
+ag_chart_set_flat_stylesheet(gboolean flat)
+{
+    g_mutex_lock(&stylesheet_cache_lock);
+    use_flat_stylesheet = flat;
+    g_mutex_unlock(&stylesheet_cache_lock);
+
+    ag_chart_invalidate_stylesheet_cache();
+}
+
+/**
+ * ag_chart_set_prune_hidden:
+ * @prune: %TRUE to leave the elements hidden by the display theme out of
+ *         the generated SVG, %FALSE to only hide them with CSS
+ *
+ * Select how ag_chart_create_svg() handles the planets, aspects and antiscia
+ * hidden by the display theme. Pruning them is the default; it makes the
+ * SVG smaller and faster to render. The CSS rules hiding them are generated
+ * either way.
+ */
+void
+ag_chart_set_prune_hidden(gboolean prune)
+{
+    g_atomic_int_set(&prune_hidden_elements, prune);
+}
+
+/**
+ * ag_chart_get_stylesheet_cache_stats:
+ * @hits: (out) (allow-none): the number of renderings that used the cached
+ *        stylesheet
+ * @misses: (out) (allow-none): the number of times the stylesheet had to be
+ *          parsed
+ *
+ * Get the hit/miss counters of the compiled stylesheet cache.
+ */
+void
+ag_chart_get_stylesheet_cache_stats(guint *hits, guint *misses)
+{
+    g_mutex_lock(&stylesheet_cache_lock);
+
+    if (hits != NULL) {
+        *hits = stylesheet_cache_hits;
+    }
+
+    if (misses != NULL) {
+        *misses = stylesheet_cache_misses;
+    }
+
+    g_mutex_unlock(&stylesheet_cache_lock);
+}
+
+/**
+ * ag_chart_clear_ephemeris_cache:
+ *
+ * Drop all moments from the ephemeris cache shared by the charts. The hit
+ * and miss counters are kept.
+ */
+void
+ag_chart_clear_ephemeris_cache(void)
+{
+    g_mutex_lock(&ephemeris_cache_lock);
+
+    if (ephemeris_cache != NULL) {
+        g_hash_table_remove_all(ephemeris_cache);
+    }
+
+    g_queue_foreach(
+            &ephemeris_cache_lru,
+            (GFunc)ag_ephemeris_cache_entry_free,
+            NULL
+        );
+    g_queue_clear(&ephemeris_cache_lru);
+
+    g_mutex_unlock(&ephemeris_cache_lock);
+}
+
+/**
+ * ag_chart_get_ephemeris_cache_stats:
+ * @hits: (out) (allow-none): the number of chart layouts that got their
+ *        planets from the ephemeris cache
+ * @misses: (out) (allow-none): the number of chart layouts that had to
+ *          calculate their planets
+ *
+ * Get the hit/miss counters of the ephemeris cache shared by the charts.
+ */
+void
+ag_chart_get_ephemeris_cache_stats(guint *hits, guint *misses)
+{
+    g_mutex_lock(&ephemeris_cache_lock);
+
+    if (hits != NULL) {
+        *hits = ephemeris_cache_hits;
+    }
+
+    if (misses != NULL) {
+        *misses = ephemeris_cache_misses;
+    }
+
+    g_mutex_unlock(&ephemeris_cache_lock);
+}
+
+/*
+ * ag_chart_set_geometry_prop:
+ * @node: the node to add the property to
+ * @name: the name of the property
+ * @format: the value of the property, with a # in place of each number
+ * @...: the numbers, all of them gdouble
+ *
+ * Add a property with numbers formatted the same way in every locale.
+ */
+static void
+ag_chart_set_geometry_prop(xmlNodePtr  node,
+                           const gchar *name,
+                           const gchar *format,
+                           ...)
+{
+    va_list     args;
+    GString     *value = g_string_sized_new(64);
+    const gchar *p;
+    gchar       buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+    va_start(args, format);
+
+    for (p = format; *p; p++) {
+        if (*p == '#') {
+            g_string_append(value, g_ascii_formatd(
+                    buffer,
+                    sizeof(buffer),
+                    "%.4f",
+                    va_arg(args, gdouble)
+                ));
+        } else {
+            g_string_append_c(value, *p);
+        }
+    }
+
+    va_end(args);
+
+    xmlNewProp(node, BAD_CAST name, BAD_CAST value->str);
+    g_string_free(value, TRUE);
+}
+
+/*
+ * ag_chart_add_geometry_node:
+ *
+ * Add the sizes the stylesheet needs to the chart document, so it doesn’t
+ * have to calculate anything.
+ */
+static void
+ag_chart_add_geometry_node(xmlNodePtr root_node, const AgChartGeometry *g)
+{
+    xmlNodePtr node;
+    gdouble    icon_half = g->icon_size / 2;
+
+    node = xmlNewChild(root_node, NULL, BAD_CAST "geometry", NULL);
+
+    ag_chart_set_geometry_prop(node, "image_size", "#", g->image_size);
+    ag_chart_set_geometry_prop(node, "center", "#", g->image_size / 2);
+    ag_chart_set_geometry_prop(node, "asc_rotate", "#", g->asc_rotate);
+    ag_chart_set_geometry_prop(node, "r_outer", "#", g->r_outer);
+    ag_chart_set_geometry_prop(node, "r_signs", "#", g->r_signs);
+    ag_chart_set_geometry_prop(node, "r_aspect", "#", g->r_aspect);
+    ag_chart_set_geometry_prop(node, "r_houses", "#", g->r_houses);
+    ag_chart_set_geometry_prop(node, "r_moon", "#", g->r_moon);
+    ag_chart_set_geometry_prop(
+            node, "deg5_end",
+            "#", g->r_aspect + g->deg5_len
+        );
+    ag_chart_set_geometry_prop(
+            node, "deg1_end",
+            "#", g->r_aspect + g->deg1_len
+        );
+    ag_chart_set_geometry_prop(
+            node, "sign_transform",
+            "translate(#,#) rotate(90,#,#) scale(#)",
+            g->sign_pos, -icon_half,
+            icon_half, icon_half,
+            g->icon_scale
+        );
+    ag_chart_set_geometry_prop(
+            node, "arrow_ref",
+            "#", g->chart_size * 0.005833
+        );
+    ag_chart_set_geometry_prop(
+            node, "arrow_points",
+            "0.0,0.0 #,# #,0.0 #,#",
+            g->chart_size * 0.011666, -g->chart_size * 0.003333,
+            g->chart_size * 0.008333,
+            g->chart_size * 0.011666, g->chart_size * 0.003333
+        );
+    ag_chart_set_geometry_prop(
+            node, "house_font_size",
+            "#", g->chart_size * 0.016666
+        );
+    ag_chart_set_geometry_prop(
+            node, "house_number_pos",
+            "#", g->chart_size * 0.091666
+        );
+    ag_chart_set_geometry_prop(
+            node, "house_cusp_start",
+            "#", g->chart_size * 0.083333
+        );
+    ag_chart_set_geometry_prop(
+            node, "house_cusp_end",
+            "#", g->chart_size * 0.4
+        );
+    ag_chart_set_geometry_prop(
+            node, "house_cusp_outer_start",
+            "#", g->chart_size * 0.5
+        );
+    ag_chart_set_geometry_prop(
+            node, "house_cusp_outer_end",
+            "#", g->chart_size * 0.55
+        );
+    ag_chart_set_geometry_prop(
+            node, "axis_start",
+            "#", g->chart_size * 0.083333
+        );
+    ag_chart_set_geometry_prop(
+            node, "axis_end",
+            "#", g->chart_size * 0.533333
+        );
+    ag_chart_set_geometry_prop(
+            node, "planet_marker_start",
+            "#", g->r_aspect - g->planet_marker_len
+        );
+    ag_chart_set_geometry_prop(
+            node, "planet_marker_end",
+            "#", g->r_outer + g->planet_marker_len
+        );
+    ag_chart_set_geometry_prop(
+            node, "symbol_transform",
+            "scale(#)", g->icon_scale
+        );
+    ag_chart_set_geometry_prop(
+            node, "upside_down_symbol_transform",
+            "rotate(180,#,#) scale(#)",
+            icon_half, icon_half,
+            g->icon_scale
+        );
+    ag_chart_set_geometry_prop(node, "retrograde_font_size", "#", icon_half);
+    ag_chart_set_geometry_prop(
+            node, "retrograde_transform",
+            "translate(#,#)",
+            g->icon_size, g->icon_size * 1.5
+        );
+}
+
+/*
+ * ag_chart_set_planet_geometry:
+ *
+ * Add the transformations that put a planet symbol to its place, to
+ * properties named @prefix + "transform" and @prefix + "symbol_transform".
+ */
+static void
+ag_chart_set_planet_geometry(xmlNodePtr            node,
+                             const gchar           *prefix,
+                             const AgChartGeometry *g,
+                             gdouble               degree,
+                             guint                 dist)
+{
+    gchar   *name;
+    gdouble icon_half = g->icon_size / 2;
+
+    name = g_strconcat(prefix, "transform", NULL);
+    ag_chart_set_geometry_prop(node, name, "rotate(#,0,0)", -degree);
+    g_free(name);
+
+    // Move the symbol outwards, and turn it back upright
+    name = g_strconcat(prefix, "symbol_transform", NULL);
+    ag_chart_set_geometry_prop(
+            node, name,
+            "translate(#,#) rotate(#,#,#)",
+            ag_chart_geometry_get_planet_pos(g, dist), -icon_half,
+            degree - g->asc_rotate, icon_half, icon_half
+        );
+    g_free(name);
+}
+
+/*
+ * ag_chart_set_line_geometry:
+ *
+ * Add the endpoints of an aspect or antiscion line between two positions on
+ * the inner circle.
+ */
+static void
+ag_chart_set_line_geometry(xmlNodePtr            node,
+                           const AgChartGeometry *g,
+                           gdouble               position1,
+                           gdouble               position2)
+{
+    gdouble x,
+            y;
+
+    ag_chart_geometry_polar(position1, g->r_aspect, &x, &y);
+    ag_chart_set_geometry_prop(node, "x1", "#", x);
+    ag_chart_set_geometry_prop(node, "y1", "#", y);
+
+    ag_chart_geometry_polar(position2, g->r_aspect, &x, &y);
+    ag_chart_set_geometry_prop(node, "x2", "#", x);
+    ag_chart_set_geometry_prop(node, "y2", "#", y);
+}
+
+/*
+ * ag_chart_set_moon_geometry:
+ *
+ * Add the outline of the lit part of the Moon, unless it is a full or a new
+ * Moon.
+ */
+static void
+ag_chart_set_moon_geometry(xmlNodePtr            node,
+                           const AgChartGeometry *g,
+                           const gchar           *phase,
+                           gdouble               illumination)
+{
+    gdouble  r = g->r_moon,
+             r2;
+    gboolean waning;
+
+    if (strncmp(phase, "wa", 2) != 0) {
+        return;
+    }
+
+    waning = (strncmp(phase, "wan", 3) == 0);
+    r2     = ag_chart_geometry_get_moon_arc_radius(g, illumination);
+
+    // The lit half of the disc, then the terminator back to the start
+    if (illumination == 50.0) {
+        ag_chart_set_geometry_prop(
+                node, "path",
+                (waning)
+                    ? "m 0,# a #,# 0 0,1 0,# l 0,# z"
+                    : "m 0,# a #,# 0 0,0 0,# l 0,# z",
+                r, r, r, -2 * r, 2 * r
+            );
+    } else {
+        ag_chart_set_geometry_prop(
+                node, "path",
+                (waning)
+                    ? (illumination > 50.0)
+                        ? "m 0,# a #,# 0 0,1 0,# a #,# 0 0,1 0,# z"
+                        : "m 0,# a #,# 0 0,1 0,# a #,# 0 0,0 0,# z"
+                    : (illumination > 50.0)
+                        ? "m 0,# a #,# 0 0,0 0,# a #,# 0 0,0 0,# z"
+                        : "m 0,# a #,# 0 0,0 0,# a #,# 0 0,1 0,# z",
+                r, r, r, -2 * r, r2, r2, 2 * r
+            );
+    }
+}
+
+/*
+ * ag_chart_transform:
+ *
+ * Build the XML description of @chart, and transform it to an SVG document
+ * with the chart stylesheet. The returned document must be freed with
+ * xmlFreeDoc().
+ */
+static xmlDocPtr
+ag_chart_transform(AgChart        *chart,
+                   gboolean       rendering,
+                   AgDisplayTheme *theme,
+                   guint          image_size,
+                   guint          icon_size,
+                   GError         **err)
+{
+    xmlDocPtr         doc,
+                      svg_doc;
+    xmlNodePtr        root_node     = NULL,
+                      ascmcs_node   = NULL,
+                      houses_node   = NULL,
+                      bodies_node   = NULL,
+                      aspects_node  = NULL,
+                      antiscia_node = NULL,
+                      vertex_node   = NULL,
+                      node          = NULL;
+    gchar             *value,
+                      *css,
+                      **params;
+    AgChartLayout     *layout;
+    guint             i;
+    AgChartGeometry   geometry;
+    AgRenderContext   *context;
+    locale_t          current_locale;
+    GEnumValue        *enum_value;
+    AgDisplayTheme    *filter;
+    gint64            start;
+
+    // Elements not shown by filter are left out of the XML tree. A NULL
+    // theme shows everything
+    filter = (g_atomic_int_get(&prune_hidden_elements)) ? theme : NULL;
+
+    if ((context = ag_render_context_get(err)) == NULL) {
+        return NULL;
+    }
+
+    // Only the chart data may trigger calculations in the ephemeris; the
+    // tree is built from the layout, which doesn’t need the lock
+    start = ag_trace_begin();
+    g_rec_mutex_lock(&ephemeris_lock);
+    doc = create_save_doc(chart);
+    g_rec_mutex_unlock(&ephemeris_lock);
+
+    layout    = ag_chart_get_layout(chart);
+    root_node = xmlDocGetRootElement(doc);
+
+    // Begin <ascmcs> node
+    g_debug("Generating theoretical points table");
+    ascmcs_node = xmlNewChild(root_node, NULL, BAD_CAST "ascmcs", NULL);
+
+    node  = xmlNewChild(ascmcs_node, NULL, BAD_CAST "ascendant", NULL);
+    value = g_malloc0(12);
+    g_ascii_dtostr(value, 12, layout->ascendant);
+    xmlNewProp(node, BAD_CAST "degree_ut", BAD_CAST value);
+    g_free(value);
+
+    node  = xmlNewChild(ascmcs_node, NULL, BAD_CAST "mc", NULL);
+    value = g_malloc0(12);
+    g_ascii_dtostr(value, 12, layout->mc);
+    xmlNewProp(node, BAD_CAST "degree_ut", BAD_CAST value);
+    g_free(value);
+
+    if (ag_display_theme_shows_planet(filter, GSWE_PLANET_VERTEX)) {
+        vertex_node = xmlNewChild(
+                ascmcs_node,
+                NULL,
+                BAD_CAST "vertex",
+                NULL
             );
-        xmlFreeDoc(doc);
 
-        return NULL;
+        value = g_malloc0(12);
+        g_ascii_dtostr(value, 12, layout->vertex);
+        xmlNewProp(vertex_node, BAD_CAST "degree_ut", BAD_CAST value);
+        g_free(value);
     }
 
-#if LIBXML_VERSION >= 20603
-    xmlXIncludeProcessFlags(xslt_doc, XSLT_PARSE_OPTIONS);
-#else
-    xmlXIncludeProcess(xslt_doc);
-#endif
+    // Begin <houses> node
+    g_debug("Generating houses table");
+    houses_node = xmlNewChild(root_node, NULL, BAD_CAST "houses", NULL);
 
-    if ((xslt_proc = xsltParseStylesheetDoc(xslt_doc)) == NULL) {
-        g_set_error(
-                err,
-                AG_CHART_ERROR, AG_CHART_ERROR_CORRUPT_FILE,
-                "Built in style sheet can not be parsed as a stylesheet file."
+    for (i = 0; i < layout->n_houses; i++) {
+        gdouble cusp      = layout->houses[i],
+                next_cusp = layout->houses[(i + 1) % layout->n_houses];
+
+        node = xmlNewChild(houses_node, NULL, BAD_CAST "house", NULL);
+
+        value = g_malloc0(3);
+        g_ascii_dtostr(value, 3, i + 1);
+        xmlNewProp(node, BAD_CAST "number", BAD_CAST value);
+        g_free(value);
+
+        value = g_malloc0(12);
+        g_ascii_dtostr(value, 12, cusp);
+        xmlNewProp(node, BAD_CAST "degree", BAD_CAST value);
+        g_free(value);
+
+        // The house number goes halfway to the next cusp
+        if (next_cusp < cusp) {
+            next_cusp += 360.0;
+        }
+
+        ag_chart_set_geometry_prop(
+                node, "mid",
+                "#", fmod((cusp + next_cusp) / 2, 360.0)
             );
-        xmlFreeDoc(xslt_doc);
-        xmlFreeDoc(doc);
+    }
 
-        return NULL;
+    // Begin <bodies> node
+    g_debug("Generating bodies table");
+    bodies_node = xmlNewChild(root_node, NULL, BAD_CAST "bodies", NULL);
+
+    ag_chart_geometry_init(
+            &geometry,
+            layout->ascendant,
+            layout->max_dist,
+            image_size,
+            (image_size == 0) ? 0 : icon_size
+        );
+    ag_chart_add_geometry_node(root_node, &geometry);
+
+    if (vertex_node != NULL) {
+        ag_chart_set_planet_geometry(
+                vertex_node, "",
+                &geometry,
+                layout->vertex,
+                layout->vertex_dist
+            );
+    }
+
+    // Hidden bodies still take part in the layout, so the visible ones stay
+    // where they would be with the CSS rules only
+    for (i = 0; i < layout->n_bodies; i++) {
+        AgChartLayoutBody *body = &(layout->bodies[i]);
+
+        if (!ag_display_theme_shows_planet(filter, body->planet)) {
+            continue;
+        }
+
+        node = xmlNewChild(bodies_node, NULL, BAD_CAST "body", NULL);
+
+        enum_value = g_enum_get_value(context->planets_class, body->planet);
+        xmlNewProp(node, BAD_CAST "name", BAD_CAST enum_value->value_nick);
+
+        value = g_malloc0(12);
+        g_ascii_dtostr(value, 12, body->position);
+        xmlNewProp(node, BAD_CAST "degree", BAD_CAST value);
+        g_free(value);
+
+        xmlNewProp(
+                node,
+                BAD_CAST "retrograde",
+                BAD_CAST ((body->retrograde) ? "True" : "False")
+            );
+
+        value = g_strdup_printf("%d", body->dist);
+        xmlNewProp(node, BAD_CAST "dist", BAD_CAST value);
+        g_free(value);
+
+        ag_chart_set_planet_geometry(
+                node, "",
+                &geometry,
+                body->position,
+                body->dist
+            );
+
+        // The descending node is drawn opposite to the ascending one
+        if (body->planet == GSWE_PLANET_MOON_NODE) {
+            ag_chart_set_planet_geometry(
+                    node, "desc_",
+                    &geometry,
+                    body->position + 180.0,
+                    body->dist
+                );
+        }
+    }
+
+    // Begin <aspects> node
+    g_debug("Generating aspects table");
+    aspects_node = xmlNewChild(root_node, NULL, BAD_CAST "aspects", NULL);
+
+    for (i = 0; i < layout->n_aspects; i++) {
+        AgChartLayoutAspect *aspect = &(layout->aspects[i]);
+
+        if (
+                    !ag_display_theme_shows_aspect(filter, aspect->aspect)
+                    || !ag_display_theme_shows_planet(filter, aspect->planet1)
+                    || !ag_display_theme_shows_planet(filter, aspect->planet2)
+                ) {
+            continue;
+        }
+
+        node = xmlNewChild(aspects_node, NULL, BAD_CAST "aspect", NULL);
+
+        enum_value = g_enum_get_value(context->planets_class, aspect->planet1);
+        xmlNewProp(node, BAD_CAST "body1", BAD_CAST enum_value->value_nick);
+
+        enum_value = g_enum_get_value(context->planets_class, aspect->planet2);
+        xmlNewProp(node, BAD_CAST "body2", BAD_CAST enum_value->value_nick);
+
+        enum_value = g_enum_get_value(context->aspects_class, aspect->aspect);
+        xmlNewProp(node, BAD_CAST "type", BAD_CAST enum_value->value_nick);
+
+        ag_chart_set_line_geometry(
+                node,
+                &geometry,
+                aspect->position1,
+                aspect->position2
+            );
+    }
+
+    // Begin <antiscia> node
+    g_debug("Generating antiscia table");
+    antiscia_node = xmlNewChild(root_node, NULL, BAD_CAST "antiscia", NULL);
+
+    for (i = 0; i < layout->n_antiscia; i++) {
+        AgChartLayoutAntiscion *antiscion = &(layout->antiscia[i]);
+
+        if (
+                    !ag_display_theme_shows_antiscion_axis(
+                            filter,
+                            antiscion->axis
+                        )
+                    || !ag_display_theme_shows_planet(
+                            filter,
+                            antiscion->planet1
+                        )
+                    || !ag_display_theme_shows_planet(
+                            filter,
+                            antiscion->planet2
+                        )
+                ) {
+            continue;
+        }
+
+        node = xmlNewChild(antiscia_node, NULL, BAD_CAST "antiscia", NULL);
+
+        enum_value = g_enum_get_value(
+                context->planets_class,
+                antiscion->planet1
+            );
+        xmlNewProp(node, BAD_CAST "body1", BAD_CAST enum_value->value_nick);
+
+        enum_value = g_enum_get_value(
+                context->planets_class,
+                antiscion->planet2
+            );
+        xmlNewProp(node, BAD_CAST "body2", BAD_CAST enum_value->value_nick);
+
+        enum_value = g_enum_get_value(
+                context->antiscia_class,
+                antiscion->axis
+            );
+        xmlNewProp(node, BAD_CAST "axis", BAD_CAST enum_value->value_nick);
+
+        ag_chart_set_line_geometry(
+                node,
+                &geometry,
+                antiscion->position1,
+                antiscion->position2
+            );
     }
 
-    params    = g_new0(gchar *, 11);
+    g_debug("Getting Moon phase");
+
+    enum_value = g_enum_get_value(
+            context->moon_phase_class,
+            layout->moon_phase
+        );
+    value = g_malloc0(12);
+    g_ascii_dtostr(value, 12, layout->moon_illumination);
+
+    node = xmlNewChild(root_node, NULL, BAD_CAST "moonphase", NULL);
+
+    xmlNewProp(node, BAD_CAST "phase", BAD_CAST enum_value->value_nick);
+    xmlNewProp(node, BAD_CAST "illumination", BAD_CAST value);
+    ag_chart_set_moon_geometry(
+            node,
+            &geometry,
+            enum_value->value_nick,
+            layout->moon_illumination
+        );
+
+    g_free(value);
+    ag_chart_layout_free(layout);
+
+    ag_trace_end(AG_TRACE_CHART_TREE, start);
+
+    // Now, doc contains the generated XML tree
+
+    // The image size is already in the <geometry> node
+    params    = g_new0(gchar *, 5);
     params[0] = "rendering";
     params[1] = (rendering) ? "'yes'" : "'no'";
     params[2] = "additional-css";
     css       = ag_display_theme_to_css(theme);
     params[3] = g_strdup_printf("\"%s\"", css);
     g_free(css);
-    params[4] = "chart-size";
-    params[6] = "image-size";
-    params[8] = "icon-size";
-
-    if (image_size == 0) {
-        params[5] = g_strdup_printf("%d", AG_CHART_DEFAULT_RING_SIZE);
-        params[7] = g_strdup("0");
-        params[9] = g_strdup("0");
-    } else {
-        params[5] = g_strdup("0");
-        params[7] = g_strdup_printf("%d", image_size);
-        params[9] = g_strdup_printf("%d", icon_size);
-    }
 
     // libxml2 messes up the output, as it prints decimal floating point
     // numbers in a localized format. It is not good in locales that use a
     // character for decimal separator other than a dot. So let's just use the
-    // C locale until the SVG is generated.
-    current_locale = uselocale(newlocale(LC_ALL, "C", 0));
-
-    svg_doc        = xsltApplyStylesheet(xslt_proc, doc, (const char **)params);
+    // C locale until the SVG is generated. uselocale() only affects the
+    // calling thread.
+    current_locale = uselocale(context->c_locale);
+    start          = ag_trace_begin();
+
+    svg_doc        = xsltApplyStylesheet(
+            context->stylesheet,
+            doc,
+            (const char **)params
+        );
 
+    ag_trace_end(AG_TRACE_CHART_XSLT, start);
     uselocale(current_locale);
-    xsltFreeStylesheet(xslt_proc);
+    ag_render_context_unref(context);
     xmlFreeDoc(doc);
     g_free(params[3]);
-    g_free(params[5]);
-    g_free(params[7]);
-    g_free(params[9]);
     g_free(params);
 
-    // Now, svg_doc contains the generated SVG file
+    if (svg_doc == NULL) {
+        g_set_error(
+                err,
+                AG_CHART_ERROR, AG_CHART_ERROR_LIBXML,
+                "Chart stylesheet could not be applied"
+            );
+    }
+
+    return svg_doc;
+}
+
+gchar *
+ag_chart_create_svg(AgChart        *chart,
+                    gsize          *length,
+                    gboolean       rendering,
+                    AgDisplayTheme *theme,
+                    guint          image_size,
+                    guint          icon_size,
+                    GError         **err)
+{
+    xmlDocPtr svg_doc;
+    gchar     *save_content = NULL;
+    gint      save_length;
+    gint64    start,
+              trace = ag_trace_begin();
+
+    if ((svg_doc = ag_chart_transform(
+                chart,
+                rendering,
+                theme,
+                image_size,
+                icon_size,
+                err
+            )) == NULL) {
+        return NULL;
+    }
 
+    start = ag_trace_begin();
     xmlDocDumpFormatMemoryEnc(
             svg_doc,
             (xmlChar **)&save_content,
@@ -1884,7 +3285,9 @@ ag_chart_create_svg(AgChart        *chart,
             "UTF-8",
             1
         );
+    ag_trace_end(AG_TRACE_CHART_SERIALIZE, start);
     xmlFreeDoc(svg_doc);
+    ag_trace_end(AG_TRACE_CHART_CREATE_SVG, trace);
 
     if (length != NULL) {
         *length = save_length;
@@ -1893,12 +3296,177 @@ ag_chart_create_svg(AgChart        *chart,
     return save_content;
 }
 
+typedef struct {
+    GOutputStream *stream;
+    GCancellable  *cancellable;
+    GError        *err;
+} AgChartSvgWriter;
+
+static int
+ag_chart_svg_writer_write(void *context, const char *buffer, int len)
+{
+    AgChartSvgWriter *writer = context;
+
+    // Don’t try again after a failed write
+    if (writer->err != NULL) {
+        return -1;
+    }
+
+    if (!g_output_stream_write_all(
+                writer->stream,
+                buffer,
+                len,
+                NULL,
+                writer->cancellable,
+                &(writer->err)
+            )) {
+        return -1;
+    }
+
+    return len;
+}
+
+static int
+ag_chart_svg_writer_close(void *context)
+{
+    // The stream belongs to the caller
+    return 0;
+}
+
+/**
+ * ag_chart_write_svg:
+ * @chart: the chart to render
+ * @stream: the stream to write the SVG document to
+ * @rendering: %TRUE if the SVG is going to be rendered to an image
+ * @theme: (allow-none): the display theme to use
+ * @image_size: the size of the image, or 0 to use the default
+ * @icon_size: the size of the planet and sign symbols, or 0 to use the
+ *             default
+ * @cancellable: (allow-none): a #GCancellable
+ * @err: a #GError
+ *
+ * Like ag_chart_create_svg(), but the SVG document is written to @stream
+ * while it is serialized, without indentation, instead of being collected
+ * into one buffer. @stream is not closed.
+ *
+ * Returns: %TRUE on success
+ */
+gboolean
+ag_chart_write_svg(AgChart        *chart,
+                   GOutputStream  *stream,
+                   gboolean       rendering,
+                   AgDisplayTheme *theme,
+                   guint          image_size,
+                   guint          icon_size,
+                   GCancellable   *cancellable,
+                   GError         **err)
+{
+    xmlDocPtr        svg_doc;
+    xmlSaveCtxtPtr   save_ctxt;
+    AgChartSvgWriter writer = { stream, cancellable, NULL };
+    gboolean         failed;
+
+    if ((svg_doc = ag_chart_transform(
+                chart,
+                rendering,
+                theme,
+                image_size,
+                icon_size,
+                err
+            )) == NULL) {
+        return FALSE;
+    }
+
+    save_ctxt = xmlSaveToIO(
+            ag_chart_svg_writer_write,
+            ag_chart_svg_writer_close,
+            &writer,
+            "UTF-8",
+            0
+        );
+
+    if (save_ctxt == NULL) {
+        xmlFreeDoc(svg_doc);
+        g_set_error(
+                err,
+                AG_CHART_ERROR, AG_CHART_ERROR_LIBXML,
+                "SVG output could not be initialized"
+            );
+
+        return FALSE;
+    }
+
+    failed = (xmlSaveDoc(save_ctxt, svg_doc) < 0);
+    failed = (xmlSaveClose(save_ctxt) < 0) || failed;
+    xmlFreeDoc(svg_doc);
+
+    if (writer.err != NULL) {
+        g_propagate_error(err, writer.err);
+
+        return FALSE;
+    }
+
+    if (failed) {
+        g_set_error(
+                err,
+                AG_CHART_ERROR, AG_CHART_ERROR_LIBXML,
+                "SVG document could not be serialized"
+            );
+
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
 GList *
 ag_chart_get_planets(AgChart *chart)
 {
     AgChartPrivate *priv = ag_chart_get_instance_private(chart);
 
-    return priv->planet_list;
+    return priv->planet_list;
+}
+
+static void
+ag_chart_export_svg(AgChart        *chart,
+                    GFile          *file,
+                    guint          image_size,
+                    AgDisplayTheme *theme,
+                    GError         **err)
+{
+    GFileOutputStream *stream;
+    GCancellable      *cancellable;
+
+    if ((stream = g_file_replace(
+                file,
+                NULL,
+                FALSE,
+                G_FILE_CREATE_NONE,
+                NULL,
+                err
+            )) == NULL) {
+        return;
+    }
+
+    if (ag_chart_write_svg(
+                chart,
+                G_OUTPUT_STREAM(stream),
+                TRUE,
+                theme,
+                image_size, 0,
+                NULL,
+                err
+            )) {
+        g_output_stream_close(G_OUTPUT_STREAM(stream), NULL, err);
+    } else {
+        // Closing with a cancelled cancellable keeps the original file
+        cancellable = g_cancellable_new();
+        g_cancellable_cancel(cancellable);
+        g_output_stream_close(G_OUTPUT_STREAM(stream), cancellable, NULL);
+        g_object_unref(cancellable);
+    }
+
+    g_object_unref(stream);
 }
 
 void
@@ -1907,44 +3475,98 @@ ag_chart_export_svg_to_file(AgChart        *chart,
                             AgDisplayTheme *theme,
                             GError         **err)
 {
-    gchar *svg;
-    gsize length;
-
-    if ((svg = ag_chart_create_svg(
-                 chart,
-                 &length,
-                 TRUE,
-                 theme,
-                 0, 0,
-                 err
-            )) == NULL) {
-        return;
-    }
-
-    g_file_replace_contents(
-            file,
-            (const gchar *)svg,
-            length,
-            NULL,
-            FALSE,
-            G_FILE_CREATE_NONE,
-            NULL,
-            NULL,
-            err
-        );
+    ag_chart_export_svg(chart, file, 0, theme, err);
 }
 
+/**
+ * ag_chart_get_pixbuf:
+ * @chart: the chart to render
+ * @image_size: the size of the generated image, or 0 to use the default
+ *              chart size
+ * @icon_size: the size of the planet icons on the image, or 0 to use the
+ *             default icon size
+ * @theme: (allow-none): the display theme to use
+ * @err: a #GError
+ *
+ * Render @chart directly with cairo. The result looks the same as the SVG
+ * created by ag_chart_create_svg(), but it is drawn without running the
+ * XSLT stylesheet and rasterizing the SVG document.
+ *
+ * Returns: (transfer full): the chart image, or %NULL on error
+ */
 GdkPixbuf *
 ag_chart_get_pixbuf(AgChart        *chart,
                     guint          image_size,
                     guint          icon_size,
                     AgDisplayTheme *theme,
                     GError         **err)
+{
+    AgChartLayout   *layout;
+    gint            size;
+    cairo_surface_t *surface;
+    cairo_t         *cr;
+    cairo_status_t  status;
+    GdkPixbuf       *pixbuf = NULL;
+    gint64          trace   = ag_trace_begin();
+
+    layout  = ag_chart_get_layout(chart);
+    size    = ag_chart_cairo_get_image_size(layout, image_size, icon_size);
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, size, size);
+    cr      = cairo_create(surface);
+
+    ag_chart_cairo_draw(layout, cr, theme, image_size, icon_size);
+    ag_chart_layout_free(layout);
+
+    if ((status = cairo_status(cr)) == CAIRO_STATUS_SUCCESS) {
+        cairo_surface_flush(surface);
+        pixbuf = gdk_pixbuf_get_from_surface(surface, 0, 0, size, size);
+    }
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+
+    if (pixbuf == NULL) {
+        g_set_error(
+                err,
+                AG_CHART_ERROR, AG_CHART_ERROR_RENDERING_ERROR,
+                _("Rendering error: %s"),
+                cairo_status_to_string(status)
+            );
+    }
+
+    ag_trace_end(AG_TRACE_CHART_GET_PIXBUF, trace);
+
+    return pixbuf;
+}
+
+/**
+ * ag_chart_get_pixbuf_from_svg:
+ * @chart: the chart to render
+ * @image_size: the size of the generated image, or 0 to use the default
+ *              chart size
+ * @icon_size: the size of the planet icons on the image, or 0 to use the
+ *             default icon size
+ * @theme: (allow-none): the display theme to use
+ * @err: a #GError
+ *
+ * Render @chart by creating its SVG image with ag_chart_create_svg(), and
+ * rasterizing it with librsvg. This is much slower than
+ * ag_chart_get_pixbuf(); it is kept to compare the two renderers.
+ *
+ * Returns: (transfer full): the chart image, or %NULL on error
+ */
+GdkPixbuf *
+ag_chart_get_pixbuf_from_svg(AgChart        *chart,
+                             guint          image_size,
+                             guint          icon_size,
+                             AgDisplayTheme *theme,
+                             GError         **err)
 {
     gchar      *svg;
     gsize      svg_length;
     RsvgHandle *svg_handle;
     GdkPixbuf  *pixbuf;
+    gint64     start;
 
     if ((svg = ag_chart_create_svg(
                 chart,
@@ -1958,6 +3580,8 @@ ag_chart_get_pixbuf(AgChart        *chart,
         return NULL;
     }
 
+    start = ag_trace_begin();
+
     if ((svg_handle = rsvg_handle_new_from_data(
                 (const guint8 *)svg,
                 svg_length,
@@ -1970,7 +3594,11 @@ ag_chart_get_pixbuf(AgChart        *chart,
 
     g_free(svg);
 
-    if ((pixbuf = rsvg_handle_get_pixbuf(svg_handle)) == NULL) {
+    pixbuf = rsvg_handle_get_pixbuf(svg_handle);
+    g_object_unref(svg_handle);
+    ag_trace_end(AG_TRACE_CHART_RSVG, start);
+
+    if (pixbuf == NULL) {
         g_set_error(
                 err,
                 AG_CHART_ERROR, AG_CHART_ERROR_RENDERING_ERROR,
@@ -1983,9 +3611,393 @@ ag_chart_get_pixbuf(AgChart        *chart,
     return pixbuf;
 }
 
+static void
+ag_chart_append_double(GString *string, gdouble value)
+{
+    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+    g_string_append(string, g_ascii_dtostr(buffer, sizeof(buffer), value));
+    g_string_append_c(string, '|');
+}
+
+/*
+ * ag_chart_get_preview_cache_key:
+ *
+ * Generate the cache key of a preview image. Only data that affects the
+ * image is hashed, so renaming a chart or changing its note keeps the cached
+ * image valid.
+ *
+ * Returns: (transfer full): the cache key as a hex string
+ */
+static gchar *
+ag_chart_get_preview_cache_key(AgDbChartSave   *save_data,
+                               gboolean        preview,
+                               GsweHouseSystem house_system,
+                               AgDisplayTheme  *theme,
+                               guint           image_size,
+                               guint           icon_size)
+{
+    GString *key_data = g_string_new(AG_CHART_RENDERER_VERSION);
+    gchar   *css      = ag_display_theme_to_css(theme),
+            *key;
+
+    g_string_append_printf(
+            key_data,
+            "|%d-%d-%d %d:%d:%d|",
+            save_data->year, save_data->month, save_data->day,
+            save_data->hour, save_data->minute, save_data->second
+        );
+    ag_chart_append_double(key_data, save_data->timezone);
+    ag_chart_append_double(key_data, save_data->longitude);
+    ag_chart_append_double(key_data, save_data->latitude);
+    ag_chart_append_double(key_data, save_data->altitude);
+    g_string_append_printf(
+            key_data,
+            "%s|%d|%u|%u|%s",
+            ag_house_system_id_to_nick(house_system),
+            (preview) ? 1 : 0,
+            image_size,
+            icon_size,
+            css
+        );
+    g_free(css);
+
+    key = g_compute_checksum_for_data(
+            G_CHECKSUM_SHA1,
+            (const guchar *)key_data->str,
+            key_data->len
+        );
+    g_string_free(key_data, TRUE);
+
+    return key;
+}
+
+static gint
+ag_chart_compare_preview_age(GFileInfo *a, GFileInfo *b)
+{
+    guint64 a_time,
+            b_time;
+
+    a_time = g_file_info_get_attribute_uint64(
+            a,
+            G_FILE_ATTRIBUTE_TIME_MODIFIED
+        );
+    b_time = g_file_info_get_attribute_uint64(
+            b,
+            G_FILE_ATTRIBUTE_TIME_MODIFIED
+        );
+
+    return (a_time < b_time) ? -1 : (a_time > b_time);
+}
+
+static void
+ag_chart_delete_preview(GFile *cache_dir, GFileInfo *info)
+{
+    GFile *file = g_file_get_child(cache_dir, g_file_info_get_name(info));
+
+    g_file_delete(file, NULL, NULL);
+    g_object_unref(file);
+}
+
+/*
+ * ag_chart_prune_preview_cache:
+ * @cache_dir: the preview cache directory
+ *
+ * Remove the previews not used for AG_CHART_PREVIEW_CACHE_MAX_AGE days, then
+ * the least recently used ones above AG_CHART_PREVIEW_CACHE_SIZE. A preview
+ * is touched every time it is loaded, so its modification time tells when it
+ * was last used.
+ */
+static void
+ag_chart_prune_preview_cache(GFile *cache_dir)
+{
+    GFileEnumerator *enumerator;
+    GFileInfo       *info;
+    GList           *previews  = NULL,
+                    *l;
+    guint           n_previews = 0;
+    guint64         oldest_time;
+
+    if ((enumerator = g_file_enumerate_children(
+                cache_dir,
+                G_FILE_ATTRIBUTE_STANDARD_NAME ","
+                G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                NULL,
+                NULL
+            )) == NULL) {
+        return;
+    }
+
+    oldest_time = g_get_real_time() / G_USEC_PER_SEC
+        - AG_CHART_PREVIEW_CACHE_MAX_AGE * 24 * 60 * 60;
+
+    while ((info = g_file_enumerator_next_file(
+                enumerator,
+                NULL,
+                NULL
+            )) != NULL) {
+        if (!g_str_has_suffix(g_file_info_get_name(info), ".png")) {
+            g_object_unref(info);
+
+            continue;
+        }
+
+        if (g_file_info_get_attribute_uint64(
+                    info,
+                    G_FILE_ATTRIBUTE_TIME_MODIFIED
+                ) < oldest_time) {
+            ag_chart_delete_preview(cache_dir, info);
+            g_object_unref(info);
+
+            continue;
+        }
+
+        previews = g_list_prepend(previews, info);
+        n_previews++;
+    }
+
+    g_object_unref(enumerator);
+
+    previews = g_list_sort(
+            previews,
+            (GCompareFunc)ag_chart_compare_preview_age
+        );
+
+    // The oldest previews come first
+    for (l = previews; l; l = g_list_next(l)) {
+        if (n_previews <= AG_CHART_PREVIEW_CACHE_SIZE) {
+            break;
+        }
+
+        ag_chart_delete_preview(cache_dir, l->data);
+        n_previews--;
+    }
+
+    g_list_free_full(previews, g_object_unref);
+}
+
+/*
+ * ag_chart_get_preview_cache_dir:
+ *
+ * Get the preview cache directory. The first call creates the directory,
+ * and prunes the previews that are not used anymore.
+ *
+ * Returns: (transfer full): the preview cache directory
+ */
+static GFile *
+ag_chart_get_preview_cache_dir(void)
+{
+    static gsize initialized = 0;
+    static gchar *cache_path = NULL;
+
+    if (g_once_init_enter(&initialized)) {
+        GFile *data_dir  = ag_get_user_data_dir(),
+              *cache_dir = g_file_get_child(data_dir, "previews");
+
+        g_object_unref(data_dir);
+        cache_path = g_file_get_path(cache_dir);
+
+        if (g_mkdir_with_parents(cache_path, 0700) != 0) {
+            g_warning(
+                    "Preview cache directory ‘%s’ cannot be created.",
+                    cache_path
+                );
+        } else {
+            ag_chart_prune_preview_cache(cache_dir);
+        }
+
+        g_object_unref(cache_dir);
+        g_once_init_leave(&initialized, 1);
+    }
+
+    return g_file_new_for_path(cache_path);
+}
+
+/**
+ * ag_chart_get_preview_pixbuf:
+ * @save_data: the chart data to render
+ * @house_system: the house system to use
+ * @image_size: the size of the generated image
+ * @icon_size: the size of the planet icons on the image
+ * @theme: the display theme to use
+ * @err: a #GError
+ *
+ * Get the preview image of a saved chart. Images are cached in the user's
+ * data directory, so the chart is only calculated and rendered if there is
+ * no cached image for the same moment, location, house system, theme and
+ * image size. Previews not used for a long time are removed from the cache
+ * the first time it is used in a run.
+ *
+ * This function doesn’t use any application-wide objects, so it is safe to
+ * call it from worker threads.
+ *
+ * Returns: (transfer full): the preview image, or %NULL on error
+ */
+GdkPixbuf *
+ag_chart_get_preview_pixbuf(AgDbChartSave   *save_data,
+                            GsweHouseSystem house_system,
+                            guint           image_size,
+                            guint           icon_size,
+                            AgDisplayTheme  *theme,
+                            GError          **err)
+{
+    gchar           *key,
+                    *file_name,
+                    *path,
+                    *png_data = NULL;
+    gsize           png_length;
+    GFile           *cache_dir,
+                    *cache_file;
+    GdkPixbuf       *pixbuf;
+    AgChart         *chart;
+    GError          *local_err = NULL;
+    gint64          trace      = ag_trace_begin();
+
+    if (save_data == NULL) {
+        g_set_error(
+                err,
+                AG_CHART_ERROR, AG_CHART_ERROR_EMPTY_RECORD,
+                "Invalid chart"
+            );
+
+        return NULL;
+    }
+
+    key = ag_chart_get_preview_cache_key(
+            save_data,
+            TRUE,
+            house_system,
+            theme,
+            image_size,
+            icon_size
+        );
+    file_name = g_strdup_printf("%s.png", key);
+    g_free(key);
+
+    cache_dir  = ag_chart_get_preview_cache_dir();
+    cache_file = g_file_get_child(cache_dir, file_name);
+    path       = g_file_get_path(cache_file);
+    g_object_unref(cache_dir);
+    g_object_unref(cache_file);
+    g_free(file_name);
+
+    if ((pixbuf = gdk_pixbuf_new_from_file(path, NULL)) != NULL) {
+        // Mark the preview as recently used, so pruning keeps it
+        g_utime(path, NULL);
+        g_free(path);
+        ag_trace_end(AG_TRACE_CHART_PREVIEW, trace);
+
+        return pixbuf;
+    }
+
+    if ((chart = ag_chart_new_from_db_save_with_house_system(
+                save_data,
+                TRUE,
+                house_system,
+                err
+            )) == NULL) {
+        g_free(path);
+
+        return NULL;
+    }
+
+    pixbuf = ag_chart_get_pixbuf(chart, image_size, icon_size, theme, err);
+    g_object_unref(chart);
+
+    if (pixbuf == NULL) {
+        g_free(path);
+
+        return NULL;
+    }
+
+    // Failing to write the cache is not fatal; we will simply render the
+    // preview again next time
+    if (
+                !gdk_pixbuf_save_to_buffer(
+                        pixbuf,
+                        &png_data, &png_length,
+                        "png",
+                        &local_err,
+                        NULL
+                    )
+                || !g_file_set_contents(path, png_data, png_length, &local_err)
+            ) {
+        g_warning(
+                "Unable to save preview to ‘%s’: %s",
+                path,
+                local_err->message
+            );
+        g_clear_error(&local_err);
+    }
+
+    g_free(png_data);
+    g_free(path);
+    ag_trace_end(AG_TRACE_CHART_PREVIEW, trace);
+
+    return pixbuf;
+}
+
+/**
+ * ag_chart_export_save_to_file:
+ * @save_data: the chart data to export
+ * @house_system: the house system to use
+ * @file: the file to write
+ * @format: the format of the exported image
+ * @image_size: the size of the image, or 0 to use the default
+ * @theme: (allow-none): the display theme to use
+ * @err: a #GError
+ *
+ * Calculate a saved chart, and export it with ag_chart_export_to_file().
+ * Like ag_chart_get_preview_pixbuf(), this is safe to call from worker
+ * threads.
+ *
+ * Returns: %TRUE if the chart was exported
+ */
+gboolean
+ag_chart_export_save_to_file(AgDbChartSave       *save_data,
+                             GsweHouseSystem     house_system,
+                             GFile               *file,
+                             AgChartExportFormat format,
+                             guint               image_size,
+                             AgDisplayTheme      *theme,
+                             GError              **err)
+{
+    AgChart *chart;
+    GError  *local_err = NULL;
+
+    if ((chart = ag_chart_new_from_db_save_with_house_system(
+                save_data,
+                FALSE,
+                house_system,
+                err
+            )) == NULL) {
+        return FALSE;
+    }
+
+    ag_chart_export_to_file(
+            chart,
+            file,
+            format,
+            image_size,
+            theme,
+            &local_err
+        );
+    g_object_unref(chart);
+
+    if (local_err != NULL) {
+        g_propagate_error(err, local_err);
+
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
 static void
 ag_chart_export_to_image(AgChart        *chart,
                          GFile          *file,
+                         guint          image_size,
                          AgDisplayTheme *theme,
                          gchar          *format,
                          GError         **err)
@@ -1994,7 +4006,7 @@ ag_chart_export_to_image(AgChart        *chart,
     gsize      jpg_length;
     GdkPixbuf  *pixbuf;
 
-    pixbuf = ag_chart_get_pixbuf(chart, 0, 0, theme, err);
+    pixbuf = ag_chart_get_pixbuf(chart, image_size, 0, theme, err);
 
     if (pixbuf == NULL) {
         return;
@@ -2036,7 +4048,7 @@ ag_chart_export_jpg_to_file(AgChart        *chart,
                             AgDisplayTheme *theme,
                             GError         **err)
 {
-    ag_chart_export_to_image(chart, file, theme, "jpeg", err);
+    ag_chart_export_to_image(chart, file, 0, theme, "jpeg", err);
 }
 
 void
@@ -2045,7 +4057,68 @@ ag_chart_export_png_to_file(AgChart        *chart,
                             AgDisplayTheme *theme,
                             GError         **err)
 {
-    ag_chart_export_to_image(chart, file, theme, "png", err);
+    ag_chart_export_to_image(chart, file, 0, theme, "png", err);
+}
+
+/**
+ * ag_chart_export_to_file:
+ * @chart: the chart to export
+ * @file: the file to write
+ * @format: the format of the exported image
+ * @image_size: the size of the image, or 0 to use the default
+ * @theme: (allow-none): the display theme to use
+ * @err: a #GError
+ *
+ * Export @chart as an image. If @image_size is given, the planet and sign
+ * symbols are scaled with the image.
+ */
+void
+ag_chart_export_to_file(AgChart             *chart,
+                        GFile               *file,
+                        AgChartExportFormat format,
+                        guint               image_size,
+                        AgDisplayTheme      *theme,
+                        GError              **err)
+{
+    switch (format) {
+        case AG_CHART_EXPORT_FORMAT_SVG:
+            ag_chart_export_svg(chart, file, image_size, theme, err);
+
+            break;
+
+        case AG_CHART_EXPORT_FORMAT_JPG:
+            ag_chart_export_to_image(
+                    chart,
+                    file,
+                    image_size,
+                    theme,
+                    "jpeg",
+                    err
+                );
+
+            break;
+
+        case AG_CHART_EXPORT_FORMAT_PNG:
+            ag_chart_export_to_image(
+                    chart,
+                    file,
+                    image_size,
+                    theme,
+                    "png",
+                    err
+                );
+
+            break;
+
+        default:
+            g_set_error(
+                    err,
+                    AG_CHART_ERROR, AG_CHART_ERROR_NOT_IMPLEMENTED,
+                    "Unknown export format"
+                );
+
+            break;
+    }
 }
 
 void
@@ -2074,6 +4147,9 @@ ag_chart_get_db_save(AgChart *chart)
     AgDbChartSave   *save_data = ag_db_chart_save_new(TRUE);
     GsweTimestamp   *timestamp = gswe_moment_get_timestamp(GSWE_MOMENT(chart));
 
+    // Converting the timestamp may need the ephemeris
+    g_rec_mutex_lock(&ephemeris_lock);
+
     save_data->db_id = priv->db_id;
 
     save_data->name         = g_strdup(priv->name);
@@ -2108,9 +4184,121 @@ ag_chart_get_db_save(AgChart *chart)
     save_data->timezone     = gswe_timestamp_get_gregorian_timezone(timestamp);
     save_data->note         = g_strdup(priv->note);
 
+    g_rec_mutex_unlock(&ephemeris_lock);
+
     return save_data;
 }
 
+/**
+ * ag_chart_update_from_db_save:
+ * @chart: the #AgChart to update
+ * @save_data: the new chart data
+ * @house_system: the house system to use
+ * @set_details: if %TRUE, the name, country, city and note are also set
+ *
+ * Change only the parts of @chart that differ from @save_data. Changing the
+ * name, country, city or note doesn’t recalculate anything, and the next
+ * ag_chart_get_layout() reuses the planets and their aspects if only the
+ * house system changed. The planets are calculated topocentrically, so a
+ * change of the location recalculates them, just like a change of the time.
+ *
+ * Returns: the parts of the chart that changed
+ */
+AgChartChange
+ag_chart_update_from_db_save(AgChart         *chart,
+                             AgDbChartSave   *save_data,
+                             GsweHouseSystem house_system,
+                             gboolean        set_details)
+{
+    GsweCoordinates *coords;
+    AgChartTimeKey  key;
+    AgChartPrivate  *priv   = ag_chart_get_instance_private(chart);
+    AgChartChange   changes = AG_CHART_CHANGE_NONE;
+
+    if (set_details) {
+        if (g_strcmp0(priv->name, save_data->name) != 0) {
+            ag_chart_set_name(chart, save_data->name);
+            changes |= AG_CHART_CHANGE_DETAILS;
+        }
+
+        if (g_strcmp0(priv->country, save_data->country) != 0) {
+            ag_chart_set_country(chart, save_data->country);
+            changes |= AG_CHART_CHANGE_DETAILS;
+        }
+
+        if (g_strcmp0(priv->city, save_data->city) != 0) {
+            ag_chart_set_city(chart, save_data->city);
+            changes |= AG_CHART_CHANGE_DETAILS;
+        }
+
+        if (g_strcmp0(priv->note, save_data->note) != 0) {
+            ag_chart_set_note(chart, save_data->note);
+            changes |= AG_CHART_CHANGE_DETAILS;
+        }
+    }
+
+    // Converting the timestamp may need the ephemeris, and the setters
+    // below invalidate the swe-glib data a preview or export worker may be
+    // reading
+    g_rec_mutex_lock(&ephemeris_lock);
+    ag_chart_get_time_key(chart, &key);
+
+    coords = gswe_moment_get_coordinates(GSWE_MOMENT(chart));
+
+    if (gswe_moment_get_house_system(GSWE_MOMENT(chart)) != house_system) {
+        changes |= AG_CHART_CHANGE_HOUSE_SYSTEM;
+    }
+
+    if (
+                (coords->longitude != save_data->longitude)
+                || (coords->latitude != save_data->latitude)
+                || (coords->altitude != save_data->altitude)
+            ) {
+        changes |= AG_CHART_CHANGE_LOCATION;
+    }
+
+    g_free(coords);
+
+    if (
+                (key.year != save_data->year)
+                || (key.month != save_data->month)
+                || (key.day != save_data->day)
+                || (key.hour != save_data->hour)
+                || (key.minute != save_data->minute)
+                || (key.second != save_data->second)
+                || (key.timezone != save_data->timezone)
+            ) {
+        changes |= AG_CHART_CHANGE_TIME;
+    }
+
+    if (changes & AG_CHART_CHANGE_HOUSE_SYSTEM) {
+        gswe_moment_set_house_system(GSWE_MOMENT(chart), house_system);
+    }
+
+    if (changes & AG_CHART_CHANGE_LOCATION) {
+        gswe_moment_set_coordinates(
+                GSWE_MOMENT(chart),
+                save_data->longitude,
+                save_data->latitude,
+                save_data->altitude
+            );
+    }
+
+    if (changes & AG_CHART_CHANGE_TIME) {
+        gswe_timestamp_set_gregorian_full(
+                gswe_moment_get_timestamp(GSWE_MOMENT(chart)),
+                save_data->year, save_data->month, save_data->day,
+                save_data->hour, save_data->minute, save_data->second, 0,
+                save_data->timezone,
+                NULL
+            );
+    }
+
+    g_rec_mutex_unlock(&ephemeris_lock);
+
+    return changes;
+}
+
 void
 ag_chart_set_db_id(AgChart *chart, gint id)
 {
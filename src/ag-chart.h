@@ -43,6 +43,20 @@ typedef enum {
     AG_CHART_ERROR_RENDERING_ERROR,
 } AgChartError;
 
+typedef enum {
+    AG_CHART_EXPORT_FORMAT_SVG,
+    AG_CHART_EXPORT_FORMAT_JPG,
+    AG_CHART_EXPORT_FORMAT_PNG
+} AgChartExportFormat;
+
+typedef enum {
+    AG_CHART_CHANGE_NONE         = 0,
+    AG_CHART_CHANGE_DETAILS      = 1 << 0,
+    AG_CHART_CHANGE_HOUSE_SYSTEM = 1 << 1,
+    AG_CHART_CHANGE_LOCATION     = 1 << 2,
+    AG_CHART_CHANGE_TIME         = 1 << 3
+} AgChartChange;
+
 #define AG_TYPE_CHART         (ag_chart_get_type())
 #define AG_CHART(o)           (G_TYPE_CHECK_INSTANCE_CAST((o), \
                                                           AG_TYPE_CHART, \
@@ -67,6 +81,47 @@ struct _AgChartClass {
     GsweMomentClass parent_class;
 };
 
+typedef struct _AgChartLayoutBody {
+    GswePlanet planet;
+    gdouble    position;
+    gboolean   retrograde;
+    guint      dist;
+} AgChartLayoutBody;
+
+typedef struct _AgChartLayoutAspect {
+    GswePlanet planet1;
+    GswePlanet planet2;
+    gdouble    position1;
+    gdouble    position2;
+    GsweAspect aspect;
+} AgChartLayoutAspect;
+
+typedef struct _AgChartLayoutAntiscion {
+    GswePlanet        planet1;
+    GswePlanet        planet2;
+    gdouble           position1;
+    gdouble           position2;
+    GsweAntiscionAxis axis;
+} AgChartLayoutAntiscion;
+
+typedef struct _AgChartLayout {
+    gdouble                ascendant;
+    gdouble                mc;
+    gdouble                vertex;
+    guint                  vertex_dist;
+    guint                  n_houses;
+    gdouble                houses[12];
+    guint                  n_bodies;
+    AgChartLayoutBody      *bodies;
+    guint                  max_dist;
+    guint                  n_aspects;
+    AgChartLayoutAspect    *aspects;
+    guint                  n_antiscia;
+    AgChartLayoutAntiscion *antiscia;
+    GsweMoonPhase          moon_phase;
+    gdouble                moon_illumination;
+} AgChartLayout;
+
 typedef void (*AgChartSaveImageFunc)(AgChart *,
                                      GFile *,
                                      AgDisplayTheme *,
@@ -89,6 +144,11 @@ AgChart *ag_chart_new_preview(GsweTimestamp   *timestamp,
 AgChart *ag_chart_load_from_agc(GFile  *file,
                                 GError **err);
 
+AgChart *ag_chart_load_from_agc_data(const gchar *xml,
+                                     gsize       length,
+                                     const gchar *uri,
+                                     GError      **err);
+
 AgChart *ag_chart_load_from_placidus_file(GFile  *file,
                                           GError **err);
 
@@ -96,6 +156,12 @@ AgChart *ag_chart_new_from_db_save(AgDbChartSave *save_data,
                                    gboolean      preview,
                                    GError        **err);
 
+AgChart *ag_chart_new_from_db_save_with_house_system(
+        AgDbChartSave   *save_data,
+        gboolean        preview,
+        GsweHouseSystem house_system,
+        GError          **err);
+
 void ag_chart_save_to_file(AgChart *chart,
                            GFile   *file,
                            GError  **err);
@@ -115,6 +181,13 @@ void ag_chart_export_png_to_file(AgChart        *chart,
                                  AgDisplayTheme *theme,
                                  GError         **err);
 
+void ag_chart_export_to_file(AgChart             *chart,
+                             GFile               *file,
+                             AgChartExportFormat format,
+                             guint               image_size,
+                             AgDisplayTheme      *theme,
+                             GError              **err);
+
 void ag_chart_set_name(AgChart     *chart,
                        const gchar *name);
 
@@ -138,24 +211,79 @@ gchar *ag_chart_create_svg(AgChart        *chart,
                            guint          icon_size,
                            GError         **err);
 
+gboolean ag_chart_write_svg(AgChart        *chart,
+                            GOutputStream  *stream,
+                            gboolean       rendering,
+                            AgDisplayTheme *theme,
+                            guint          image_size,
+                            guint          icon_size,
+                            GCancellable   *cancellable,
+                            GError         **err);
+
 GList *ag_chart_get_planets(AgChart *chart);
 
+AgChartLayout *ag_chart_get_layout(AgChart *chart);
+
+void ag_chart_layout_free(AgChartLayout *layout);
+
+gboolean ag_chart_layout_get_position(const AgChartLayout *layout,
+                                      GswePlanet          planet,
+                                      gdouble             *position);
+
 void ag_chart_set_note(AgChart *chart, const gchar *note);
 
 const gchar *ag_chart_get_note(AgChart *chart);
 
 AgDbChartSave *ag_chart_get_db_save(AgChart *chart);
 
+AgChartChange ag_chart_update_from_db_save(AgChart         *chart,
+                                           AgDbChartSave   *save_data,
+                                           GsweHouseSystem house_system,
+                                           gboolean        set_details);
+
 GdkPixbuf *ag_chart_get_pixbuf(AgChart        *chart,
                                guint          image_size,
                                guint          icon_size,
                                AgDisplayTheme *theme,
                                GError         **err);
 
+GdkPixbuf *ag_chart_get_pixbuf_from_svg(AgChart        *chart,
+                                        guint          image_size,
+                                        guint          icon_size,
+                                        AgDisplayTheme *theme,
+                                        GError         **err);
+
+GdkPixbuf *ag_chart_get_preview_pixbuf(AgDbChartSave   *save_data,
+                                       GsweHouseSystem house_system,
+                                       guint           image_size,
+                                       guint           icon_size,
+                                       AgDisplayTheme  *theme,
+                                       GError          **err);
+
+gboolean ag_chart_export_save_to_file(AgDbChartSave       *save_data,
+                                      GsweHouseSystem     house_system,
+                                      GFile               *file,
+                                      AgChartExportFormat format,
+                                      guint               image_size,
+                                      AgDisplayTheme      *theme,
+                                      GError              **err);
+
 void ag_chart_set_db_id(AgChart *chart, gint db_id);
 
 gint ag_chart_get_db_id(AgChart *chart);
 
+void ag_chart_invalidate_stylesheet_cache(void);
+
+void ag_chart_set_flat_stylesheet(gboolean flat);
+
+void ag_chart_set_prune_hidden(gboolean prune);
+
+void ag_chart_get_stylesheet_cache_stats(guint *hits, guint *misses);
+
+void ag_chart_clear_ephemeris_cache(void);
+
+void ag_chart_get_ephemeris_cache_stats(guint *hits, guint *misses);
+
 #define AG_CHART_ERROR (ag_chart_error_quark())
 GQuark ag_chart_error_quark(void);
 
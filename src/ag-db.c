@@ -26,6 +26,7 @@
 #include "config.h"
 #include "ag-app.h"
 #include "ag-db.h"
+#include "ag-trace.h"
 
 #define SCHEMA_VERSION 1
 
@@ -34,8 +35,40 @@ static AgDb *singleton = NULL;
 typedef struct _AgDbPrivate {
     gchar         *dsn;
     GdaConnection *conn;
+    GHashTable    *statements;
+    guint         statement_hits;
+    guint         statement_misses;
+    gint64        statement_parse_time;
+    gboolean      in_transaction;
+    GArray        *pending_changes;
 } AgDbPrivate;
 
+typedef struct {
+    guint signal;
+    gint  db_id;
+} AgDbChange;
+
+enum {
+    SIGNAL_CHART_INSERTED,
+    SIGNAL_CHART_UPDATED,
+    SIGNAL_CHART_DELETED,
+    SIGNAL_COUNT
+};
+
+typedef struct {
+    GdaStatement *statement;
+    GdaSet       *params;
+} AgDbStatement;
+
+struct _AgDbChartList {
+    AgDb             *db;
+    GdaDataModel     *result;
+    GdaDataModelIter *iter;
+    gboolean         finished;
+};
+
+static guint signals[SIGNAL_COUNT];
+
 G_DEFINE_QUARK(ag_db_error_quark, ag_db_error);
 
 G_DEFINE_TYPE_WITH_PRIVATE(AgDb, ag_db, G_TYPE_OBJECT);
@@ -90,27 +123,50 @@ static TableColumnDef chart_table_column[] = {
     { COLUMN_CHART_NOTE,         "note" },
 };
 
+static void
+ag_db_statement_free(AgDbStatement *statement)
+{
+    g_object_unref(statement->statement);
+    g_clear_object(&(statement->params));
+    g_free(statement);
+}
+
 /**
- * ag_db_non_select:
- * @db: the AgDb to operate on
- * @sql: the SQL query to execute
+ * ag_db_get_statement:
+ * @db: the #AgDb object to operate on
+ * @sql: the SQL query
  *
- * Executes a non-SELECT query on @db. No result is returned right now (TODO)
+ * Get the prepared statement for @sql. The query is parsed only the first
+ * time it is requested; later calls return the same statement and parameter
+ * set, so callers must set every parameter before execution.
+ *
+ * Returns: (transfer none): the prepared statement
  */
-static void
-ag_db_non_select(AgDb *db, const gchar *sql)
+static AgDbStatement *
+ag_db_get_statement(AgDb *db, const gchar *sql)
 {
-    GdaStatement *sth;
-    gint         nrows;
-    const gchar  *remain;
-    GdaSqlParser *parser;
-    AgDbPrivate  *priv = ag_db_get_instance_private(db);
-    GError       *err = NULL;
+    AgDbStatement *statement;
+    const gchar   *remain;
+    GdaSqlParser  *parser;
+    gint64        parse_start;
+    AgDbPrivate   *priv = ag_db_get_instance_private(db);
+    GError        *err  = NULL;
+
+    if ((statement = g_hash_table_lookup(priv->statements, sql)) != NULL) {
+        priv->statement_hits++;
+
+        return statement;
+    }
+
+    priv->statement_misses++;
+    parse_start = g_get_monotonic_time();
 
     parser = g_object_get_data(G_OBJECT(priv->conn), "parser");
     g_assert(GDA_IS_SQL_PARSER(parser));
 
-    if ((sth = gda_sql_parser_parse_string(
+    statement = g_new0(AgDbStatement, 1);
+
+    if ((statement->statement = gda_sql_parser_parse_string(
                 parser,
                 sql,
                 &remain,
@@ -124,86 +180,147 @@ ag_db_non_select(AgDb *db, const gchar *sql)
             );
     }
 
-    if ((nrows = gda_connection_statement_execute_non_select(
-                 priv->conn,
-                 sth,
-                 NULL,
-                 NULL,
-                 &err
-             )) == -1) {
+    if (!gda_statement_get_parameters(
+                statement->statement,
+                &(statement->params),
+                &err
+            )) {
         g_error(
-                "SQL error: %s",
+                "Params error: %s",
                 (err && err->message)
                     ? err->message
-                    : "no details"
+                    : "no reason"
             );
     }
 
-    g_object_unref(sth);
+    priv->statement_parse_time += g_get_monotonic_time() - parse_start;
+
+    g_hash_table_insert(priv->statements, g_strdup(sql), statement);
+
+    return statement;
 }
 
 /**
- * ag_db_table_exists:
+ * ag_db_get_statement_cache_stats:
  * @db: the #AgDb object to operate on
- * @table: the nawe of the table to check for
- *
- * Checks if the specified table exists. It is done by querying the
- * sqlite_master system table.
+ * @hits: (out) (allow-none): the number of queries served from the cache
+ * @misses: (out) (allow-none): the number of queries that had to be parsed
+ * @parse_time: (out) (allow-none): the total time spent on parsing queries,
+ *              in microseconds
  *
- * Returns: TRUE if the table exists, FALSE otherwise
+ * Get the statistics of the prepared statement cache.
  */
-static gboolean
-ag_db_table_exists(AgDb *db, const gchar *table)
+void
+ag_db_get_statement_cache_stats(AgDb   *db,
+                                guint  *hits,
+                                guint  *misses,
+                                gint64 *parse_time)
 {
-    GdaSqlParser *parser;
-    GdaStatement *sth;
-    GdaDataModel *result;
-    GdaSet       *params;
-    GdaHolder    *holder;
-    const gchar  *remain;
-    gboolean     ret;
-    GValue       table_value = G_VALUE_INIT;
-    AgDbPrivate  *priv       = ag_db_get_instance_private(db);
-    GError       *err        = NULL;
+    AgDbPrivate *priv = ag_db_get_instance_private(db);
 
-    parser = g_object_get_data(G_OBJECT(priv->conn), "parser");
+    if (hits != NULL) {
+        *hits = priv->statement_hits;
+    }
 
-    if ((sth = gda_sql_parser_parse_string(
-                parser,
-                "SELECT type \n"       \
-                "    FROM sqlite_master \n"   \
-                "    WHERE type = 'table' \n" \
-                "    AND name = ##name::string",
-                &remain,
-                &err
-            )) == NULL) {
+    if (misses != NULL) {
+        *misses = priv->statement_misses;
+    }
+
+    if (parse_time != NULL) {
+        *parse_time = priv->statement_parse_time;
+    }
+}
+
+static void
+ag_db_statement_set_value(AgDbStatement *statement,
+                          const gchar   *key,
+                          const GValue  *value)
+{
+    GdaHolder *holder;
+    GError    *err = NULL;
+
+    if ((holder = gda_set_get_holder(statement->params, key)) == NULL) {
+        g_error("Error: holder %s is not defined in query.", key);
+    }
+
+    if (!gda_holder_set_value(holder, value, &err)) {
         g_error(
-                "SQL error: %s",
+                "SQL GdaHolder error: %s",
                 (err && err->message)
                     ? err->message
                     : "no reason"
             );
     }
+}
+
+/**
+ * ag_db_non_select:
+ * @db: the AgDb to operate on
+ * @sql: the SQL query to execute
+ *
+ * Executes a non-SELECT query on @db. No result is returned right now (TODO)
+ */
+static void
+ag_db_non_select(AgDb *db, const gchar *sql)
+{
+    AgDbStatement *statement = ag_db_get_statement(db, sql);
+    gint          nrows;
+    AgDbPrivate   *priv      = ag_db_get_instance_private(db);
+    GError        *err       = NULL;
 
-    if (gda_statement_get_parameters(sth, &params, &err) == FALSE) {
+    if ((nrows = gda_connection_statement_execute_non_select(
+                 priv->conn,
+                 statement->statement,
+                 statement->params,
+                 NULL,
+                 &err
+             )) == -1) {
         g_error(
-                "Params error: %s",
+                "SQL error: %s",
                 (err && err->message)
                     ? err->message
-                    : "no reason"
+                    : "no details"
             );
     }
+}
+
+/**
+ * ag_db_table_exists:
+ * @db: the #AgDb object to operate on
+ * @table: the nawe of the table to check for
+ *
+ * Checks if the specified table exists. It is done by querying the
+ * sqlite_master system table.
+ *
+ * Returns: TRUE if the table exists, FALSE otherwise
+ */
+static gboolean
+ag_db_table_exists(AgDb *db, const gchar *table)
+{
+    AgDbStatement *statement;
+    GdaDataModel  *result;
+    gboolean      ret;
+    GValue        table_value = G_VALUE_INIT;
+    AgDbPrivate   *priv       = ag_db_get_instance_private(db);
+    GError        *err        = NULL;
+
+    statement = ag_db_get_statement(
+            db,
+            "SELECT type \n"       \
+            "    FROM sqlite_master \n"   \
+            "    WHERE type = 'table' \n" \
+            "    AND name = ##name::string"
+        );
 
-    holder = gda_set_get_holder(params, "name");
     g_value_init(&table_value, G_TYPE_STRING);
     g_value_set_string(&table_value, table);
-    gda_holder_set_value(holder, &table_value, &err);
+    ag_db_statement_set_value(statement, "name", &table_value);
     g_value_unset(&table_value);
 
     result = gda_connection_statement_execute_select(
             priv->conn,
-            sth,
-            params,
+            statement->statement,
+            statement->params,
             &err
         );
 
@@ -214,62 +331,34 @@ ag_db_table_exists(AgDb *db, const gchar *table)
     }
 
     g_object_unref(result);
-    g_object_unref(sth);
 
     return ret;
 }
 
 /**
- * ag_db_select:
+ * ag_db_select_valist:
  * @db: the database object to work on
  * @err: a #GError or NULL
+ * @model_usage: how the returned data model will be accessed
  * @sql: the query to execute
- * @...: a NULL terminated list of key-value pairs of the query parameters
+ * @ap: a NULL terminated list of key-value pairs of the query parameters
  *
  * Returns: (transfer full): the #GdaDataModel as the result of the query
  */
 static GdaDataModel *
-ag_db_select(AgDb *db, GError **err, const gchar *sql, ...)
+ag_db_select_valist(AgDb                    *db,
+                    GError                  **err,
+                    GdaStatementModelUsage  model_usage,
+                    const gchar             *sql,
+                    va_list                 ap)
 {
-    GdaSqlParser *parser;
-    const gchar  *remain;
-    GdaSet       *params;
-    GdaStatement *sth;
-    GdaDataModel *ret;
-    gchar        *error     = NULL;
-    GError       *local_err = NULL;
-    AgDbPrivate  *priv      = ag_db_get_instance_private(db);
-
-    parser = g_object_get_data(G_OBJECT(priv->conn), "parser");
-
-    if ((sth = gda_sql_parser_parse_string(
-                parser,
-                sql,
-                &remain,
-                &local_err
-            )) == NULL) {
-        g_error(
-                "SQL error: %s",
-                (local_err && local_err->message)
-                    ? local_err->message
-                    : "no reason"
-            );
-    }
-
-    if (!gda_statement_get_parameters(sth, &params, &local_err)) {
-        g_error(
-                "SQL error: %s",
-                (local_err && local_err->message)
-                    ? local_err->message
-                    : "no reason"
-            );
-    }
-
-    if (params) {
-        va_list ap;
-
-        va_start(ap, sql);
+    AgDbStatement *statement = ag_db_get_statement(db, sql);
+    gchar         *error     = NULL;
+    AgDbPrivate   *priv      = ag_db_get_instance_private(db);
+    GdaDataModel  *result;
+    gint64        trace      = ag_trace_begin();
 
+    if (statement->params) {
         while (TRUE) {
             gchar     *key;
             GdaHolder *holder;
@@ -281,7 +370,7 @@ ag_db_select(AgDb *db, GError **err, const gchar *sql, ...)
             }
 
             if ((holder = gda_set_get_holder(
-                        params,
+                        statement->params,
                         (const gchar *)key
                     )) == NULL) {
                 g_error("Error: holder %s is not defined in query.", key);
@@ -295,21 +384,80 @@ ag_db_select(AgDb *db, GError **err, const gchar *sql, ...)
                 g_error("SQL GValue error: %s", error);
             }
 
-            if (!gda_holder_set_value(holder, (const GValue *)&value, err)) {
-                g_error(
-                        "SQL GdaHolder error: %s",
-                        (*err && (*err)->message)
-                            ? (*err)->message
-                            : "no reason"
-                    );
-            }
+            ag_db_statement_set_value(statement, key, &value);
+            g_value_unset(&value);
         }
-
-        va_end(ap);
     }
 
-    ret = gda_connection_statement_execute_select(priv->conn, sth, params, err);
-    g_object_unref(sth);
+    result = gda_connection_statement_execute_select_full(
+            priv->conn,
+            statement->statement,
+            statement->params,
+            model_usage,
+            NULL,
+            err
+        );
+    ag_trace_end(AG_TRACE_DB_SELECT, trace);
+
+    return result;
+}
+
+/**
+ * ag_db_select:
+ * @db: the database object to work on
+ * @err: a #GError or NULL
+ * @sql: the query to execute
+ * @...: a NULL terminated list of key-value pairs of the query parameters
+ *
+ * Returns: (transfer full): the #GdaDataModel as the result of the query
+ */
+static GdaDataModel *
+ag_db_select(AgDb *db, GError **err, const gchar *sql, ...)
+{
+    GdaDataModel *ret;
+    va_list      ap;
+
+    va_start(ap, sql);
+    ret = ag_db_select_valist(
+            db,
+            err,
+            GDA_STATEMENT_MODEL_RANDOM_ACCESS,
+            sql,
+            ap
+        );
+    va_end(ap);
+
+    return ret;
+}
+
+/**
+ * ag_db_select_cursor:
+ * @db: the database object to work on
+ * @err: a #GError or NULL
+ * @sql: the query to execute
+ * @...: a NULL terminated list of key-value pairs of the query parameters
+ *
+ * Same as ag_db_select(), but the returned data model can only be iterated
+ * forward. Rows are fetched from the database as the iterator moves, so the
+ * whole result set is never held in memory.
+ *
+ * Returns: (transfer full): the #GdaDataModel as the result of the query
+ */
+static GdaDataModel *
+ag_db_select_cursor(AgDb *db, GError **err, const gchar *sql, ...)
+{
+    GdaDataModel *ret;
+    va_list      ap;
+
+    va_start(ap, sql);
+    ret = ag_db_select_valist(
+            db,
+            err,
+            GDA_STATEMENT_MODEL_CURSOR_FORWARD,
+            sql,
+            ap
+        );
+    va_end(ap);
 
     return ret;
 }
@@ -485,6 +633,13 @@ ag_db_init(AgDb *db)
     gda_init();
 
     priv->dsn = g_strdup_printf("SQLite://DB_DIR=%s;DB_NAME=charts", path);
+    priv->statements = g_hash_table_new_full(
+            g_str_hash,
+            g_str_equal,
+            g_free,
+            (GDestroyNotify)ag_db_statement_free
+        );
+    priv->pending_changes = g_array_new(FALSE, FALSE, sizeof(AgDbChange));
 
     g_free(path);
     g_clear_object(&ag_data_dir);
@@ -525,8 +680,18 @@ ag_db_dispose(GObject *gobject)
 {
     AgDbPrivate *priv = ag_db_get_instance_private(AG_DB(gobject));
 
-    g_object_unref(priv->conn);
-    g_free(priv->dsn);
+    g_debug(
+            "Statement cache: %u hits, %u misses, %" G_GINT64_FORMAT
+            "µs spent on parsing",
+            priv->statement_hits,
+            priv->statement_misses,
+            priv->statement_parse_time
+        );
+
+    g_clear_pointer(&(priv->statements), g_hash_table_destroy);
+    g_clear_pointer(&(priv->pending_changes), g_array_unref);
+    g_clear_object(&(priv->conn));
+    g_clear_pointer(&(priv->dsn), g_free);
     G_OBJECT_CLASS(ag_db_parent_class)->dispose(gobject);
 }
 
@@ -545,6 +710,66 @@ ag_db_class_init(AgDbClass *klass)
 
     gobject_class->dispose  = ag_db_dispose;
     gobject_class->finalize = ag_db_finalize;
+
+    /**
+     * AgDb::chart-inserted:
+     * @db: the #AgDb that emitted the signal
+     * @db_id: the ID of the new chart
+     *
+     * Emitted after a new chart is saved. Within a transaction, the signal
+     * is emitted only when the transaction is committed.
+     */
+    signals[SIGNAL_CHART_INSERTED] = g_signal_new(
+            "chart-inserted",
+            AG_TYPE_DB,
+            G_SIGNAL_RUN_FIRST,
+            0,
+            NULL, NULL,
+            g_cclosure_marshal_VOID__INT,
+            G_TYPE_NONE,
+            1,
+            G_TYPE_INT
+        );
+
+    /**
+     * AgDb::chart-updated:
+     * @db: the #AgDb that emitted the signal
+     * @db_id: the ID of the changed chart
+     *
+     * Emitted after an existing chart is saved. Within a transaction, the
+     * signal is emitted only when the transaction is committed.
+     */
+    signals[SIGNAL_CHART_UPDATED] = g_signal_new(
+            "chart-updated",
+            AG_TYPE_DB,
+            G_SIGNAL_RUN_FIRST,
+            0,
+            NULL, NULL,
+            g_cclosure_marshal_VOID__INT,
+            G_TYPE_NONE,
+            1,
+            G_TYPE_INT
+        );
+
+    /**
+     * AgDb::chart-deleted:
+     * @db: the #AgDb that emitted the signal
+     * @db_id: the ID of the deleted chart
+     *
+     * Emitted after a chart is deleted. Within a transaction, the signal is
+     * emitted only when the transaction is committed.
+     */
+    signals[SIGNAL_CHART_DELETED] = g_signal_new(
+            "chart-deleted",
+            AG_TYPE_DB,
+            G_SIGNAL_RUN_FIRST,
+            0,
+            NULL, NULL,
+            g_cclosure_marshal_VOID__INT,
+            G_TYPE_NONE,
+            1,
+            G_TYPE_INT
+        );
 }
 
 AgDb *
@@ -617,6 +842,117 @@ ag_db_chart_save_unref(AgDbChartSave *save_data)
     }
 }
 
+/*
+ * ag_db_notify_change:
+ * @db: the #AgDb object to operate on
+ * @signal: the signal to emit
+ * @db_id: the ID of the changed chart
+ *
+ * Emit a change signal. Within a transaction, changes are queued until the
+ * transaction is committed, and dropped if it is rolled back, so listeners
+ * never see rows that don’t exist.
+ */
+static void
+ag_db_notify_change(AgDb *db, guint signal, gint db_id)
+{
+    AgDbPrivate *priv = ag_db_get_instance_private(db);
+
+    if (priv->in_transaction) {
+        AgDbChange change = { signal, db_id };
+
+        g_array_append_val(priv->pending_changes, change);
+    } else {
+        g_signal_emit(db, signals[signal], 0, db_id);
+    }
+}
+
+/**
+ * ag_db_begin_transaction:
+ * @db: the #AgDb object to operate on
+ * @err: a #GError
+ *
+ * Start a transaction. Until ag_db_commit_transaction() or
+ * ag_db_rollback_transaction() is called, every modification is done within
+ * this transaction, which makes bulk inserts a lot faster.
+ *
+ * Returns: TRUE if the transaction is started, FALSE otherwise
+ */
+gboolean
+ag_db_begin_transaction(AgDb *db, GError **err)
+{
+    AgDbPrivate *priv = ag_db_get_instance_private(db);
+
+    if (!gda_connection_begin_transaction(
+                priv->conn,
+                NULL,
+                GDA_TRANSACTION_ISOLATION_UNKNOWN,
+                err
+            )) {
+        return FALSE;
+    }
+
+    priv->in_transaction = TRUE;
+
+    return TRUE;
+}
+
+/**
+ * ag_db_commit_transaction:
+ * @db: the #AgDb object to operate on
+ * @err: a #GError
+ *
+ * Commit the transaction started with ag_db_begin_transaction(). The change
+ * signals of the charts modified within the transaction are emitted after
+ * the commit.
+ *
+ * Returns: TRUE if the commit succeeds, FALSE otherwise
+ */
+gboolean
+ag_db_commit_transaction(AgDb *db, GError **err)
+{
+    AgDbPrivate *priv    = ag_db_get_instance_private(db);
+    GArray      *changes = priv->pending_changes;
+    gboolean    ret;
+    guint       i;
+
+    ret = gda_connection_commit_transaction(priv->conn, NULL, err);
+
+    // Listeners may start a new transaction, so swap the queue out before
+    // emitting anything
+    priv->in_transaction  = FALSE;
+    priv->pending_changes = g_array_new(FALSE, FALSE, sizeof(AgDbChange));
+
+    for (i = 0; ret && (i < changes->len); i++) {
+        AgDbChange *change = &g_array_index(changes, AgDbChange, i);
+
+        g_signal_emit(db, signals[change->signal], 0, change->db_id);
+    }
+
+    g_array_unref(changes);
+
+    return ret;
+}
+
+/**
+ * ag_db_rollback_transaction:
+ * @db: the #AgDb object to operate on
+ * @err: a #GError
+ *
+ * Drop every modification made since ag_db_begin_transaction().
+ *
+ * Returns: TRUE if the rollback succeeds, FALSE otherwise
+ */
+gboolean
+ag_db_rollback_transaction(AgDb *db, GError **err)
+{
+    AgDbPrivate *priv = ag_db_get_instance_private(db);
+
+    priv->in_transaction = FALSE;
+    g_array_set_size(priv->pending_changes, 0);
+
+    return gda_connection_rollback_transaction(priv->conn, NULL, err);
+}
+
 /**
  * ag_db_chart_save:
  * @db: the #AgDb object to operate on
@@ -649,7 +985,10 @@ ag_db_chart_save(AgDb *db, AgDbChartSave *save_data,  GError **err)
                 second       = G_VALUE_INIT,
                 timezone     = G_VALUE_INIT,
                 note         = G_VALUE_INIT;
-    AgDbPrivate *priv = ag_db_get_instance_private(db);
+    AgDbStatement *statement;
+    GdaSet        *last_insert_row = NULL;
+    AgDbPrivate   *priv            = ag_db_get_instance_private(db);
+    gboolean      insert;
 
     if (save_data == NULL) {
         g_error("Trying to save a NULL chart!");
@@ -702,105 +1041,126 @@ ag_db_chart_save(AgDb *db, AgDbChartSave *save_data,  GError **err)
     g_value_set_string(&note, save_data->note);
 
     /* It is possible to get 0 here, which is as non-existant as -1 */
-    if (save_data->db_id < 0) {
-        if (!gda_connection_insert_row_into_table(
-                    priv->conn,
-                    "chart",
-                    &local_err,
-                    "name",         &name,
-                    "country_name", &country,
-                    "city_name",    &city,
-                    "longitude",    &longitude,
-                    "latitude",     &latitude,
-                    "altitude",     &altitude,
-                    "year",         &year,
-                    "month",        &month,
-                    "day",          &day,
-                    "hour",         &hour,
-                    "minute",       &minute,
-                    "second",       &second,
-                    "timezone",     &timezone,
-                    "note",         &note,
-                    NULL
-                )) {
-
-            g_set_error(
-                    err,
-                    AG_DB_ERROR,
-                    AG_DB_ERROR_DATABASE_ERROR,
-                    "%s",
-                    (local_err && local_err->message)
-                        ? local_err->message
-                        : _("Reason unknown")
-                );
+    if ((insert = (save_data->db_id < 0))) {
+        statement = ag_db_get_statement(
+                db,
+                "INSERT INTO chart (" \
+                    "name, country_name, city_name, " \
+                    "longitude, latitude, altitude, " \
+                    "year, month, day, hour, minute, second, timezone, " \
+                    "note" \
+                ") VALUES (" \
+                    "##name::string, " \
+                    "##country_name::string::null, " \
+                    "##city_name::string::null, " \
+                    "##longitude::gdouble, " \
+                    "##latitude::gdouble, " \
+                    "##altitude::gdouble, " \
+                    "##year::gint, " \
+                    "##month::guint, " \
+                    "##day::guint, " \
+                    "##hour::guint, " \
+                    "##minute::guint, " \
+                    "##second::guint, " \
+                    "##timezone::gdouble, " \
+                    "##note::string::null" \
+                ")"
+            );
+    } else {
+        statement = ag_db_get_statement(
+                db,
+                "UPDATE chart SET " \
+                    "name = ##name::string, " \
+                    "country_name = ##country_name::string::null, " \
+                    "city_name = ##city_name::string::null, " \
+                    "longitude = ##longitude::gdouble, " \
+                    "latitude = ##latitude::gdouble, " \
+                    "altitude = ##altitude::gdouble, " \
+                    "year = ##year::gint, " \
+                    "month = ##month::guint, " \
+                    "day = ##day::guint, " \
+                    "hour = ##hour::guint, " \
+                    "minute = ##minute::guint, " \
+                    "second = ##second::guint, " \
+                    "timezone = ##timezone::gdouble, " \
+                    "note = ##note::string::null " \
+                "WHERE id = ##id::gint"
+            );
 
-            save_success = FALSE;
-        } else {
-            // Get inserted row's id
-            GdaDataModel *result = ag_db_select(
-                    db,
-                    &local_err,
-                    "SELECT last_insert_rowid()"
-                );
+        g_value_init(&db_id, G_TYPE_INT);
+        g_value_set_int(&db_id, save_data->db_id);
+        ag_db_statement_set_value(statement, "id", &db_id);
+        g_value_unset(&db_id);
+    }
 
-            if (result == NULL) {
-                if (err) {
-                    *err = g_error_copy(local_err);
-                }
+    ag_db_statement_set_value(statement, "name",         &name);
+    ag_db_statement_set_value(statement, "country_name", &country);
+    ag_db_statement_set_value(statement, "city_name",    &city);
+    ag_db_statement_set_value(statement, "longitude",    &longitude);
+    ag_db_statement_set_value(statement, "latitude",     &latitude);
+    ag_db_statement_set_value(statement, "altitude",     &altitude);
+    ag_db_statement_set_value(statement, "year",         &year);
+    ag_db_statement_set_value(statement, "month",        &month);
+    ag_db_statement_set_value(statement, "day",          &day);
+    ag_db_statement_set_value(statement, "hour",         &hour);
+    ag_db_statement_set_value(statement, "minute",       &minute);
+    ag_db_statement_set_value(statement, "second",       &second);
+    ag_db_statement_set_value(statement, "timezone",     &timezone);
+    ag_db_statement_set_value(statement, "note",         &note);
+
+    // For INSERTs, last_insert_row holds the new row, so we don’t need an
+    // additional query to get the new row’s ID
+    if (gda_connection_statement_execute_non_select(
+                priv->conn,
+                statement->statement,
+                statement->params,
+                (insert) ? &last_insert_row : NULL,
+                &local_err
+            ) == -1) {
+        g_set_error(
+                err,
+                AG_DB_ERROR,
+                AG_DB_ERROR_DATABASE_ERROR,
+                "%s",
+                (local_err && local_err->message)
+                    ? local_err->message
+                    : _("Reason unknown")
+            );
+        g_clear_error(&local_err);
 
-                // TODO: a more reasonable return value should be given here
-                save_success = FALSE;
-            } else {
-                const GValue *value = gda_data_model_get_value_at(
-                        result,
-                        0, 0,
-                        NULL
-                    );
+        save_success = FALSE;
+    } else if (insert) {
+        const GValue *value = NULL;
 
-                save_data->db_id = g_value_get_int(value);
-            }
+        // The SQLite provider names the holders of last_insert_row as +N,
+        // where N is the column number; id is the first column
+        if (last_insert_row != NULL) {
+            value = gda_set_get_holder_value(last_insert_row, "+0");
         }
-    } else {
-        g_value_init(&db_id, G_TYPE_INT);
-        g_value_set_int(&db_id, save_data->db_id);
-
-        if (!gda_connection_update_row_in_table(
-                    priv->conn,
-                    "chart",
-                    "id",
-                    &db_id,
-                    &local_err,
-                    "name",         &name,
-                    "country_name", &country,
-                    "city_name",    &city,
-                    "longitude",    &longitude,
-                    "latitude",     &latitude,
-                    "altitude",     &altitude,
-                    "year",         &year,
-                    "month",        &month,
-                    "day",          &day,
-                    "hour",         &hour,
-                    "minute",       &minute,
-                    "second",       &second,
-                    "timezone",     &timezone,
-                    "note",         &note,
-                    NULL
-                )) {
 
+        if ((value == NULL) || !G_VALUE_HOLDS_INT(value)) {
             g_set_error(
                     err,
                     AG_DB_ERROR,
                     AG_DB_ERROR_DATABASE_ERROR,
                     "%s",
-                    (local_err && local_err->message)
-                        ? local_err->message
-                        : _("Reason unknown")
+                    _("Unable to get the ID of the new chart")
                 );
 
             save_success = FALSE;
+        } else {
+            save_data->db_id = g_value_get_int(value);
         }
 
-        g_value_unset(&db_id);
+        g_clear_object(&last_insert_row);
+    }
+
+    if (save_success) {
+        ag_db_notify_change(
+                db,
+                (insert) ? SIGNAL_CHART_INSERTED : SIGNAL_CHART_UPDATED,
+                save_data->db_id
+            );
     }
 
     g_value_unset(&note);
@@ -884,90 +1244,48 @@ ag_db_chart_get_list(AgDb *db, GError **err)
 }
 
 /**
- * ag_db_chart_get_data_by_id:
- * @db: the #AgDb object to operate on
- * @row_id: the ID field of the requested chart
- * @err: a #GError
- *
- * Fetches the specified row from the chart table.
+ * ag_db_chart_get_columns:
  *
- * Returns: (transfer full): A fully filled #AgDbChartSave record of the chart
+ * Returns: (transfer full): the comma separated list of chart table columns,
+ *          in the order of the COLUMN_CHART_* constants
  */
-AgDbChartSave *
-ag_db_chart_get_data_by_id(AgDb *db, guint row_id, GError **err)
+static gchar *
+ag_db_chart_get_columns(void)
 {
-    AgDbChartSave     *save_data;
-    const GValue      *value;
-    gchar             *query,
-                      *columns;
-    guint             i;
-    GdaDataModel      *result;
-    GError            *local_err = NULL;
-
-    columns = NULL;
+    guint   i;
+    GString *columns = g_string_new(chart_table_column[0].name);
 
     for (i = 1; i < COLUMN_CHART_COUNT; i++) {
-        gchar *tmp;
-
-        if (i == 1) {
-            columns = g_strjoin(
-                    ", ",
-                    chart_table_column[0].name,
-                    chart_table_column[1].name,
-                    NULL
-                );
-        } else {
-            tmp = g_strjoin(", ", columns, chart_table_column[i].name, NULL);
-            g_free(columns);
-            columns = tmp;
-        }
-    }
-
-    query = g_strdup_printf(
-            "SELECT %s FROM chart WHERE id = ##id::gint",
-            columns
-        );
-    g_free(columns);
-
-    result = ag_db_select(db, &local_err, query, "id", row_id, NULL);
-    g_free(query);
-
-    if (local_err && (local_err->message)) {
-        return NULL;
+        g_string_append(columns, ", ");
+        g_string_append(columns, chart_table_column[i].name);
     }
 
-    if (gda_data_model_get_n_rows(result) < 1) {
-        g_set_error(
-                err,
-                AG_DB_ERROR, AG_DB_ERROR_NO_CHART,
-                "Chart does not exist"
-            );
-
-        return NULL;
-    }
+    return g_string_free(columns, FALSE);
+}
 
-    save_data = ag_db_chart_save_new(TRUE);
+/**
+ * ag_db_chart_save_new_from_iter:
+ * @iter: a #GdaDataModelIter pointing to a row that has all the columns
+ *        returned by ag_db_chart_get_columns()
+ *
+ * Returns: (transfer full): A fully filled #AgDbChartSave record of the row
+ */
+static AgDbChartSave *
+ag_db_chart_save_new_from_iter(GdaDataModelIter *iter)
+{
+    AgDbChartSave *save_data = ag_db_chart_save_new(TRUE);
+    const GValue  *value;
 
     /* id */
-    value = gda_data_model_get_value_at(
-            result,
-            COLUMN_CHART_ID,
-            0,
-            NULL
-        );
+    value = gda_data_model_iter_get_value_at(iter, COLUMN_CHART_ID);
     save_data->db_id = g_value_get_int(value);
 
     /* name */
-    value = gda_data_model_get_value_at(
-            result,
-            COLUMN_CHART_NAME,
-            0,
-            NULL
-        );
+    value = gda_data_model_iter_get_value_at(iter, COLUMN_CHART_NAME);
     save_data->name = g_strdup(g_value_get_string(value));
 
     /* country */
-    value = gda_data_model_get_value_at(result, COLUMN_CHART_COUNTRY, 0, NULL);
+    value = gda_data_model_iter_get_value_at(iter, COLUMN_CHART_COUNTRY);
 
     if (GDA_VALUE_HOLDS_NULL(value)) {
         save_data->country = NULL;
@@ -975,7 +1293,7 @@ ag_db_chart_get_data_by_id(AgDb *db, guint row_id, GError **err)
         save_data->country = g_strdup(g_value_get_string(value));
     }
 
-    value = gda_data_model_get_value_at(result, COLUMN_CHART_CITY, 0, NULL);
+    value = gda_data_model_iter_get_value_at(iter, COLUMN_CHART_CITY);
 
     if (GDA_VALUE_HOLDS_NULL(value)) {
         save_data->city = NULL;
@@ -983,23 +1301,13 @@ ag_db_chart_get_data_by_id(AgDb *db, guint row_id, GError **err)
         save_data->city = g_strdup(g_value_get_string(value));
     }
 
-    value = gda_data_model_get_value_at(
-            result,
-            COLUMN_CHART_LONGITUDE,
-            0,
-            NULL
-        );
+    value = gda_data_model_iter_get_value_at(iter, COLUMN_CHART_LONGITUDE);
     save_data->longitude = g_value_get_double(value);
 
-    value = gda_data_model_get_value_at(
-            result,
-            COLUMN_CHART_LATITUDE,
-            0,
-            NULL
-        );
+    value = gda_data_model_iter_get_value_at(iter, COLUMN_CHART_LATITUDE);
     save_data->latitude = g_value_get_double(value);
 
-    value = gda_data_model_get_value_at(result, COLUMN_CHART_ALTITUDE, 0, NULL);
+    value = gda_data_model_iter_get_value_at(iter, COLUMN_CHART_ALTITUDE);
 
     if (GDA_VALUE_HOLDS_NULL(value)) {
         save_data->altitude = DEFAULT_ALTITUDE;
@@ -1007,53 +1315,28 @@ ag_db_chart_get_data_by_id(AgDb *db, guint row_id, GError **err)
         save_data->altitude = g_value_get_double(value);
     }
 
-    value = gda_data_model_get_value_at(
-            result,
-            COLUMN_CHART_YEAR,
-            0,
-            NULL
-        );
+    value = gda_data_model_iter_get_value_at(iter, COLUMN_CHART_YEAR);
     save_data->year = g_value_get_int(value);
 
-    value = gda_data_model_get_value_at(
-            result,
-            COLUMN_CHART_MONTH,
-            0,
-            NULL
-        );
+    value = gda_data_model_iter_get_value_at(iter, COLUMN_CHART_MONTH);
     save_data->month = g_value_get_uint(value);
 
-    value = gda_data_model_get_value_at(result, COLUMN_CHART_DAY, 0, NULL);
+    value = gda_data_model_iter_get_value_at(iter, COLUMN_CHART_DAY);
     save_data->day = g_value_get_uint(value);
 
-    value = gda_data_model_get_value_at(result, COLUMN_CHART_HOUR, 0, NULL);
+    value = gda_data_model_iter_get_value_at(iter, COLUMN_CHART_HOUR);
     save_data->hour = g_value_get_uint(value);
 
-    value = gda_data_model_get_value_at(
-            result,
-            COLUMN_CHART_MINUTE,
-            0,
-            NULL
-        );
+    value = gda_data_model_iter_get_value_at(iter, COLUMN_CHART_MINUTE);
     save_data->minute = g_value_get_uint(value);
 
-    value = gda_data_model_get_value_at(
-            result,
-            COLUMN_CHART_SECOND,
-            0,
-            NULL
-        );
+    value = gda_data_model_iter_get_value_at(iter, COLUMN_CHART_SECOND);
     save_data->second = g_value_get_uint(value);
 
-    value = gda_data_model_get_value_at(
-            result,
-            COLUMN_CHART_TIMEZONE,
-            0,
-            NULL
-        );
+    value = gda_data_model_iter_get_value_at(iter, COLUMN_CHART_TIMEZONE);
     save_data->timezone = g_value_get_double(value);
 
-    value = gda_data_model_get_value_at(result, COLUMN_CHART_NOTE, 0, NULL);
+    value = gda_data_model_iter_get_value_at(iter, COLUMN_CHART_NOTE);
 
     if (GDA_VALUE_HOLDS_NULL(value)) {
         save_data->note = NULL;
@@ -1061,11 +1344,162 @@ ag_db_chart_get_data_by_id(AgDb *db, guint row_id, GError **err)
         save_data->note = g_strdup(g_value_get_string(value));
     }
 
+    return save_data;
+}
+
+/**
+ * ag_db_chart_get_data_by_id:
+ * @db: the #AgDb object to operate on
+ * @row_id: the ID field of the requested chart
+ * @err: a #GError
+ *
+ * Fetches the specified row from the chart table.
+ *
+ * Returns: (transfer full): A fully filled #AgDbChartSave record of the chart
+ */
+AgDbChartSave *
+ag_db_chart_get_data_by_id(AgDb *db, guint row_id, GError **err)
+{
+    AgDbChartSave     *save_data;
+    gchar             *query,
+                      *columns;
+    GdaDataModel      *result;
+    GdaDataModelIter  *iter;
+    GError            *local_err = NULL;
+
+    columns = ag_db_chart_get_columns();
+    query = g_strdup_printf(
+            "SELECT %s FROM chart WHERE id = ##id::gint",
+            columns
+        );
+    g_free(columns);
+
+    result = ag_db_select(db, &local_err, query, "id", row_id, NULL);
+    g_free(query);
+
+    if (local_err && (local_err->message)) {
+        g_propagate_error(err, local_err);
+
+        return NULL;
+    }
+
+    iter = gda_data_model_create_iter(result);
+
+    if (!gda_data_model_iter_move_next(iter)) {
+        g_set_error(
+                err,
+                AG_DB_ERROR, AG_DB_ERROR_NO_CHART,
+                "Chart does not exist"
+            );
+        g_object_unref(iter);
+        g_object_unref(result);
+
+        return NULL;
+    }
+
+    save_data = ag_db_chart_save_new_from_iter(iter);
+
+    g_object_unref(iter);
     g_object_unref(result);
 
     return save_data;
 }
 
+/**
+ * ag_db_chart_list_open:
+ * @db: the #AgDb object to operate on
+ * @err: a #GError
+ *
+ * Start reading all charts from the database, ordered by name. Unlike
+ * ag_db_chart_get_list(), the records are fully populated, and they are all
+ * fetched with a single query. Rows are read from the database only when
+ * they are requested with ag_db_chart_list_next().
+ *
+ * Returns: (transfer full): a new #AgDbChartList, or %NULL on error. Free it
+ *          with ag_db_chart_list_close()
+ */
+AgDbChartList *
+ag_db_chart_list_open(AgDb *db, GError **err)
+{
+    gchar         *query,
+                  *columns;
+    GdaDataModel  *result;
+    AgDbChartList *list;
+
+    columns = ag_db_chart_get_columns();
+    query   = g_strdup_printf(
+            "SELECT %s FROM chart ORDER BY name",
+            columns
+        );
+    g_free(columns);
+
+    result = ag_db_select_cursor(db, err, query, NULL);
+    g_free(query);
+
+    if (result == NULL) {
+        return NULL;
+    }
+
+    list         = g_new0(AgDbChartList, 1);
+    list->db     = g_object_ref(db);
+    list->result = result;
+    list->iter   = gda_data_model_create_iter(result);
+
+    return list;
+}
+
+/**
+ * ag_db_chart_list_next:
+ * @list: the #AgDbChartList to read from
+ * @max_rows: the maximum number of rows to return
+ *
+ * Read the next (at most) @max_rows charts from @list.
+ *
+ * Returns: (element-type AgDbChartSave) (transfer full): the list of fully
+ *          populated charts, or %NULL if there are no more rows
+ */
+GList *
+ag_db_chart_list_next(AgDbChartList *list, guint max_rows)
+{
+    GList *ret = NULL;
+    guint i;
+
+    if (list->finished) {
+        return NULL;
+    }
+
+    for (i = 0; i < max_rows; i++) {
+        if (!gda_data_model_iter_move_next(list->iter)) {
+            list->finished = TRUE;
+
+            break;
+        }
+
+        ret = g_list_prepend(ret, ag_db_chart_save_new_from_iter(list->iter));
+    }
+
+    return g_list_reverse(ret);
+}
+
+/**
+ * ag_db_chart_list_close:
+ * @list: the #AgDbChartList to free
+ *
+ * Free @list and all associated resources
+ */
+void
+ag_db_chart_list_close(AgDbChartList *list)
+{
+    if (list == NULL) {
+        return;
+    }
+
+    g_object_unref(list->iter);
+    g_object_unref(list->result);
+    g_object_unref(list->db);
+    g_free(list);
+}
+
 /**
  * string_collate:
  * @str1: the first string
@@ -1215,15 +1649,31 @@ ag_db_chart_save_identical(const AgDbChartSave *a,
 gboolean
 ag_db_chart_delete(AgDb *db, gint row_id, GError **err)
 {
-    AgDbPrivate *priv = ag_db_get_instance_private(db);
-    GValue      id    = G_VALUE_INIT;
+    AgDbPrivate   *priv = ag_db_get_instance_private(db);
+    AgDbStatement *statement;
+    GValue        id    = G_VALUE_INIT;
+
+    statement = ag_db_get_statement(
+            db,
+            "DELETE FROM chart WHERE id = ##id::gint"
+        );
 
     g_value_init(&id, G_TYPE_INT);
     g_value_set_int(&id, row_id);
+    ag_db_statement_set_value(statement, "id", &id);
+    g_value_unset(&id);
 
-    return gda_connection_delete_row_from_table(
-            priv->conn, "chart",
-            "id", &id,
-            err
-        );
+    if (gda_connection_statement_execute_non_select(
+                priv->conn,
+                statement->statement,
+                statement->params,
+                NULL,
+                err
+            ) == -1) {
+        return FALSE;
+    }
+
+    ag_db_notify_change(db, SIGNAL_CHART_DELETED, row_id);
+
+    return TRUE;
 }
@@ -68,6 +68,8 @@ typedef struct _AgDbChartSave {
     gint refcount;
 } AgDbChartSave;
 
+typedef struct _AgDbChartList AgDbChartList;
+
 GType ag_db_chart_save_get_type(void);
 #define AG_TYPE_DB_CHART_SAVE (ag_db_chart_save_get_type())
 
@@ -80,6 +82,12 @@ GType ag_db_get_type(void) G_GNUC_CONST;
 
 AgDb *ag_db_get(void);
 
+gboolean ag_db_begin_transaction(AgDb *db, GError **err);
+
+gboolean ag_db_commit_transaction(AgDb *db, GError **err);
+
+gboolean ag_db_rollback_transaction(AgDb *db, GError **err);
+
 gboolean ag_db_chart_save(AgDb           *db,
                           AgDbChartSave  *save_data,
                           GError         **err);
@@ -94,8 +102,19 @@ GList *ag_db_chart_get_list(AgDb *db, GError **err);
 
 AgDbChartSave *ag_db_chart_get_data_by_id(AgDb *db, guint row_id, GError **err);
 
+AgDbChartList *ag_db_chart_list_open(AgDb *db, GError **err);
+
+GList *ag_db_chart_list_next(AgDbChartList *list, guint max_rows);
+
+void ag_db_chart_list_close(AgDbChartList *list);
+
 gboolean ag_db_chart_delete(AgDb *db, gint row_id, GError **err);
 
+void ag_db_get_statement_cache_stats(AgDb   *db,
+                                     guint  *hits,
+                                     guint  *misses,
+                                     gint64 *parse_time);
+
 gboolean ag_db_chart_save_identical(const AgDbChartSave *a,
                                     const AgDbChartSave *b,
                                     gboolean            chart_only);
@@ -122,6 +122,77 @@ ag_display_theme_to_css(AgDisplayTheme *theme)
     return ret;
 }
 
+/**
+ * ag_display_theme_shows_planet:
+ * @theme: (allow-none): an #AgDisplayTheme
+ * @planet: the planet to check
+ *
+ * Check if @planet should be drawn on charts displayed with @theme. This is
+ * the same decision ag_display_theme_to_css() makes, for renderers that
+ * don’t use CSS.
+ *
+ * Returns: %TRUE if @planet is visible
+ */
+gboolean
+ag_display_theme_shows_planet(AgDisplayTheme *theme, GswePlanet planet)
+{
+    if (theme == NULL) {
+        return TRUE;
+    }
+
+    return (g_list_find(
+                theme->planets,
+                GINT_TO_POINTER(planet)
+            ) != NULL) == theme->planets_include;
+}
+
+/**
+ * ag_display_theme_shows_aspect:
+ * @theme: (allow-none): an #AgDisplayTheme
+ * @aspect: the aspect type to check
+ *
+ * Check if aspects of type @aspect should be drawn on charts displayed with
+ * @theme.
+ *
+ * Returns: %TRUE if @aspect is visible
+ */
+gboolean
+ag_display_theme_shows_aspect(AgDisplayTheme *theme, GsweAspect aspect)
+{
+    if (theme == NULL) {
+        return TRUE;
+    }
+
+    return (g_list_find(
+                theme->aspects,
+                GINT_TO_POINTER(aspect)
+            ) != NULL) == theme->aspects_include;
+}
+
+/**
+ * ag_display_theme_shows_antiscion_axis:
+ * @theme: (allow-none): an #AgDisplayTheme
+ * @antiscion_axis: the antiscion axis to check
+ *
+ * Check if antiscia on @antiscion_axis should be drawn on charts displayed
+ * with @theme.
+ *
+ * Returns: %TRUE if @antiscion_axis is visible
+ */
+gboolean
+ag_display_theme_shows_antiscion_axis(AgDisplayTheme    *theme,
+                                      GsweAntiscionAxis antiscion_axis)
+{
+    if (theme == NULL) {
+        return TRUE;
+    }
+
+    return (g_list_find(
+                theme->antiscia,
+                GINT_TO_POINTER(antiscion_axis)
+            ) != NULL) == theme->antiscia_include;
+}
+
 static AgDisplayTheme *
 ag_display_theme_get_builtin(gint id)
 {
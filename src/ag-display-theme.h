@@ -20,6 +20,7 @@
 #define __AG_DISPLAY_THEME_H__
 
 #include <glib.h>
+#include <swe-glib.h>
 
 typedef struct _AgDisplayTheme {
     gint     id;
@@ -43,6 +44,16 @@ enum {
 
 gchar *ag_display_theme_to_css(AgDisplayTheme *display_theme);
 
+gboolean ag_display_theme_shows_planet(AgDisplayTheme *display_theme,
+                                       GswePlanet     planet);
+
+gboolean ag_display_theme_shows_aspect(AgDisplayTheme *display_theme,
+                                       GsweAspect     aspect);
+
+gboolean ag_display_theme_shows_antiscion_axis(
+        AgDisplayTheme    *display_theme,
+        GsweAntiscionAxis antiscion_axis);
+
 AgDisplayTheme *ag_display_theme_get_by_id(int id);
 
 GList *ag_display_theme_get_list(void);
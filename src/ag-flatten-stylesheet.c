@@ -0,0 +1,243 @@
+/* ag-flatten-stylesheet.c - Build time stylesheet flattener for Astrognome
+ *
+ * Copyright (C) 2014 Polonkai Gergely
+ *
+ * Astrognome is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Astrognome is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libxml/parser.h>
+#include <libxml/tree.h>
+#include <libxml/xinclude.h>
+#include <libxml/xmlIO.h>
+
+// Resolves every XInclude of the chart stylesheet, so the application can
+// load it without going through the gres:// input callbacks. The gres://
+// links are resolved against the resource directory given on the command
+// line. Symbols included more than once into a <defs> element are only
+// kept once.
+//
+// This runs on the build host and only needs libxml2, so it doesn’t use
+// GLib.
+
+#define SVG_NS "http://www.w3.org/2000/svg"
+#define XI_NS  "http://www.w3.org/2001/XInclude"
+#define FLATTEN_PARSE_OPTIONS (XML_PARSE_NOXINCNODE | XML_PARSE_NOBASEFIX)
+
+static const char *resource_dir = NULL;
+
+static int
+flatten_match_gresource(const char *uri)
+{
+    return ((uri != NULL) && (strncmp("gres://", uri, 7) == 0));
+}
+
+static void *
+flatten_open_gresource(const char *uri)
+{
+    char *path;
+    FILE *file;
+
+    if ((path = malloc(strlen(resource_dir) + strlen(uri + 7) + 2)) == NULL) {
+        return NULL;
+    }
+
+    sprintf(path, "%s/%s", resource_dir, uri + 7);
+
+    if ((file = fopen(path, "rb")) == NULL) {
+        fprintf(stderr, "Unable to open %s (included as %s)\n", path, uri);
+    }
+
+    free(path);
+
+    return file;
+}
+
+static int
+flatten_read_gresource(void *context, char *buffer, int len)
+{
+    if ((context == NULL) || (buffer == NULL) || (len < 0)) {
+        return -1;
+    }
+
+    return fread(buffer, 1, len, (FILE *)context);
+}
+
+static int
+flatten_close_gresource(void *context)
+{
+    if (context == NULL) {
+        return -1;
+    }
+
+    return fclose((FILE *)context);
+}
+
+static int
+flatten_has_ns(xmlNodePtr node, const char *ns)
+{
+    return (
+                (node->ns != NULL)
+                && (node->ns->href != NULL)
+                && (strcmp((const char *)node->ns->href, ns) == 0)
+            );
+}
+
+/*
+ * flatten_dedup_defs:
+ *
+ * Drop every element from the <defs> elements of the tree under @node whose
+ * id already appeared in an earlier <defs>. Returns the number of removed
+ * elements.
+ */
+static int
+flatten_dedup_defs(xmlNodePtr node, xmlHashTablePtr ids)
+{
+    int        removed = 0;
+    xmlNodePtr child,
+               next;
+
+    for (; node; node = node->next) {
+        if (node->type != XML_ELEMENT_NODE) {
+            continue;
+        }
+
+        if (
+                    flatten_has_ns(node, SVG_NS)
+                    && (strcmp((const char *)node->name, "defs") == 0)
+                ) {
+            for (child = node->children; child; child = next) {
+                xmlChar *id;
+
+                next = child->next;
+
+                if (
+                            (child->type != XML_ELEMENT_NODE)
+                            || ((id = xmlGetProp(child, BAD_CAST "id")) == NULL)
+                        ) {
+                    continue;
+                }
+
+                if (xmlHashLookup(ids, id) != NULL) {
+                    xmlUnlinkNode(child);
+                    xmlFreeNode(child);
+                    removed++;
+                } else {
+                    xmlHashAddEntry(ids, id, node);
+                }
+
+                xmlFree(id);
+            }
+
+            continue;
+        }
+
+        removed += flatten_dedup_defs(node->children, ids);
+    }
+
+    return removed;
+}
+
+static int
+flatten_count_includes(xmlNodePtr node)
+{
+    int count = 0;
+
+    for (; node; node = node->next) {
+        if (node->type != XML_ELEMENT_NODE) {
+            continue;
+        }
+
+        if (
+                    flatten_has_ns(node, XI_NS)
+                    && (strcmp((const char *)node->name, "include") == 0)
+                ) {
+            count++;
+        }
+
+        count += flatten_count_includes(node->children);
+    }
+
+    return count;
+}
+
+int
+main(int argc, char *argv[])
+{
+    xmlDocPtr       doc;
+    xmlHashTablePtr ids;
+    int             removed;
+
+    if (argc != 4) {
+        fprintf(
+                stderr,
+                "Usage: %s RESOURCE_DIR INPUT OUTPUT\n",
+                argv[0]
+            );
+
+        return EXIT_FAILURE;
+    }
+
+    resource_dir = argv[1];
+
+    LIBXML_TEST_VERSION;
+    xmlRegisterInputCallbacks(
+            flatten_match_gresource,
+            flatten_open_gresource,
+            flatten_read_gresource,
+            flatten_close_gresource
+        );
+
+    if ((doc = xmlReadFile(argv[2], NULL, 0)) == NULL) {
+        fprintf(stderr, "Unable to parse %s\n", argv[2]);
+
+        return EXIT_FAILURE;
+    }
+
+    if (xmlXIncludeProcessFlags(doc, FLATTEN_PARSE_OPTIONS) < 0) {
+        fprintf(stderr, "Unable to resolve the XIncludes of %s\n", argv[2]);
+        xmlFreeDoc(doc);
+
+        return EXIT_FAILURE;
+    }
+
+    if (flatten_count_includes(xmlDocGetRootElement(doc)) > 0) {
+        fprintf(stderr, "Some XIncludes of %s remained unresolved\n", argv[2]);
+        xmlFreeDoc(doc);
+
+        return EXIT_FAILURE;
+    }
+
+    ids     = xmlHashCreate(64);
+    removed = flatten_dedup_defs(xmlDocGetRootElement(doc), ids);
+    xmlHashFree(ids, NULL);
+
+    if (removed > 0) {
+        fprintf(stderr, "Removed %d duplicate symbols\n", removed);
+    }
+
+    if (xmlSaveFileEnc(argv[3], doc, "UTF-8") < 0) {
+        fprintf(stderr, "Unable to write %s\n", argv[3]);
+        xmlFreeDoc(doc);
+
+        return EXIT_FAILURE;
+    }
+
+    xmlFreeDoc(doc);
+    xmlCleanupParser();
+
+    return EXIT_SUCCESS;
+}
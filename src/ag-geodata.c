@@ -0,0 +1,1110 @@
+/* ag-geodata.c - Memory mapped geographical data for Astrognome
+ *
+ * Copyright (C) 2014 Polonkai Gergely
+ *
+ * Astrognome is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Astrognome is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <math.h>
+#include <string.h>
+
+#include "config.h"
+#include "astrognome.h"
+#include "ag-geodata.h"
+#include "ag-trace.h"
+
+/*
+ * The binary geodata file is generated by data/geonames/geonames_process.pl.
+ * Every number in it is little endian. The layout is:
+ *
+ *   - an AgGeodataHeader
+ *   - n_countries AgGeodataCountry records
+ *   - n_cities AgGeodataCity records
+ *   - the string table, a list of NUL terminated UTF-8 strings
+ *
+ * Records refer to strings by their offset within the string table. The
+ * record tables start at 8 byte aligned offsets, so they can be accessed
+ * directly in the mapped file.
+ */
+#define AG_GEODATA_MAGIC   "AGGEODAT"
+#define AG_GEODATA_VERSION 1
+
+typedef struct {
+    gchar   magic[8];
+    guint32 version;
+    guint32 n_countries;
+    guint32 n_cities;
+    guint32 countries_offset;
+    guint32 cities_offset;
+    guint32 strings_offset;
+    guint32 strings_size;
+    guint32 reserved;
+} AgGeodataHeader;
+
+typedef struct {
+    guint32 code;
+    guint32 name;
+} AgGeodataCountry;
+
+typedef struct {
+    guint32 name;
+    guint32 country;
+    gdouble latitude;
+    gdouble longitude;
+    gdouble altitude;
+    gdouble tz_offset;
+    gdouble tz_dst_offset;
+} AgGeodataCity;
+
+G_STATIC_ASSERT(sizeof(AgGeodataHeader) == 40);
+G_STATIC_ASSERT(sizeof(AgGeodataCountry) == 8);
+G_STATIC_ASSERT(sizeof(AgGeodataCity) == 48);
+
+typedef struct {
+    guint32 key;
+    guint32 city;
+} AgGeodataIndexEntry;
+
+typedef struct {
+    guint start;
+    guint end;
+} AgGeodataIndexRange;
+
+/*
+ * The city name indexes.
+ *
+ * keys holds the normalized, casefolded name of every city; by_name lists
+ * all cities sorted by these keys, while by_country lists them sorted by
+ * country code first, so every country is a continuous range of it, found
+ * via countries. These are used for prefix searches.
+ *
+ * names maps the collation key of every distinct city name to the first
+ * city with that name; same_name links it to the next city with the same
+ * name (or AG_GEODATA_NO_CITY). These are used for exact lookups.
+ */
+typedef struct {
+    gchar               *keys;
+    AgGeodataIndexEntry *by_name;
+    AgGeodataIndexEntry *by_country;
+    GHashTable          *countries;
+    GStringChunk        *collate_keys;
+    GHashTable          *names;
+    guint32             *same_name;
+} AgGeodataIndex;
+
+#define AG_GEODATA_NO_CITY G_MAXUINT32
+
+struct _AgGeodata {
+    GMappedFile            *file;
+    const AgGeodataCountry *countries;
+    const AgGeodataCity    *cities;
+    const gchar            *strings;
+    guint                  n_countries;
+    guint                  n_cities;
+    gsize                  strings_size;
+    GtkTreeModel           *country_model;
+    GtkTreeModel           *city_model;
+    GThread                *index_thread;
+    AgGeodataIndex         *index;
+};
+
+typedef enum {
+    AG_GEODATA_TABLE_COUNTRIES,
+    AG_GEODATA_TABLE_CITIES,
+} AgGeodataTable;
+
+typedef struct _AgGeodataModelPrivate {
+    AgGeodata      *geodata;
+    AgGeodataTable table;
+    gint           stamp;
+} AgGeodataModelPrivate;
+
+static void ag_geodata_model_tree_model_init(GtkTreeModelIface *iface);
+
+G_DEFINE_QUARK(ag_geodata_error_quark, ag_geodata_error);
+
+G_DEFINE_TYPE_WITH_CODE(
+        AgGeodataModel,
+        ag_geodata_model,
+        G_TYPE_OBJECT,
+        G_ADD_PRIVATE(AgGeodataModel)
+        G_IMPLEMENT_INTERFACE(
+                GTK_TYPE_TREE_MODEL,
+                ag_geodata_model_tree_model_init
+            )
+    );
+
+#define GET_PRIV(v, o) AgGeodataModelPrivate *v = ag_geodata_model_get_instance_private(o);
+
+static gpointer ag_geodata_build_index(AgGeodata *geodata);
+
+static gboolean
+ag_geodata_table_is_valid(gsize  file_size,
+                          guint  offset,
+                          guint  count,
+                          gsize  record_size)
+{
+    if ((offset % 8) != 0) {
+        return FALSE;
+    }
+
+    if (offset > file_size) {
+        return FALSE;
+    }
+
+    return ((file_size - offset) / record_size >= count);
+}
+
+/**
+ * ag_geodata_open:
+ * @filename: the binary geodata file to open
+ * @err: a #GError
+ *
+ * Maps @filename into memory. Only the header is checked here, so opening
+ * takes the same time regardless of the number of places in the file;
+ * records are read on demand.
+ *
+ * Returns: (transfer full): a new #AgGeodata, or %NULL on error
+ */
+AgGeodata *
+ag_geodata_open(const gchar *filename, GError **err)
+{
+    GMappedFile     *file;
+    AgGeodata       *geodata;
+    AgGeodataHeader header;
+    const gchar     *contents;
+    gsize           size;
+    guint           strings_offset;
+    gint64          trace = ag_trace_begin();
+
+    if ((file = g_mapped_file_new(filename, FALSE, err)) == NULL) {
+        return NULL;
+    }
+
+    contents = g_mapped_file_get_contents(file);
+    size     = g_mapped_file_get_length(file);
+
+    if (size < sizeof(AgGeodataHeader)) {
+        g_set_error(
+                err,
+                AG_GEODATA_ERROR, AG_GEODATA_ERROR_CORRUPT,
+                "%s is too short to be a geodata file",
+                filename
+            );
+        g_mapped_file_unref(file);
+
+        return NULL;
+    }
+
+    memcpy(&header, contents, sizeof(AgGeodataHeader));
+
+    if (memcmp(header.magic, AG_GEODATA_MAGIC, sizeof(header.magic)) != 0) {
+        g_set_error(
+                err,
+                AG_GEODATA_ERROR, AG_GEODATA_ERROR_CORRUPT,
+                "%s is not a geodata file",
+                filename
+            );
+        g_mapped_file_unref(file);
+
+        return NULL;
+    }
+
+    if (GUINT32_FROM_LE(header.version) != AG_GEODATA_VERSION) {
+        g_set_error(
+                err,
+                AG_GEODATA_ERROR, AG_GEODATA_ERROR_VERSION,
+                "%s has an unsupported version (%u)",
+                filename,
+                GUINT32_FROM_LE(header.version)
+            );
+        g_mapped_file_unref(file);
+
+        return NULL;
+    }
+
+    geodata = g_new0(AgGeodata, 1);
+    geodata->file         = file;
+    geodata->n_countries  = GUINT32_FROM_LE(header.n_countries);
+    geodata->n_cities     = GUINT32_FROM_LE(header.n_cities);
+    geodata->strings_size = GUINT32_FROM_LE(header.strings_size);
+    strings_offset        = GUINT32_FROM_LE(header.strings_offset);
+
+    // The string table must fit in the file, and must end with a NUL byte,
+    // so any offset within it points to a terminated string
+    if (
+                !ag_geodata_table_is_valid(
+                        size,
+                        GUINT32_FROM_LE(header.countries_offset),
+                        geodata->n_countries,
+                        sizeof(AgGeodataCountry)
+                    )
+                || !ag_geodata_table_is_valid(
+                        size,
+                        GUINT32_FROM_LE(header.cities_offset),
+                        geodata->n_cities,
+                        sizeof(AgGeodataCity)
+                    )
+                || (strings_offset > size)
+                || (geodata->strings_size == 0)
+                || (size - strings_offset < geodata->strings_size)
+                || (contents[strings_offset + geodata->strings_size - 1] != 0)
+            ) {
+        g_set_error(
+                err,
+                AG_GEODATA_ERROR, AG_GEODATA_ERROR_CORRUPT,
+                "%s is corrupt",
+                filename
+            );
+        ag_geodata_free(geodata);
+
+        return NULL;
+    }
+
+    geodata->countries = (const AgGeodataCountry *)(
+            contents + GUINT32_FROM_LE(header.countries_offset)
+        );
+    geodata->cities = (const AgGeodataCity *)(
+            contents + GUINT32_FROM_LE(header.cities_offset)
+        );
+    geodata->strings = contents + strings_offset;
+
+    // Building the city name indexes requires reading all the places, so it
+    // is done in the background; lookups wait for it if necessary
+    geodata->index_thread = g_thread_new(
+            "geodata-index",
+            (GThreadFunc)ag_geodata_build_index,
+            geodata
+        );
+
+    g_debug(
+            "Mapped %s: %u countries, %u cities",
+            filename,
+            geodata->n_countries,
+            geodata->n_cities
+        );
+    ag_trace_end(AG_TRACE_GEODATA_OPEN, trace);
+
+    return geodata;
+}
+
+/**
+ * ag_geodata_free:
+ * @geodata: the #AgGeodata to free
+ *
+ * Unmaps the geodata file. The models returned by
+ * ag_geodata_get_country_model() and ag_geodata_get_city_model() must not be
+ * used after this.
+ */
+void
+ag_geodata_free(AgGeodata *geodata)
+{
+    if (geodata == NULL) {
+        return;
+    }
+
+    g_clear_object(&(geodata->country_model));
+    g_clear_object(&(geodata->city_model));
+
+    if (geodata->index_thread != NULL) {
+        geodata->index = g_thread_join(geodata->index_thread);
+    }
+
+    if (geodata->index != NULL) {
+        g_free(geodata->index->keys);
+        g_free(geodata->index->by_name);
+        g_free(geodata->index->by_country);
+        g_hash_table_destroy(geodata->index->countries);
+        g_hash_table_destroy(geodata->index->names);
+        g_string_chunk_free(geodata->index->collate_keys);
+        g_free(geodata->index->same_name);
+        g_free(geodata->index);
+    }
+
+    g_mapped_file_unref(geodata->file);
+    g_free(geodata);
+}
+
+static const gchar *
+ag_geodata_get_string(AgGeodata *geodata, guint32 offset)
+{
+    offset = GUINT32_FROM_LE(offset);
+
+    if (offset >= geodata->strings_size) {
+        return "";
+    }
+
+    return geodata->strings + offset;
+}
+
+guint
+ag_geodata_get_country_count(AgGeodata *geodata)
+{
+    return geodata->n_countries;
+}
+
+guint
+ag_geodata_get_city_count(AgGeodata *geodata)
+{
+    return geodata->n_cities;
+}
+
+const gchar *
+ag_geodata_country_get_code(AgGeodata *geodata, guint country)
+{
+    g_return_val_if_fail(country < geodata->n_countries, NULL);
+
+    return ag_geodata_get_string(geodata, geodata->countries[country].code);
+}
+
+const gchar *
+ag_geodata_country_get_name(AgGeodata *geodata, guint country)
+{
+    g_return_val_if_fail(country < geodata->n_countries, NULL);
+
+    return ag_geodata_get_string(geodata, geodata->countries[country].name);
+}
+
+const gchar *
+ag_geodata_city_get_name(AgGeodata *geodata, guint city)
+{
+    g_return_val_if_fail(city < geodata->n_cities, NULL);
+
+    return ag_geodata_get_string(geodata, geodata->cities[city].name);
+}
+
+const gchar *
+ag_geodata_city_get_country(AgGeodata *geodata, guint city)
+{
+    g_return_val_if_fail(city < geodata->n_cities, NULL);
+
+    return ag_geodata_get_string(geodata, geodata->cities[city].country);
+}
+
+/**
+ * ag_geodata_city_get_position:
+ * @geodata: an #AgGeodata
+ * @city: the index of the city
+ * @latitude: (out) (allow-none): the latitude of the city
+ * @longitude: (out) (allow-none): the longitude of the city
+ * @altitude: (out) (allow-none): the altitude of the city
+ * @tz_offset: (out) (allow-none): the time zone offset of the city
+ * @tz_dst_offset: (out) (allow-none): the daylight saving time zone offset
+ *                 of the city
+ *
+ * Gets the location data of @city. If the altitude of @city is unknown,
+ * DEFAULT_ALTITUDE is returned in @altitude.
+ */
+void
+ag_geodata_city_get_position(AgGeodata *geodata,
+                             guint     city,
+                             gdouble   *latitude,
+                             gdouble   *longitude,
+                             gdouble   *altitude,
+                             gdouble   *tz_offset,
+                             gdouble   *tz_dst_offset)
+{
+    const AgGeodataCity *record;
+
+    g_return_if_fail(city < geodata->n_cities);
+
+    record = &(geodata->cities[city]);
+
+    if (latitude) {
+        *latitude = GDOUBLE_FROM_LE(record->latitude);
+    }
+
+    if (longitude) {
+        *longitude = GDOUBLE_FROM_LE(record->longitude);
+    }
+
+    if (altitude) {
+        *altitude = GDOUBLE_FROM_LE(record->altitude);
+
+        // Places without elevation data are stored with NaN altitude
+        if (isnan(*altitude)) {
+            *altitude = DEFAULT_ALTITUDE;
+        }
+    }
+
+    if (tz_offset) {
+        *tz_offset = GDOUBLE_FROM_LE(record->tz_offset);
+    }
+
+    if (tz_dst_offset) {
+        *tz_dst_offset = GDOUBLE_FROM_LE(record->tz_dst_offset);
+    }
+}
+
+static gchar *
+ag_geodata_make_key(const gchar *name)
+{
+    gchar *normalized_name,
+          *key;
+
+    if ((normalized_name = g_utf8_normalize(name, -1, G_NORMALIZE_ALL)) == NULL) {
+        return NULL;
+    }
+
+    key = g_utf8_casefold(normalized_name, -1);
+    g_free(normalized_name);
+
+    return key;
+}
+
+static gint
+ag_geodata_index_compare_name(const AgGeodataIndexEntry *a,
+                              const AgGeodataIndexEntry *b,
+                              const gchar               *keys)
+{
+    return strcmp(keys + a->key, keys + b->key);
+}
+
+static gint
+ag_geodata_index_compare_country(const AgGeodataIndexEntry *a,
+                                 const AgGeodataIndexEntry *b,
+                                 const gpointer            *data)
+{
+    AgGeodata      *geodata = data[0];
+    AgGeodataIndex *index   = data[1];
+    gint           ret;
+
+    ret = strcmp(
+            ag_geodata_city_get_country(geodata, a->city),
+            ag_geodata_city_get_country(geodata, b->city)
+        );
+
+    if (ret != 0) {
+        return ret;
+    }
+
+    return ag_geodata_index_compare_name(a, b, index->keys);
+}
+
+/*
+ * ag_geodata_build_index:
+ *
+ * Runs in its own thread, started by ag_geodata_open(). Only reads the
+ * mapped file, so it doesn't need any locking.
+ */
+static gpointer
+ag_geodata_build_index(AgGeodata *geodata)
+{
+    AgGeodataIndex *index;
+    GString        *keys;
+    guint          i;
+    gpointer       compare_data[2];
+    gint64         start_time = g_get_monotonic_time(),
+                   trace      = ag_trace_begin();
+
+    index             = g_new0(AgGeodataIndex, 1);
+    index->by_name    = g_new(AgGeodataIndexEntry, geodata->n_cities);
+    index->countries  = g_hash_table_new_full(
+            g_str_hash,
+            g_str_equal,
+            NULL,
+            g_free
+        );
+    keys              = g_string_new(NULL);
+
+    for (i = 0; i < geodata->n_cities; i++) {
+        gchar *key = ag_geodata_make_key(ag_geodata_city_get_name(geodata, i));
+
+        index->by_name[i].key  = keys->len;
+        index->by_name[i].city = i;
+        g_string_append(keys, (key) ? key : "");
+        g_string_append_c(keys, 0);
+        g_free(key);
+    }
+
+    index->keys = g_string_free(keys, FALSE);
+    index->by_country = g_new(AgGeodataIndexEntry, geodata->n_cities);
+    memcpy(
+            index->by_country,
+            index->by_name,
+            sizeof(AgGeodataIndexEntry) * geodata->n_cities
+        );
+
+    g_qsort_with_data(
+            index->by_name,
+            geodata->n_cities,
+            sizeof(AgGeodataIndexEntry),
+            (GCompareDataFunc)ag_geodata_index_compare_name,
+            index->keys
+        );
+
+    compare_data[0] = geodata;
+    compare_data[1] = index;
+    g_qsort_with_data(
+            index->by_country,
+            geodata->n_cities,
+            sizeof(AgGeodataIndexEntry),
+            (GCompareDataFunc)ag_geodata_index_compare_country,
+            compare_data
+        );
+
+    for (i = 0; i < geodata->n_cities; ) {
+        AgGeodataIndexRange *range = g_new(AgGeodataIndexRange, 1);
+        const gchar         *country;
+
+        country = ag_geodata_city_get_country(
+                geodata,
+                index->by_country[i].city
+            );
+        range->start = i;
+
+        while (
+                    (i < geodata->n_cities)
+                    && (strcmp(
+                            country,
+                            ag_geodata_city_get_country(
+                                    geodata,
+                                    index->by_country[i].city
+                                )
+                        ) == 0)
+                ) {
+            i++;
+        }
+
+        range->end = i;
+
+        // The country codes live in the mapped file, which outlives the
+        // index
+        g_hash_table_insert(index->countries, (gpointer)country, range);
+    }
+
+    index->collate_keys = g_string_chunk_new(1024 * 1024);
+    index->names        = g_hash_table_new(g_str_hash, g_str_equal);
+    index->same_name    = g_new(guint32, geodata->n_cities);
+
+    // Going backwards, so every chain of same named cities ends up in file
+    // order
+    for (i = geodata->n_cities; i-- > 0; ) {
+        gchar    *collate_key,
+                 *key;
+        gpointer next;
+
+        collate_key = g_utf8_collate_key(
+                ag_geodata_city_get_name(geodata, i),
+                -1
+            );
+        key = g_string_chunk_insert_const(index->collate_keys, collate_key);
+        g_free(collate_key);
+
+        if (g_hash_table_lookup_extended(index->names, key, NULL, &next)) {
+            index->same_name[i] = GPOINTER_TO_UINT(next);
+        } else {
+            index->same_name[i] = AG_GEODATA_NO_CITY;
+        }
+
+        g_hash_table_insert(index->names, key, GUINT_TO_POINTER(i));
+    }
+
+    g_debug(
+            "City name index built in %" G_GINT64_FORMAT " µs",
+            g_get_monotonic_time() - start_time
+        );
+    ag_trace_end(AG_TRACE_GEODATA_INDEX, trace);
+
+    return index;
+}
+
+static void
+ag_geodata_wait_for_index(AgGeodata *geodata)
+{
+    if (geodata->index_thread != NULL) {
+        geodata->index        = g_thread_join(geodata->index_thread);
+        geodata->index_thread = NULL;
+    }
+}
+
+/**
+ * ag_geodata_find_cities:
+ * @geodata: an #AgGeodata
+ * @country_code: (allow-none): the country to search in, or %NULL to search
+ *                all countries
+ * @prefix: the beginning of the city name
+ * @max_results: the maximum number of cities to return
+ * @results: (out caller-allocates) (array length=max_results): an array to
+ *           store the indexes of the found cities in
+ *
+ * Finds the cities whose names start with @prefix, ignoring case and
+ * Unicode normalization differences. Cities are returned in alphabetical
+ * order.
+ *
+ * Only the matching range of the name index is visited, so this is fast
+ * regardless of the number of cities. The first call may block until the
+ * index, built in the background by ag_geodata_open(), is finished.
+ *
+ * Returns: the number of cities stored in @results
+ */
+guint
+ag_geodata_find_cities(AgGeodata   *geodata,
+                       const gchar *country_code,
+                       const gchar *prefix,
+                       guint       max_results,
+                       guint       *results)
+{
+    const AgGeodataIndexEntry *entries;
+    gchar                     *key;
+    gsize                     key_len;
+    guint                     low,
+                              high,
+                              end,
+                              found = 0;
+
+    ag_geodata_wait_for_index(geodata);
+
+    if ((key = ag_geodata_make_key(prefix)) == NULL) {
+        return 0;
+    }
+
+    if (country_code == NULL) {
+        entries = geodata->index->by_name;
+        low     = 0;
+        end     = geodata->n_cities;
+    } else {
+        AgGeodataIndexRange *range;
+
+        if ((range = g_hash_table_lookup(
+                        geodata->index->countries,
+                        country_code
+                    )) == NULL) {
+            g_free(key);
+
+            return 0;
+        }
+
+        entries = geodata->index->by_country;
+        low     = range->start;
+        end     = range->end;
+    }
+
+    key_len = strlen(key);
+    high    = end;
+
+    // Find the first entry not less than key
+    while (low < high) {
+        guint mid = low + (high - low) / 2;
+
+        if (strcmp(geodata->index->keys + entries[mid].key, key) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    // Entries are sorted, so every match follows it
+    for (
+                ;
+                (low < end) && (found < max_results)
+                && (strncmp(
+                        geodata->index->keys + entries[low].key,
+                        key,
+                        key_len
+                    ) == 0);
+                low++
+            ) {
+        results[found++] = entries[low].city;
+    }
+
+    g_free(key);
+
+    return found;
+}
+
+/**
+ * ag_geodata_lookup_city:
+ * @geodata: an #AgGeodata
+ * @country_code: (allow-none): the country the city must be in, or %NULL to
+ *                accept any country
+ * @name: the name of the city
+ *
+ * Finds the city named @name. Names are compared with g_utf8_collate(), and
+ * if there are more matching cities, the first one in the geodata file is
+ * returned.
+ *
+ * The lookup is a hash table lookup, followed by a walk through the
+ * (usually very few) cities with the same name. The first call may block
+ * until the index, built in the background by ag_geodata_open(), is
+ * finished.
+ *
+ * Returns: the index of the city, or -1 if no such city exists
+ */
+gint
+ag_geodata_lookup_city(AgGeodata   *geodata,
+                       const gchar *country_code,
+                       const gchar *name)
+{
+    gchar    *collate_key;
+    gpointer first;
+    guint32  city;
+    gboolean found;
+
+    ag_geodata_wait_for_index(geodata);
+
+    collate_key = g_utf8_collate_key(name, -1);
+    found       = g_hash_table_lookup_extended(
+            geodata->index->names,
+            collate_key,
+            NULL,
+            &first
+        );
+    g_free(collate_key);
+
+    if (!found) {
+        return -1;
+    }
+
+    for (
+                city = GPOINTER_TO_UINT(first);
+                city != AG_GEODATA_NO_CITY;
+                city = geodata->index->same_name[city]
+            ) {
+        if (
+                    (country_code == NULL)
+                    || (strcmp(
+                            country_code,
+                            ag_geodata_city_get_country(geodata, city)
+                        ) == 0)
+                ) {
+            return city;
+        }
+    }
+
+    return -1;
+}
+
+static GtkTreeModel *
+ag_geodata_model_new(AgGeodata *geodata, AgGeodataTable table)
+{
+    AgGeodataModel *model = g_object_new(AG_TYPE_GEODATA_MODEL, NULL);
+    GET_PRIV(priv, model);
+
+    priv->geodata = geodata;
+    priv->table   = table;
+
+    return GTK_TREE_MODEL(model);
+}
+
+/**
+ * ag_geodata_get_country_model:
+ * @geodata: an #AgGeodata
+ *
+ * Gets a read only #GtkTreeModel with the AG_COUNTRY_* columns, backed
+ * directly by the mapped file.
+ *
+ * Returns: (transfer none): the country list model
+ */
+GtkTreeModel *
+ag_geodata_get_country_model(AgGeodata *geodata)
+{
+    if (geodata->country_model == NULL) {
+        geodata->country_model = ag_geodata_model_new(
+                geodata,
+                AG_GEODATA_TABLE_COUNTRIES
+            );
+    }
+
+    return geodata->country_model;
+}
+
+/**
+ * ag_geodata_get_city_model:
+ * @geodata: an #AgGeodata
+ *
+ * Gets a read only #GtkTreeModel with the AG_CITY_* columns, backed directly
+ * by the mapped file.
+ *
+ * Returns: (transfer none): the city list model
+ */
+GtkTreeModel *
+ag_geodata_get_city_model(AgGeodata *geodata)
+{
+    if (geodata->city_model == NULL) {
+        geodata->city_model = ag_geodata_model_new(
+                geodata,
+                AG_GEODATA_TABLE_CITIES
+            );
+    }
+
+    return geodata->city_model;
+}
+
+static guint
+ag_geodata_model_get_row_count(AgGeodataModel *model)
+{
+    GET_PRIV(priv, model);
+
+    if (priv->table == AG_GEODATA_TABLE_COUNTRIES) {
+        return priv->geodata->n_countries;
+    } else {
+        return priv->geodata->n_cities;
+    }
+}
+
+static gboolean
+ag_geodata_model_set_iter(AgGeodataModel *model,
+                          GtkTreeIter    *iter,
+                          gint           row)
+{
+    GET_PRIV(priv, model);
+
+    if ((row < 0) || ((guint)row >= ag_geodata_model_get_row_count(model))) {
+        iter->stamp = 0;
+
+        return FALSE;
+    }
+
+    iter->stamp      = priv->stamp;
+    iter->user_data  = GINT_TO_POINTER(row);
+    iter->user_data2 = NULL;
+    iter->user_data3 = NULL;
+
+    return TRUE;
+}
+
+static GtkTreeModelFlags
+ag_geodata_model_get_flags(GtkTreeModel *tree_model)
+{
+    return GTK_TREE_MODEL_ITERS_PERSIST | GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint
+ag_geodata_model_get_n_columns(GtkTreeModel *tree_model)
+{
+    GET_PRIV(priv, AG_GEODATA_MODEL(tree_model));
+
+    if (priv->table == AG_GEODATA_TABLE_COUNTRIES) {
+        return AG_COUNTRY_COLCOUNT;
+    } else {
+        return AG_CITY_COLCOUNT;
+    }
+}
+
+static GType
+ag_geodata_model_get_column_type(GtkTreeModel *tree_model, gint index)
+{
+    GET_PRIV(priv, AG_GEODATA_MODEL(tree_model));
+
+    if (priv->table == AG_GEODATA_TABLE_COUNTRIES) {
+        return G_TYPE_STRING;
+    }
+
+    switch (index) {
+        case AG_CITY_COUNTRY:
+        case AG_CITY_NAME:
+            return G_TYPE_STRING;
+
+        default:
+            return G_TYPE_DOUBLE;
+    }
+}
+
+static gboolean
+ag_geodata_model_get_iter(GtkTreeModel *tree_model,
+                          GtkTreeIter  *iter,
+                          GtkTreePath  *path)
+{
+    if (gtk_tree_path_get_depth(path) != 1) {
+        iter->stamp = 0;
+
+        return FALSE;
+    }
+
+    return ag_geodata_model_set_iter(
+            AG_GEODATA_MODEL(tree_model),
+            iter,
+            gtk_tree_path_get_indices(path)[0]
+        );
+}
+
+static GtkTreePath *
+ag_geodata_model_get_path(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+    return gtk_tree_path_new_from_indices(
+            GPOINTER_TO_INT(iter->user_data),
+            -1
+        );
+}
+
+static void
+ag_geodata_model_get_value(GtkTreeModel *tree_model,
+                           GtkTreeIter  *iter,
+                           gint         column,
+                           GValue       *value)
+{
+    guint  row = GPOINTER_TO_INT(iter->user_data);
+    GET_PRIV(priv, AG_GEODATA_MODEL(tree_model));
+
+    g_value_init(
+            value,
+            ag_geodata_model_get_column_type(tree_model, column)
+        );
+
+    if (priv->table == AG_GEODATA_TABLE_COUNTRIES) {
+        switch (column) {
+            case AG_COUNTRY_CODE:
+                g_value_set_static_string(
+                        value,
+                        ag_geodata_country_get_code(priv->geodata, row)
+                    );
+
+                break;
+
+            case AG_COUNTRY_NAME:
+                g_value_set_static_string(
+                        value,
+                        ag_geodata_country_get_name(priv->geodata, row)
+                    );
+
+                break;
+        }
+    } else {
+        gdouble position[5];
+
+        switch (column) {
+            case AG_CITY_COUNTRY:
+                g_value_set_static_string(
+                        value,
+                        ag_geodata_city_get_country(priv->geodata, row)
+                    );
+
+                break;
+
+            case AG_CITY_NAME:
+                g_value_set_static_string(
+                        value,
+                        ag_geodata_city_get_name(priv->geodata, row)
+                    );
+
+                break;
+
+            default:
+                ag_geodata_city_get_position(
+                        priv->geodata,
+                        row,
+                        &position[0],
+                        &position[1],
+                        &position[2],
+                        &position[3],
+                        &position[4]
+                    );
+                g_value_set_double(value, position[column - AG_CITY_LAT]);
+
+                break;
+        }
+    }
+}
+
+static gboolean
+ag_geodata_model_iter_next(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+    return ag_geodata_model_set_iter(
+            AG_GEODATA_MODEL(tree_model),
+            iter,
+            GPOINTER_TO_INT(iter->user_data) + 1
+        );
+}
+
+static gboolean
+ag_geodata_model_iter_previous(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+    return ag_geodata_model_set_iter(
+            AG_GEODATA_MODEL(tree_model),
+            iter,
+            GPOINTER_TO_INT(iter->user_data) - 1
+        );
+}
+
+static gboolean
+ag_geodata_model_iter_nth_child(GtkTreeModel *tree_model,
+                                GtkTreeIter  *iter,
+                                GtkTreeIter  *parent,
+                                gint         n)
+{
+    // This is a list; rows have no children
+    if (parent != NULL) {
+        iter->stamp = 0;
+
+        return FALSE;
+    }
+
+    return ag_geodata_model_set_iter(AG_GEODATA_MODEL(tree_model), iter, n);
+}
+
+static gboolean
+ag_geodata_model_iter_children(GtkTreeModel *tree_model,
+                               GtkTreeIter  *iter,
+                               GtkTreeIter  *parent)
+{
+    return ag_geodata_model_iter_nth_child(tree_model, iter, parent, 0);
+}
+
+static gboolean
+ag_geodata_model_iter_has_child(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+    return FALSE;
+}
+
+static gint
+ag_geodata_model_iter_n_children(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+    if (iter != NULL) {
+        return 0;
+    }
+
+    return ag_geodata_model_get_row_count(AG_GEODATA_MODEL(tree_model));
+}
+
+static gboolean
+ag_geodata_model_iter_parent(GtkTreeModel *tree_model,
+                             GtkTreeIter  *iter,
+                             GtkTreeIter  *child)
+{
+    iter->stamp = 0;
+
+    return FALSE;
+}
+
+static void
+ag_geodata_model_tree_model_init(GtkTreeModelIface *iface)
+{
+    iface->get_flags       = ag_geodata_model_get_flags;
+    iface->get_n_columns   = ag_geodata_model_get_n_columns;
+    iface->get_column_type = ag_geodata_model_get_column_type;
+    iface->get_iter        = ag_geodata_model_get_iter;
+    iface->get_path        = ag_geodata_model_get_path;
+    iface->get_value       = ag_geodata_model_get_value;
+    iface->iter_next       = ag_geodata_model_iter_next;
+    iface->iter_previous   = ag_geodata_model_iter_previous;
+    iface->iter_children   = ag_geodata_model_iter_children;
+    iface->iter_has_child  = ag_geodata_model_iter_has_child;
+    iface->iter_n_children = ag_geodata_model_iter_n_children;
+    iface->iter_nth_child  = ag_geodata_model_iter_nth_child;
+    iface->iter_parent     = ag_geodata_model_iter_parent;
+}
+
+static void
+ag_geodata_model_init(AgGeodataModel *model)
+{
+    GET_PRIV(priv, model);
+
+    priv->stamp = g_random_int();
+}
+
+static void
+ag_geodata_model_class_init(AgGeodataModelClass *klass)
+{
+}
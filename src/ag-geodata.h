@@ -0,0 +1,105 @@
+/* ag-geodata.h - Memory mapped geographical data for Astrognome
+ *
+ * Copyright (C) 2014 Polonkai Gergely
+ *
+ * Astrognome is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Astrognome is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef __AG_GEODATA_H__
+#define __AG_GEODATA_H__
+
+#include <glib-object.h>
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+#define AG_TYPE_GEODATA_MODEL         (ag_geodata_model_get_type())
+#define AG_GEODATA_MODEL(o)           (G_TYPE_CHECK_INSTANCE_CAST((o), \
+                                                                  AG_TYPE_GEODATA_MODEL, \
+                                                                  AgGeodataModel))
+#define AG_GEODATA_MODEL_CLASS(k)     (G_TYPE_CHECK_CLASS_CAST((k), \
+                                                               AG_TYPE_GEODATA_MODEL, \
+                                                               AgGeodataModelClass))
+#define AG_IS_GEODATA_MODEL(o)        (G_TYPE_CHECK_INSTANCE_TYPE((o), \
+                                                                  AG_TYPE_GEODATA_MODEL))
+#define AG_IS_GEODATA_MODEL_CLASS(k)  (G_TYPE_CHECK_CLASS_TYPE((k), \
+                                                               AG_TYPE_GEODATA_MODEL))
+#define AG_GEODATA_MODEL_GET_CLASS(o) (G_TYPE_INSTANCE_GET_CLASS((o), \
+                                                                 AG_TYPE_GEODATA_MODEL, \
+                                                                 AgGeodataModelClass))
+
+typedef struct _AgGeodataModel      AgGeodataModel;
+typedef struct _AgGeodataModelClass AgGeodataModelClass;
+
+struct _AgGeodataModel {
+    GObject parent_instance;
+};
+
+struct _AgGeodataModelClass {
+    GObjectClass parent_class;
+};
+
+typedef struct _AgGeodata AgGeodata;
+
+typedef enum {
+    AG_GEODATA_ERROR_CORRUPT,
+    AG_GEODATA_ERROR_VERSION,
+} AgGeodataError;
+
+#define AG_GEODATA_ERROR (ag_geodata_error_quark())
+GQuark ag_geodata_error_quark(void);
+
+GType ag_geodata_model_get_type(void) G_GNUC_CONST;
+
+AgGeodata *ag_geodata_open(const gchar *filename, GError **err);
+
+void ag_geodata_free(AgGeodata *geodata);
+
+guint ag_geodata_get_country_count(AgGeodata *geodata);
+
+guint ag_geodata_get_city_count(AgGeodata *geodata);
+
+const gchar *ag_geodata_country_get_code(AgGeodata *geodata, guint country);
+
+const gchar *ag_geodata_country_get_name(AgGeodata *geodata, guint country);
+
+const gchar *ag_geodata_city_get_name(AgGeodata *geodata, guint city);
+
+const gchar *ag_geodata_city_get_country(AgGeodata *geodata, guint city);
+
+void ag_geodata_city_get_position(AgGeodata *geodata,
+                                  guint     city,
+                                  gdouble   *latitude,
+                                  gdouble   *longitude,
+                                  gdouble   *altitude,
+                                  gdouble   *tz_offset,
+                                  gdouble   *tz_dst_offset);
+
+guint ag_geodata_find_cities(AgGeodata   *geodata,
+                             const gchar *country_code,
+                             const gchar *prefix,
+                             guint       max_results,
+                             guint       *results);
+
+gint ag_geodata_lookup_city(AgGeodata   *geodata,
+                            const gchar *country_code,
+                            const gchar *name);
+
+GtkTreeModel *ag_geodata_get_country_model(AgGeodata *geodata);
+
+GtkTreeModel *ag_geodata_get_city_model(AgGeodata *geodata);
+
+G_END_DECLS
+
+#endif /* __AG_GEODATA_H__ */
@@ -7,19 +7,47 @@
 #include "ag-display-theme.h"
 #include "ag-chart.h"
 
+#include "ag-settings.h"
+#include "ag-trace.h"
+
+#define AG_ICON_VIEW_PREVIEW_BATCH_INTERVAL 100
+
 typedef struct _AgIconViewPrivate {
     AgIconViewMode  mode;
     AgChartRenderer *thumb_renderer;
     GtkCellRenderer *text_renderer;
     GtkListStore    *model;
+    GHashTable      *rows;
+    AgDb            *db;
+
+    GThreadPool     *preview_pool;
+    GAsyncQueue     *preview_results;
+    GCancellable    *preview_cancellable;
+    AgDisplayTheme  *preview_theme;
+    guint           preview_batch_id;
+    guint           previews_total;
+    guint           previews_done;
 } AgIconViewPrivate;
 
+typedef struct {
+    AgDbChartSave   *save_data;
+    GsweHouseSystem house_system;
+    GCancellable    *cancellable;
+    GdkPixbuf       *pixbuf;
+} AgIconViewPreviewJob;
+
 enum {
     PROP_0,
     PROP_MODE,
+    PROP_PREVIEW_WORKERS,
     PROP_LAST
 };
 
+enum {
+    SIGNAL_PREVIEW_PROGRESS,
+    SIGNAL_COUNT
+};
+
 enum {
     AG_ICON_VIEW_COLUMN_SELECTED,
     AG_ICON_VIEW_COLUMN_ITEM,
@@ -30,6 +58,7 @@ enum {
 G_DEFINE_TYPE_WITH_PRIVATE(AgIconView, ag_icon_view, GTK_TYPE_ICON_VIEW);
 
 static GParamSpec *properties[PROP_LAST];
+static guint      signals[SIGNAL_COUNT];
 
 void
 ag_icon_view_set_mode(AgIconView *icon_view, AgIconViewMode mode)
@@ -67,6 +96,35 @@ ag_icon_view_get_mode(AgIconView *icon_view)
     return priv->mode;
 }
 
+/**
+ * ag_icon_view_set_preview_workers:
+ * @icon_view: the #AgIconView to operate on
+ * @workers: the number of threads generating previews, or 0 to use one
+ *           thread per processor
+ *
+ * Set the number of worker threads used to generate chart previews.
+ */
+void
+ag_icon_view_set_preview_workers(AgIconView *icon_view, guint workers)
+{
+    AgIconViewPrivate *priv = ag_icon_view_get_instance_private(icon_view);
+
+    if (workers == 0) {
+        workers = g_get_num_processors();
+    }
+
+    if (workers == g_thread_pool_get_max_threads(priv->preview_pool)) {
+        return;
+    }
+
+    g_thread_pool_set_max_threads(priv->preview_pool, workers, NULL);
+
+    g_object_notify_by_pspec(
+            G_OBJECT(icon_view),
+            properties[PROP_PREVIEW_WORKERS]
+        );
+}
+
 static void
 ag_icon_view_set_property(GObject      *gobject,
                           guint        prop_id,
@@ -82,6 +140,14 @@ ag_icon_view_set_property(GObject      *gobject,
 
             break;
 
+        case PROP_PREVIEW_WORKERS:
+            ag_icon_view_set_preview_workers(
+                    AG_ICON_VIEW(gobject),
+                    g_value_get_uint(value)
+                );
+
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(gobject, prop_id, param_spec);
 
@@ -105,6 +171,14 @@ ag_icon_view_get_property(GObject    *gobject,
 
             break;
 
+        case PROP_PREVIEW_WORKERS:
+            g_value_set_uint(
+                    value,
+                    g_thread_pool_get_max_threads(priv->preview_pool)
+                );
+
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(gobject, prop_id, param_spec);
 
@@ -176,12 +250,207 @@ ag_icon_view_button_press_event_cb(GtkWidget      *widget,
     return FALSE;
 }
 
+static void
+ag_icon_view_preview_job_free(AgIconViewPreviewJob *job)
+{
+    ag_db_chart_save_unref(job->save_data);
+    g_clear_object(&(job->cancellable));
+    g_clear_object(&(job->pixbuf));
+    g_free(job);
+}
+
+/*
+ * ag_icon_view_preview_worker:
+ *
+ * Runs in a worker thread. Generates (or loads from the cache) the preview
+ * of a chart, and queues the result for the main thread.
+ */
+static void
+ag_icon_view_preview_worker(AgIconViewPreviewJob *job, AgIconView *icon_view)
+{
+    AgIconViewPrivate *priv = ag_icon_view_get_instance_private(icon_view);
+    GError            *err  = NULL;
+
+    if (!g_cancellable_is_cancelled(job->cancellable)) {
+        if ((job->pixbuf = ag_chart_get_preview_pixbuf(
+                    job->save_data,
+                    job->house_system,
+                    AG_CHART_RENDERER_TILE_SIZE,
+                    AG_CHART_RENDERER_ICON_SIZE,
+                    priv->preview_theme,
+                    &err
+                )) == NULL) {
+            g_warning(
+                    "Unable to generate preview for %s: %s",
+                    job->save_data->name,
+                    (err) ? err->message : "unknown error"
+                );
+            g_clear_error(&err);
+        }
+    }
+
+    g_async_queue_push(priv->preview_results, job);
+}
+
+/*
+ * ag_icon_view_deliver_previews:
+ *
+ * Runs in the main thread. Puts every finished preview into the model in one
+ * batch.
+ */
+static gboolean
+ag_icon_view_deliver_previews(AgIconView *icon_view)
+{
+    AgIconViewPrivate    *priv = ag_icon_view_get_instance_private(icon_view);
+    AgIconViewPreviewJob *job;
+    guint                delivered = 0;
+
+    while ((job = g_async_queue_try_pop(priv->preview_results)) != NULL) {
+        GtkTreeIter *iter;
+
+        // Jobs of a cancelled load are already accounted for
+        if (g_cancellable_is_cancelled(job->cancellable)) {
+            ag_icon_view_preview_job_free(job);
+
+            continue;
+        }
+
+        delivered++;
+
+        if ((iter = g_hash_table_lookup(
+                    priv->rows,
+                    GINT_TO_POINTER(job->save_data->db_id)
+                )) != NULL) {
+            AgDbChartSave *current;
+
+            gtk_tree_model_get(
+                    GTK_TREE_MODEL(priv->model), iter,
+                    AG_ICON_VIEW_COLUMN_ITEM, &current,
+                    -1
+                );
+
+            // If the chart data changed since this job was queued, a newer
+            // job is on its way, so drop this stale preview
+            if (ag_db_chart_save_identical(current, job->save_data, TRUE)) {
+                gtk_list_store_set(
+                        priv->model, iter,
+                        AG_ICON_VIEW_COLUMN_PIXBUF, job->pixbuf,
+                        -1
+                    );
+            }
+
+            ag_db_chart_save_unref(current);
+        }
+
+        ag_icon_view_preview_job_free(job);
+    }
+
+    if (delivered == 0) {
+        return G_SOURCE_CONTINUE;
+    }
+
+    priv->previews_done += delivered;
+
+    g_signal_emit(
+            icon_view,
+            signals[SIGNAL_PREVIEW_PROGRESS], 0,
+            priv->previews_done,
+            priv->previews_total
+        );
+
+    if (priv->previews_done < priv->previews_total) {
+        return G_SOURCE_CONTINUE;
+    }
+
+    g_debug("All %u previews are generated", priv->previews_total);
+
+    priv->previews_done    = 0;
+    priv->previews_total   = 0;
+    priv->preview_batch_id = 0;
+
+    return G_SOURCE_REMOVE;
+}
+
+/*
+ * ag_icon_view_cancel_previews:
+ *
+ * Cancel every pending preview generation. Jobs already running finish in the
+ * background, but their results are dropped.
+ */
+static void
+ag_icon_view_cancel_previews(AgIconView *icon_view)
+{
+    AgIconViewPrivate *priv = ag_icon_view_get_instance_private(icon_view);
+
+    if (priv->preview_cancellable) {
+        g_cancellable_cancel(priv->preview_cancellable);
+        g_object_unref(priv->preview_cancellable);
+    }
+
+    priv->preview_cancellable = g_cancellable_new();
+
+    if (priv->preview_batch_id != 0) {
+        g_source_remove(priv->preview_batch_id);
+        priv->preview_batch_id = 0;
+    }
+
+    priv->previews_total = 0;
+    priv->previews_done  = 0;
+}
+
+static void
+ag_icon_view_dispose(GObject *gobject)
+{
+    AgIconView           *icon_view = AG_ICON_VIEW(gobject);
+    AgIconViewPrivate    *priv      = ag_icon_view_get_instance_private(
+            icon_view
+        );
+    AgIconViewPreviewJob *job;
+
+    if (priv->preview_pool) {
+        ag_icon_view_cancel_previews(icon_view);
+
+        // Every queued job sees the cancellation and returns immediately, so
+        // this only waits for the previews being rendered right now
+        g_thread_pool_free(priv->preview_pool, FALSE, TRUE);
+        priv->preview_pool = NULL;
+
+        while ((job = g_async_queue_try_pop(priv->preview_results)) != NULL) {
+            ag_icon_view_preview_job_free(job);
+        }
+    }
+
+    g_clear_object(&(priv->preview_cancellable));
+
+    if (priv->db) {
+        g_signal_handlers_disconnect_by_data(priv->db, icon_view);
+        g_clear_object(&(priv->db));
+    }
+
+    G_OBJECT_CLASS(ag_icon_view_parent_class)->dispose(gobject);
+}
+
+static void
+ag_icon_view_finalize(GObject *gobject)
+{
+    AgIconViewPrivate *priv = ag_icon_view_get_instance_private(
+            AG_ICON_VIEW(gobject)
+        );
+
+    g_async_queue_unref(priv->preview_results);
+    g_hash_table_destroy(priv->rows);
+
+    G_OBJECT_CLASS(ag_icon_view_parent_class)->finalize(gobject);
+}
+
 static void
 ag_icon_view_class_init(AgIconViewClass *klass)
 {
     GObjectClass     *gobject_class   = G_OBJECT_CLASS(klass);
     GtkWidgetClass   *widget_class    = GTK_WIDGET_CLASS(klass);
 
+    gobject_class->dispose      = ag_icon_view_dispose;
+    gobject_class->finalize     = ag_icon_view_finalize;
     gobject_class->set_property = ag_icon_view_set_property;
     gobject_class->get_property = ag_icon_view_get_property;
     widget_class->button_press_event = ag_icon_view_button_press_event_cb;
@@ -203,6 +472,40 @@ ag_icon_view_class_init(AgIconViewClass *klass)
             PROP_MODE,
             properties[PROP_MODE]
         );
+
+    properties[PROP_PREVIEW_WORKERS] = g_param_spec_uint(
+            "preview-workers",
+            "Preview workers",
+            "Number of threads generating chart previews (0 means one per processor)",
+            0, G_MAXINT, 0,
+            G_PARAM_STATIC_NAME
+                | G_PARAM_STATIC_NICK
+                | G_PARAM_STATIC_BLURB
+                | G_PARAM_READABLE
+                | G_PARAM_WRITABLE
+        );
+    g_object_class_install_property(
+            gobject_class,
+            PROP_PREVIEW_WORKERS,
+            properties[PROP_PREVIEW_WORKERS]
+        );
+
+    /**
+     * AgIconView::preview-progress:
+     * @icon_view: the #AgIconView that emitted the signal
+     * @done: the number of previews generated so far
+     * @total: the number of previews requested
+     *
+     * Emitted every time a batch of previews is put into the view.
+     */
+    signals[SIGNAL_PREVIEW_PROGRESS] = g_signal_new(
+            "preview-progress",
+            G_TYPE_FROM_CLASS(klass),
+            G_SIGNAL_RUN_FIRST,
+            0, NULL, NULL,
+            g_cclosure_marshal_generic, G_TYPE_NONE, 2,
+            G_TYPE_UINT, G_TYPE_UINT
+        );
 }
 
 static void
@@ -225,6 +528,44 @@ ag_icon_view_text_renderer_func(GtkCellLayout   *layout,
     }
 }
 
+static void
+ag_icon_view_chart_inserted_cb(AgDb       *db,
+                               gint       db_id,
+                               AgIconView *icon_view)
+{
+    AgDbChartSave *save_data;
+
+    if ((save_data = ag_db_chart_get_data_by_id(db, db_id, NULL)) == NULL) {
+        return;
+    }
+
+    ag_icon_view_add_chart(icon_view, save_data);
+    ag_db_chart_save_unref(save_data);
+}
+
+static void
+ag_icon_view_chart_updated_cb(AgDb       *db,
+                              gint       db_id,
+                              AgIconView *icon_view)
+{
+    AgDbChartSave *save_data;
+
+    if ((save_data = ag_db_chart_get_data_by_id(db, db_id, NULL)) == NULL) {
+        return;
+    }
+
+    ag_icon_view_update_chart(icon_view, save_data);
+    ag_db_chart_save_unref(save_data);
+}
+
+static void
+ag_icon_view_chart_deleted_cb(AgDb       *db,
+                              gint       db_id,
+                              AgIconView *icon_view)
+{
+    ag_icon_view_remove_chart(icon_view, db_id);
+}
+
 static void
 ag_icon_view_init(AgIconView *icon_view)
 {
@@ -242,6 +583,14 @@ ag_icon_view_init(AgIconView *icon_view)
             GTK_ICON_VIEW(icon_view),
             GTK_TREE_MODEL(priv->model)
         );
+    // List store iters stay valid as long as their row exists, so they
+    // serve as row handles without the O(n) bookkeeping of row references
+    priv->rows = g_hash_table_new_full(
+            g_direct_hash,
+            g_direct_equal,
+            NULL,
+            (GDestroyNotify)gtk_tree_iter_free
+        );
 
     gtk_icon_view_set_selection_mode(
             GTK_ICON_VIEW(icon_view),
@@ -249,6 +598,37 @@ ag_icon_view_init(AgIconView *icon_view)
         );
     priv->mode = AG_ICON_VIEW_MODE_NORMAL;
 
+    priv->preview_theme   = ag_display_theme_get_preview_theme();
+    priv->preview_results = g_async_queue_new();
+    priv->preview_pool    = g_thread_pool_new(
+            (GFunc)ag_icon_view_preview_worker,
+            icon_view,
+            g_get_num_processors(),
+            FALSE,
+            NULL
+        );
+    ag_icon_view_cancel_previews(icon_view);
+
+    priv->db = ag_db_get();
+    g_signal_connect(
+            priv->db,
+            "chart-inserted",
+            G_CALLBACK(ag_icon_view_chart_inserted_cb),
+            icon_view
+        );
+    g_signal_connect(
+            priv->db,
+            "chart-updated",
+            G_CALLBACK(ag_icon_view_chart_updated_cb),
+            icon_view
+        );
+    g_signal_connect(
+            priv->db,
+            "chart-deleted",
+            G_CALLBACK(ag_icon_view_chart_deleted_cb),
+            icon_view
+        );
+
     gtk_icon_view_set_item_padding(GTK_ICON_VIEW(icon_view), 0);
     gtk_icon_view_set_margin(GTK_ICON_VIEW(icon_view), 12);
 
@@ -311,55 +691,222 @@ ag_icon_view_init(AgIconView *icon_view)
         );
 }
 
-void
-ag_icon_view_add_chart(AgIconView *icon_view, AgDbChartSave *chart_save)
+/**
+ * ag_icon_view_has_pending_previews:
+ * @icon_view: the #AgIconView to operate on
+ *
+ * Returns: %TRUE if there are charts in the view with their preview still
+ *          being generated
+ */
+gboolean
+ag_icon_view_has_pending_previews(AgIconView *icon_view)
 {
-    GtkTreeIter       iter;
-    AgChart           *chart;
-    AgIconViewPrivate *priv      = ag_icon_view_get_instance_private(icon_view);
-    AgDisplayTheme    *theme     = ag_display_theme_get_preview_theme();
-    AgDbChartSave     *save_data = chart_save;
-    AgDb              *db        = ag_db_get();
-    GdkPixbuf         *pixbuf    = NULL;
+    AgIconViewPrivate *priv = ag_icon_view_get_instance_private(icon_view);
 
-    g_debug("Adding chart for %s", chart_save->name);
+    return (priv->previews_total > 0);
+}
 
-    if (!chart_save->populated) {
-        save_data = ag_db_chart_get_data_by_id(
-                db,
-                chart_save->db_id,
-                NULL
+/*
+ * ag_icon_view_queue_preview:
+ *
+ * Queue the generation of the preview of @save_data for a worker thread.
+ */
+static void
+ag_icon_view_queue_preview(AgIconView *icon_view, AgDbChartSave *save_data)
+{
+    AgIconViewPrivate    *priv = ag_icon_view_get_instance_private(
+            icon_view
         );
-    } else {
-        save_data = ag_db_chart_save_ref(chart_save);
+    AgSettings           *settings;
+    AgIconViewPreviewJob *job;
+
+    // The settings object is not thread safe, so resolve the house system
+    // here
+    settings = ag_settings_get();
+
+    job               = g_new0(AgIconViewPreviewJob, 1);
+    job->save_data    = ag_db_chart_save_ref(save_data);
+    job->house_system = ag_settings_get_house_system(settings);
+    job->cancellable  = g_object_ref(priv->preview_cancellable);
+
+    g_object_unref(settings);
+
+    priv->previews_total++;
+
+    if (priv->preview_batch_id == 0) {
+        priv->preview_batch_id = g_timeout_add(
+                AG_ICON_VIEW_PREVIEW_BATCH_INTERVAL,
+                (GSourceFunc)ag_icon_view_deliver_previews,
+                icon_view
+            );
+    }
+
+    g_thread_pool_push(priv->preview_pool, job, NULL);
+}
+
+/*
+ * ag_icon_view_populate:
+ *
+ * Returns: (transfer full): the populated version of @chart_save, or NULL if
+ *          the chart doesn’t exist in the database
+ */
+static AgDbChartSave *
+ag_icon_view_populate(AgDbChartSave *chart_save)
+{
+    AgDbChartSave *save_data;
+    AgDb          *db;
+
+    if (chart_save->populated) {
+        return ag_db_chart_save_ref(chart_save);
     }
 
+    db        = ag_db_get();
+    save_data = ag_db_chart_get_data_by_id(db, chart_save->db_id, NULL);
     g_object_unref(db);
 
-    chart = ag_chart_new_from_db_save(
-            save_data,
-            TRUE,
-            NULL
-        );
+    return save_data;
+}
 
-    pixbuf = ag_chart_get_pixbuf(
-            chart,
-            AG_CHART_RENDERER_TILE_SIZE,
-            AG_CHART_RENDERER_ICON_SIZE,
-            theme,
-            NULL
-        );
+/**
+ * ag_icon_view_add_chart:
+ * @icon_view: the #AgIconView to operate on
+ * @chart_save: the chart to add
+ *
+ * Add a chart to the view. The chart is added without a preview image, which
+ * is generated in a worker thread and put into the view later. If the chart
+ * is already in the view, it gets updated instead.
+ */
+void
+ag_icon_view_add_chart(AgIconView *icon_view, AgDbChartSave *chart_save)
+{
+    GtkTreeIter       iter;
+    AgIconViewPrivate *priv = ag_icon_view_get_instance_private(icon_view);
+    AgDbChartSave     *save_data;
+    gint64            trace = ag_trace_begin();
+
+    g_debug("Adding chart for %s", chart_save->name);
+
+    if ((save_data = ag_icon_view_populate(chart_save)) == NULL) {
+        return;
+    }
+
+    if (g_hash_table_contains(
+                priv->rows,
+                GINT_TO_POINTER(save_data->db_id)
+            )) {
+        ag_icon_view_update_chart(icon_view, save_data);
+        ag_db_chart_save_unref(save_data);
+        ag_trace_end(AG_TRACE_ICON_VIEW_ADD_CHART, trace);
 
-    g_object_unref(chart);
+        return;
+    }
 
     gtk_list_store_append(priv->model, &iter);
     gtk_list_store_set(
             priv->model, &iter,
             AG_ICON_VIEW_COLUMN_SELECTED, FALSE,
             AG_ICON_VIEW_COLUMN_ITEM,     save_data,
-            AG_ICON_VIEW_COLUMN_PIXBUF,   pixbuf,
+            AG_ICON_VIEW_COLUMN_PIXBUF,   NULL,
             -1
         );
+
+    g_hash_table_replace(
+            priv->rows,
+            GINT_TO_POINTER(save_data->db_id),
+            gtk_tree_iter_copy(&iter)
+        );
+
+    ag_icon_view_queue_preview(icon_view, save_data);
+    ag_db_chart_save_unref(save_data);
+    ag_trace_end(AG_TRACE_ICON_VIEW_ADD_CHART, trace);
+}
+
+/**
+ * ag_icon_view_update_chart:
+ * @icon_view: the #AgIconView to operate on
+ * @chart_save: the new version of a chart
+ *
+ * Replace the chart with the same database ID as @chart_save. The preview is
+ * regenerated only if the chart data changed; changing only the name or the
+ * note of a chart keeps the current preview. If the chart is not in the view
+ * yet, it gets added.
+ */
+void
+ag_icon_view_update_chart(AgIconView *icon_view, AgDbChartSave *chart_save)
+{
+    GtkTreeIter       *iter;
+    AgIconViewPrivate *priv = ag_icon_view_get_instance_private(icon_view);
+    AgDbChartSave     *save_data,
+                      *old_save;
+
+    if ((iter = g_hash_table_lookup(
+                priv->rows,
+                GINT_TO_POINTER(chart_save->db_id)
+            )) == NULL) {
+        ag_icon_view_add_chart(icon_view, chart_save);
+
+        return;
+    }
+
+    if ((save_data = ag_icon_view_populate(chart_save)) == NULL) {
+        return;
+    }
+
+    g_debug("Updating chart for %s", save_data->name);
+
+    gtk_tree_model_get(
+            GTK_TREE_MODEL(priv->model), iter,
+            AG_ICON_VIEW_COLUMN_ITEM, &old_save,
+            -1
+        );
+    gtk_list_store_set(
+            priv->model, iter,
+            AG_ICON_VIEW_COLUMN_ITEM, save_data,
+            -1
+        );
+
+    // The old preview stays visible until the new one is ready
+    if (!ag_db_chart_save_identical(old_save, save_data, TRUE)) {
+        ag_icon_view_queue_preview(icon_view, save_data);
+    }
+
+    ag_db_chart_save_unref(old_save);
+    ag_db_chart_save_unref(save_data);
+}
+
+/**
+ * ag_icon_view_remove_chart:
+ * @icon_view: the #AgIconView to operate on
+ * @db_id: the database ID of the chart to remove
+ *
+ * Remove a chart from the view. Nothing happens if the chart is not in the
+ * view.
+ */
+void
+ag_icon_view_remove_chart(AgIconView *icon_view, gint db_id)
+{
+    GtkTreeIter       *iter;
+    gboolean          selected;
+    AgIconViewPrivate *priv = ag_icon_view_get_instance_private(icon_view);
+
+    if ((iter = g_hash_table_lookup(
+                priv->rows,
+                GINT_TO_POINTER(db_id)
+            )) == NULL) {
+        return;
+    }
+
+    gtk_tree_model_get(
+            GTK_TREE_MODEL(priv->model), iter,
+            AG_ICON_VIEW_COLUMN_SELECTED, &selected,
+            -1
+        );
+    gtk_list_store_remove(priv->model, iter);
+    g_hash_table_remove(priv->rows, GINT_TO_POINTER(db_id));
+
+    if (selected) {
+        ag_icon_view_selection_changed(icon_view);
+    }
 }
 
 static gboolean
@@ -373,12 +920,20 @@ ag_icon_view_check_selected(GtkTreeModel *model,
     gtk_tree_model_get(model, iter, AG_ICON_VIEW_COLUMN_SELECTED, &selected, -1);
 
     if (selected) {
-        *list = g_list_prepend(*list, path);
+        *list = g_list_prepend(*list, gtk_tree_path_copy(path));
     }
 
     return FALSE;
 }
 
+/**
+ * ag_icon_view_get_selected_items:
+ * @icon_view: the #AgIconView to operate on
+ *
+ * Returns: (transfer full) (element-type GtkTreePath): the paths of the
+ *          selected charts. Free with g_list_free_full() and
+ *          gtk_tree_path_free().
+ */
 GList *
 ag_icon_view_get_selected_items(AgIconView *icon_view)
 {
@@ -462,14 +1017,27 @@ ag_icon_view_remove_selected(AgIconView *icon_view)
           *l;
 
     for (l = paths; l; l = g_list_next(l)) {
-        GtkTreeIter iter;
-        GtkTreePath *path = l->data;
+        GtkTreeIter   iter;
+        GtkTreePath   *path = l->data;
+        AgDbChartSave *save_data;
 
         if (gtk_tree_model_get_iter(GTK_TREE_MODEL(priv->model), &iter, path)) {
+            gtk_tree_model_get(
+                    GTK_TREE_MODEL(priv->model), &iter,
+                    AG_ICON_VIEW_COLUMN_ITEM, &save_data,
+                    -1
+                );
             gtk_list_store_remove(priv->model, &iter);
+            g_hash_table_remove(
+                    priv->rows,
+                    GINT_TO_POINTER(save_data->db_id)
+                );
+            ag_db_chart_save_unref(save_data);
         }
     }
 
+    g_list_free_full(paths, (GDestroyNotify)gtk_tree_path_free);
+
     ag_icon_view_selection_changed(icon_view);
 }
 
@@ -478,5 +1046,7 @@ ag_icon_view_remove_all(AgIconView *icon_view)
 {
     AgIconViewPrivate *priv = ag_icon_view_get_instance_private(icon_view);
 
+    ag_icon_view_cancel_previews(icon_view);
+    g_hash_table_remove_all(priv->rows);
     gtk_list_store_clear(priv->model);
 }
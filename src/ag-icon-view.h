@@ -52,8 +52,17 @@ void ag_icon_view_set_mode(AgIconView *icon_view, AgIconViewMode mode);
 
 AgIconViewMode ag_icon_view_get_mode(AgIconView *icon_view);
 
+void ag_icon_view_set_preview_workers(AgIconView *icon_view, guint workers);
+
 void ag_icon_view_add_chart(AgIconView *icon_view, AgDbChartSave *chart_save);
 
+void ag_icon_view_update_chart(AgIconView    *icon_view,
+                               AgDbChartSave *chart_save);
+
+void ag_icon_view_remove_chart(AgIconView *icon_view, gint db_id);
+
+gboolean ag_icon_view_has_pending_previews(AgIconView *icon_view);
+
 GList *ag_icon_view_get_selected_items(AgIconView *icon_view);
 
 AgDbChartSave *ag_icon_view_get_chart_save_at_path(AgIconView *icon_view,
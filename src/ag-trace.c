@@ -0,0 +1,282 @@
+/* ag-trace.c - Render pipeline tracing for Astrognome
+ *
+ * Copyright (C) 2014 Polonkai Gergely
+ *
+ * Astrognome is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Astrognome is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+#include <glib.h>
+
+#include "ag-trace.h"
+
+// The time of the traced sections is stored in a ring buffer, so only the
+// last AG_TRACE_BUFFER_SIZE events are kept, and memory use doesn’t grow
+// however long the application runs. Histograms are only made from the
+// buffer when they are requested. The number and the total time of the
+// events of each section are also summed, for benchmarks that run more
+// events than the buffer can hold.
+
+#define AG_TRACE_BUFFER_SIZE 8192
+
+// Events are sorted into buckets by the binary logarithm of their length in
+// microseconds; the last bucket holds everything longer than ~4 seconds
+#define AG_TRACE_BUCKET_COUNT 23
+
+#define AG_TRACE_BAR_WIDTH 40
+
+typedef struct {
+    AgTraceMark mark;
+    gint64      start;
+    gint64      duration;
+} AgTraceEvent;
+
+static const gchar *mark_names[AG_TRACE_MARK_COUNT] = {
+    "chart layout (swe-glib)",
+    "ag_chart_create_svg",
+    "XML tree building",
+    "stylesheet parsing (libxslt)",
+    "XSLT transformation (libxslt)",
+    "SVG serialization (libxml2)",
+    "SVG rasterization (librsvg)",
+    "ag_chart_get_pixbuf (cairo)",
+    "preview image",
+    "ag_icon_view_add_chart",
+    "database query (GDA)",
+    "geodata loading",
+    "geodata index building",
+};
+
+volatile gint       ag_trace_enabled = FALSE;
+static GMutex       trace_lock;
+static AgTraceEvent *trace_events    = NULL;
+static guint64      trace_position   = 0;
+static guint        trace_counts[AG_TRACE_MARK_COUNT];
+static gint64       trace_totals[AG_TRACE_MARK_COUNT];
+
+/**
+ * ag_trace_end:
+ * @mark: the traced section
+ * @start: the return value of ag_trace_begin()
+ *
+ * Record the time spent in a traced section. Does nothing if tracing was
+ * disabled when the section started.
+ */
+void
+ag_trace_end(AgTraceMark mark, gint64 start)
+{
+    AgTraceEvent *event;
+    gint64       end;
+
+    if (G_LIKELY(start == 0)) {
+        return;
+    }
+
+    end = g_get_monotonic_time();
+
+    g_mutex_lock(&trace_lock);
+
+    if (trace_events == NULL) {
+        trace_events = g_new0(AgTraceEvent, AG_TRACE_BUFFER_SIZE);
+    }
+
+    event           = &(trace_events[trace_position % AG_TRACE_BUFFER_SIZE]);
+    event->mark     = mark;
+    event->start    = start;
+    event->duration = end - start;
+    trace_position++;
+
+    trace_counts[mark]++;
+    trace_totals[mark] += event->duration;
+
+    g_mutex_unlock(&trace_lock);
+}
+
+/**
+ * ag_trace_set_enabled:
+ * @enabled: %TRUE to record the time of the traced sections
+ *
+ * Turn tracing on or off. Tracing is off by default, unless the
+ * ASTROGNOME_TRACE environment variable is set.
+ */
+void
+ag_trace_set_enabled(gboolean enabled)
+{
+    g_atomic_int_set(&ag_trace_enabled, enabled);
+}
+
+static guint
+ag_trace_get_bucket(gint64 duration)
+{
+    guint bucket = 0;
+
+    while ((duration > 1) && (bucket < AG_TRACE_BUCKET_COUNT - 1)) {
+        duration >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+/**
+ * ag_trace_get_histograms:
+ *
+ * Create a histogram of the lengths of each traced section, from the events
+ * still in the trace buffer.
+ *
+ * Returns: (transfer full): the histograms as human readable text
+ */
+gchar *
+ag_trace_get_histograms(void)
+{
+    GString *text = g_string_new(NULL);
+    guint   counts[AG_TRACE_MARK_COUNT][AG_TRACE_BUCKET_COUNT] = { { 0 } },
+            n_events[AG_TRACE_MARK_COUNT]                      = { 0 },
+            count,
+            mark,
+            bucket,
+            i;
+    gint64  min[AG_TRACE_MARK_COUNT],
+            max[AG_TRACE_MARK_COUNT]   = { 0 },
+            total[AG_TRACE_MARK_COUNT] = { 0 };
+
+    g_mutex_lock(&trace_lock);
+
+    count = MIN(trace_position, AG_TRACE_BUFFER_SIZE);
+
+    for (i = 0; i < count; i++) {
+        AgTraceEvent *event = &(trace_events[i]);
+
+        if (n_events[event->mark] == 0) {
+            min[event->mark] = event->duration;
+        }
+
+        counts[event->mark][ag_trace_get_bucket(event->duration)]++;
+        n_events[event->mark]++;
+        min[event->mark]    = MIN(min[event->mark], event->duration);
+        max[event->mark]    = MAX(max[event->mark], event->duration);
+        total[event->mark] += event->duration;
+    }
+
+    g_string_append_printf(
+            text,
+            "Trace of the last %u events (%" G_GUINT64_FORMAT " in total)\n",
+            count,
+            trace_position
+        );
+
+    g_mutex_unlock(&trace_lock);
+
+    for (mark = 0; mark < AG_TRACE_MARK_COUNT; mark++) {
+        guint highest = 0;
+
+        if (n_events[mark] == 0) {
+            continue;
+        }
+
+        g_string_append_printf(
+                text,
+                "\n%s: %u events, min %.3f ms, avg %.3f ms, max %.3f ms\n",
+                mark_names[mark],
+                n_events[mark],
+                min[mark] / 1000.0,
+                total[mark] / 1000.0 / n_events[mark],
+                max[mark] / 1000.0
+            );
+
+        for (bucket = 0; bucket < AG_TRACE_BUCKET_COUNT; bucket++) {
+            highest = MAX(highest, counts[mark][bucket]);
+        }
+
+        for (bucket = 0; bucket < AG_TRACE_BUCKET_COUNT; bucket++) {
+            guint width;
+
+            if (counts[mark][bucket] == 0) {
+                continue;
+            }
+
+            width = (counts[mark][bucket] * AG_TRACE_BAR_WIDTH + highest - 1)
+                / highest;
+
+            if (bucket < AG_TRACE_BUCKET_COUNT - 1) {
+                g_string_append_printf(
+                        text,
+                        "  %9.3f – %9.3f ms %7u ",
+                        (bucket == 0) ? 0.0 : (1 << bucket) / 1000.0,
+                        (2 << bucket) / 1000.0,
+                        counts[mark][bucket]
+                    );
+            } else {
+                g_string_append_printf(
+                        text,
+                        "  %9.3f ms and up   %7u ",
+                        (1 << bucket) / 1000.0,
+                        counts[mark][bucket]
+                    );
+            }
+
+            for (i = 0; i < width; i++) {
+                g_string_append_c(text, '#');
+            }
+
+            g_string_append_c(text, '\n');
+        }
+    }
+
+    return g_string_free(text, FALSE);
+}
+
+/**
+ * ag_trace_get_totals:
+ * @mark: the traced section to query
+ * @count: (out) (allow-none): the number of times @mark was traced
+ * @elapsed: (out) (allow-none): the total time spent in @mark, in
+ *           microseconds
+ *
+ * Get the number and the total time of the events of a traced section since
+ * the last ag_trace_clear() call, including those already dropped from the
+ * trace buffer.
+ */
+void
+ag_trace_get_totals(AgTraceMark mark, guint *count, gint64 *elapsed)
+{
+    g_return_if_fail(mark < AG_TRACE_MARK_COUNT);
+
+    g_mutex_lock(&trace_lock);
+
+    if (count != NULL) {
+        *count = trace_counts[mark];
+    }
+
+    if (elapsed != NULL) {
+        *elapsed = trace_totals[mark];
+    }
+
+    g_mutex_unlock(&trace_lock);
+}
+
+/**
+ * ag_trace_clear:
+ *
+ * Drop all recorded events, and zero the totals.
+ */
+void
+ag_trace_clear(void)
+{
+    g_mutex_lock(&trace_lock);
+    trace_position = 0;
+    memset(trace_counts, 0, sizeof(trace_counts));
+    memset(trace_totals, 0, sizeof(trace_totals));
+    g_mutex_unlock(&trace_lock);
+}
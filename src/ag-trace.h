@@ -0,0 +1,72 @@
+/* ag-trace.h - Render pipeline tracing for Astrognome
+ *
+ * Copyright (C) 2014 Polonkai Gergely
+ *
+ * Astrognome is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Astrognome is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef __AG_TRACE_H__
+#define __AG_TRACE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef enum {
+    AG_TRACE_CHART_LAYOUT,
+    AG_TRACE_CHART_CREATE_SVG,
+    AG_TRACE_CHART_TREE,
+    AG_TRACE_CHART_STYLESHEET,
+    AG_TRACE_CHART_XSLT,
+    AG_TRACE_CHART_SERIALIZE,
+    AG_TRACE_CHART_RSVG,
+    AG_TRACE_CHART_GET_PIXBUF,
+    AG_TRACE_CHART_PREVIEW,
+    AG_TRACE_ICON_VIEW_ADD_CHART,
+    AG_TRACE_DB_SELECT,
+    AG_TRACE_GEODATA_OPEN,
+    AG_TRACE_GEODATA_INDEX,
+    AG_TRACE_MARK_COUNT
+} AgTraceMark;
+
+extern volatile gint ag_trace_enabled;
+
+/**
+ * ag_trace_begin:
+ *
+ * Start measuring a traced section. When tracing is disabled, this only
+ * reads a flag.
+ *
+ * Returns: the start time of the section to pass to ag_trace_end(), or 0 if
+ *          tracing is disabled
+ */
+static inline gint64
+ag_trace_begin(void)
+{
+    return (G_UNLIKELY(ag_trace_enabled)) ? g_get_monotonic_time() : 0;
+}
+
+void ag_trace_end(AgTraceMark mark, gint64 start);
+
+void ag_trace_set_enabled(gboolean enabled);
+
+gchar *ag_trace_get_histograms(void);
+
+void ag_trace_get_totals(AgTraceMark mark, guint *count, gint64 *elapsed);
+
+void ag_trace_clear(void);
+
+G_END_DECLS
+
+#endif /* __AG_TRACE_H__ */
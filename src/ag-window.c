@@ -21,7 +21,6 @@
 #include <glib/gi18n.h>
 #include <libxml/parser.h>
 #include <libxml/tree.h>
-#include <webkit2/webkit2.h>
 #include <gtk/gtk.h>
 
 #include <swe-glib.h>
@@ -30,6 +29,8 @@
 #include "ag-app.h"
 #include "ag-window.h"
 #include "ag-chart.h"
+#include "ag-chart-view.h"
+#include "ag-aspect-grid.h"
 #include "ag-settings.h"
 #include "ag-db.h"
 #include "ag-display-theme.h"
@@ -37,6 +38,8 @@
 #include "ag-chart-edit.h"
 #include "ag-header-bar.h"
 
+#define AG_WINDOW_EXPORT_PROGRESS_INTERVAL 100
+
 struct _AgWindowPrivate {
     AgHeaderBar   *header_bar;
     GtkWidget     *selection_toolbar;
@@ -52,21 +55,23 @@ struct _AgWindowPrivate {
     GtkWidget     *tab_edit;
     GtkWidget     *current_tab;
 
-    GtkWidget     *aspect_table;
-    WebKitWebView *chart_web_view;
+    AgAspectGrid  *aspect_grid;
+    AgChartView   *chart_view;
     GtkWidget     *points_eq;
 
     AgIconView    *chart_list;
     AgSettings    *settings;
     AgChart       *chart;
-    gboolean      aspect_table_populated;
     GtkListStore  *house_system_model;
     AgDbChartSave *saved_data;
-    GList         *style_sheets;
     AgDisplayTheme *theme;
     GtkListStore   *display_theme_model;
     gulong         chart_changed_handler;
-    WebKitUserContentManager *content_manager;
+    guint          load_id;
+    gboolean       chart_list_loaded;
+    guint          redraw_tick_id;
+    guint          redraws_done;
+    guint          redraws_skipped;
 };
 
 enum {
@@ -80,11 +85,36 @@ typedef struct {
     guint           load_state;
     guint           load_id;
     AgWindowPrivate *priv;
-    gint            n_items;
     gint            n_loaded;
-    GList           *items;
+    AgDbChartList   *items;
 } LoadIdleData;
 
+typedef struct {
+    AgWindow            *window;
+    GThreadPool         *pool;
+    GAsyncQueue         *results;
+    GCancellable        *cancellable;
+    GtkWidget           *dialog;
+    GtkProgressBar      *progress;
+    AgChartExportFormat format;
+    guint               image_size;
+    AgDisplayTheme      *theme;
+    GsweHouseSystem     house_system;
+    guint               progress_id;
+    guint               n_charts;
+    guint               n_done;
+    guint               n_exported;
+    gint64              start_time;
+    GString             *errors;
+} AgWindowExport;
+
+typedef struct {
+    AgDbChartSave *save_data;
+    GFile         *file;
+    gboolean      exported;
+    GError        *err;
+} AgWindowExportItem;
+
 enum {
     PROP_0,
     PROP_CHART,
@@ -99,419 +129,297 @@ static GParamSpec *properties[PROP_COUNT];
 
 #define GET_PRIV(o) AgWindowPrivate *priv = ag_window_get_instance_private((o))
 
-const gchar *
-ag_window_planet_character(GswePlanet planet)
-{
-    switch (planet) {
-        case GSWE_PLANET_ASCENDANT:
-            return "AC";
-
-        case GSWE_PLANET_MC:
-            return "MC";
-
-        case GSWE_PLANET_VERTEX:
-            return "Vx";
-
-        case GSWE_PLANET_SUN:
-            return "☉";
-
-        case GSWE_PLANET_MOON:
-            return "☽";
-
-        case GSWE_PLANET_MOON_NODE:
-            return "☊";
-
-        case GSWE_PLANET_MERCURY:
-            return "☿";
-
-        case GSWE_PLANET_VENUS:
-            return "♀";
-
-        case GSWE_PLANET_MARS:
-            return "♂";
+#define AG_WINDOW_LOAD_BATCH_SIZE 100
 
-        case GSWE_PLANET_JUPITER:
-            return "♃";
-
-        case GSWE_PLANET_SATURN:
-            return "♄";
-
-        case GSWE_PLANET_URANUS:
-            return "♅";
-
-        case GSWE_PLANET_NEPTUNE:
-            return "♆";
-
-        case GSWE_PLANET_PLUTO:
-            return "♇";
+/*
+ * ag_window_redraw_aspect_table:
+ * @window: the #AgWindow to operate on
+ * @layout: the layout of the chart
+ *
+ * Fill the aspect table from @layout, so swe-glib doesn’t have to calculate
+ * the chart again outside the ephemeris lock.
+ */
+static void
+ag_window_redraw_aspect_table(AgWindow *window, AgChartLayout *layout)
+{
+    GList      *planet_list,
+               *l;
+    guint      n_planets,
+               i,
+               j;
+    GswePlanet *planets;
+    GsweAspect *aspects;
+    GET_PRIV(window);
 
-        case GSWE_PLANET_CERES:
-            return "⚳";
+    planet_list = ag_chart_get_planets(priv->chart);
+    ag_aspect_grid_set_planets(priv->aspect_grid, planet_list);
 
-        case GSWE_PLANET_PALLAS:
-            return "⚴";
+    n_planets = g_list_length(planet_list);
+    planets   = g_new(GswePlanet, n_planets);
+    aspects   = g_new0(GsweAspect, n_planets * n_planets);
 
-        case GSWE_PLANET_JUNO:
-            return "⚵";
+    for (l = planet_list, i = 0; l; l = g_list_next(l), i++) {
+        planets[i] = GPOINTER_TO_INT(l->data);
+    }
 
-        case GSWE_PLANET_VESTA:
-            return "⚶";
+    for (i = 0; i < n_planets * n_planets; i++) {
+        aspects[i] = GSWE_ASPECT_NONE;
+    }
 
-        case GSWE_PLANET_CHIRON:
-            return "⚷";
+    // The layout lists only the real aspects, in no particular order
+    for (i = 0; i < layout->n_aspects; i++) {
+        AgChartLayoutAspect *aspect = &(layout->aspects[i]);
+        guint               planet1,
+                            planet2;
 
-        case GSWE_PLANET_MOON_APOGEE:
-            return "⚸";
+        for (planet1 = 0; planet1 < n_planets; planet1++) {
+            if (planets[planet1] == aspect->planet1) {
+                break;
+            }
+        }
 
-        default:
-            return NULL;
-    }
-}
+        for (planet2 = 0; planet2 < n_planets; planet2++) {
+            if (planets[planet2] == aspect->planet2) {
+                break;
+            }
+        }
 
-GtkWidget *
-ag_window_create_planet_widget(GswePlanetInfo *planet_info)
-{
-    const gchar *planet_char;
-    GswePlanet  planet    = gswe_planet_info_get_planet(planet_info);
-    GSettings   *settings = ag_settings_peek_main_settings(ag_settings_get());
+        if ((planet1 == n_planets) || (planet2 == n_planets)) {
+            continue;
+        }
 
-    if (
-            ((planet_char = ag_window_planet_character(planet)) != NULL)
-            && (g_settings_get_boolean(settings, "planets-char"))
-        )
-    {
-        return gtk_label_new(planet_char);
+        aspects[planet1 * n_planets + planet2] = aspect->aspect;
+        aspects[planet2 * n_planets + planet1] = aspect->aspect;
     }
 
-    switch (planet) {
-        case GSWE_PLANET_SUN:
-            return gtk_image_new_from_resource(
-                    "/eu/polonkai/gergely"
-                    "/Astrognome/default-icons/planet-sun.svg"
+    for (i = 0; i < n_planets; i++) {
+        for (j = 0; j < i; j++) {
+            ag_aspect_grid_set_aspect(
+                    priv->aspect_grid,
+                    i, j,
+                    aspects[i * n_planets + j]
                 );
-
-        default:
-            return gtk_label_new(gswe_planet_info_get_name(planet_info));
+        }
     }
+
+    g_free(aspects);
+    g_free(planets);
 }
 
-const gchar *
-ag_window_aspect_character(GsweAspect aspect)
+/*
+ * ag_window_get_sign_info:
+ * @layout: the layout of the chart
+ * @planet: a planet on the chart
+ *
+ * Get the sign @planet is in, using its position in @layout.
+ *
+ * Returns: (transfer none): the sign of @planet, or %NULL if it is not
+ *          on the chart
+ */
+static GsweSignInfo *
+ag_window_get_sign_info(AgChartLayout *layout, GswePlanet planet)
 {
-    switch (aspect) {
-        case GSWE_ASPECT_CONJUCTION:
-            return "☌";
-
-        case GSWE_ASPECT_OPPOSITION:
-            return "☍";
-
-        case GSWE_ASPECT_QUINTILE:
-            return "Q";
-
-        case GSWE_ASPECT_BIQUINTILE:
-            return "BQ";
-
-        case GSWE_ASPECT_SQUARE:
-            return "◽";
-
-        case GSWE_ASPECT_TRINE:
-            return "▵";
-
-        case GSWE_ASPECT_SEXTILE:
-            return "⚹";
+    gdouble position;
 
-        case GSWE_ASPECT_SEMISEXTILE:
-            return "⚺";
-
-        case GSWE_ASPECT_QUINCUNX:
-            return "⚻";
-
-        case GSWE_ASPECT_SESQUISQUARE:
-            return "⚼";
-
-        default:
-            return NULL;
+    if (!ag_chart_layout_get_position(layout, planet, &position)) {
+        return NULL;
     }
+
+    return gswe_find_sign_info_by_id(
+            (GsweZodiac)(fmod(position, 360.0) / 30.0) + GSWE_SIGN_ARIES,
+            NULL
+        );
 }
 
-GtkWidget *
-ag_window_create_aspect_widget(GsweAspectInfo *aspect_info)
+static void
+ag_window_set_points_label(AgWindow *window,
+                           guint    points,
+                           guint    left,
+                           guint    top)
 {
-    const gchar *aspect_char;
-    GsweAspect  aspect    = gswe_aspect_info_get_aspect(aspect_info);
-    GSettings   *settings = ag_settings_peek_main_settings(ag_settings_get());
+    GtkWidget *label;
+    gchar     *points_string;
+    GET_PRIV(window);
 
-    if (
-            ((aspect_char = ag_window_aspect_character(aspect)) != NULL)
-            && (g_settings_get_boolean(settings, "aspects-char"))
-        )
-    {
-        return gtk_label_new(aspect_char);
+    if ((label = gtk_grid_get_child_at(
+                GTK_GRID(priv->points_eq),
+                left, top
+            )) == NULL) {
+        label = gtk_label_new("");
+        gtk_grid_attach(GTK_GRID(priv->points_eq), label, left, top, 1, 1);
+        gtk_widget_show(label);
     }
 
-    switch (aspect) {
-        default:
-            return gtk_label_new(gswe_aspect_info_get_name(aspect_info));
-    }
+    points_string = g_strdup_printf("%d", points);
+    gtk_label_set_text(GTK_LABEL(label), points_string);
+    g_free(points_string);
 }
 
-void
-ag_window_redraw_aspect_table(AgWindow *window)
-{
-    GList           *planet_list,
-                    *planet1,
-                    *planet2;
-    guint           i,
-                    j;
+/*
+ * ag_window_set_element_point:
+ *
+ * Sum the points of the planets in the signs of @element, the same way
+ * gswe_moment_get_element_points() does, but from the chart layout.
+ */
+static void
+ag_window_set_element_point(AgWindow      *window,
+                            AgChartLayout *layout,
+                            GsweElement   element,
+                            guint         left,
+                            guint         top)
+{
+    guint points = 0;
+    GList *l;
     GET_PRIV(window);
 
-    planet_list = ag_chart_get_planets(priv->chart);
-
-    if (priv->aspect_table_populated == FALSE) {
-        GList *planet;
-        guint i;
+    for (l = ag_chart_get_planets(priv->chart); l; l = g_list_next(l)) {
+        GswePlanet   planet    = GPOINTER_TO_INT(l->data);
+        GsweSignInfo *sign_info = ag_window_get_sign_info(layout, planet);
 
-        for (
-                    planet = planet_list, i = 0;
-                    planet;
-                    planet = g_list_next(planet), i++
+        if (
+                    (sign_info != NULL)
+                    && (gswe_sign_info_get_element(sign_info) == element)
                 ) {
-            GtkWidget      *label_hor,
-                           *label_ver,
-                           *current_widget;
-            GswePlanet     planet_id;
-            GswePlanetData *planet_data;
-            GswePlanetInfo *planet_info;
-
-            planet_id = GPOINTER_TO_INT(planet->data);
-            planet_data = gswe_moment_get_planet(
-                    GSWE_MOMENT(priv->chart),
-                    planet_id,
-                    NULL
+            points += gswe_planet_info_get_points(
+                    gswe_find_planet_info_by_id(planet, NULL)
                 );
-            planet_info = gswe_planet_data_get_planet_info(planet_data);
-
-            if ((current_widget = gtk_grid_get_child_at(
-                        GTK_GRID(priv->aspect_table),
-                        i + 1, i
-                    )) != NULL) {
-                gtk_container_remove(
-                        GTK_CONTAINER(priv->aspect_table),
-                        current_widget
-                    );
-            }
-
-            label_hor = ag_window_create_planet_widget(planet_info);
-            gtk_grid_attach(
-                    GTK_GRID(priv->aspect_table),
-                    label_hor,
-                    i + 1, i,
-                    1, 1
-                );
-
-            if (i > 0) {
-                if ((current_widget = gtk_grid_get_child_at(
-                            GTK_GRID(priv->aspect_table),
-                            0, i
-                    )) != NULL) {
-                    gtk_container_remove(
-                            GTK_CONTAINER(priv->aspect_table),
-                            current_widget
-                        );
-                }
-
-                label_ver = ag_window_create_planet_widget(planet_info);
-                gtk_grid_attach(
-                        GTK_GRID(priv->aspect_table),
-                        label_ver,
-                        0, i,
-                        1, 1
-                    );
-            }
         }
-
-        priv->aspect_table_populated = TRUE;
     }
 
-    for (
-                planet1 = planet_list, i = 0;
-                planet1;
-                planet1 = g_list_next(planet1), i++
-            ) {
-        for (
-                    planet2 = planet_list, j = 0;
-                    planet2;
-                    planet2 = g_list_next(planet2), j++
-                ) {
-            GsweAspectData *aspect;
-            GtkWidget      *aspect_widget;
-            GError         *err = NULL;
+    ag_window_set_points_label(window, points, left, top);
+}
 
-            if (GPOINTER_TO_INT(planet1->data)
-                        == GPOINTER_TO_INT(planet2->data)
-                    ) {
-                break;
-            }
+static void
+ag_window_set_quality_point(AgWindow      *window,
+                            AgChartLayout *layout,
+                            GsweQuality   quality,
+                            guint         left,
+                            guint         top)
+{
+    guint points = 0;
+    GList *l;
+    GET_PRIV(window);
 
-            if ((aspect_widget = gtk_grid_get_child_at(
-                        GTK_GRID(priv->aspect_table),
-                        j + 1, i
-                    )) != NULL) {
-                gtk_container_remove(
-                        GTK_CONTAINER(priv->aspect_table),
-                        aspect_widget
-                    );
-            }
+    for (l = ag_chart_get_planets(priv->chart); l; l = g_list_next(l)) {
+        GswePlanet   planet    = GPOINTER_TO_INT(l->data);
+        GsweSignInfo *sign_info = ag_window_get_sign_info(layout, planet);
 
-            if ((aspect = gswe_moment_get_aspect_by_planets(
-                        GSWE_MOMENT(priv->chart),
-                        GPOINTER_TO_INT(planet1->data),
-                        GPOINTER_TO_INT(planet2->data),
-                        &err
-                    )) != NULL) {
-                GsweAspectInfo *aspect_info;
-
-                aspect_info   = gswe_aspect_data_get_aspect_info(aspect);
-
-                if (gswe_aspect_data_get_aspect(aspect) != GSWE_ASPECT_NONE) {
-                    aspect_widget = ag_window_create_aspect_widget(aspect_info);
-                    gtk_grid_attach(
-                            GTK_GRID(priv->aspect_table),
-                            aspect_widget,
-                            j + 1, i,
-                            1, 1
-                        );
-                }
-            } else if (err) {
-                g_warning("%s\n", err->message);
-            } else {
-                g_error(
-                        "No aspect is returned between two planets. " \
-                        "This is a bug in SWE-GLib!"
-                    );
-            }
+        if (
+                    (sign_info != NULL)
+                    && (gswe_sign_info_get_quality(sign_info) == quality)
+                ) {
+            points += gswe_planet_info_get_points(
+                    gswe_find_planet_info_by_id(planet, NULL)
+                );
         }
     }
 
-    gtk_widget_show_all(priv->aspect_table);
+    ag_window_set_points_label(window, points, left, top);
 }
 
 static void
-ag_window_set_element_point(AgWindow    *window,
-                            GsweElement element,
-                            guint       left,
-                            guint       top)
-{
-    guint            points;
-    GtkWidget        *label;
-    gchar            *points_string;
+ag_window_redraw_points_table(AgWindow *window, AgChartLayout *layout)
+{
+    ag_window_set_element_point(window, layout, GSWE_ELEMENT_FIRE, 4, 1);
+    ag_window_set_element_point(window, layout, GSWE_ELEMENT_EARTH, 4, 2);
+    ag_window_set_element_point(window, layout, GSWE_ELEMENT_AIR, 4, 3);
+    ag_window_set_element_point(window, layout, GSWE_ELEMENT_WATER, 4, 4);
+
+    ag_window_set_quality_point(window, layout, GSWE_QUALITY_CARDINAL, 1, 5);
+    ag_window_set_quality_point(window, layout, GSWE_QUALITY_FIX, 2, 5);
+    ag_window_set_quality_point(window, layout, GSWE_QUALITY_MUTABLE, 3, 5);
+}
+
+/**
+ * ag_window_redraw_chart:
+ * @window: the #AgWindow to operate on
+ *
+ * Redraw the chart on the chart view.
+ */
+void
+ag_window_redraw_chart(AgWindow *window)
+{
+    AgChartLayout *layout;
     GET_PRIV(window);
 
-    points = gswe_moment_get_element_points(
-            GSWE_MOMENT(priv->chart),
-            element
-        );
+    ag_chart_view_refresh(priv->chart_view);
 
-    if ((label = gtk_grid_get_child_at(
-                GTK_GRID(priv->points_eq),
-                left, top
-            )) == NULL) {
-        label = gtk_label_new("");
-        gtk_grid_attach(GTK_GRID(priv->points_eq), label, left, top, 1, 1);
-        gtk_widget_show(label);
+    if (priv->chart == NULL) {
+        return;
     }
 
-    points_string = g_strdup_printf("%d", points);
-    gtk_label_set_text(GTK_LABEL(label), points_string);
-    g_free(points_string);
+    // The tables are filled from the layout, as the ephemeris may only be
+    // used under the lock in ag-chart.c
+    layout = ag_chart_get_layout(priv->chart);
+    ag_window_redraw_aspect_table(window, layout);
+    ag_window_redraw_points_table(window, layout);
+    ag_chart_layout_free(layout);
 }
 
-static void
-ag_window_set_quality_point(AgWindow    *window,
-                            GsweQuality quality,
-                            guint       left,
-                            guint       top)
-{
-    guint            points;
-    GtkWidget        *label;
-    gchar            *points_string;
+static gboolean
+ag_window_redraw_tick_cb(GtkWidget     *widget,
+                         GdkFrameClock *frame_clock,
+                         gpointer      user_data)
+{
+    AgWindow *window = AG_WINDOW(widget);
     GET_PRIV(window);
 
-    points = gswe_moment_get_quality_points(
-            GSWE_MOMENT(priv->chart),
-            quality
-        );
+    priv->redraw_tick_id = 0;
+    priv->redraws_done++;
 
-    if ((label = gtk_grid_get_child_at(
-                GTK_GRID(priv->points_eq),
-                left, top
-            )) == NULL) {
-        label = gtk_label_new("");
-        gtk_grid_attach(GTK_GRID(priv->points_eq), label, left, top, 1, 1);
-        gtk_widget_show(label);
-    }
+    ag_window_redraw_chart(window);
 
-    points_string = g_strdup_printf("%d", points);
-    gtk_label_set_text(GTK_LABEL(label), points_string);
-    g_free(points_string);
+    return G_SOURCE_REMOVE;
 }
 
+/**
+ * ag_window_queue_redraw_chart:
+ * @window: the #AgWindow to operate on
+ *
+ * Redraw the chart, and the tables calculated from it, before the next frame
+ * is painted. Calls coming in before that are merged into the pending
+ * redraw, which uses the state of the chart at the time it runs, so a burst
+ * of changes costs only one redraw.
+ */
 static void
-ag_window_redraw_points_table(AgWindow *window)
+ag_window_queue_redraw_chart(AgWindow *window)
 {
-    ag_window_set_element_point(window, GSWE_ELEMENT_FIRE, 4, 1);
-    ag_window_set_element_point(window, GSWE_ELEMENT_EARTH, 4, 2);
-    ag_window_set_element_point(window, GSWE_ELEMENT_AIR, 4, 3);
-    ag_window_set_element_point(window, GSWE_ELEMENT_WATER, 4, 4);
+    GET_PRIV(window);
+
+    if (priv->redraw_tick_id != 0) {
+        priv->redraws_skipped++;
+
+        return;
+    }
 
-    ag_window_set_quality_point(window, GSWE_QUALITY_CARDINAL, 1, 5);
-    ag_window_set_quality_point(window, GSWE_QUALITY_FIX, 2, 5);
-    ag_window_set_quality_point(window, GSWE_QUALITY_MUTABLE, 3, 5);
+    priv->redraw_tick_id = gtk_widget_add_tick_callback(
+            GTK_WIDGET(window),
+            ag_window_redraw_tick_cb,
+            NULL, NULL
+        );
 }
 
 /**
- * ag_window_redraw_chart:
+ * ag_window_get_redraw_stats:
  * @window: the #AgWindow to operate on
+ * @done: (out) (allow-none): the number of chart redraws done
+ * @skipped: (out) (allow-none): the number of redraw requests merged into
+ *           another one
  *
- * Redraw the chart on the chart view.
+ * Get how many chart redraws were saved by merging redraw requests.
  */
 void
-ag_window_redraw_chart(AgWindow *window)
+ag_window_get_redraw_stats(AgWindow *window, guint *done, guint *skipped)
 {
-    gsize           length;
-    GError          *err         = NULL;
     GET_PRIV(window);
-    gchar           *svg_content = ag_chart_create_svg(
-            priv->chart,
-            &length,
-            FALSE,
-            NULL,
-            0, 0,
-            &err
-        );
-
-    if (svg_content == NULL) {
-        ag_app_message_dialog(
-                GTK_WINDOW(window),
-                GTK_MESSAGE_WARNING,
-                "Unable to draw chart: %s",
-                err->message
-            );
-    } else {
-        GBytes *content;
-
-        content = g_bytes_new_take(svg_content, length);
 
-        webkit_web_view_load_bytes(
-                priv->chart_web_view,
-                content, "image/svg+xml",
-                "UTF-8", NULL
-            );
-        g_bytes_unref(content);
+    if (done) {
+        *done = priv->redraws_done;
     }
 
-    ag_window_redraw_aspect_table(window);
-    ag_window_redraw_points_table(window);
+    if (skipped) {
+        *skipped = priv->redraws_skipped;
+    }
 }
 
 static gboolean
@@ -597,58 +505,42 @@ ag_window_update_from_chart(AgWindow *window)
 
     g_free(coordinates);
 
-    ag_window_redraw_chart(window);
+    ag_window_queue_redraw_chart(window);
 }
 
 static void
 ag_window_chart_changed(AgChart *chart, AgWindow *window)
 {
     g_debug("Chart changed!");
-    ag_window_redraw_chart(window);
+    ag_window_queue_redraw_chart(window);
 }
 
 static void
 ag_window_recalculate_chart(AgWindow *window, gboolean set_everything)
 {
-    AgDbChartSave   *edit_data,
-                    *chart_data;
+    AgDbChartSave   *edit_data;
     GET_PRIV(window);
     GsweHouseSystem house_system;
     GsweTimestamp   *timestamp;
     gint            db_id = (priv->saved_data) ? priv->saved_data->db_id : -1;
     AgSettings      *settings;
+    AgChartChange   changes;
 
     ag_chart_edit_update(AG_CHART_EDIT(priv->tab_edit));
 
     edit_data = ag_chart_edit_get_chart_save(AG_CHART_EDIT(priv->tab_edit));
     edit_data->db_id = db_id;
 
-    chart_data = (priv->chart)
-            ? ag_chart_get_db_save(priv->chart)
-            : NULL
-        ;
-
-    if (ag_db_chart_save_identical(edit_data, chart_data, !set_everything)) {
-        g_debug("No redrawing needed");
-
-        ag_db_chart_save_unref(edit_data);
-        ag_db_chart_save_unref(chart_data);
-
-        return;
-    }
-
-    ag_db_chart_save_unref(chart_data);
-
-    g_debug("Recalculating chart data");
-
-    settings = ag_settings_get();
-    house_system = ag_settings_get_house_system(settings);
-    g_object_unref(settings);
-
     // TODO: Set timezone according to the city selected!
     if (priv->chart == NULL) {
         AgChart *chart;
 
+        g_debug("Calculating chart data");
+
+        settings = ag_settings_get();
+        house_system = ag_settings_get_house_system(settings);
+        g_object_unref(settings);
+
         timestamp = gswe_timestamp_new_from_gregorian_full(
                 edit_data->year, edit_data->month, edit_data->day,
                 edit_data->hour, edit_data->minute, edit_data->second, 0,
@@ -660,24 +552,35 @@ ag_window_recalculate_chart(AgWindow *window, gboolean set_everything)
                 house_system
             );
         ag_window_set_chart(window, chart);
-        ag_window_redraw_chart(window);
+        ag_window_queue_redraw_chart(window);
+
+        if (set_everything) {
+            ag_chart_set_name(priv->chart, edit_data->name);
+            ag_chart_set_country(priv->chart, edit_data->country);
+            ag_chart_set_city(priv->chart, edit_data->city);
+            ag_chart_set_note(priv->chart, edit_data->note);
+        }
     } else {
-        gswe_moment_set_house_system(GSWE_MOMENT(priv->chart), house_system);
-        timestamp = gswe_moment_get_timestamp(GSWE_MOMENT(priv->chart));
-        gswe_timestamp_set_gregorian_full(
-                timestamp,
-                edit_data->year, edit_data->month, edit_data->day,
-                edit_data->hour, edit_data->minute, edit_data->second, 0,
-                edit_data->timezone,
-                NULL
+        // Keep the house system selected on the chart tab. Only the parts
+        // that differ are recalculated; if only the details changed,
+        // nothing is, and the chart is not redrawn.
+        changes = ag_chart_update_from_db_save(
+                priv->chart,
+                edit_data,
+                gswe_moment_get_house_system(GSWE_MOMENT(priv->chart)),
+                set_everything
             );
-    }
 
-    if (set_everything) {
-        ag_chart_set_name(priv->chart, edit_data->name);
-        ag_chart_set_country(priv->chart, edit_data->country);
-        ag_chart_set_city(priv->chart, edit_data->city);
-        ag_chart_set_note(priv->chart, edit_data->note);
+        if ((changes & ~AG_CHART_CHANGE_DETAILS) == 0) {
+            g_debug("No redrawing needed");
+        } else if (
+                    (changes & AG_CHART_CHANGE_TIME)
+                    || (changes & AG_CHART_CHANGE_LOCATION)
+                ) {
+            g_debug("Recalculating chart data");
+        } else {
+            g_debug("Recalculating houses and angles only");
+        }
     }
 
     ag_db_chart_save_unref(edit_data);
@@ -1147,121 +1050,15 @@ ag_window_delete_event_callback(AgWindow *window,
     return (!ag_window_can_close(window, TRUE));
 }
 
-static void
-ag_window_clear_style_sheets(AgWindow *window)
-{
-    GET_PRIV(window);
-
-    g_debug("Clearing style sheets");
-
-    webkit_user_content_manager_remove_all_style_sheets(priv->content_manager);
-    g_list_free_full(
-            priv->style_sheets,
-            (GDestroyNotify)webkit_user_style_sheet_unref
-        );
-    priv->style_sheets = NULL;
-}
-
-static void
-ag_window_add_style_sheet(AgWindow *window, const gchar *path)
-{
-    gchar           *css_source;
-    gboolean        source_free = FALSE;
-    GET_PRIV(window);
-
-    if (strncmp("gres://", path, 7) == 0) {
-        gchar  *res_path = g_strdup_printf(
-                "/eu/polonkai/gergely/Astrognome/%s",
-                path + 7
-            );
-        GBytes *css_data = g_resources_lookup_data(
-                res_path,
-                G_RESOURCE_LOOKUP_FLAGS_NONE,
-                NULL
-            );
-
-        css_source  = g_strdup(g_bytes_get_data(css_data, NULL));
-        source_free = TRUE;
-        g_bytes_unref(css_data);
-    } else if (strncmp("raw:", path, 4) == 0) {
-        css_source = (gchar *)path + 4;
-    } else {
-        GFile  *css_file = g_file_new_for_uri(path);
-        GError *err = NULL;
-
-        g_file_load_contents(
-                css_file,
-                NULL,
-                &css_source, NULL,
-                NULL,
-                &err
-            );
-        source_free = TRUE;
-        g_object_unref(css_file);
-    }
-
-    if (css_source) {
-        WebKitUserStyleSheet *style_sheet = webkit_user_style_sheet_new(
-                css_source,
-                WEBKIT_USER_CONTENT_INJECT_TOP_FRAME,
-                WEBKIT_USER_STYLE_LEVEL_USER,
-                NULL, NULL
-            );
-
-        priv->style_sheets = g_list_append(priv->style_sheets, style_sheet);
-
-        if (source_free) {
-            g_free(css_source);
-        }
-    }
-}
-
-static void
-ag_window_update_style_sheets(AgWindow *window)
-{
-    GList                    *item;
-    GET_PRIV(window);
-
-    g_debug("Updating style sheets");
-
-    webkit_user_content_manager_remove_all_style_sheets(priv->content_manager);
-
-    for (item = priv->style_sheets; item; item = g_list_next(item)) {
-        WebKitUserStyleSheet *style_sheet = item->data;
-
-        webkit_user_content_manager_add_style_sheet(priv->content_manager, style_sheet);
-    }
-}
-
 static void
 ag_window_set_theme(AgWindow *window, AgDisplayTheme *theme)
 {
-    gchar           *css,
-                    *css_final;
     GET_PRIV(window);
 
     g_debug("Setting theme to %s", (theme) ? theme->name : "no theme");
-    ag_window_clear_style_sheets(window);
 
     priv->theme = theme;
-
-    // Add the default style sheet
-    ag_window_add_style_sheet(
-            window,
-            "gres://ui/chart-default.css"
-        );
-
-    if (theme) {
-        css = ag_display_theme_to_css(theme);
-        css_final = g_strdup_printf("raw:%s", css);
-        g_free(css);
-
-        ag_window_add_style_sheet(window, css_final);
-
-        g_free(css_final);
-    }
-
-    ag_window_update_style_sheets(window);
+    ag_chart_view_set_theme(priv->chart_view, theme);
 }
 
 static void
@@ -1310,7 +1107,7 @@ ag_window_tab_changed_cb(GtkStack *tabs, GParamSpec *pspec, AgWindow *window)
         // not the real active one!
         if (priv->current_tab == priv->tab_edit) {
             ag_window_recalculate_chart(window, FALSE);
-            ag_window_redraw_chart(window);
+            ag_window_queue_redraw_chart(window);
         }
     }
 
@@ -1446,7 +1243,12 @@ ag_window_back_action(GSimpleAction *action,
         ag_db_chart_save_unref(priv->saved_data);
         priv->saved_data = NULL;
 
-        ag_window_reload_chart_list(window);
+        // Once loaded, the list is kept up to date by the database change
+        // signals
+        if (!priv->chart_list_loaded) {
+            ag_window_reload_chart_list(window);
+        }
+
         gtk_stack_set_visible_child_name(priv->tabs, "list");
         gtk_header_bar_set_subtitle(GTK_HEADER_BAR(priv->header_bar), NULL);
     }
@@ -1518,6 +1320,7 @@ ag_window_delete_action(GSimpleAction *action,
                         gpointer      user_data)
 {
     GList           *selection,
+                    *charts = NULL,
                     *item;
     AgWindow        *window = AG_WINDOW(user_data);
     GET_PRIV(window);
@@ -1525,12 +1328,27 @@ ag_window_delete_action(GSimpleAction *action,
 
     selection = ag_icon_view_get_selected_items(priv->chart_list);
 
+    // Deleted charts disappear from the view immediately, which invalidates
+    // the paths, so collect the charts first
     for (item = selection; item; item = g_list_next(item)) {
-        GtkTreePath   *path = item->data;
-        GError        *err = NULL;
-        AgDbChartSave *save_data;
+        charts = g_list_prepend(
+                charts,
+                ag_icon_view_get_chart_save_at_path(
+                        priv->chart_list,
+                        item->data
+                    )
+            );
+    }
+
+    g_list_free_full(selection, (GDestroyNotify)gtk_tree_path_free);
 
-        save_data = ag_icon_view_get_chart_save_at_path(priv->chart_list, path);
+    for (item = charts; item; item = g_list_next(item)) {
+        GError        *err       = NULL;
+        AgDbChartSave *save_data = item->data;
+
+        if (save_data == NULL) {
+            continue;
+        }
 
         if (!ag_db_chart_delete(db, save_data->db_id, &err)) {
             ag_app_message_dialog(
@@ -1541,30 +1359,470 @@ ag_window_delete_action(GSimpleAction *action,
                         ? err->message
                         : "No reason"
                 );
+            g_clear_error(&err);
         }
+
+        ag_db_chart_save_unref(save_data);
     }
 
-    ag_icon_view_remove_selected(priv->chart_list);
+    g_list_free(charts);
+    g_object_unref(db);
 
     g_action_group_activate_action(G_ACTION_GROUP(window), "selection", NULL);
-    g_action_group_activate_action(G_ACTION_GROUP(window), "refresh", NULL);
 }
 
 static void
-ag_window_js_callback(WebKitWebView *web_view,
-                      GAsyncResult  *res,
-                      gpointer      user_data)
+ag_window_export_item_free(AgWindowExportItem *item)
+{
+    ag_db_chart_save_unref(item->save_data);
+    g_object_unref(item->file);
+    g_clear_error(&(item->err));
+    g_free(item);
+}
+
+/*
+ * ag_window_export_worker:
+ *
+ * Runs in a worker thread. Calculates and exports one chart, and queues the
+ * result for the main thread.
+ */
+static void
+ag_window_export_worker(AgWindowExportItem *item, AgWindowExport *export)
+{
+    if (!g_cancellable_is_cancelled(export->cancellable)) {
+        item->exported = ag_chart_export_save_to_file(
+                item->save_data,
+                export->house_system,
+                item->file,
+                export->format,
+                export->image_size,
+                export->theme,
+                &(item->err)
+            );
+    }
+
+    g_async_queue_push(export->results, item);
+}
+
+static gdouble
+ag_window_export_get_rate(AgWindowExport *export)
+{
+    gdouble elapsed = (g_get_monotonic_time() - export->start_time)
+            / (gdouble)G_USEC_PER_SEC;
+
+    return (elapsed > 0.0) ? export->n_exported / elapsed : 0.0;
+}
+
+static void
+ag_window_export_finish(AgWindowExport *export)
 {
-    WebKitJavascriptResult *js_result;
-    GError                 *err = NULL;
+    g_thread_pool_free(export->pool, FALSE, TRUE);
+    g_async_queue_unref(export->results);
+
+    gtk_widget_destroy(export->dialog);
+
+    if (export->errors->len > 0) {
+        ag_app_message_dialog(
+                GTK_WINDOW(export->window),
+                GTK_MESSAGE_WARNING,
+                _("%u of %u charts exported. Errors:\n%s"),
+                export->n_exported,
+                export->n_charts,
+                export->errors->str
+            );
+    }
+
+    g_debug(
+            "Export finished, %u of %u charts exported, %.2f charts/s",
+            export->n_exported,
+            export->n_charts,
+            ag_window_export_get_rate(export)
+        );
+
+    g_object_unref(export->cancellable);
+    g_object_unref(export->window);
+    g_string_free(export->errors, TRUE);
+    g_free(export);
+}
+
+/*
+ * ag_window_export_update:
+ *
+ * Runs in the main thread. Collects the results of the workers, and updates
+ * the progress bar.
+ */
+static gboolean
+ag_window_export_update(AgWindowExport *export)
+{
+    AgWindowExportItem *item;
+    gchar              *progress_text;
+
+    while ((item = g_async_queue_try_pop(export->results)) != NULL) {
+        export->n_done++;
+
+        if (item->exported) {
+            export->n_exported++;
+        } else if (item->err != NULL) {
+            gchar *name = g_file_get_parse_name(item->file);
+
+            g_string_append_printf(
+                    export->errors,
+                    "%s: %s\n",
+                    name,
+                    item->err->message
+                );
+            g_free(name);
+        }
+
+        ag_window_export_item_free(item);
+    }
+
+    gtk_progress_bar_set_fraction(
+            export->progress,
+            (gdouble)export->n_done / (gdouble)export->n_charts
+        );
+    progress_text = g_strdup_printf(
+            _("%u of %u (%.1f charts/s)"),
+            export->n_done,
+            export->n_charts,
+            ag_window_export_get_rate(export)
+        );
+    gtk_progress_bar_set_text(export->progress, progress_text);
+    g_free(progress_text);
+
+    if (export->n_done < export->n_charts) {
+        return G_SOURCE_CONTINUE;
+    }
+
+    export->progress_id = 0;
+    ag_window_export_finish(export);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+ag_window_export_dialog_response_cb(GtkDialog      *dialog,
+                                    gint           response_id,
+                                    AgWindowExport *export)
+{
+    // Charts not yet exported will be skipped; the export finishes when the
+    // workers are done with the ones already started
+    if (response_id == GTK_RESPONSE_CANCEL) {
+        g_cancellable_cancel(export->cancellable);
+        gtk_dialog_set_response_sensitive(dialog, GTK_RESPONSE_CANCEL, FALSE);
+    }
+}
+
+/*
+ * ag_window_export_get_file:
+ *
+ * Get the file to export @save_data to. Files are named after the charts;
+ * if more charts have the same name, their database ID is added.
+ */
+static GFile *
+ag_window_export_get_file(GFile         *directory,
+                          AgDbChartSave *save_data,
+                          const gchar   *extension,
+                          GHashTable    *used_names)
+{
+    gchar *base_name,
+          *file_name;
+    GFile *file;
+
+    if ((save_data->name == NULL) || (*(save_data->name) == 0)) {
+        base_name = g_strdup(_("Chart"));
+    } else {
+        base_name = g_strdelimit(g_strdup(save_data->name), "/\\", '_');
+    }
+
+    file_name = g_strdup_printf("%s.%s", base_name, extension);
+
+    if (g_hash_table_contains(used_names, file_name)) {
+        g_free(file_name);
+        file_name = g_strdup_printf(
+                "%s (%d).%s",
+                base_name,
+                save_data->db_id,
+                extension
+            );
+    }
+
+    file = g_file_get_child(directory, file_name);
+    g_hash_table_add(used_names, file_name);
+    g_free(base_name);
+
+    return file;
+}
+
+/*
+ * ag_window_export_run_dialog:
+ *
+ * Ask for the target directory, format and size of a batch export.
+ *
+ * Returns: %TRUE if the user wants to export
+ */
+static gboolean
+ag_window_export_run_dialog(AgWindow            *window,
+                            GFile               **directory,
+                            AgChartExportFormat *format,
+                            guint               *image_size)
+{
+    GtkWidget   *dialog,
+                *grid,
+                *label,
+                *folder_button,
+                *format_combo,
+                *size_spin;
+    const gchar *pictures_dir;
+    gint        response;
+
+    dialog = gtk_dialog_new_with_buttons(
+            _("Export Selected Charts"),
+            GTK_WINDOW(window),
+            GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+            _("_Cancel"), GTK_RESPONSE_CANCEL,
+            _("_Export"), GTK_RESPONSE_ACCEPT,
+            NULL
+        );
+    gtk_dialog_set_default_response(GTK_DIALOG(dialog), GTK_RESPONSE_ACCEPT);
+
+    grid = gtk_grid_new();
+    gtk_grid_set_row_spacing(GTK_GRID(grid), 6);
+    gtk_grid_set_column_spacing(GTK_GRID(grid), 12);
+    gtk_container_set_border_width(GTK_CONTAINER(grid), 12);
+
+    label = gtk_label_new_with_mnemonic(_("_Folder"));
+    gtk_widget_set_halign(label, GTK_ALIGN_END);
+    folder_button = gtk_file_chooser_button_new(
+            _("Select a Folder"),
+            GTK_FILE_CHOOSER_ACTION_SELECT_FOLDER
+        );
+    gtk_file_chooser_set_local_only(GTK_FILE_CHOOSER(folder_button), FALSE);
 
-    if ((js_result = webkit_web_view_run_javascript_finish(
-                web_view,
-                res,
-                &err
+    if ((pictures_dir = g_get_user_special_dir(
+                G_USER_DIRECTORY_PICTURES
             )) != NULL) {
-        webkit_javascript_result_unref(js_result);
+        gtk_file_chooser_set_current_folder(
+                GTK_FILE_CHOOSER(folder_button),
+                pictures_dir
+            );
+    }
+
+    gtk_label_set_mnemonic_widget(GTK_LABEL(label), folder_button);
+    gtk_grid_attach(GTK_GRID(grid), label, 0, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), folder_button, 1, 0, 1, 1);
+
+    label = gtk_label_new_with_mnemonic(_("F_ormat"));
+    gtk_widget_set_halign(label, GTK_ALIGN_END);
+    format_combo = gtk_combo_box_text_new();
+    gtk_combo_box_text_append(
+            GTK_COMBO_BOX_TEXT(format_combo),
+            "svg",
+            gtk_file_filter_get_name(filter_svg)
+        );
+    gtk_combo_box_text_append(
+            GTK_COMBO_BOX_TEXT(format_combo),
+            "png",
+            gtk_file_filter_get_name(filter_png)
+        );
+    gtk_combo_box_text_append(
+            GTK_COMBO_BOX_TEXT(format_combo),
+            "jpg",
+            gtk_file_filter_get_name(filter_jpg)
+        );
+    gtk_combo_box_set_active(GTK_COMBO_BOX(format_combo), 0);
+    gtk_label_set_mnemonic_widget(GTK_LABEL(label), format_combo);
+    gtk_grid_attach(GTK_GRID(grid), label, 0, 1, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), format_combo, 1, 1, 1, 1);
+
+    label = gtk_label_new_with_mnemonic(_("Image _size"));
+    gtk_widget_set_halign(label, GTK_ALIGN_END);
+    size_spin = gtk_spin_button_new_with_range(0, 20000, 100);
+    gtk_widget_set_tooltip_text(
+            size_spin,
+            _("Width and height of the images in pixels, or 0 for the default size")
+        );
+    gtk_label_set_mnemonic_widget(GTK_LABEL(label), size_spin);
+    gtk_grid_attach(GTK_GRID(grid), label, 0, 2, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), size_spin, 1, 2, 1, 1);
+
+    gtk_box_pack_start(
+            GTK_BOX(gtk_dialog_get_content_area(GTK_DIALOG(dialog))),
+            grid,
+            TRUE, TRUE, 0
+        );
+    gtk_widget_show_all(dialog);
+
+    response    = gtk_dialog_run(GTK_DIALOG(dialog));
+    *directory  = gtk_file_chooser_get_file(GTK_FILE_CHOOSER(folder_button));
+    *image_size = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(size_spin));
+
+    switch (gtk_combo_box_get_active(GTK_COMBO_BOX(format_combo))) {
+        case 1:
+            *format = AG_CHART_EXPORT_FORMAT_PNG;
+
+            break;
+
+        case 2:
+            *format = AG_CHART_EXPORT_FORMAT_JPG;
+
+            break;
+
+        default:
+            *format = AG_CHART_EXPORT_FORMAT_SVG;
+
+            break;
+    }
+
+    gtk_widget_destroy(dialog);
+
+    if ((response != GTK_RESPONSE_ACCEPT) || (*directory == NULL)) {
+        g_clear_object(directory);
+
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void
+ag_window_export_selection_action(GSimpleAction *action,
+                                  GVariant      *parameter,
+                                  gpointer      user_data)
+{
+    AgWindow            *window = AG_WINDOW(user_data);
+    AgWindowExport      *export;
+    AgChartExportFormat format;
+    GFile               *directory;
+    GList               *selection,
+                        *item;
+    GHashTable          *used_names;
+    GtkWidget           *content_area;
+    const gchar         *extension;
+    guint               image_size;
+    GET_PRIV(window);
+
+    if (!ag_window_export_run_dialog(
+                window,
+                &directory,
+                &format,
+                &image_size
+            )) {
+        return;
+    }
+
+    switch (format) {
+        case AG_CHART_EXPORT_FORMAT_PNG:
+            extension = "png";
+
+            break;
+
+        case AG_CHART_EXPORT_FORMAT_JPG:
+            extension = "jpg";
+
+            break;
+
+        default:
+            extension = "svg";
+
+            break;
+    }
+
+    export = g_new0(AgWindowExport, 1);
+    export->window       = g_object_ref(window);
+    export->format       = format;
+    export->image_size   = image_size;
+    export->theme        = priv->theme;
+    export->house_system = ag_settings_get_house_system(priv->settings);
+    export->errors       = g_string_new(NULL);
+    export->cancellable  = g_cancellable_new();
+    export->results      = g_async_queue_new();
+    export->start_time   = g_get_monotonic_time();
+    export->pool         = g_thread_pool_new(
+            (GFunc)ag_window_export_worker,
+            export,
+            g_get_num_processors(),
+            FALSE,
+            NULL
+        );
+
+    // The window is kept alive until the export finishes, but it may be
+    // closed; the progress dialog must not be destroyed with it
+    export->dialog = gtk_dialog_new_with_buttons(
+            _("Exporting charts"),
+            GTK_WINDOW(window),
+            0,
+            _("_Cancel"), GTK_RESPONSE_CANCEL,
+            NULL
+        );
+    g_signal_connect(
+            export->dialog,
+            "response",
+            G_CALLBACK(ag_window_export_dialog_response_cb),
+            export
+        );
+    g_signal_connect(
+            export->dialog,
+            "delete-event",
+            G_CALLBACK(gtk_true),
+            NULL
+        );
+
+    export->progress = GTK_PROGRESS_BAR(gtk_progress_bar_new());
+    gtk_progress_bar_set_show_text(export->progress, TRUE);
+    content_area = gtk_dialog_get_content_area(GTK_DIALOG(export->dialog));
+    gtk_container_set_border_width(GTK_CONTAINER(content_area), 12);
+    gtk_box_pack_start(
+            GTK_BOX(content_area),
+            GTK_WIDGET(export->progress),
+            TRUE, TRUE, 0
+        );
+    gtk_widget_show_all(export->dialog);
+
+    selection  = ag_icon_view_get_selected_items(priv->chart_list);
+    used_names = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+    for (item = selection; item; item = g_list_next(item)) {
+        AgWindowExportItem *export_item;
+        AgDbChartSave      *save_data;
+
+        if ((save_data = ag_icon_view_get_chart_save_at_path(
+                    priv->chart_list,
+                    item->data
+                )) == NULL) {
+            continue;
+        }
+
+        export_item            = g_new0(AgWindowExportItem, 1);
+        export_item->save_data = save_data;
+        export_item->file      = ag_window_export_get_file(
+                directory,
+                save_data,
+                extension,
+                used_names
+            );
+
+        export->n_charts++;
+        g_thread_pool_push(export->pool, export_item, NULL);
     }
+
+    g_hash_table_destroy(used_names);
+    g_list_free_full(selection, (GDestroyNotify)gtk_tree_path_free);
+    g_object_unref(directory);
+
+    g_action_group_activate_action(G_ACTION_GROUP(window), "selection", NULL);
+
+    if (export->n_charts == 0) {
+        ag_window_export_finish(export);
+
+        return;
+    }
+
+    export->progress_id = g_timeout_add(
+            AG_WINDOW_EXPORT_PROGRESS_INTERVAL,
+            (GSourceFunc)ag_window_export_update,
+            export
+        );
 }
 
 static void
@@ -1574,12 +1832,7 @@ ag_window_connection_action(GSimpleAction *action,
 {
     GVariant        *current_state;
     const gchar     *state;
-    gchar           *js_code = NULL;
     GET_PRIV(AG_WINDOW(user_data));
-    static gchar *js         = "aspects = document.getElementById('aspects');\n"   \
-                               "antiscia = document.getElementById('antiscia');\n" \
-                               "aspects.setAttribute('display', '%s');\n"       \
-                               "antiscia.setAttribute('display', '%s');\n";
 
     current_state = g_action_get_state(G_ACTION(action));
 
@@ -1587,30 +1840,27 @@ ag_window_connection_action(GSimpleAction *action,
         return;
     }
 
-    g_action_change_state(G_ACTION(action), parameter);
-
     state = g_variant_get_string(parameter, NULL);
 
     if (strcmp("aspects", state) == 0) {
         g_debug("Switching to aspects");
-        js_code = g_strdup_printf(js, "block", "none");
+        ag_chart_view_set_connection(
+                priv->chart_view,
+                AG_CHART_CAIRO_CONNECTION_ASPECTS
+            );
     } else if (strcmp("antiscia", state) == 0) {
         g_debug("Switching to antiscia");
-        js_code = g_strdup_printf(js, "none", "block");
+        ag_chart_view_set_connection(
+                priv->chart_view,
+                AG_CHART_CAIRO_CONNECTION_ANTISCIA
+            );
     } else {
         g_warning("Connection type '%s' is invalid", state);
-    }
 
-    if (js_code) {
-        webkit_web_view_run_javascript(
-                priv->chart_web_view,
-                js_code,
-                NULL,
-                (GAsyncReadyCallback)ag_window_js_callback,
-                NULL
-            );
-        g_free(js_code);
+        return;
     }
+
+    g_action_change_state(G_ACTION(action), parameter);
 }
 
 static void
@@ -1634,35 +1884,21 @@ ag_window_select_none_action(GSimpleAction *action,
 }
 
 static GActionEntry win_entries[] = {
-    { "close",        ag_window_close_action,          NULL, NULL,        NULL },
-    { "save",         ag_window_save_action,           NULL, NULL,        NULL },
-    { "export-agc",   ag_window_export_agc_action,     NULL, NULL,        NULL },
-    { "export-image", ag_window_export_image_action,   NULL, NULL,        NULL },
-    { "change-tab",   ag_window_change_tab_action,     "s",  "'edit'",    NULL },
-    { "new-chart",    ag_window_new_chart_action,      NULL, NULL,        NULL },
-    { "back",         ag_window_back_action,           NULL, NULL,        NULL },
-    { "refresh",      ag_window_refresh_action,        NULL, NULL,        NULL },
-    { "delete",       ag_window_delete_action,         NULL, NULL,        NULL },
-    { "connection",   ag_window_connection_action,     "s",  "'aspects'", NULL },
-    { "select-all",   ag_window_select_all_action,     NULL, NULL,        NULL },
-    { "select-none",  ag_window_select_none_action,    NULL, NULL,        NULL },
+    { "close",            ag_window_close_action,            NULL, NULL,        NULL },
+    { "save",             ag_window_save_action,             NULL, NULL,        NULL },
+    { "export-agc",       ag_window_export_agc_action,       NULL, NULL,        NULL },
+    { "export-image",     ag_window_export_image_action,     NULL, NULL,        NULL },
+    { "change-tab",       ag_window_change_tab_action,       "s",  "'edit'",    NULL },
+    { "new-chart",        ag_window_new_chart_action,        NULL, NULL,        NULL },
+    { "back",             ag_window_back_action,             NULL, NULL,        NULL },
+    { "refresh",          ag_window_refresh_action,          NULL, NULL,        NULL },
+    { "delete",           ag_window_delete_action,           NULL, NULL,        NULL },
+    { "export-selection", ag_window_export_selection_action, NULL, NULL,        NULL },
+    { "connection",       ag_window_connection_action,       "s",  "'aspects'", NULL },
+    { "select-all",       ag_window_select_all_action,       NULL, NULL,        NULL },
+    { "select-none",      ag_window_select_none_action,      NULL, NULL,        NULL },
 };
 
-static void
-ag_window_display_changed(GSettings *settings, gchar *key, AgWindow *window)
-{
-    GET_PRIV(window);
-
-    /* The planet symbols are redrawn only if aspect_table_populated is
-     * set to FALSE */
-    if (g_str_equal("planets-char", key)) {
-        priv->aspect_table_populated = FALSE;
-    }
-
-    ag_window_redraw_aspect_table(window);
-    ag_window_redraw_points_table(window);
-}
-
 static void
 ag_window_add_house_system(GsweHouseSystemInfo *house_system_info,
                            AgWindowPrivate *priv)
@@ -1775,8 +2011,10 @@ ag_window_list_selection_changed_cb(AgIconView *view, AgWindow *window)
     GET_PRIV(window);
 
     selection = ag_icon_view_get_selected_items(view);
+    count     = g_list_length(selection);
+    g_list_free_full(selection, (GDestroyNotify)gtk_tree_path_free);
 
-    if ((count = g_list_length(selection)) > 0) {
+    if (count > 0) {
         gtk_revealer_set_reveal_child(
                 GTK_REVEALER(priv->selection_toolbar),
                 TRUE
@@ -1791,14 +2029,24 @@ ag_window_list_selection_changed_cb(AgIconView *view, AgWindow *window)
     // Here it is possible to set button sensitivity later
 }
 
-gboolean
-ag_window_chart_context_cb(WebKitWebView       *web_view,
-                           GtkWidget           *default_menu,
-                           WebKitHitTestResult *hit_test_result,
-                           gboolean            triggered_with_keyboard,
-                           gpointer user_data)
+static void
+ag_window_preview_progress_cb(AgIconView *icon_view,
+                              guint      done,
+                              guint      total,
+                              AgWindow   *window)
 {
-    return TRUE;
+    GET_PRIV(window);
+
+    gtk_progress_bar_set_fraction(
+            priv->load_progress,
+            (total == 0) ? 1.0 : (gdouble)done / (gdouble)total
+        );
+
+    // Previews may catch up with the list loader; hide the progress bar only
+    // if there are no more charts to add
+    if ((done == total) && (priv->load_id == 0)) {
+        gtk_revealer_set_reveal_child(priv->load_progress_revealer, FALSE);
+    }
 }
 
 static void
@@ -1817,16 +2065,26 @@ ag_window_init(AgWindow *window)
     priv->settings = ag_settings_get();
     main_settings  = ag_settings_peek_main_settings(priv->settings);
 
-    g_signal_connect(
-            G_OBJECT(main_settings),
-            "changed::planets-char",
-            G_CALLBACK(ag_window_display_changed),
-            window
+    g_settings_bind(
+            main_settings, "planets-char",
+            priv->aspect_grid, "planets-char",
+            G_SETTINGS_BIND_GET
+        );
+    g_settings_bind(
+            main_settings, "aspects-char",
+            priv->aspect_grid, "aspects-char",
+            G_SETTINGS_BIND_GET
+        );
+
+    g_settings_bind(
+            main_settings, "preview-workers",
+            priv->chart_list, "preview-workers",
+            G_SETTINGS_BIND_GET
         );
     g_signal_connect(
-            G_OBJECT(main_settings),
-            "changed::aspects-char",
-            G_CALLBACK(ag_window_display_changed),
+            priv->chart_list,
+            "preview-progress",
+            G_CALLBACK(ag_window_preview_progress_cb),
             window
         );
 
@@ -1972,6 +2230,15 @@ ag_window_destroy(GtkWidget *widget)
         g_signal_handlers_destroy(priv->tabs);
     }
 
+    if (priv->load_id != 0) {
+        g_source_remove(priv->load_id);
+    }
+
+    if (priv->redraw_tick_id != 0) {
+        gtk_widget_remove_tick_callback(widget, priv->redraw_tick_id);
+        priv->redraw_tick_id = 0;
+    }
+
     GTK_WIDGET_CLASS(ag_window_parent_class)->destroy(widget);
 }
 
@@ -2077,7 +2344,7 @@ ag_window_class_init(AgWindowClass *klass)
     gtk_widget_class_bind_template_child_private(
             widget_class,
             AgWindow,
-            aspect_table
+            aspect_grid
         );
     gtk_widget_class_bind_template_child_private(widget_class, AgWindow, tabs);
     gtk_widget_class_bind_template_child_private(
@@ -2118,12 +2385,7 @@ ag_window_class_init(AgWindowClass *klass)
     gtk_widget_class_bind_template_child_private(
             widget_class,
             AgWindow,
-            chart_web_view
-        );
-    gtk_widget_class_bind_template_child_private(
-            widget_class,
-            AgWindow,
-            content_manager
+            chart_view
         );
     gtk_widget_class_bind_template_child_private(
             widget_class,
@@ -2172,10 +2434,6 @@ ag_window_class_init(AgWindowClass *klass)
             widget_class,
             ag_window_header_bar_mode_change_cb
         );
-    gtk_widget_class_bind_template_callback(
-            widget_class,
-            ag_window_chart_context_cb
-        );
 }
 
 static gboolean
@@ -2200,21 +2458,6 @@ ag_window_new(AgApp *app)
     AgWindow *window  = g_object_new(AG_TYPE_WINDOW, NULL);
     GET_PRIV(window);
 
-    // TODO: translate this error message!
-    webkit_web_view_load_html(
-            priv->chart_web_view,
-            "<html>" \
-                "<head>" \
-                    "<title>No Chart</title>" \
-                "</head>" \
-                "<body>" \
-                    "<h1>No Chart</h1>" \
-                    "<p>No chart is loaded. Create one on the " \
-                    "edit view, or open one from the application menu!</p>" \
-                "</body>" \
-            "</html>",
-            NULL);
-
     gtk_window_set_application(GTK_WINDOW(window), GTK_APPLICATION(app));
 
     gtk_window_set_icon_name(GTK_WINDOW(window), "astrognome");
@@ -2263,6 +2506,8 @@ ag_window_set_chart(AgWindow *window, AgChart *chart)
         priv->saved_data = NULL;
     }
 
+    ag_chart_view_set_chart(priv->chart_view, chart);
+
     g_object_notify_by_pspec(G_OBJECT(window), properties[PROP_CHART]);
 }
 
@@ -2341,46 +2586,38 @@ ag_window_change_tab(AgWindow *window, const gchar *tab_name)
 static gboolean
 ag_window_add_chart(LoadIdleData *idle_data)
 {
-    AgDbChartSave *save_data;
+    GList *batch,
+          *l;
 
     g_assert(
             (idle_data->load_state == PREVIEW_STATE_STARTED)
             || (idle_data->load_state == PREVIEW_STATE_LOADING)
         );
 
-    if (!idle_data->items) {
-        idle_data->load_state = PREVIEW_STATE_COMPLETE;
+    idle_data->load_state = PREVIEW_STATE_LOADING;
 
-        return FALSE;
-    }
+    // Previews are generated by the icon view in worker threads, so adding a
+    // chart is cheap. Add them in batches to keep the UI responsive
+    batch = ag_db_chart_list_next(idle_data->items, AG_WINDOW_LOAD_BATCH_SIZE);
 
-    if (!idle_data->n_items) {
-        idle_data->n_items = g_list_length(idle_data->items);
-        idle_data->n_loaded = 0;
-        idle_data->load_state = PREVIEW_STATE_LOADING;
+    for (l = batch; l; l = g_list_next(l)) {
+        ag_icon_view_add_chart(idle_data->priv->chart_list, l->data);
+        idle_data->n_loaded++;
     }
 
-    gtk_progress_bar_set_fraction(
-            idle_data->priv->load_progress,
-            (gdouble)idle_data->n_loaded / (gdouble)idle_data->n_items
-        );
-
-    save_data = g_list_nth_data(idle_data->items, idle_data->n_loaded);
-
-    g_assert(save_data);
-
-    ag_icon_view_add_chart(idle_data->priv->chart_list, save_data);
-
-    idle_data->n_loaded++;
+    g_list_free_full(batch, (GDestroyNotify)ag_db_chart_save_unref);
 
-    if (idle_data->n_loaded == idle_data->n_items) {
-        g_debug("Finished loading");
+    if (batch == NULL) {
+        g_debug("Finished loading %d charts", idle_data->n_loaded);
 
         idle_data->load_state = PREVIEW_STATE_COMPLETE;
-        idle_data->n_loaded = 0;
-        idle_data->n_items = 0;
-        g_list_free(idle_data->items);
-        idle_data->items = NULL;
+
+        if (!ag_icon_view_has_pending_previews(idle_data->priv->chart_list)) {
+            gtk_revealer_set_reveal_child(
+                    idle_data->priv->load_progress_revealer,
+                    FALSE
+                );
+        }
 
         return FALSE;
     } else {
@@ -2391,15 +2628,13 @@ ag_window_add_chart(LoadIdleData *idle_data)
 static void
 ag_window_cleanup_load_items(LoadIdleData *idle_data)
 {
-    g_assert(idle_data->load_state == PREVIEW_STATE_COMPLETE);
-
     g_debug("Cleaning up lazy loader");
 
-    gtk_revealer_set_reveal_child(
-            idle_data->priv->load_progress_revealer,
-            FALSE
-        );
+    if (idle_data->priv->load_id == idle_data->load_id) {
+        idle_data->priv->load_id = 0;
+    }
 
+    ag_db_chart_list_close(idle_data->items);
     g_free(idle_data);
 }
 
@@ -2409,17 +2644,34 @@ ag_window_reload_chart_list(AgWindow *window)
     LoadIdleData    *idle_data;
     AgDb            *db         = ag_db_get();
     GError          *err        = NULL;
-    GList           *chart_list = ag_db_chart_get_list(db, &err);
+    AgDbChartList   *chart_list = ag_db_chart_list_open(db, &err);
     GET_PRIV(window);
 
+    g_object_unref(db);
+
+    // Stop the previous loader, if it is still running
+    if (priv->load_id != 0) {
+        g_source_remove(priv->load_id);
+    }
+
     ag_icon_view_remove_all(priv->chart_list);
+    priv->chart_list_loaded = TRUE;
+
+    if (chart_list == NULL) {
+        g_warning(
+                "Unable to load the chart list: %s",
+                (err) ? err->message : "unknown error"
+            );
+        g_clear_error(&err);
+
+        return FALSE;
+    }
 
     /* Lazy loading of charts with previews. Idea is from
      * http://blogs.gnome.org/ebassi/documentation/lazy-loading/ */
 
     idle_data = g_new(LoadIdleData, 1);
     idle_data->items = chart_list;
-    idle_data->n_items = 0;
     idle_data->n_loaded = 0;
     idle_data->priv = priv;
     idle_data->load_state = PREVIEW_STATE_STARTED;
@@ -2427,7 +2679,7 @@ ag_window_reload_chart_list(AgWindow *window)
     gtk_progress_bar_set_fraction(priv->load_progress, 0.0);
     gtk_revealer_set_reveal_child(priv->load_progress_revealer, TRUE);
 
-    idle_data->load_id = g_idle_add_full(
+    idle_data->load_id = priv->load_id = g_idle_add_full(
             G_PRIORITY_DEFAULT_IDLE,
             (GSourceFunc)ag_window_add_chart,
             idle_data,
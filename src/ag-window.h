@@ -79,6 +79,10 @@ gboolean ag_window_reload_chart_list(AgWindow *window);
 
 gboolean ag_window_is_usable(AgWindow *window);
 
+void ag_window_get_redraw_stats(AgWindow *window,
+                                guint    *done,
+                                guint    *skipped);
+
 #define AG_WINDOW_ERROR (ag_window_error_quark())
 
 GQuark ag_window_error_quark(void);
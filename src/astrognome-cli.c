@@ -0,0 +1,959 @@
+/* astrognome-cli.c - Command line chart renderer for Astrognome
+ *
+ * Copyright (C) 2014 Polonkai Gergely
+ *
+ * Astrognome is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Astrognome is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <swe-glib.h>
+
+#include "config.h"
+
+#include "astrognome.h"
+#include "ag-chart.h"
+#include "ag-db.h"
+#include "ag-display-theme.h"
+
+// Calculates charts and writes them as SVG, PNG, JPG or JSON, without
+// opening a window, so it can run on machines without a display. Charts can
+// come from .agc and .hor files, from the standard input (as .agc data), or
+// from the database of the application. Every chart is processed in a thread
+// pool; the time of the whole run is printed at the end.
+//
+// The database is only accessed from the main thread. The charts read from
+// it are calculated with the house system given on the command line, as the
+// settings of the application are not read.
+
+typedef struct {
+    const gchar         *name;
+    AgChartExportFormat export_format;
+    const gchar         *pixbuf_format;
+    gboolean            json;
+} CliFormat;
+
+static const CliFormat cli_formats[] = {
+    { "svg",  AG_CHART_EXPORT_FORMAT_SVG, NULL,   FALSE },
+    { "png",  AG_CHART_EXPORT_FORMAT_PNG, "png",  FALSE },
+    { "jpg",  AG_CHART_EXPORT_FORMAT_JPG, "jpeg", FALSE },
+    { "json", AG_CHART_EXPORT_FORMAT_SVG, NULL,   TRUE  },
+};
+
+static const struct {
+    const gchar *name;
+    gint        id;
+} cli_themes[] = {
+    { "all",       AG_DISPLAY_THEME_ALL       },
+    { "classic",   AG_DISPLAY_THEME_CLASSIC   },
+    { "no-comets", AG_DISPLAY_THEME_NO_COMETS },
+};
+
+typedef struct {
+    gchar         *source;
+    GFile         *input;
+    gchar         *data;
+    gsize         length;
+    AgDbChartSave *save_data;
+    GFile         *output;
+    gchar         *result;
+    gsize         result_length;
+} CliJob;
+
+static gchar           *format_name       = "svg";
+static gchar           *output_dir        = NULL;
+static gboolean        to_stdout          = FALSE;
+static gint            image_size         = 0;
+static gchar           *house_system_name = "placidus";
+static gchar           *theme_name        = "all";
+static gchar           **db_ids           = NULL;
+static gboolean        all_db             = FALSE;
+static gint            jobs               = 0;
+static gboolean        quiet              = FALSE;
+static gchar           **inputs           = NULL;
+static const CliFormat *format            = NULL;
+static GsweHouseSystem house_system;
+static AgDisplayTheme  *theme;
+static volatile gint   failures           = 0;
+
+static GOptionEntry option_entries[] = {
+    {
+        "format", 'f',
+        0, G_OPTION_ARG_STRING,
+        &format_name,
+        "Output format: svg, png, jpg or json (default: svg)",
+        "FORMAT"
+    },
+    {
+        "output-dir", 'o',
+        0, G_OPTION_ARG_FILENAME,
+        &output_dir,
+        "Write the output files to DIR (default: the current directory)",
+        "DIR"
+    },
+    {
+        "stdout", 'c',
+        0, G_OPTION_ARG_NONE,
+        &to_stdout,
+        "Write to the standard output; JSON is written one chart per line",
+        NULL
+    },
+    {
+        "size", 's',
+        0, G_OPTION_ARG_INT,
+        &image_size,
+        "Size of the images in pixels (default: the natural chart size)",
+        "N"
+    },
+    {
+        "house-system", 'H',
+        0, G_OPTION_ARG_STRING,
+        &house_system_name,
+        "House system of the charts read from the database (default: placidus)",
+        "NICK"
+    },
+    {
+        "theme", 't',
+        0, G_OPTION_ARG_STRING,
+        &theme_name,
+        "Display theme of the images: all, classic or no-comets (default: all)",
+        "THEME"
+    },
+    {
+        "db-id", 'd',
+        0, G_OPTION_ARG_STRING_ARRAY,
+        &db_ids,
+        "Process the chart with ID from the database; can be repeated",
+        "ID"
+    },
+    {
+        "all", 'a',
+        0, G_OPTION_ARG_NONE,
+        &all_db,
+        "Process every chart in the database",
+        NULL
+    },
+    {
+        "jobs", 'j',
+        0, G_OPTION_ARG_INT,
+        &jobs,
+        "Process N charts at once (default: the number of processors)",
+        "N"
+    },
+    {
+        "quiet", 'q',
+        0, G_OPTION_ARG_NONE,
+        &quiet,
+        "Don’t print the time of the run",
+        NULL
+    },
+    {
+        G_OPTION_REMAINING, 0,
+        0, G_OPTION_ARG_FILENAME_ARRAY,
+        &inputs,
+        NULL,
+        "[FILE…]"
+    },
+    { NULL }
+};
+
+static void
+cli_job_free(CliJob *job)
+{
+    g_free(job->source);
+    g_clear_object(&(job->input));
+    g_free(job->data);
+
+    if (job->save_data) {
+        ag_db_chart_save_unref(job->save_data);
+    }
+
+    g_clear_object(&(job->output));
+    g_free(job->result);
+    g_free(job);
+}
+
+static void
+cli_json_append_string(GString *json, const gchar *value)
+{
+    const gchar *p;
+
+    if (value == NULL) {
+        g_string_append(json, "null");
+
+        return;
+    }
+
+    g_string_append_c(json, '"');
+
+    for (p = value; *p; p++) {
+        switch (*p) {
+            case '"':
+                g_string_append(json, "\\\"");
+
+                break;
+
+            case '\\':
+                g_string_append(json, "\\\\");
+
+                break;
+
+            case '\n':
+                g_string_append(json, "\\n");
+
+                break;
+
+            case '\r':
+                g_string_append(json, "\\r");
+
+                break;
+
+            case '\t':
+                g_string_append(json, "\\t");
+
+                break;
+
+            default:
+                if ((guchar)*p < 0x20) {
+                    g_string_append_printf(json, "\\u%04x", (guchar)*p);
+                } else {
+                    g_string_append_c(json, *p);
+                }
+
+                break;
+        }
+    }
+
+    g_string_append_c(json, '"');
+}
+
+// Numbers must not depend on the locale, so they are not formatted with
+// g_string_append_printf()
+static void
+cli_json_append_double(GString *json, gdouble value)
+{
+    gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+    g_string_append(json, g_ascii_formatd(buf, sizeof(buf), "%.6f", value));
+}
+
+static void
+cli_json_append_member(GString *json, const gchar *name)
+{
+    if (json->str[json->len - 1] != '{') {
+        g_string_append_c(json, ',');
+    }
+
+    cli_json_append_string(json, name);
+    g_string_append_c(json, ':');
+}
+
+/*
+ * cli_chart_to_json:
+ *
+ * Create a JSON object of the data and the calculated positions of @chart.
+ * The object is written on a single line, without a trailing newline.
+ */
+static gchar *
+cli_chart_to_json(AgChart *chart)
+{
+    GString       *json = g_string_new("{");
+    AgDbChartSave *save_data;
+    AgChartLayout *layout;
+    GEnumClass    *moon_phase_class;
+    GEnumValue    *moon_phase;
+    guint         i;
+    gchar         *value;
+
+    save_data = ag_chart_get_db_save(chart);
+    layout    = ag_chart_get_layout(chart);
+
+    cli_json_append_member(json, "name");
+    cli_json_append_string(json, save_data->name);
+    cli_json_append_member(json, "country");
+    cli_json_append_string(json, save_data->country);
+    cli_json_append_member(json, "city");
+    cli_json_append_string(json, save_data->city);
+    cli_json_append_member(json, "longitude");
+    cli_json_append_double(json, save_data->longitude);
+    cli_json_append_member(json, "latitude");
+    cli_json_append_double(json, save_data->latitude);
+    cli_json_append_member(json, "altitude");
+    cli_json_append_double(json, save_data->altitude);
+
+    value = g_strdup_printf(
+            "%04d-%02u-%02uT%02u:%02u:%02u",
+            save_data->year, save_data->month, save_data->day,
+            save_data->hour, save_data->minute, save_data->second
+        );
+    cli_json_append_member(json, "time");
+    cli_json_append_string(json, value);
+    g_free(value);
+
+    cli_json_append_member(json, "timezone");
+    cli_json_append_double(json, save_data->timezone);
+    cli_json_append_member(json, "house_system");
+    cli_json_append_string(
+            json,
+            ag_house_system_id_to_nick(
+                    gswe_moment_get_house_system(GSWE_MOMENT(chart))
+                )
+        );
+
+    cli_json_append_member(json, "ascendant");
+    cli_json_append_double(json, layout->ascendant);
+    cli_json_append_member(json, "mc");
+    cli_json_append_double(json, layout->mc);
+    cli_json_append_member(json, "vertex");
+    cli_json_append_double(json, layout->vertex);
+
+    cli_json_append_member(json, "houses");
+    g_string_append_c(json, '[');
+
+    for (i = 0; i < layout->n_houses; i++) {
+        if (i > 0) {
+            g_string_append_c(json, ',');
+        }
+
+        cli_json_append_double(json, layout->houses[i]);
+    }
+
+    g_string_append_c(json, ']');
+
+    cli_json_append_member(json, "bodies");
+    g_string_append_c(json, '[');
+
+    for (i = 0; i < layout->n_bodies; i++) {
+        AgChartLayoutBody *body = &(layout->bodies[i]);
+
+        g_string_append(json, (i > 0) ? ",{" : "{");
+        cli_json_append_member(json, "planet");
+        cli_json_append_string(json, ag_planet_id_to_nick(body->planet));
+        cli_json_append_member(json, "position");
+        cli_json_append_double(json, body->position);
+        cli_json_append_member(json, "retrograde");
+        g_string_append(json, (body->retrograde) ? "true" : "false");
+        g_string_append_c(json, '}');
+    }
+
+    g_string_append_c(json, ']');
+
+    cli_json_append_member(json, "aspects");
+    g_string_append_c(json, '[');
+
+    for (i = 0; i < layout->n_aspects; i++) {
+        AgChartLayoutAspect *aspect = &(layout->aspects[i]);
+
+        g_string_append(json, (i > 0) ? ",{" : "{");
+        cli_json_append_member(json, "planet1");
+        cli_json_append_string(json, ag_planet_id_to_nick(aspect->planet1));
+        cli_json_append_member(json, "planet2");
+        cli_json_append_string(json, ag_planet_id_to_nick(aspect->planet2));
+        cli_json_append_member(json, "aspect");
+        cli_json_append_string(json, ag_aspect_id_to_nick(aspect->aspect));
+        g_string_append_c(json, '}');
+    }
+
+    g_string_append_c(json, ']');
+
+    cli_json_append_member(json, "antiscia");
+    g_string_append_c(json, '[');
+
+    for (i = 0; i < layout->n_antiscia; i++) {
+        AgChartLayoutAntiscion *antiscion = &(layout->antiscia[i]);
+
+        g_string_append(json, (i > 0) ? ",{" : "{");
+        cli_json_append_member(json, "planet1");
+        cli_json_append_string(json, ag_planet_id_to_nick(antiscion->planet1));
+        cli_json_append_member(json, "planet2");
+        cli_json_append_string(json, ag_planet_id_to_nick(antiscion->planet2));
+        cli_json_append_member(json, "axis");
+        cli_json_append_string(
+                json,
+                ag_antiscion_axis_id_to_nick(antiscion->axis)
+            );
+        g_string_append_c(json, '}');
+    }
+
+    g_string_append_c(json, ']');
+
+    moon_phase_class = g_type_class_ref(GSWE_TYPE_MOON_PHASE);
+    moon_phase       = g_enum_get_value(moon_phase_class, layout->moon_phase);
+    cli_json_append_member(json, "moon_phase");
+    cli_json_append_string(json, (moon_phase) ? moon_phase->value_nick : NULL);
+    g_type_class_unref(moon_phase_class);
+    cli_json_append_member(json, "moon_illumination");
+    cli_json_append_double(json, layout->moon_illumination);
+
+    g_string_append_c(json, '}');
+
+    ag_chart_layout_free(layout);
+    ag_db_chart_save_unref(save_data);
+
+    return g_string_free(json, FALSE);
+}
+
+static AgChart *
+cli_job_load(CliJob *job, GError **err)
+{
+    if (job->save_data) {
+        return ag_chart_new_from_db_save_with_house_system(
+                job->save_data,
+                FALSE,
+                house_system,
+                err
+            );
+    }
+
+    if (job->input == NULL) {
+        return ag_chart_load_from_agc_data(
+                job->data,
+                job->length,
+                job->source,
+                err
+            );
+    }
+
+    if (g_str_has_suffix(job->source, ".hor")) {
+        return ag_chart_load_from_placidus_file(job->input, err);
+    }
+
+    return ag_chart_load_from_agc(job->input, err);
+}
+
+/*
+ * cli_job_render:
+ *
+ * Create the output of @chart in memory, for writing it to the standard
+ * output.
+ */
+static gboolean
+cli_job_render(CliJob *job, AgChart *chart, GError **err)
+{
+    GdkPixbuf *pixbuf;
+    gboolean  ret;
+
+    if (format->json) {
+        job->result        = cli_chart_to_json(chart);
+        job->result_length = strlen(job->result);
+
+        return TRUE;
+    }
+
+    if (format->pixbuf_format == NULL) {
+        job->result = ag_chart_create_svg(
+                chart,
+                &(job->result_length),
+                FALSE,
+                theme,
+                image_size,
+                0,
+                err
+            );
+
+        return (job->result != NULL);
+    }
+
+    if ((pixbuf = ag_chart_get_pixbuf(
+                chart,
+                image_size,
+                0,
+                theme,
+                err
+            )) == NULL) {
+        return FALSE;
+    }
+
+    ret = gdk_pixbuf_save_to_buffer(
+            pixbuf,
+            &(job->result),
+            &(job->result_length),
+            format->pixbuf_format,
+            err,
+            NULL
+        );
+    g_object_unref(pixbuf);
+
+    return ret;
+}
+
+static gboolean
+cli_job_write(CliJob *job, AgChart *chart, GError **err)
+{
+    gchar    *json;
+    gboolean ret;
+    GError   *local_err = NULL;
+
+    if (!format->json) {
+        ag_chart_export_to_file(
+                chart,
+                job->output,
+                format->export_format,
+                image_size,
+                theme,
+                &local_err
+            );
+
+        if (local_err != NULL) {
+            g_propagate_error(err, local_err);
+
+            return FALSE;
+        }
+
+        return TRUE;
+    }
+
+    json = cli_chart_to_json(chart);
+    ret  = g_file_replace_contents(
+            job->output,
+            json,
+            strlen(json),
+            NULL,
+            FALSE,
+            G_FILE_CREATE_NONE,
+            NULL,
+            NULL,
+            err
+        );
+    g_free(json);
+
+    return ret;
+}
+
+static void
+cli_job_run(CliJob *job, gpointer user_data)
+{
+    AgChart  *chart;
+    gboolean ok;
+    GError   *err = NULL;
+
+    if ((chart = cli_job_load(job, &err)) == NULL) {
+        ok = FALSE;
+    } else {
+        if (job->output) {
+            ok = cli_job_write(job, chart, &err);
+        } else {
+            ok = cli_job_render(job, chart, &err);
+        }
+
+        g_object_unref(chart);
+    }
+
+    if (!ok) {
+        g_printerr(
+                "%s: %s\n",
+                job->source,
+                (err) ? err->message : "unknown error"
+            );
+        g_clear_error(&err);
+        g_atomic_int_inc(&failures);
+    }
+}
+
+/*
+ * cli_get_output:
+ *
+ * Get the output file for a chart named @base_name. If @base_name is already
+ * used by another chart, a number is appended to it.
+ */
+static GFile *
+cli_get_output(GFile *dir, const gchar *base_name, GHashTable *used_names)
+{
+    gchar *file_name;
+    guint i;
+    GFile *file;
+
+    file_name = g_strdup_printf("%s.%s", base_name, format->name);
+
+    for (i = 2; g_hash_table_contains(used_names, file_name); i++) {
+        g_free(file_name);
+        file_name = g_strdup_printf("%s (%u).%s", base_name, i, format->name);
+    }
+
+    file = g_file_get_child(dir, file_name);
+    g_hash_table_add(used_names, file_name);
+
+    return file;
+}
+
+static gboolean
+cli_add_file_jobs(GPtrArray *job_list, GError **err)
+{
+    gchar **input;
+
+    for (input = inputs; input && *input; input++) {
+        CliJob *job = g_new0(CliJob, 1);
+
+        if (strcmp(*input, "-") == 0) {
+            GIOChannel *channel;
+            GIOStatus  status;
+
+            job->source = g_strdup("stdin");
+            channel     = g_io_channel_unix_new(fileno(stdin));
+            g_io_channel_set_encoding(channel, NULL, NULL);
+            status = g_io_channel_read_to_end(
+                    channel,
+                    &(job->data),
+                    &(job->length),
+                    err
+                );
+            g_io_channel_unref(channel);
+
+            if (status != G_IO_STATUS_NORMAL) {
+                cli_job_free(job);
+
+                return FALSE;
+            }
+        } else {
+            job->source = g_strdup(*input);
+            job->input  = g_file_new_for_commandline_arg(*input);
+        }
+
+        g_ptr_array_add(job_list, job);
+    }
+
+    return TRUE;
+}
+
+static void
+cli_add_save_job(GPtrArray *job_list, AgDbChartSave *save_data)
+{
+    CliJob *job = g_new0(CliJob, 1);
+
+    job->source    = g_strdup_printf(
+            "%s (%d)",
+            (save_data->name) ? save_data->name : "",
+            save_data->db_id
+        );
+    job->save_data = save_data;
+    g_ptr_array_add(job_list, job);
+}
+
+static gboolean
+cli_add_db_jobs(GPtrArray *job_list, GError **err)
+{
+    AgDb  *db;
+    gchar **id;
+
+    if ((db_ids == NULL) && !all_db) {
+        return TRUE;
+    }
+
+    db = ag_db_get();
+
+    for (id = db_ids; id && *id; id++) {
+        AgDbChartSave *save_data;
+        gchar         *end;
+        guint64       row_id;
+
+        row_id = g_ascii_strtoull(*id, &end, 10);
+
+        if ((*end != '\0') || (end == *id) || (row_id > G_MAXINT)) {
+            g_set_error(
+                    err,
+                    G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE,
+                    "Invalid chart ID: %s",
+                    *id
+                );
+            g_object_unref(db);
+
+            return FALSE;
+        }
+
+        if ((save_data = ag_db_chart_get_data_by_id(
+                    db,
+                    (guint)row_id,
+                    err
+                )) == NULL) {
+            g_object_unref(db);
+
+            return FALSE;
+        }
+
+        cli_add_save_job(job_list, save_data);
+    }
+
+    if (all_db) {
+        AgDbChartList *list;
+        GList         *rows,
+                      *l;
+
+        if ((list = ag_db_chart_list_open(db, err)) == NULL) {
+            g_object_unref(db);
+
+            return FALSE;
+        }
+
+        while ((rows = ag_db_chart_list_next(list, 100)) != NULL) {
+            for (l = rows; l; l = g_list_next(l)) {
+                cli_add_save_job(job_list, l->data);
+            }
+
+            g_list_free(rows);
+        }
+
+        ag_db_chart_list_close(list);
+    }
+
+    g_object_unref(db);
+
+    return TRUE;
+}
+
+/*
+ * cli_set_outputs:
+ *
+ * Set the output file of every job in @job_list. File names are made from
+ * the input file names, or from the chart names and IDs for the charts read
+ * from the database.
+ */
+static void
+cli_set_outputs(GPtrArray *job_list)
+{
+    GFile      *dir;
+    GHashTable *used_names;
+    guint      i;
+
+    dir        = g_file_new_for_commandline_arg((output_dir) ? output_dir : ".");
+    used_names = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+    for (i = 0; i < job_list->len; i++) {
+        CliJob *job = g_ptr_array_index(job_list, i);
+        gchar  *base_name,
+               *extension;
+
+        if (job->save_data) {
+            base_name = g_strdup(job->source);
+            g_strdelimit(base_name, G_DIR_SEPARATOR_S, '_');
+        } else if (job->input) {
+            base_name = g_file_get_basename(job->input);
+
+            if ((extension = strrchr(base_name, '.')) != NULL) {
+                *extension = '\0';
+            }
+        } else {
+            base_name = g_strdup(job->source);
+        }
+
+        job->output = cli_get_output(dir, base_name, used_names);
+        g_free(base_name);
+    }
+
+    g_hash_table_unref(used_names);
+    g_object_unref(dir);
+}
+
+static gboolean
+cli_parse_options(GError **err)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(cli_formats); i++) {
+        if (g_ascii_strcasecmp(format_name, cli_formats[i].name) == 0) {
+            format = &(cli_formats[i]);
+
+            break;
+        }
+    }
+
+    if (format == NULL) {
+        g_set_error(
+                err,
+                G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE,
+                "Unknown output format: %s",
+                format_name
+            );
+
+        return FALSE;
+    }
+
+    if ((house_system = ag_house_system_nick_to_id(
+                house_system_name
+            )) == GSWE_HOUSE_SYSTEM_NONE) {
+        g_set_error(
+                err,
+                G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE,
+                "Unknown house system: %s",
+                house_system_name
+            );
+
+        return FALSE;
+    }
+
+    for (i = 0; i < G_N_ELEMENTS(cli_themes); i++) {
+        if (g_ascii_strcasecmp(theme_name, cli_themes[i].name) == 0) {
+            theme = ag_display_theme_get_by_id(cli_themes[i].id);
+
+            break;
+        }
+    }
+
+    if (theme == NULL) {
+        g_set_error(
+                err,
+                G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE,
+                "Unknown display theme: %s",
+                theme_name
+            );
+
+        return FALSE;
+    }
+
+    if (image_size < 0) {
+        g_set_error(
+                err,
+                G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE,
+                "Invalid image size: %d",
+                image_size
+            );
+
+        return FALSE;
+    }
+
+    if (jobs <= 0) {
+        jobs = g_get_num_processors();
+    }
+
+    return TRUE;
+}
+
+int
+main(int argc, char *argv[])
+{
+    GOptionContext *context;
+    GError         *err = NULL;
+    GPtrArray      *job_list;
+    GThreadPool    *pool;
+    guint          i,
+                   hits,
+                   misses;
+    gint64         start;
+    gdouble        elapsed;
+
+    context = g_option_context_new("- calculate and render charts");
+    g_option_context_add_main_entries(context, option_entries, NULL);
+    g_option_context_set_description(
+            context,
+            "FILE can be an Astrognome (.agc) or a Placidus (.hor) file, or - "
+            "to read Astrognome data from the standard input."
+        );
+
+    if (!g_option_context_parse(context, &argc, &argv, &err)) {
+        g_printerr("%s\n", err->message);
+
+        return EXIT_FAILURE;
+    }
+
+    g_option_context_free(context);
+
+    ag_init();
+
+    if (!cli_parse_options(&err)) {
+        g_printerr("%s\n", err->message);
+
+        return EXIT_FAILURE;
+    }
+
+    job_list = g_ptr_array_new_with_free_func((GDestroyNotify)cli_job_free);
+
+    if (
+                !cli_add_file_jobs(job_list, &err)
+                || !cli_add_db_jobs(job_list, &err)
+            ) {
+        g_printerr("%s\n", (err) ? err->message : "unknown error");
+        g_ptr_array_unref(job_list);
+
+        return EXIT_FAILURE;
+    }
+
+    if (job_list->len == 0) {
+        g_printerr("Nothing to do; give some files, --db-id or --all\n");
+        g_ptr_array_unref(job_list);
+
+        return EXIT_FAILURE;
+    }
+
+    if (to_stdout && !format->json && (job_list->len > 1)) {
+        g_printerr("Only one image can be written to the standard output\n");
+        g_ptr_array_unref(job_list);
+
+        return EXIT_FAILURE;
+    }
+
+    if (!to_stdout) {
+        cli_set_outputs(job_list);
+    }
+
+    start = g_get_monotonic_time();
+    pool  = g_thread_pool_new(
+            (GFunc)cli_job_run,
+            NULL,
+            MIN((guint)jobs, job_list->len),
+            TRUE,
+            NULL
+        );
+
+    for (i = 0; i < job_list->len; i++) {
+        g_thread_pool_push(pool, g_ptr_array_index(job_list, i), NULL);
+    }
+
+    g_thread_pool_free(pool, FALSE, TRUE);
+    elapsed = (g_get_monotonic_time() - start) / (gdouble)G_USEC_PER_SEC;
+
+    // Results go to the standard output in the order of the inputs,
+    // regardless of which one got ready first
+    if (to_stdout) {
+        for (i = 0; i < job_list->len; i++) {
+            CliJob *job = g_ptr_array_index(job_list, i);
+
+            if (job->result == NULL) {
+                continue;
+            }
+
+            fwrite(job->result, 1, job->result_length, stdout);
+
+            if (format->json) {
+                fputc('\n', stdout);
+            }
+        }
+
+        fflush(stdout);
+    }
+
+    if (!quiet) {
+        g_printerr(
+                "%u charts in %.3f s (%.1f charts/s, %d threads), %d failed\n",
+                job_list->len,
+                elapsed,
+                (elapsed > 0.0) ? job_list->len / elapsed : 0.0,
+                MIN(jobs, (gint)job_list->len),
+                failures
+            );
+
+        ag_chart_get_ephemeris_cache_stats(&hits, &misses);
+        g_printerr(
+                "Ephemeris cache: %u hits, %u misses\n",
+                hits,
+                misses
+            );
+    }
+
+    g_ptr_array_unref(job_list);
+    ag_chart_invalidate_stylesheet_cache();
+    ag_chart_clear_ephemeris_cache();
+
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
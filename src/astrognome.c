@@ -1,4 +1,4 @@
-/* astrognome.c - Utility functions and main() for Astrognome
+/* astrognome.c - Utility functions for Astrognome
  *
  * Copyright (C) 2014 Polonkai Gergely
  *
@@ -16,7 +16,6 @@
  * along with this software; if not, see
  * <http://www.gnu.org/licenses/>.
  */
-#include <stdlib.h>
 #include <glib.h>
 #include <gtk/gtk.h>
 #include <glib/gi18n.h>
@@ -25,18 +24,14 @@
 #include <libxslt/xslt.h>
 #include <libxslt/transform.h>
 #include <libexslt/exslt.h>
-#include <libxml/xmlreader.h>
 
 #include <swe-glib.h>
 
 #include "config.h"
 
-#include "ag-app.h"
-#include "ag-window.h"
-
-#ifndef LIBXML_READER_ENABLED
-#error "You need to have libxml2 with XmlReader enabled"
-#endif
+#include "astrognome.h"
+#include "ag-chart.h"
+#include "ag-trace.h"
 
 GtkBuilder    *builder;
 GtkFileFilter *filter_all   = NULL;
@@ -46,10 +41,16 @@ GtkFileFilter *filter_svg   = NULL;
 GtkFileFilter *filter_jpg   = NULL;
 GtkFileFilter *filter_png   = NULL;
 GtkTreeModel  *country_list = NULL;
-GtkTreeModel  *city_list    = NULL;
-GHashTable    *xinclude_positions;
+AgGeodata     *geodata      = NULL;
 gsize         used_planets_count;
 
+// A gres:// link opened by libxml. Every open link has its own read
+// position, so the same resource can be read by several threads at once.
+typedef struct {
+    GBytes *data;
+    gsize  position;
+} AgGresourceStream;
+
 const char    *moonStateName[] = {
     "New Moon",
     "Waxing Crescent Moon",
@@ -140,9 +141,9 @@ xml_match_gresource(const char *uri)
 static void *
 xml_open_gresource(const gchar *uri)
 {
-    gchar  *path;
-    GBytes *res_location;
-    gsize  *position;
+    gchar             *path;
+    GBytes            *res_location;
+    AgGresourceStream *stream;
 
     if ((uri == NULL) || (strncmp("gres://", uri, 7))) {
         return NULL;
@@ -158,30 +159,29 @@ xml_open_gresource(const gchar *uri)
         );
     g_free(path);
 
-    if ((position = g_hash_table_lookup(
-                 xinclude_positions,
-                 res_location
-             )) == NULL) {
-        g_hash_table_insert(xinclude_positions, res_location, g_new0(gsize, 1));
-    } else {
-        g_warning("Reopening gres:// link?");
-        *position = 0;
+    if (res_location == NULL) {
+        return NULL;
     }
 
-    return res_location;
+    stream       = g_new0(AgGresourceStream, 1);
+    stream->data = res_location;
+
+    return stream;
 }
 
 static int
 xml_close_gresource(void *context)
 {
-    if (context == NULL) {
+    AgGresourceStream *stream = context;
+
+    if (stream == NULL) {
         return -1;
     }
 
     g_debug("Closing gres:// link");
 
-    g_hash_table_remove(xinclude_positions, context);
-    g_bytes_unref((GBytes *)context);
+    g_bytes_unref(stream->data);
+    g_free(stream);
 
     return 0;
 }
@@ -189,35 +189,27 @@ xml_close_gresource(void *context)
 static int
 xml_read_gresource(void *context, char *buffer, int len)
 {
-    const gchar *data;
-    gsize       max_length;
-    GBytes      *data_holder = (GBytes *)context;
-    gsize       *position;
+    const gchar       *data;
+    gsize             max_length;
+    AgGresourceStream *stream = context;
 
-    if ((context == NULL) || (buffer == NULL) || (len < 0)) {
+    if ((stream == NULL) || (buffer == NULL) || (len < 0)) {
         return -1;
     }
 
-    data     = g_bytes_get_data(data_holder, &max_length);
-    position = g_hash_table_lookup(xinclude_positions, data_holder);
-
-    if (position == NULL) {
-        g_warning("Trying to read non-opened gres:// link!");
-
-        return -1;
-    }
+    data = g_bytes_get_data(stream->data, &max_length);
 
-    if (*position >= max_length) {
+    if (stream->position >= max_length) {
         return 0;
     }
 
-    if (len > max_length - *position) {
-        len = max_length - *position;
+    if (len > max_length - stream->position) {
+        len = max_length - stream->position;
     }
 
-    memcpy(buffer, data + *position, len);
+    memcpy(buffer, data + stream->position, len);
     g_debug("Read %d bytes", len);
-    *position += len;
+    stream->position += len;
 
     return len;
 }
@@ -384,45 +376,24 @@ ag_get_user_data_dir(void)
     return ag_data_dir;
 }
 
-int
-main(int argc, char *argv[])
+/**
+ * ag_init:
+ *
+ * Initializes the libraries used for chart calculation and rendering. This
+ * must be called before any charts are created, by every program using the
+ * Astrognome sources.
+ *
+ * Charts are rendered with the stylesheet flattened at build time. If the
+ * ASTROGNOME_XINCLUDE_STYLESHEET environment variable is set, the original
+ * stylesheet is used, with its XIncludes resolved at runtime.
+ *
+ * If the ASTROGNOME_TRACE environment variable is set, the time of the
+ * rendering stages, database queries and geodata loading is recorded from
+ * the start; see ag_trace_get_histograms().
+ */
+void
+ag_init(void)
 {
-    gint              status;
-    AgApp             *app;
-    xmlTextReaderPtr  reader;
-    AstrognomeOptions options;
-    GError            *err             = NULL;
-    GOptionEntry      option_entries[] = {
-        {
-                "new-window", 'n',
-                0, G_OPTION_ARG_NONE,
-                &(options.new_window),
-                N_("Opens a new Astrognome window"),
-                NULL
-        },
-        {
-                "version",    'v',
-                0, G_OPTION_ARG_NONE,
-                &(options.version),
-                N_("Display version and exit"),
-                NULL
-        },
-        {
-                "quit",       'q',
-                0, G_OPTION_ARG_NONE,
-                &(options.quit),
-                N_("Quit any running Astrognome"),
-                NULL
-        },
-        { NULL }
-    };
-
-#ifdef ENABLE_NLS
-    bindtextdomain(GETTEXT_PACKAGE, LOCALEDIR);
-    bind_textdomain_codeset(GETTEXT_PACKAGE, "UTF-8");
-    textdomain(GETTEXT_PACKAGE);
-#endif
-
     used_planets_count = sizeof(used_planets) / sizeof(GswePlanet);
     LIBXML_TEST_VERSION;
     xmlSubstituteEntitiesDefault(1);
@@ -437,195 +408,12 @@ main(int argc, char *argv[])
     xsltSetXIncludeDefault(1);
     exsltRegisterAll();
     gswe_init();
-    xinclude_positions = g_hash_table_new_full(
-            g_bytes_hash,
-            g_bytes_equal,
-            (GDestroyNotify)g_bytes_unref,
-            (GDestroyNotify)g_free
-        );
-
-    memset(&options, 0, sizeof(AstrognomeOptions));
-
-    if (!gtk_init_with_args(
-                &argc, &argv,
-                _("[FILE…]"
-            ), option_entries, GETTEXT_PACKAGE, &err)) {
-        g_printerr("%s\n", err->message);
 
-        return EXIT_FAILURE;
+    if (g_getenv("ASTROGNOME_XINCLUDE_STYLESHEET") != NULL) {
+        ag_chart_set_flat_stylesheet(FALSE);
     }
 
-    if (options.version) {
-        g_print("%s\n", PACKAGE_STRING);
-
-        return EXIT_SUCCESS;
-    }
-
-    init_filters();
-
-    app = ag_app_new();
-    g_application_set_default(G_APPLICATION(app));
-
-    if (!g_application_register(G_APPLICATION(app), NULL, &err)) {
-        g_printerr(
-                "Couldn't register Astrognome instance: '%s'\n",
-                (err) ? err->message : ""
-            );
-        g_object_unref(app);
-
-        return EXIT_FAILURE;
+    if (g_getenv("ASTROGNOME_TRACE") != NULL) {
+        ag_trace_set_enabled(TRUE);
     }
-
-    if (g_application_get_is_remote(G_APPLICATION(app))) {
-        ag_app_run_action(app, TRUE, (const AstrognomeOptions *)&options);
-        g_object_unref(app);
-
-        return EXIT_SUCCESS;
-    }
-
-    country_list = GTK_TREE_MODEL(gtk_list_store_new(
-            AG_COUNTRY_COLCOUNT,
-            G_TYPE_STRING,
-            G_TYPE_STRING
-        ));
-
-    city_list = GTK_TREE_MODEL(gtk_list_store_new(
-            AG_CITY_COLCOUNT,
-            G_TYPE_STRING,
-            G_TYPE_STRING,
-            G_TYPE_DOUBLE,
-            G_TYPE_DOUBLE,
-            G_TYPE_DOUBLE,
-            G_TYPE_DOUBLE,
-            G_TYPE_DOUBLE
-        ));
-
-    reader = xmlReaderForFile(PKGDATADIR "/geodata.xml", NULL, 0);
-
-    if (reader != NULL) {
-        int ret;
-
-        while ((ret = xmlTextReaderRead(reader)) == 1) {
-            gchar        *name;
-            GtkTreeIter  iter;
-
-            name = (gchar *)xmlTextReaderConstName(reader);
-
-            if (strcmp(name, "p") == 0) {
-                gchar   *aname,
-                        *acode,
-                        *alat,
-                        *alon,
-                        *aalt,
-                        *atzo,
-                        *atzd,
-                        *endptr;
-                gdouble lat,
-                        lon,
-                        alt,
-                        tzo,
-                        tzd;
-
-                aname = (gchar *)xmlTextReaderGetAttribute(
-                        reader,
-                        BAD_CAST "n"
-                    );
-                acode = (gchar *)xmlTextReaderGetAttribute(
-                        reader,
-                        BAD_CAST "c"
-                    );
-                alat = (gchar *)xmlTextReaderGetAttribute(
-                        reader,
-                        BAD_CAST "lat"
-                    );
-                alon = (gchar *)xmlTextReaderGetAttribute(
-                        reader,
-                        BAD_CAST "lon"
-                    );
-                aalt = (gchar *)xmlTextReaderGetAttribute(
-                        reader,
-                        BAD_CAST "alt"
-                    );
-                atzo = (gchar *)xmlTextReaderGetAttribute(
-                        reader,
-                        BAD_CAST "tzo"
-                    );
-                atzd = (gchar *)xmlTextReaderGetAttribute(
-                        reader,
-                        BAD_CAST "tzd"
-                    );
-
-                lat = g_ascii_strtod(alat, &endptr);
-                lon = g_ascii_strtod(alon, &endptr);
-
-                if (*aalt == '\0') {
-                    alt = DEFAULT_ALTITUDE;
-                } else {
-                    alt = g_ascii_strtod(aalt, &endptr);
-                }
-
-                tzo = g_ascii_strtod(atzo, &endptr);
-                tzd = g_ascii_strtod(atzd, &endptr);
-
-                gtk_list_store_append(GTK_LIST_STORE(city_list), &iter);
-                gtk_list_store_set(
-                        GTK_LIST_STORE(city_list), &iter,
-                        AG_CITY_COUNTRY, acode,
-                        AG_CITY_NAME,    aname,
-                        AG_CITY_LAT,     lat,
-                        AG_CITY_LONG,    lon,
-                        AG_CITY_ALT,     alt,
-                        AG_CITY_TZO,     tzo,
-                        AG_CITY_TZD,     tzd,
-                        -1
-                    );
-
-                g_free(aname);
-                g_free(acode);
-                g_free(alat);
-                g_free(alon);
-                g_free(aalt);
-                g_free(atzo);
-                g_free(atzd);
-            } else if (strcmp(name, "c") == 0) {
-                gchar *aname,
-                      *acode;
-
-                aname = (gchar *)xmlTextReaderGetAttribute(
-                        reader,
-                        BAD_CAST "n"
-                    );
-                acode = (gchar *)xmlTextReaderGetAttribute(
-                        reader,
-                        BAD_CAST "c"
-                    );
-
-                gtk_list_store_append(GTK_LIST_STORE(country_list), &iter);
-                gtk_list_store_set(
-                        GTK_LIST_STORE(country_list), &iter,
-                        AG_COUNTRY_CODE, acode,
-                        AG_COUNTRY_NAME, aname,
-                        -1
-                    );
-
-                g_free(aname);
-                g_free(acode);
-            }
-        }
-
-        xmlFreeTextReader(reader);
-
-        if (ret != 0) {
-            g_error("Parse error in geodata.xml!");
-        }
-    } else {
-        g_error("Unable to open geodata.xml!");
-    }
-
-    status = g_application_run(G_APPLICATION(app), argc, argv);
-
-    g_hash_table_destroy(xinclude_positions);
-    g_object_unref(app);
-
-    return status;
 }
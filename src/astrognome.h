@@ -1,4 +1,4 @@
-/* astrognome.h - Utility functions and main() for Astrognome
+/* astrognome.h - Utility functions for Astrognome
  *
  * Copyright (C) 2014 Polonkai Gergely
  *
@@ -22,6 +22,8 @@
 #include <gtk/gtk.h>
 #include <swe-glib.h>
 
+#include "ag-geodata.h"
+
 typedef struct {
     gboolean version;
     gboolean quit;
@@ -35,7 +37,7 @@ extern GtkFileFilter    *filter_svg;
 extern GtkFileFilter    *filter_jpg;
 extern GtkFileFilter    *filter_png;
 extern GtkTreeModel     *country_list;
-extern GtkTreeModel     *city_list;
+extern AgGeodata        *geodata;
 extern const GswePlanet used_planets[];
 extern gsize            used_planets_count;
 
@@ -70,6 +72,10 @@ GsweAntiscionAxis ag_antiscion_axis_nick_to_id(const gchar *nick);
 
 GFile *ag_get_user_data_dir(void);
 
+void init_filters(void);
+
+void ag_init(void);
+
 #ifndef GDOUBLE_FROM_LE
 inline static gdouble
 GDOUBLE_SWAP_LE_BE(gdouble in)
@@ -0,0 +1,876 @@
+/* bench-render.c - Chart rendering benchmark for Astrognome
+ *
+ * Copyright (C) 2014 Polonkai Gergely
+ *
+ * Astrognome is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Astrognome is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <swe-glib.h>
+
+#include "config.h"
+
+#include "astrognome.h"
+#include "ag-chart.h"
+#include "ag-chart-renderer.h"
+#include "ag-db.h"
+#include "ag-display-theme.h"
+#include "ag-geodata.h"
+#include "ag-trace.h"
+
+// Renders the same charts with the cairo renderer and with the
+// XSLT + librsvg pipeline, at icon view preview size and at export size,
+// and prints the average time of one rendering. The time of generating the
+// SVG (building the XML tree, the XSLT transformation and serializing the
+// result, but no rasterization) is measured on full charts, with every body
+// shown.
+// The "svg-css" preview renders keep the elements hidden by the theme in the
+// SVG, only hiding them with CSS.
+//
+// With --threads, the SVG of the full charts is also generated from several
+// threads at once, and every result is compared to the single threaded one.
+//
+// The stages of ag_chart_get_pixbuf_from_svg() are timed one by one: the
+// ephemeris calculation, building the XML tree, parsing the stylesheet,
+// applying it, serializing the SVG and rasterizing it with librsvg. The
+// chart list is loaded from synthetic databases of --db-rows charts, which
+// are created in a temporary data directory, and the time of opening the
+// geodata file is measured, too.
+//
+// With --machine-readable, every line is a tab separated group, name, run
+// count and milliseconds per run, so results of different releases can be
+// compared.
+
+typedef GdkPixbuf *(*BenchRenderFunc)(AgChart *,
+                                      guint,
+                                      guint,
+                                      AgDisplayTheme *,
+                                      GError **);
+
+typedef struct {
+    gint    year;
+    gint    month;
+    gint    day;
+    gint    hour;
+    gint    minute;
+    gdouble timezone;
+    gdouble longitude;
+    gdouble latitude;
+} BenchChart;
+
+static const BenchChart bench_charts[] = {
+    { 1983,  3,  7, 11, 54, 1.0,  19.081599, 47.462485 },
+    { 1969,  7, 20, 20, 17, 0.0, -95.611420, 29.560380 },
+    { 2000,  1,  1,  0,  0, 0.0,  -0.127758, 51.507351 },
+    { 1955, 11, 12, 22,  4, 9.0, 139.691706, 35.689487 },
+};
+
+typedef struct {
+    GList          *charts;
+    gchar          **expected;
+    AgDisplayTheme *theme;
+    volatile gint  count;
+    volatile gint  mismatches;
+} BenchThreadData;
+
+
+static gint     iterations       = 10;
+static gint     chart_count      = G_N_ELEMENTS(bench_charts);
+static gint     threads          = 0;
+static gchar    *db_rows         = "10000,100000";
+static gchar    *geodata_file    = PKGDATADIR "/geodata.bin";
+static gboolean machine_readable = FALSE;
+
+static GOptionEntry option_entries[] = {
+    {
+        "iterations", 'n',
+        0, G_OPTION_ARG_INT,
+        &iterations,
+        "Render every chart N times (default: 10)",
+        "N"
+    },
+    {
+        "charts", 'c',
+        0, G_OPTION_ARG_INT,
+        &chart_count,
+        "Render N different charts (default: 4)",
+        "N"
+    },
+    {
+        "threads", 't',
+        0, G_OPTION_ARG_INT,
+        &threads,
+        "Also generate the SVG of the full charts from N threads at once, and check the results",
+        "N"
+    },
+    {
+        "db-rows", 'd',
+        0, G_OPTION_ARG_STRING,
+        &db_rows,
+        "Load the chart list from databases with these numbers of charts, in increasing order; empty to skip (default: 10000,100000)",
+        "N,…"
+    },
+    {
+        "geodata", 'g',
+        0, G_OPTION_ARG_FILENAME,
+        &geodata_file,
+        "Measure opening FILE as geodata (default: the installed geodata)",
+        "FILE"
+    },
+    {
+        "machine-readable", 'm',
+        0, G_OPTION_ARG_NONE,
+        &machine_readable,
+        "Print tab separated values",
+        NULL
+    },
+    { NULL }
+};
+
+static void
+bench_print(const gchar *group,
+            const gchar *name,
+            guint       count,
+            gint64      elapsed)
+{
+    gdouble per_run = (count == 0) ? 0.0 : elapsed / 1000.0 / count;
+
+    if (machine_readable) {
+        g_print("%s\t%s\t%u\t%.3f\n", group, name, count, per_run);
+    } else {
+        g_print(
+                "%-7s %-13s %6u runs, %10.3f ms/run\n",
+                group,
+                name,
+                count,
+                per_run
+            );
+    }
+}
+
+/*
+ * bench_new_chart:
+ *
+ * Create the @index-th benchmark chart. Every round over bench_charts moves
+ * the time a bit, so all the charts are different.
+ */
+static AgChart *
+bench_new_chart(guint index, gboolean preview)
+{
+    const BenchChart *data;
+    guint            shift;
+    GsweTimestamp    *timestamp;
+
+    data  = &(bench_charts[index % G_N_ELEMENTS(bench_charts)]);
+    shift = index / G_N_ELEMENTS(bench_charts);
+
+    timestamp = gswe_timestamp_new_from_gregorian_full(
+            data->year, data->month, data->day,
+            (data->hour + shift) % 24, (data->minute + shift * 7) % 60, 0, 0,
+            data->timezone
+        );
+
+    if (preview) {
+        return ag_chart_new_preview(
+                timestamp,
+                data->longitude,
+                data->latitude,
+                280.0,
+                GSWE_HOUSE_SYSTEM_PLACIDUS
+            );
+    }
+
+    return ag_chart_new_full(
+            timestamp,
+            data->longitude,
+            data->latitude,
+            280.0,
+            GSWE_HOUSE_SYSTEM_PLACIDUS
+        );
+}
+
+static void
+bench_render(const gchar     *renderer,
+             BenchRenderFunc render_func,
+             const gchar     *size_name,
+             GList           *charts,
+             guint           image_size,
+             guint           icon_size,
+             AgDisplayTheme  *theme)
+{
+    GList   *l;
+    gint    i;
+    guint   count = 0;
+    gint64  start;
+
+    // Warm up the stylesheet and symbol caches, so they don’t count
+    render_func(charts->data, image_size, icon_size, theme, NULL);
+
+    start = g_get_monotonic_time();
+
+    for (i = 0; i < iterations; i++) {
+        for (l = charts; l; l = g_list_next(l)) {
+            GdkPixbuf *pixbuf;
+            GError    *err = NULL;
+
+            if ((pixbuf = render_func(
+                        l->data,
+                        image_size,
+                        icon_size,
+                        theme,
+                        &err
+                    )) == NULL) {
+                g_printerr(
+                        "%s rendering failed: %s\n",
+                        renderer,
+                        (err) ? err->message : "unknown error"
+                    );
+                g_clear_error(&err);
+
+                continue;
+            }
+
+            g_object_unref(pixbuf);
+            count++;
+        }
+    }
+
+    bench_print(
+            renderer,
+            size_name,
+            count,
+            g_get_monotonic_time() - start
+        );
+}
+
+static void
+bench_create_svg(GList *charts, AgDisplayTheme *theme)
+{
+    GList  *l;
+    gint   i;
+    guint  count = 0;
+    gint64 start;
+    gchar  *svg;
+
+    svg = ag_chart_create_svg(charts->data, NULL, TRUE, theme, 0, 0, NULL);
+    g_free(svg);
+
+    start = g_get_monotonic_time();
+
+    for (i = 0; i < iterations; i++) {
+        for (l = charts; l; l = g_list_next(l)) {
+            GError *err = NULL;
+
+            if ((svg = ag_chart_create_svg(
+                        l->data,
+                        NULL,
+                        TRUE,
+                        theme,
+                        0, 0,
+                        &err
+                    )) == NULL) {
+                g_printerr(
+                        "SVG generation failed: %s\n",
+                        (err) ? err->message : "unknown error"
+                    );
+                g_clear_error(&err);
+
+                continue;
+            }
+
+            g_free(svg);
+            count++;
+        }
+    }
+
+    bench_print("to-svg", "full", count, g_get_monotonic_time() - start);
+}
+
+/*
+ * bench_ephemeris_run:
+ * @cached: %FALSE to empty the ephemeris cache before each chart
+ *
+ * Time the chart calculation, either calculating the planets of each chart,
+ * or letting the charts share the cached planets.
+ */
+static void
+bench_ephemeris_run(gboolean cached)
+{
+    gint   i;
+    guint  j,
+           count = 0;
+    gint64 start;
+
+    ag_chart_clear_ephemeris_cache();
+    start = g_get_monotonic_time();
+
+    for (i = 0; i < iterations; i++) {
+        for (j = 0; j < (guint)chart_count; j++) {
+            AgChart       *chart = bench_new_chart(j, FALSE);
+            AgChartLayout *layout;
+
+            if (!cached) {
+                ag_chart_clear_ephemeris_cache();
+            }
+
+            layout = ag_chart_get_layout(chart);
+            ag_chart_layout_free(layout);
+            g_object_unref(chart);
+            count++;
+        }
+    }
+
+    bench_print(
+            "stage",
+            (cached) ? "ephemeris-hit" : "ephemeris",
+            count,
+            g_get_monotonic_time() - start
+        );
+}
+
+static void
+bench_ephemeris(void)
+{
+    guint hits_before,
+          misses_before,
+          hits,
+          misses;
+
+    bench_ephemeris_run(FALSE);
+
+    ag_chart_get_ephemeris_cache_stats(&hits_before, &misses_before);
+    bench_ephemeris_run(TRUE);
+    ag_chart_get_ephemeris_cache_stats(&hits, &misses);
+
+    if (!machine_readable) {
+        g_print(
+                "Ephemeris cache: %u hits, %u misses in the cached run\n",
+                hits - hits_before,
+                misses - misses_before
+            );
+    }
+}
+
+static void
+bench_print_stage(AgTraceMark mark, const gchar *name)
+{
+    guint  count;
+    gint64 elapsed;
+
+    ag_trace_get_totals(mark, &count, &elapsed);
+    bench_print("stage", name, count, elapsed);
+}
+
+/*
+ * bench_stages:
+ *
+ * Time the stages of rendering @charts through SVG. The charts are
+ * calculated beforehand, so building the XML tree doesn’t include the
+ * ephemeris calculation.
+ */
+static void
+bench_stages(GList *charts, AgDisplayTheme *theme)
+{
+    GList *l;
+    gint  i;
+
+    for (l = charts; l; l = g_list_next(l)) {
+        ag_chart_layout_free(ag_chart_get_layout(l->data));
+    }
+
+    // The stages are measured by the render pipeline tracing
+    ag_trace_set_enabled(TRUE);
+    ag_trace_clear();
+
+    // Parse the stylesheet again for every rendering
+    for (i = 0; i < iterations; i++) {
+        gchar *svg;
+
+        ag_chart_invalidate_stylesheet_cache();
+        svg = ag_chart_create_svg(charts->data, NULL, TRUE, theme, 0, 0, NULL);
+        g_free(svg);
+    }
+
+    bench_print_stage(AG_TRACE_CHART_STYLESHEET, "parse-xsl");
+    ag_trace_clear();
+
+    for (i = 0; i < iterations; i++) {
+        for (l = charts; l; l = g_list_next(l)) {
+            GdkPixbuf *pixbuf;
+
+            if ((pixbuf = ag_chart_get_pixbuf_from_svg(
+                        l->data,
+                        0, 0,
+                        theme,
+                        NULL
+                    )) != NULL) {
+                g_object_unref(pixbuf);
+            }
+        }
+    }
+
+    bench_print_stage(AG_TRACE_CHART_TREE, "tree");
+    bench_print_stage(AG_TRACE_CHART_XSLT, "xslt");
+    bench_print_stage(AG_TRACE_CHART_SERIALIZE, "serialize");
+    bench_print_stage(AG_TRACE_CHART_RSVG, "rsvg");
+
+    ag_trace_set_enabled(FALSE);
+    ag_trace_clear();
+}
+
+static gpointer
+bench_thread(BenchThreadData *data)
+{
+    GList *l;
+    gint  i;
+    guint j;
+
+    for (i = 0; i < iterations; i++) {
+        for (l = data->charts, j = 0; l; l = g_list_next(l), j++) {
+            gchar  *svg;
+            GError *err = NULL;
+
+            if ((svg = ag_chart_create_svg(
+                        l->data,
+                        NULL,
+                        TRUE,
+                        data->theme,
+                        0, 0,
+                        &err
+                    )) == NULL) {
+                g_printerr(
+                        "SVG generation failed: %s\n",
+                        (err) ? err->message : "unknown error"
+                    );
+                g_clear_error(&err);
+                g_atomic_int_inc(&(data->mismatches));
+
+                continue;
+            }
+
+            if (g_strcmp0(svg, data->expected[j]) != 0) {
+                g_atomic_int_inc(&(data->mismatches));
+            }
+
+            g_free(svg);
+            g_atomic_int_inc(&(data->count));
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * bench_threads:
+ *
+ * Transform every chart in @charts @iterations times from each of @threads
+ * threads, and compare the results to the output of a single threaded
+ * transformation.
+ *
+ * Returns: %TRUE if every result was the same
+ */
+static gboolean
+bench_threads(GList *charts, AgDisplayTheme *theme)
+{
+    BenchThreadData data = { charts, NULL, theme, 0, 0 };
+    GThread         **thread_list;
+    GList           *l;
+    guint           i;
+    gint64          start;
+
+    data.expected = g_new0(gchar *, g_list_length(charts) + 1);
+
+    for (l = charts, i = 0; l; l = g_list_next(l), i++) {
+        data.expected[i] = ag_chart_create_svg(
+                l->data,
+                NULL,
+                TRUE,
+                theme,
+                0, 0,
+                NULL
+            );
+    }
+
+    thread_list = g_new0(GThread *, threads);
+    start       = g_get_monotonic_time();
+
+    for (i = 0; i < threads; i++) {
+        thread_list[i] = g_thread_new(
+                "bench-render",
+                (GThreadFunc)bench_thread,
+                &data
+            );
+    }
+
+    for (i = 0; i < threads; i++) {
+        g_thread_join(thread_list[i]);
+    }
+
+    bench_print(
+            "to-svg",
+            "full-mt",
+            data.count,
+            g_get_monotonic_time() - start
+        );
+
+    if (data.mismatches > 0) {
+        g_printerr(
+                "%d parallel transformations failed or differ from the single threaded result\n",
+                data.mismatches
+            );
+    }
+
+    g_free(thread_list);
+    g_strfreev(data.expected);
+
+    return (data.mismatches == 0);
+}
+
+static AgDbChartSave *
+bench_new_save(guint index)
+{
+    const BenchChart *data;
+    AgDbChartSave    *save_data = ag_db_chart_save_new(TRUE);
+
+    data = &(bench_charts[index % G_N_ELEMENTS(bench_charts)]);
+
+    // Scramble the names, so the rows are not inserted in name order
+    save_data->db_id     = -1;
+    save_data->name      = g_strdup_printf(
+            "Chart %08x",
+            index * 2654435761U
+        );
+    save_data->country   = g_strdup("hu");
+    save_data->city      = g_strdup("Budapest");
+    save_data->longitude = data->longitude;
+    save_data->latitude  = data->latitude;
+    save_data->altitude  = 280.0;
+    save_data->year      = data->year;
+    save_data->month     = data->month;
+    save_data->day       = data->day;
+    save_data->hour      = data->hour;
+    save_data->minute    = data->minute;
+    save_data->second    = 0;
+    save_data->timezone  = data->timezone;
+
+    return save_data;
+}
+
+/*
+ * bench_db_fill:
+ *
+ * Add charts to @db until it has @rows of them.
+ */
+static gboolean
+bench_db_fill(AgDb *db, guint *current, guint rows, GError **err)
+{
+    gchar  *name;
+    guint  count = rows - *current;
+    gint64 start = g_get_monotonic_time();
+
+    if (!ag_db_begin_transaction(db, err)) {
+        return FALSE;
+    }
+
+    for (; *current < rows; (*current)++) {
+        AgDbChartSave *save_data = bench_new_save(*current);
+        gboolean      saved;
+
+        saved = ag_db_chart_save(db, save_data, err);
+        ag_db_chart_save_unref(save_data);
+
+        if (!saved) {
+            ag_db_rollback_transaction(db, NULL);
+
+            return FALSE;
+        }
+    }
+
+    if (!ag_db_commit_transaction(db, err)) {
+        return FALSE;
+    }
+
+    name = g_strdup_printf("insert-%u", rows);
+    bench_print("db", name, count, g_get_monotonic_time() - start);
+    g_free(name);
+
+    return TRUE;
+}
+
+/*
+ * bench_db:
+ *
+ * Fill the database with the number of charts in each element of --db-rows,
+ * and measure loading the chart list the way the icon view does, and
+ * reading all the fully populated records.
+ */
+static gboolean
+bench_db(void)
+{
+    AgDb     *db;
+    gchar    **sizes,
+             **size;
+    guint    current = 0;
+    gboolean ok      = TRUE;
+    GError   *err    = NULL;
+
+    sizes = g_strsplit(db_rows, ",", -1);
+    db    = ag_db_get();
+
+    for (size = sizes; ok && *size; size++) {
+        gchar  *name;
+        guint  rows,
+               count;
+        gint   i;
+        gint64 start;
+
+        if ((rows = g_ascii_strtoull(*size, NULL, 10)) < current) {
+            g_printerr("Database sizes must be in increasing order\n");
+            ok = FALSE;
+
+            break;
+        }
+
+        if (!bench_db_fill(db, &current, rows, &err)) {
+            g_printerr(
+                    "Unable to fill the database: %s\n",
+                    (err) ? err->message : "unknown error"
+                );
+            g_clear_error(&err);
+            ok = FALSE;
+
+            break;
+        }
+
+        start = g_get_monotonic_time();
+
+        for (i = 0, count = 0; i < iterations; i++) {
+            GList *list;
+
+            if (((list = ag_db_chart_get_list(db, &err)) == NULL) && err) {
+                g_printerr("Unable to load the chart list: %s\n", err->message);
+                g_clear_error(&err);
+                ok = FALSE;
+
+                break;
+            }
+
+            g_list_free_full(list, (GDestroyNotify)ag_db_chart_save_unref);
+            count++;
+        }
+
+        name = g_strdup_printf("list-%u", rows);
+        bench_print("db", name, count, g_get_monotonic_time() - start);
+        g_free(name);
+
+        start = g_get_monotonic_time();
+
+        for (i = 0, count = 0; ok && (i < iterations); i++) {
+            AgDbChartList *list;
+            GList         *batch;
+
+            if ((list = ag_db_chart_list_open(db, &err)) == NULL) {
+                g_printerr(
+                        "Unable to read the charts: %s\n",
+                        (err) ? err->message : "unknown error"
+                    );
+                g_clear_error(&err);
+                ok = FALSE;
+
+                break;
+            }
+
+            while ((batch = ag_db_chart_list_next(list, 100)) != NULL) {
+                g_list_free_full(
+                        batch,
+                        (GDestroyNotify)ag_db_chart_save_unref
+                    );
+            }
+
+            ag_db_chart_list_close(list);
+            count++;
+        }
+
+        name = g_strdup_printf("full-%u", rows);
+        bench_print("db", name, count, g_get_monotonic_time() - start);
+        g_free(name);
+    }
+
+    g_object_unref(db);
+    g_strfreev(sizes);
+
+    return ok;
+}
+
+static void
+bench_remove_dir(const gchar *path)
+{
+    GDir        *dir;
+    const gchar *name;
+
+    if ((dir = g_dir_open(path, 0, NULL)) != NULL) {
+        while ((name = g_dir_read_name(dir)) != NULL) {
+            gchar *child = g_build_filename(path, name, NULL);
+
+            if (g_file_test(child, G_FILE_TEST_IS_DIR)) {
+                bench_remove_dir(child);
+            } else {
+                g_unlink(child);
+            }
+
+            g_free(child);
+        }
+
+        g_dir_close(dir);
+    }
+
+    g_rmdir(path);
+}
+
+static void
+bench_geodata(void)
+{
+    gint   i;
+    guint  count = 0;
+    gint64 start;
+
+    start = g_get_monotonic_time();
+
+    for (i = 0; i < iterations; i++) {
+        AgGeodata *data;
+        GError    *err = NULL;
+
+        if ((data = ag_geodata_open(geodata_file, &err)) == NULL) {
+            g_printerr(
+                    "Skipping the geodata benchmark: %s\n",
+                    (err) ? err->message : "unknown error"
+                );
+            g_clear_error(&err);
+
+            return;
+        }
+
+        ag_geodata_get_country_model(data);
+        ag_geodata_free(data);
+        count++;
+    }
+
+    bench_print("startup", "geodata", count, g_get_monotonic_time() - start);
+}
+
+int
+main(int argc, char *argv[])
+{
+    GOptionContext *context;
+    GError         *err      = NULL;
+    GList          *charts   = NULL,
+                   *previews = NULL;
+    guint          i;
+    AgDisplayTheme *theme;
+    gboolean       ok        = TRUE;
+    gchar          *data_dir = NULL;
+
+    context = g_option_context_new("- benchmark chart rendering");
+    g_option_context_add_main_entries(context, option_entries, NULL);
+
+    if (!g_option_context_parse(context, &argc, &argv, &err)) {
+        g_printerr("%s\n", err->message);
+
+        return EXIT_FAILURE;
+    }
+
+    g_option_context_free(context);
+
+    if ((iterations <= 0) || (chart_count <= 0)) {
+        g_printerr("The number of iterations and charts must be positive\n");
+
+        return EXIT_FAILURE;
+    }
+
+    // The synthetic databases must not touch the real one, so the data
+    // directory is moved before anything asks for it
+    if ((db_rows != NULL) && (*db_rows != '\0')) {
+        if ((data_dir = g_dir_make_tmp("ag-bench-XXXXXX", &err)) == NULL) {
+            g_printerr("%s\n", err->message);
+
+            return EXIT_FAILURE;
+        }
+
+        g_setenv("XDG_DATA_HOME", data_dir, TRUE);
+    }
+
+    ag_init();
+
+    if (machine_readable) {
+        g_print("# %s\n", PACKAGE_STRING);
+    }
+
+    for (i = 0; i < (guint)chart_count; i++) {
+        charts   = g_list_prepend(charts, bench_new_chart(i, FALSE));
+        previews = g_list_prepend(previews, bench_new_chart(i, TRUE));
+    }
+
+    theme = ag_display_theme_get_preview_theme();
+    bench_render(
+            "cairo", ag_chart_get_pixbuf,
+            "preview", previews,
+            AG_CHART_RENDERER_TILE_SIZE, AG_CHART_RENDERER_ICON_SIZE,
+            theme
+        );
+    bench_render(
+            "svg", ag_chart_get_pixbuf_from_svg,
+            "preview", previews,
+            AG_CHART_RENDERER_TILE_SIZE, AG_CHART_RENDERER_ICON_SIZE,
+            theme
+        );
+    ag_chart_set_prune_hidden(FALSE);
+    bench_render(
+            "svg-css", ag_chart_get_pixbuf_from_svg,
+            "preview", previews,
+            AG_CHART_RENDERER_TILE_SIZE, AG_CHART_RENDERER_ICON_SIZE,
+            theme
+        );
+    ag_chart_set_prune_hidden(TRUE);
+
+    theme = ag_display_theme_get_by_id(AG_DISPLAY_THEME_ALL);
+    bench_render("cairo", ag_chart_get_pixbuf, "full", charts, 0, 0, theme);
+    bench_render(
+            "svg", ag_chart_get_pixbuf_from_svg,
+            "full", charts,
+            0, 0,
+            theme
+        );
+    bench_create_svg(charts, theme);
+    bench_ephemeris();
+    bench_stages(charts, theme);
+
+    if (threads > 0) {
+        ok = bench_threads(charts, theme);
+    }
+
+    g_list_free_full(charts, g_object_unref);
+    g_list_free_full(previews, g_object_unref);
+
+    if (data_dir != NULL) {
+        ok = bench_db() && ok;
+        bench_remove_dir(data_dir);
+        g_free(data_dir);
+    }
+
+    bench_geodata();
+
+    return (ok) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
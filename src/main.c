@@ -0,0 +1,149 @@
+/* main.c - main() for Astrognome
+ *
+ * Copyright (C) 2014 Polonkai Gergely
+ *
+ * Astrognome is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Astrognome is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <glib/gi18n.h>
+
+#include "config.h"
+
+#include "astrognome.h"
+#include "ag-app.h"
+#include "ag-chart.h"
+#include "ag-chart-cairo.h"
+#include "ag-geodata.h"
+
+int
+main(int argc, char *argv[])
+{
+    gint              status;
+    guint             stylesheet_hits,
+                      stylesheet_misses,
+                      ephemeris_hits,
+                      ephemeris_misses;
+    AgApp             *app;
+    AstrognomeOptions options;
+    GError            *err             = NULL;
+    GOptionEntry      option_entries[] = {
+        {
+                "new-window", 'n',
+                0, G_OPTION_ARG_NONE,
+                &(options.new_window),
+                N_("Opens a new Astrognome window"),
+                NULL
+        },
+        {
+                "version",    'v',
+                0, G_OPTION_ARG_NONE,
+                &(options.version),
+                N_("Display version and exit"),
+                NULL
+        },
+        {
+                "quit",       'q',
+                0, G_OPTION_ARG_NONE,
+                &(options.quit),
+                N_("Quit any running Astrognome"),
+                NULL
+        },
+        { NULL }
+    };
+
+#ifdef ENABLE_NLS
+    bindtextdomain(GETTEXT_PACKAGE, LOCALEDIR);
+    bind_textdomain_codeset(GETTEXT_PACKAGE, "UTF-8");
+    textdomain(GETTEXT_PACKAGE);
+#endif
+
+    ag_init();
+
+    memset(&options, 0, sizeof(AstrognomeOptions));
+
+    if (!gtk_init_with_args(
+                &argc, &argv,
+                _("[FILE…]"
+            ), option_entries, GETTEXT_PACKAGE, &err)) {
+        g_printerr("%s\n", err->message);
+
+        return EXIT_FAILURE;
+    }
+
+    if (options.version) {
+        g_print("%s\n", PACKAGE_STRING);
+
+        return EXIT_SUCCESS;
+    }
+
+    init_filters();
+
+    app = ag_app_new();
+    g_application_set_default(G_APPLICATION(app));
+
+    if (!g_application_register(G_APPLICATION(app), NULL, &err)) {
+        g_printerr(
+                "Couldn't register Astrognome instance: '%s'\n",
+                (err) ? err->message : ""
+            );
+        g_object_unref(app);
+
+        return EXIT_FAILURE;
+    }
+
+    if (g_application_get_is_remote(G_APPLICATION(app))) {
+        ag_app_run_action(app, TRUE, (const AstrognomeOptions *)&options);
+        g_object_unref(app);
+
+        return EXIT_SUCCESS;
+    }
+
+    // The binary geodata is only mapped here; places are read on demand, so
+    // this takes the same time regardless of the number of places
+    if ((geodata = ag_geodata_open(PKGDATADIR "/geodata.bin", &err)) == NULL) {
+        g_error(
+                "Unable to open geodata: %s",
+                (err) ? err->message : "Reason unknown"
+            );
+    }
+
+    country_list = ag_geodata_get_country_model(geodata);
+
+    status = g_application_run(G_APPLICATION(app), argc, argv);
+
+    ag_chart_get_stylesheet_cache_stats(&stylesheet_hits, &stylesheet_misses);
+    g_debug(
+            "Chart stylesheet cache: %u hits, %u misses",
+            stylesheet_hits,
+            stylesheet_misses
+        );
+    ag_chart_get_ephemeris_cache_stats(&ephemeris_hits, &ephemeris_misses);
+    g_debug(
+            "Ephemeris cache: %u hits, %u misses",
+            ephemeris_hits,
+            ephemeris_misses
+        );
+    ag_chart_invalidate_stylesheet_cache();
+    ag_chart_clear_ephemeris_cache();
+    ag_chart_cairo_clear_symbol_cache();
+
+    g_object_unref(app);
+    ag_geodata_free(geodata);
+
+    return status;
+}
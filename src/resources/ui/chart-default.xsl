@@ -2,8 +2,7 @@
 <xsl:stylesheet version="1.0"
     xmlns:xsl="http://www.w3.org/1999/XSL/Transform"
     xmlns:xi="http://www.w3.org/2001/XInclude"
-    xmlns:xlink="http://www.w3.org/1999/xlink"
-    xmlns:math="http://exslt.org/math">
+    xmlns:xlink="http://www.w3.org/1999/xlink">
     <xsl:output
         method="xml"
         media-type="image/svg+xml"
@@ -12,94 +11,61 @@
         version="1.0"
         encoding="UTF-8"
         indent="yes"/>
+    <!-- Every size and position is calculated by ag_chart_create_svg(), so
+         this stylesheet only has to lay out the elements -->
+    <xsl:variable name="geometry" select="/chartinfo/geometry" />
     <xsl:variable name="asc" select="chartinfo/ascmcs/ascendant/@degree_ut" />
-    <xsl:variable name="asc_rotate" select="$asc - 180"/>
-    <xsl:variable name="PI" select="math:constant('PI', 10)" />
-    <xsl:variable name="max_dist" select="/chartinfo/bodies/body/@dist[not(. &lt; ../../body/@dist)][1]" />
-    <xsl:variable name="loaded_icon_size" select="30" />
-    <xsl:variable name="icon_size">
-      <xsl:choose>
-        <xsl:when test="$icon-size != 0">
-          <xsl:value-of select="$icon-size"/>
-        </xsl:when>
-        <xsl:otherwise>
-          <xsl:value-of select="$loaded_icon_size"/>
-        </xsl:otherwise>
-      </xsl:choose>
-    </xsl:variable>
-    <xsl:variable name="icon_scale" select="$icon_size div $loaded_icon_size" />
-    <xsl:variable name="chart_size">
-      <xsl:choose>
-        <xsl:when test="$chart-size != 0">
-          <xsl:value-of select="$chart-size"/>
-        </xsl:when>
-        <xsl:otherwise>
-          <xsl:value-of select="$image-size - 2.82 * $icon_size * ($max_dist + 2)"/>
-        </xsl:otherwise>
-      </xsl:choose>
-    </xsl:variable>
-    <xsl:variable name="image_size">
-      <xsl:choose>
-        <xsl:when test="$chart-size != 0">
-          <xsl:value-of select="$chart-size + 2.82 * $icon_size * ($max_dist + 2)"/>
-        </xsl:when>
-        <xsl:otherwise>
-          <xsl:value-of select="$image-size"/>
-        </xsl:otherwise>
-      </xsl:choose>
-    </xsl:variable>
+    <xsl:variable name="asc_rotate" select="$geometry/@asc_rotate"/>
+    <xsl:variable name="image_size" select="$geometry/@image_size" />
 
-    <xsl:variable name="r_outer" select="$chart_size * 0.5" />
-    <xsl:variable name="r_signs" select="$r_outer - ($icon_size * 1.5)" />
-    <xsl:variable name="r_aspect" select="$r_signs - ($icon_size * 0.5)" />
-    <xsl:variable name="r_houses" select="$chart_size * 0.116666" />
-    <xsl:variable name="r_moon" select="$chart_size * 0.083333" />
+    <xsl:variable name="r_outer" select="$geometry/@r_outer" />
+    <xsl:variable name="r_signs" select="$geometry/@r_signs" />
+    <xsl:variable name="r_aspect" select="$geometry/@r_aspect" />
+    <xsl:variable name="r_houses" select="$geometry/@r_houses" />
+    <xsl:variable name="r_moon" select="$geometry/@r_moon" />
 
-    <xsl:variable name="sign_pos" select="$r_signs + ($icon_size * 0.25)" />
-
-    <xsl:variable name="deg_len" select="($r_signs - $r_aspect)" />
-    <xsl:variable name="deg5_len" select="$deg_len * 0.75" />
-    <xsl:variable name="deg1_len" select="$deg_len * 0.3" />
-    <xsl:variable name="planet_marker_len" select="$icon_size div 2" />
+    <xsl:variable name="sign_transform" select="$geometry/@sign_transform" />
 
     <xsl:template name="planet-template">
         <xsl:param name="planet_name"/>
         <xsl:param name="planet_base"/>
-        <xsl:param name="rotate"/>
-        <xsl:param name="dist"/>
+        <xsl:param name="transform"/>
+        <xsl:param name="symbol_transform"/>
         <xsl:param name="retrograde"/>
         <xsl:param name="upside-down"/>
 
         <g xmlns="http://www.w3.org/2000/svg">
             <xsl:attribute name="id">planet-<xsl:value-of select="$planet_name"/></xsl:attribute>
             <xsl:attribute name="class">planet planet-<xsl:value-of select="$planet_name"/></xsl:attribute>
-            <xsl:attribute name="transform">rotate(<xsl:value-of select="-$rotate"/>, 0, 0)</xsl:attribute>
+            <xsl:attribute name="transform"><xsl:value-of select="$transform"/></xsl:attribute>
             <line y1="0" y2="0" class="planet-marker">
-                <xsl:attribute name="x1"><xsl:value-of select="$r_aspect - $planet_marker_len"/></xsl:attribute>
+                <xsl:attribute name="x1"><xsl:value-of select="$geometry/@planet_marker_start"/></xsl:attribute>
                 <xsl:attribute name="x2"><xsl:value-of select="$r_aspect"/></xsl:attribute>
             </line>
             <line y1="0" y2="0" class="planet-marker">
                 <xsl:attribute name="x1"><xsl:value-of select="$r_outer"/></xsl:attribute>
-                <xsl:attribute name="x2"><xsl:value-of select="$r_outer + $planet_marker_len"/></xsl:attribute>
+                <xsl:attribute name="x2"><xsl:value-of select="$geometry/@planet_marker_end"/></xsl:attribute>
             </line>
             <g>
-              <xsl:attribute name="transform">translate(<xsl:value-of select="$chart_size * 0.55 + $dist * ($icon_size * 1.1666666)"/>, <xsl:value-of select="-$icon_size div 2"/>) rotate(<xsl:value-of select="$rotate - $asc_rotate"/>, <xsl:value-of select="$icon_size div 2"/>, <xsl:value-of select="$icon_size div 2"/>)</xsl:attribute>
+              <xsl:attribute name="transform"><xsl:value-of select="$symbol_transform"/></xsl:attribute>
                 <use class="planet-symbol">
                     <xsl:attribute name="xlink:href">#<xsl:value-of select="$planet_base"/>_tmpl</xsl:attribute>
                     <xsl:attribute name="transform">
                         <xsl:choose>
                             <xsl:when test="$upside-down='yes'">
-                                rotate(180, <xsl:value-of select="$icon_size div 2"/>, <xsl:value-of select="$icon_size div 2"/>)
+                                <xsl:value-of select="$geometry/@upside_down_symbol_transform"/>
                             </xsl:when>
+                            <xsl:otherwise>
+                                <xsl:value-of select="$geometry/@symbol_transform"/>
+                            </xsl:otherwise>
                         </xsl:choose>
-                        scale(<xsl:value-of select="$icon_scale" />)
                     </xsl:attribute>
                 </use>
                 <xsl:choose>
                     <xsl:when test="$retrograde='True'">
                         <text>
-                            <xsl:attribute name="font-size"><xsl:value-of select="$icon_size div 2"/></xsl:attribute>
-                            <xsl:attribute name="transform">translate(<xsl:value-of select="$icon_size"/>, <xsl:value-of select="$icon_size * 1.5"/>)</xsl:attribute>
+                            <xsl:attribute name="font-size"><xsl:value-of select="$geometry/@retrograde_font_size"/></xsl:attribute>
+                            <xsl:attribute name="transform"><xsl:value-of select="$geometry/@retrograde_transform"/></xsl:attribute>
                             R
                         </text>
                     </xsl:when>
@@ -171,10 +137,9 @@
                 <xi:include href="gres://default-icons/point-vertex.xml" />
 
                 <marker id="arrow_end" orient="auto" refY="0.0" style="overflow:visible">
-                    <xsl:attribute name="refX"><xsl:value-of select="$chart_size * 0.005833"/></xsl:attribute>
+                    <xsl:attribute name="refX"><xsl:value-of select="$geometry/@arrow_ref"/></xsl:attribute>
                     <polygon>
-                        <xsl:attribute name="points">0.0,0.0  <xsl:value-of select="$chart_size * 0.011666"/>,-<xsl:value-of select="$chart_size * 0.003333"/><xsl:text> </xsl:text><xsl:value-of select="$chart_size * 0.008333"/>,0.0  <xsl:value-of select="$chart_size * 0.011666"/>,<xsl:value-of select="$chart_size * 0.003333"/>
-                        </xsl:attribute>
+                        <xsl:attribute name="points"><xsl:value-of select="$geometry/@arrow_points"/></xsl:attribute>
                     </polygon>
                 </marker>
             </defs>
@@ -189,7 +154,7 @@
             </xsl:choose>
 
             <g id="chart">
-                <xsl:attribute name="transform"><xsl:value-of select="concat('translate(', $image_size div 2, ',', $image_size div 2, ')')" /></xsl:attribute>
+                <xsl:attribute name="transform"><xsl:value-of select="concat('translate(', $geometry/@center, ',', $geometry/@center, ')')" /></xsl:attribute>
                 <g id="moonless_chart">
                     <xsl:attribute name="transform"><xsl:value-of select="concat('rotate(', $asc_rotate, ',0,0)')" /></xsl:attribute>
                     <g id="base">
@@ -255,7 +220,7 @@
 
                         <line id="deg_5" y1="0" y2="0" transform="rotate(-5,0,0)" class="degree-thin">
                             <xsl:attribute name="x1"><xsl:value-of select="$r_aspect"/></xsl:attribute>
-                            <xsl:attribute name="x2"><xsl:value-of select="$r_aspect + $deg5_len"/></xsl:attribute>
+                            <xsl:attribute name="x2"><xsl:value-of select="$geometry/@deg5_end"/></xsl:attribute>
                         </line>
                         <use x="0" y="0" xlink:href="#deg_5" id="deg_15" transform="rotate(-10,0,0)" class="degree-thin" />
                         <use x="0" y="0" xlink:href="#deg_5" id="deg_25" transform="rotate(-20,0,0)" class="degree-thin" />
@@ -295,7 +260,7 @@
 
                         <line id="deg_1" y1="0" y2="0" transform="rotate(-1,0,0)" class="degree-thin">
                             <xsl:attribute name="x1"><xsl:value-of select="$r_aspect"/></xsl:attribute>
-                            <xsl:attribute name="x2"><xsl:value-of select="$r_aspect + $deg1_len"/></xsl:attribute>
+                            <xsl:attribute name="x2"><xsl:value-of select="$geometry/@deg1_end"/></xsl:attribute>
                         </line>
                         <use x="0" y="0" xlink:href="#deg_1" id="deg_2" transform="rotate(-1,0,0)" class="degree-thin" />
                         <use x="0" y="0" xlink:href="#deg_1" id="deg_3" transform="rotate(-2,0,0)" class="degree-thin" />
@@ -586,117 +551,85 @@
                         <use x="0" y="0" xlink:href="#deg_1" id="deg_359" transform="rotate(-358,0,0)" class="degree-thin" />
 
                         <use x="0" y="0" xlink:href="#sign_aries_tmpl" id="sign_aries" class="sign sign-fire">
-                            <xsl:attribute name="transform">rotate(-15,0,0) translate(<xsl:value-of select="$sign_pos"/>,-<xsl:value-of select="$icon_size div 2"/>) rotate(90,<xsl:value-of select="$icon_size div 2"/>,<xsl:value-of select="$icon_size div 2"/>) scale(<xsl:value-of select="$icon_scale" />)</xsl:attribute>
+                            <xsl:attribute name="transform">rotate(-15,0,0) <xsl:value-of select="$sign_transform"/></xsl:attribute>
                         </use>
                         <use x="0" y="0" xlink:href="#sign_taurus_tmpl" id="sign_taurus" class="sign sign-earth">
-                            <xsl:attribute name="transform">rotate(-45,0,0) translate(<xsl:value-of select="$sign_pos"/>,-<xsl:value-of select="$icon_size div 2"/>) rotate(90,<xsl:value-of select="$icon_size div 2"/>,<xsl:value-of select="$icon_size div 2"/>) scale(<xsl:value-of select="$icon_scale" />)</xsl:attribute>
+                            <xsl:attribute name="transform">rotate(-45,0,0) <xsl:value-of select="$sign_transform"/></xsl:attribute>
                         </use>
                         <use x="0" y="0" xlink:href="#sign_gemini_tmpl" id="sign_gemini" class="sign sign-air">
-                            <xsl:attribute name="transform">rotate(-75,0,0) translate(<xsl:value-of select="$sign_pos"/>,-<xsl:value-of select="$icon_size div 2"/>) rotate(90,<xsl:value-of select="$icon_size div 2"/>,<xsl:value-of select="$icon_size div 2"/>) scale(<xsl:value-of select="$icon_scale" />)</xsl:attribute>
+                            <xsl:attribute name="transform">rotate(-75,0,0) <xsl:value-of select="$sign_transform"/></xsl:attribute>
                         </use>
                         <use x="0" y="0" xlink:href="#sign_cancer_tmpl" id="sign_cancer" class="sign sign-water">
-                            <xsl:attribute name="transform">rotate(-105,0,0) translate(<xsl:value-of select="$sign_pos"/>,-<xsl:value-of select="$icon_size div 2"/>) rotate(90,<xsl:value-of select="$icon_size div 2"/>,<xsl:value-of select="$icon_size div 2"/>) scale(<xsl:value-of select="$icon_scale" />)</xsl:attribute>
+                            <xsl:attribute name="transform">rotate(-105,0,0) <xsl:value-of select="$sign_transform"/></xsl:attribute>
                         </use>
                         <use x="0" y="0" xlink:href="#sign_leo_tmpl" id="sign_leo" class="sign sign-fire">
-                            <xsl:attribute name="transform">rotate(-135,0,0) translate(<xsl:value-of select="$sign_pos"/>,-<xsl:value-of select="$icon_size div 2"/>) rotate(90,<xsl:value-of select="$icon_size div 2"/>,<xsl:value-of select="$icon_size div 2"/>) scale(<xsl:value-of select="$icon_scale" />)</xsl:attribute>
+                            <xsl:attribute name="transform">rotate(-135,0,0) <xsl:value-of select="$sign_transform"/></xsl:attribute>
                         </use>
                         <use x="0" y="0" xlink:href="#sign_virgo_tmpl" id="sign_virgo" class="sign sign-earth">
-                            <xsl:attribute name="transform">rotate(-165,0,0) translate(<xsl:value-of select="$sign_pos"/>,-<xsl:value-of select="$icon_size div 2"/>) rotate(90,<xsl:value-of select="$icon_size div 2"/>,<xsl:value-of select="$icon_size div 2"/>) scale(<xsl:value-of select="$icon_scale" />)</xsl:attribute>
+                            <xsl:attribute name="transform">rotate(-165,0,0) <xsl:value-of select="$sign_transform"/></xsl:attribute>
                         </use>
                         <use x="0" y="0" xlink:href="#sign_libra_tmpl" id="sign_libra" class="sign sign-air">
-                            <xsl:attribute name="transform">rotate(-195,0,0) translate(<xsl:value-of select="$sign_pos"/>,-<xsl:value-of select="$icon_size div 2"/>) rotate(90,<xsl:value-of select="$icon_size div 2"/>,<xsl:value-of select="$icon_size div 2"/>) scale(<xsl:value-of select="$icon_scale" />)</xsl:attribute>
+                            <xsl:attribute name="transform">rotate(-195,0,0) <xsl:value-of select="$sign_transform"/></xsl:attribute>
                         </use>
                         <use x="0" y="0" xlink:href="#sign_scorpio_tmpl" id="sign_scorpio" class="sign sign-water">
-                            <xsl:attribute name="transform">rotate(-225,0,0) translate(<xsl:value-of select="$sign_pos"/>,-<xsl:value-of select="$icon_size div 2"/>) rotate(90,<xsl:value-of select="$icon_size div 2"/>,<xsl:value-of select="$icon_size div 2"/>) scale(<xsl:value-of select="$icon_scale" />)</xsl:attribute>
+                            <xsl:attribute name="transform">rotate(-225,0,0) <xsl:value-of select="$sign_transform"/></xsl:attribute>
                         </use>
                         <use x="0" y="0" xlink:href="#sign_sagittarius_tmpl" id="sign_sagittarius" class="sign sign-fire">
-                            <xsl:attribute name="transform">rotate(-255,0,0) translate(<xsl:value-of select="$sign_pos"/>,-<xsl:value-of select="$icon_size div 2"/>) rotate(90,<xsl:value-of select="$icon_size div 2"/>,<xsl:value-of select="$icon_size div 2"/>) scale(<xsl:value-of select="$icon_scale" />)</xsl:attribute>
+                            <xsl:attribute name="transform">rotate(-255,0,0) <xsl:value-of select="$sign_transform"/></xsl:attribute>
                         </use>
                         <use x="0" y="0" xlink:href="#sign_capricorn_tmpl" id="sign_capricorn" class="sign sign-earth">
-                            <xsl:attribute name="transform">rotate(-285,0,0) translate(<xsl:value-of select="$sign_pos"/>,-<xsl:value-of select="$icon_size div 2"/>) rotate(90,<xsl:value-of select="$icon_size div 2"/>,<xsl:value-of select="$icon_size div 2"/>) scale(<xsl:value-of select="$icon_scale" />)</xsl:attribute>
+                            <xsl:attribute name="transform">rotate(-285,0,0) <xsl:value-of select="$sign_transform"/></xsl:attribute>
                         </use>
                         <use x="0" y="0" xlink:href="#sign_aquarius_tmpl" id="sign_aquarius" class="sign sign-air">
-                            <xsl:attribute name="transform">rotate(-315,0,0) translate(<xsl:value-of select="$sign_pos"/>,-<xsl:value-of select="$icon_size div 2"/>) rotate(90,<xsl:value-of select="$icon_size div 2"/>,<xsl:value-of select="$icon_size div 2"/>) scale(<xsl:value-of select="$icon_scale" />)</xsl:attribute>
+                            <xsl:attribute name="transform">rotate(-315,0,0) <xsl:value-of select="$sign_transform"/></xsl:attribute>
                         </use>
                         <use x="0" y="0" xlink:href="#sign_pisces_tmpl" id="sign_pisces" class="sign sign-water">
-                            <xsl:attribute name="transform">rotate(-345,0,0) translate(<xsl:value-of select="$sign_pos"/>,-<xsl:value-of select="$icon_size div 2"/>) rotate(90,<xsl:value-of select="$icon_size div 2"/>,<xsl:value-of select="$icon_size div 2"/>) scale(<xsl:value-of select="$icon_scale" />)</xsl:attribute>
+                            <xsl:attribute name="transform">rotate(-345,0,0) <xsl:value-of select="$sign_transform"/></xsl:attribute>
                         </use>
                     </g>
 
                     <g id="houes">
                         <xsl:for-each select="chartinfo/houses/house">
-                            <xsl:variable name="next_house" select="@number + 1"/>
-                            <xsl:variable name="next_degree_read">
-                                <xsl:choose>
-                                    <xsl:when test="/chartinfo/houses/house[@number=$next_house]">
-                                        <xsl:value-of select="/chartinfo/houses/house[@number=$next_house]/@degree"/>
-                                    </xsl:when>
-                                    <xsl:otherwise>
-                                        <xsl:value-of select="/chartinfo/houses/house[@number='1']/@degree"/>
-                                    </xsl:otherwise>
-                                </xsl:choose>
-                            </xsl:variable>
-                            <xsl:variable name="next_degree">
-                                <xsl:choose>
-                                    <xsl:when test="$next_degree_read &lt; @degree">
-                                        <xsl:value-of select="$next_degree_read + 360.0"/>
-                                    </xsl:when>
-                                    <xsl:otherwise>
-                                        <xsl:value-of select="$next_degree_read"/>
-                                    </xsl:otherwise>
-                                </xsl:choose>
-                            </xsl:variable>
-                            <xsl:variable name="house_mid_test" select="(@degree + $next_degree) div 2"/>
-                            <xsl:variable name="house_mid">
-                                <xsl:choose>
-                                    <xsl:when test="$house_mid_test &gt; 360.0">
-                                        <xsl:value-of select="$house_mid_test - 360.0"/>
-                                    </xsl:when>
-                                    <xsl:otherwise>
-                                        <xsl:value-of select="$house_mid_test"/>
-                                    </xsl:otherwise>
-                                </xsl:choose>
-                            </xsl:variable>
                             <text text-anchor="middle">
-                                <xsl:attribute name="font-size"><xsl:value-of select="$chart_size * 0.016666"/></xsl:attribute>
+                                <xsl:attribute name="font-size"><xsl:value-of select="$geometry/@house_font_size"/></xsl:attribute>
                                 <xsl:attribute name="transform">
-                                    rotate(-<xsl:value-of select="$house_mid"/>,0,0) translate(<xsl:value-of select="$chart_size * 0.091666"/>,0) rotate(90,0,0)
+                                    rotate(-<xsl:value-of select="@mid"/>,0,0) translate(<xsl:value-of select="$geometry/@house_number_pos"/>,0) rotate(90,0,0)
                                 </xsl:attribute>
                                 <xsl:value-of select="@number"/>
                             </text>
                             <line y1="0" y2="0" class="house-cusp">
-                                <xsl:attribute name="x1"><xsl:value-of select="$chart_size * 0.083333"/></xsl:attribute>
-                                <xsl:attribute name="x2"><xsl:value-of select="$chart_size * 0.4"/></xsl:attribute>
+                                <xsl:attribute name="x1"><xsl:value-of select="$geometry/@house_cusp_start"/></xsl:attribute>
+                                <xsl:attribute name="x2"><xsl:value-of select="$geometry/@house_cusp_end"/></xsl:attribute>
                                 <xsl:attribute name="id"><xsl:value-of select="concat('house_cusp_', @number)"/></xsl:attribute>
                                 <xsl:attribute name="transform"><xsl:value-of select="concat('rotate(-', @degree, ')')" /></xsl:attribute>
                             </line>
                             <line y1="0" y2="0" class="house-cusp">
-                                <xsl:attribute name="x1"><xsl:value-of select="$chart_size * 0.5"/></xsl:attribute>
-                                <xsl:attribute name="x2"><xsl:value-of select="$chart_size * 0.55"/></xsl:attribute>
+                                <xsl:attribute name="x1"><xsl:value-of select="$geometry/@house_cusp_outer_start"/></xsl:attribute>
+                                <xsl:attribute name="x2"><xsl:value-of select="$geometry/@house_cusp_outer_end"/></xsl:attribute>
                                 <xsl:attribute name="id"><xsl:value-of select="concat('house_cusp_', @number, '_outer')"/></xsl:attribute>
                                 <xsl:attribute name="transform"><xsl:value-of select="concat('rotate(-', @degree, ')')" /></xsl:attribute>
                             </line>
                         </xsl:for-each>
 
                         <line id="descendent" y1="0" y2="0" class="axis">
-                            <xsl:attribute name="x1"><xsl:value-of select="- $chart_size * 0.533333"/></xsl:attribute>
-                            <xsl:attribute name="x2"><xsl:value-of select="- $chart_size * 0.083333"/></xsl:attribute>
+                            <xsl:attribute name="x1">-<xsl:value-of select="$geometry/@axis_end"/></xsl:attribute>
+                            <xsl:attribute name="x2">-<xsl:value-of select="$geometry/@axis_start"/></xsl:attribute>
                             <xsl:attribute name="transform"><xsl:value-of select="concat('rotate(-', $asc, ',0,0)')" /></xsl:attribute>
                         </line>
                         <line id="ascendant" y1="0" y2="0" class="axis axis-end">
-                            <xsl:attribute name="x1"><xsl:value-of select="$chart_size * 0.533333"/></xsl:attribute>
-                            <xsl:attribute name="x2"><xsl:value-of select="$chart_size * 0.083333"/></xsl:attribute>
+                            <xsl:attribute name="x1"><xsl:value-of select="$geometry/@axis_end"/></xsl:attribute>
+                            <xsl:attribute name="x2"><xsl:value-of select="$geometry/@axis_start"/></xsl:attribute>
                             <xsl:attribute name="transform"><xsl:value-of select="concat('rotate(-', $asc, ')')" /></xsl:attribute>
                         </line>
                         <xsl:variable name="mc" select="chartinfo/ascmcs/mc/@degree_ut"/>
                         <line id="ic" y1="0" y2="0" class="axis">
-                            <xsl:attribute name="x1"><xsl:value-of select="- $chart_size * 0.533333"/></xsl:attribute>
-                            <xsl:attribute name="x2"><xsl:value-of select="- $chart_size * 0.083333"/></xsl:attribute>
+                            <xsl:attribute name="x1">-<xsl:value-of select="$geometry/@axis_end"/></xsl:attribute>
+                            <xsl:attribute name="x2">-<xsl:value-of select="$geometry/@axis_start"/></xsl:attribute>
                             <xsl:attribute name="transform"><xsl:value-of select="concat('rotate(-', $mc, ')')" /></xsl:attribute>
                         </line>
                         <line id="mc" y1="0" y2="0" class="axis axis-end">
-                            <xsl:attribute name="x1"><xsl:value-of select="$chart_size * 0.533333"/></xsl:attribute>
-                            <xsl:attribute name="x2"><xsl:value-of select="$chart_size * 0.083333"/></xsl:attribute>
+                            <xsl:attribute name="x1"><xsl:value-of select="$geometry/@axis_end"/></xsl:attribute>
+                            <xsl:attribute name="x2"><xsl:value-of select="$geometry/@axis_start"/></xsl:attribute>
                             <xsl:attribute name="transform"><xsl:value-of select="concat('rotate(-', $mc, ')')" /></xsl:attribute>
                         </line>
                     </g>
@@ -705,19 +638,18 @@
                         <xsl:for-each select="chartinfo/ascmcs/vertex">
                             <xsl:call-template name="planet-template">
                                 <xsl:with-param name="planet_name">vertex</xsl:with-param>
-                                <xsl:with-param name="rotate"><xsl:value-of select="@degree_ut"/></xsl:with-param>
+                                <xsl:with-param name="transform"><xsl:value-of select="@transform"/></xsl:with-param>
+                                <xsl:with-param name="symbol_transform"><xsl:value-of select="@symbol_transform"/></xsl:with-param>
                                 <xsl:with-param name="planet_base">point_vertex</xsl:with-param>
-                                <!-- TODO: dist must be calculated for Vertex, too! -->
-                                <xsl:with-param name="dist">0</xsl:with-param>
                                 <xsl:with-param name="retrograde">False</xsl:with-param>
                             </xsl:call-template>
                         </xsl:for-each>
                         <xsl:for-each select="chartinfo/bodies/body">
                             <xsl:call-template name="planet-template">
                                 <xsl:with-param name="planet_name"><xsl:value-of select="@name"/></xsl:with-param>
-                                <xsl:with-param name="rotate"><xsl:value-of select="@degree"/></xsl:with-param>
+                                <xsl:with-param name="transform"><xsl:value-of select="@transform"/></xsl:with-param>
+                                <xsl:with-param name="symbol_transform"><xsl:value-of select="@symbol_transform"/></xsl:with-param>
                                 <xsl:with-param name="planet_base">planet_<xsl:value-of select="translate(@name, '-', '_')"/></xsl:with-param>
-                                <xsl:with-param name="dist"><xsl:value-of select="@dist"/></xsl:with-param>
                                 <xsl:with-param name="retrograde"><xsl:value-of select="@retrograde"/></xsl:with-param>
                             </xsl:call-template>
 
@@ -725,9 +657,9 @@
                                 <xsl:when test="@name='moon-node'">
                                     <xsl:call-template name="planet-template">
                                         <xsl:with-param name="planet_name"><xsl:value-of select="@name"/>-desc</xsl:with-param>
-                                        <xsl:with-param name="rotate"><xsl:value-of select="180 + @degree"/></xsl:with-param>
+                                        <xsl:with-param name="transform"><xsl:value-of select="@desc_transform"/></xsl:with-param>
+                                        <xsl:with-param name="symbol_transform"><xsl:value-of select="@desc_symbol_transform"/></xsl:with-param>
                                         <xsl:with-param name="planet_base">planet_moon_node</xsl:with-param>
-                                        <xsl:with-param name="dist"><xsl:value-of select="@dist"/></xsl:with-param>
                                         <xsl:with-param name="retrograde"><xsl:value-of select="@retrograde"/></xsl:with-param>
                                         <xsl:with-param name="upside-down">yes</xsl:with-param>
                                     </xsl:call-template>
@@ -739,54 +671,15 @@
                     <g id="aspects">
                         <xsl:for-each select="chartinfo/aspects/aspect">
                             <xsl:variable name="planet1" select="@body1"/>
-                            <xsl:variable name="deg1">
-                                <xsl:choose>
-                                    <xsl:when test="$planet1='ascendant'">
-                                        <xsl:value-of select="/chartinfo/ascmcs/ascendant/@degree_ut" />
-                                    </xsl:when>
-                                    <xsl:when test="$planet1='mc'">
-                                        <xsl:value-of select="/chartinfo/ascmcs/mc/@degree_ut" />
-                                    </xsl:when>
-                                    <xsl:when test="$planet1='vertex'">
-                                        <xsl:value-of select="/chartinfo/ascmcs/vertex/@degree_ut" />
-                                    </xsl:when>
-                                    <xsl:otherwise>
-                                        <xsl:value-of select="/chartinfo/bodies/body[@name=$planet1]/@degree" />
-                                    </xsl:otherwise>
-                                </xsl:choose>
-                            </xsl:variable>
-                            <xsl:variable name="rad1" select="$deg1 * $PI div 180"/>
-                            <xsl:variable name="x1" select="$r_aspect * math:cos($rad1)"/>
-                            <xsl:variable name="y1" select="$r_aspect * -math:sin($rad1)"/>
-
                             <xsl:variable name="planet2" select="@body2"/>
-                            <xsl:variable name="deg2">
-                                <xsl:choose>
-                                    <xsl:when test="$planet2='ascendant'">
-                                        <xsl:value-of select="/chartinfo/ascmcs/ascendant/@degree_ut" />
-                                    </xsl:when>
-                                    <xsl:when test="$planet2='mc'">
-                                        <xsl:value-of select="/chartinfo/ascmcs/mc/@degree_ut" />
-                                    </xsl:when>
-                                    <xsl:when test="$planet2='vertex'">
-                                        <xsl:value-of select="/chartinfo/ascmcs/vertex/@degree_ut" />
-                                    </xsl:when>
-                                    <xsl:otherwise>
-                                        <xsl:value-of select="/chartinfo/bodies/body[@name=$planet2]/@degree" />
-                                    </xsl:otherwise>
-                                </xsl:choose>
-                            </xsl:variable>
-                            <xsl:variable name="rad2" select="$deg2 * $PI div 180"/>
-                            <xsl:variable name="x2" select="$r_aspect * math:cos($rad2)"/>
-                            <xsl:variable name="y2" select="$r_aspect * -math:sin($rad2)"/>
 
                             <line class="aspect">
                                 <xsl:attribute name="id">aspect-<xsl:value-of select="$planet1"/>-<xsl:value-of select="$planet2"/></xsl:attribute>
                                 <xsl:attribute name="class">aspect aspect-<xsl:value-of select="@type"/> aspect-p-<xsl:value-of select="$planet1"/> aspect-p-<xsl:value-of select="$planet2"/></xsl:attribute>
-                                <xsl:attribute name="x1"><xsl:value-of select="$x1"/></xsl:attribute>
-                                <xsl:attribute name="y1"><xsl:value-of select="$y1"/></xsl:attribute>
-                                <xsl:attribute name="x2"><xsl:value-of select="$x2"/></xsl:attribute>
-                                <xsl:attribute name="y2"><xsl:value-of select="$y2"/></xsl:attribute>
+                                <xsl:attribute name="x1"><xsl:value-of select="@x1"/></xsl:attribute>
+                                <xsl:attribute name="y1"><xsl:value-of select="@y1"/></xsl:attribute>
+                                <xsl:attribute name="x2"><xsl:value-of select="@x2"/></xsl:attribute>
+                                <xsl:attribute name="y2"><xsl:value-of select="@y2"/></xsl:attribute>
                             </line>
                         </xsl:for-each>
                     </g>
@@ -794,123 +687,30 @@
                     <g id="antiscia" display="none">
                         <xsl:for-each select="chartinfo/antiscia/antiscia">
                             <xsl:variable name="planet1" select="@body1"/>
-                            <xsl:variable name="deg1">
-                                <xsl:choose>
-                                    <xsl:when test="$planet1='ascendant'">
-                                        <xsl:value-of select="/chartinfo/ascmcs/ascendant/@degree_ut" />
-                                    </xsl:when>
-                                    <xsl:when test="$planet1='mc'">
-                                        <xsl:value-of select="/chartinfo/ascmcs/mc/@degree_ut" />
-                                    </xsl:when>
-                                    <xsl:when test="$planet1='vertex'">
-                                        <xsl:value-of select="/chartinfo/ascmcs/vertex/@degree_ut" />
-                                    </xsl:when>
-                                    <xsl:otherwise>
-                                        <xsl:value-of select="/chartinfo/bodies/body[@name=$planet1]/@degree" />
-                                    </xsl:otherwise>
-                                </xsl:choose>
-                            </xsl:variable>
-                            <xsl:variable name="rad1" select="$deg1 * $PI div 180"/>
-                            <xsl:variable name="x1" select="$r_aspect * math:cos($rad1)"/>
-                            <xsl:variable name="y1" select="$r_aspect * -math:sin($rad1)"/>
-
                             <xsl:variable name="planet2" select="@body2"/>
-                            <xsl:variable name="deg2">
-                                <xsl:choose>
-                                    <xsl:when test="$planet2='ascendant'">
-                                        <xsl:value-of select="/chartinfo/ascmcs/ascendant/@degree_ut" />
-                                    </xsl:when>
-                                    <xsl:when test="$planet2='mc'">
-                                        <xsl:value-of select="/chartinfo/ascmcs/mc/@degree_ut" />
-                                    </xsl:when>
-                                    <xsl:when test="$planet2='vertex'">
-                                        <xsl:value-of select="/chartinfo/ascmcs/vertex/@degree_ut" />
-                                    </xsl:when>
-                                    <xsl:otherwise>
-                                        <xsl:value-of select="/chartinfo/bodies/body[@name=$planet2]/@degree" />
-                                    </xsl:otherwise>
-                                </xsl:choose>
-                            </xsl:variable>
-                            <xsl:variable name="rad2" select="$deg2 * $PI div 180"/>
-                            <xsl:variable name="x2" select="$r_aspect * math:cos($rad2)"/>
-                            <xsl:variable name="y2" select="$r_aspect * -math:sin($rad2)"/>
 
                             <line class="antiscion">
                                 <xsl:attribute name="id">antiscion-<xsl:value-of select="$planet1"/>-<xsl:value-of select="$planet2"/></xsl:attribute>
                                 <xsl:attribute name="class">antiscion antiscion-<xsl:value-of select="@axis"/> antiscion-p-<xsl:value-of select="$planet1"/> antiscion-p-<xsl:value-of select="$planet2"/></xsl:attribute>
-                                <xsl:attribute name="x1"><xsl:value-of select="$x1"/></xsl:attribute>
-                                <xsl:attribute name="y1"><xsl:value-of select="$y1"/></xsl:attribute>
-                                <xsl:attribute name="x2"><xsl:value-of select="$x2"/></xsl:attribute>
-                                <xsl:attribute name="y2"><xsl:value-of select="$y2"/></xsl:attribute>
+                                <xsl:attribute name="x1"><xsl:value-of select="@x1"/></xsl:attribute>
+                                <xsl:attribute name="y1"><xsl:value-of select="@y1"/></xsl:attribute>
+                                <xsl:attribute name="x2"><xsl:value-of select="@x2"/></xsl:attribute>
+                                <xsl:attribute name="y2"><xsl:value-of select="@y2"/></xsl:attribute>
                             </line>
                         </xsl:for-each>
                     </g>
                 </g>
                 <g id="moon">
-                    <xsl:variable name="moon_illum" select="/chartinfo/moonphase/@illumination"/>
-                    <xsl:variable name="moon_orig_percent">
-                        <xsl:choose>
-                            <xsl:when test="$moon_illum &gt; 50">
-                                <xsl:value-of select="100 - $moon_illum"/>
-                            </xsl:when>
-
-                            <xsl:otherwise>
-                                <xsl:value-of select="$moon_illum"/>
-                            </xsl:otherwise>
-                        </xsl:choose>
-                    </xsl:variable>
-                    <xsl:variable name="moon_phase" select="/chartinfo/moonphase/@phase"/>
-                    <xsl:variable name="moon_percent" select="$moon_orig_percent * 2 div 100"/>
-                    <xsl:variable name="moon_x" select="$r_moon * (1 - $moon_percent)"/>
-                    <xsl:variable name="moon_r2" select="$moon_x div (math:power(math:sin(math:atan($moon_x div $r_moon)), 2) * 2)"/>
                     <xsl:choose>
-                        <xsl:when test="$moon_phase='full'">
+                        <xsl:when test="/chartinfo/moonphase/@phase='full'">
                             <circle id="moon" cx="0" cy="0">
                                 <xsl:attribute name="r"><xsl:value-of select="$r_moon"/></xsl:attribute>
                             </circle>
                         </xsl:when>
 
-                        <xsl:when test="substring($moon_phase, 1, 2)='wa'">
+                        <xsl:when test="/chartinfo/moonphase/@path">
                             <path id="moon">
-                                <xsl:attribute name="d">
-                                    m 0,<xsl:value-of select="$r_moon"/>
-                                    <xsl:choose>
-                                        <xsl:when test="substring($moon_phase, 1, 3)='wan'">
-                                            a <xsl:value-of select="$r_moon"/>,<xsl:value-of select="$r_moon"/> 0 0,1 0,-<xsl:value-of select="2 * $r_moon"/>
-                                            <xsl:choose>
-                                                <xsl:when test="$moon_illum &lt; 50">
-                                                    a <xsl:value-of select="$moon_r2"/>,<xsl:value-of select="$moon_r2"/> 0 0,0 0,<xsl:value-of select="2 * $r_moon"/>
-                                                </xsl:when>
-
-                                                <xsl:when test="$moon_illum = 50">
-                                                    l 0,<xsl:value-of select="2 * $r_moon"/>
-                                                </xsl:when>
-
-                                                <xsl:when test="$moon_illum &gt; 50">
-                                                    a <xsl:value-of select="$moon_r2"/>,<xsl:value-of select="$moon_r2"/> 0 0,1 0,<xsl:value-of select="2 * $r_moon"/>
-                                                </xsl:when>
-                                            </xsl:choose>
-                                        </xsl:when>
-
-                                        <xsl:when test="substring($moon_phase, 1, 3)='wax'">
-                                            a <xsl:value-of select="$r_moon"/>,<xsl:value-of select="$r_moon"/> 0 0,0 0,-<xsl:value-of select="2 * $r_moon"/>
-                                            <xsl:choose>
-                                                <xsl:when test="$moon_illum &lt; 50">
-                                                    a <xsl:value-of select="$moon_r2"/>,<xsl:value-of select="$moon_r2"/> 0 0,1 0,<xsl:value-of select="2 * $r_moon"/>
-                                                </xsl:when>
-
-                                                <xsl:when test="$moon_illum = 50">
-                                                    l 0,<xsl:value-of select="2 * $r_moon"/>
-                                                </xsl:when>
-
-                                                <xsl:when test="$moon_illum &gt; 50">
-                                                    a <xsl:value-of select="$moon_r2"/>,<xsl:value-of select="$moon_r2"/> 0 0,0 0,<xsl:value-of select="2 * $r_moon"/>
-                                                </xsl:when>
-                                            </xsl:choose>
-                                        </xsl:when>
-                                    </xsl:choose>
-                                    z
-                                </xsl:attribute>
+                                <xsl:attribute name="d"><xsl:value-of select="/chartinfo/moonphase/@path"/></xsl:attribute>
                             </path>
                         </xsl:when>
                     </xsl:choose>
@@ -0,0 +1,281 @@
+/* test-render-threads.c - Multithreaded chart rendering test for Astrognome
+ *
+ * Copyright (C) 2014 Polonkai Gergely
+ *
+ * Astrognome is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Astrognome is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <glib.h>
+#include <swe-glib.h>
+
+#include "config.h"
+
+#include "astrognome.h"
+#include "ag-chart.h"
+#include "ag-display-theme.h"
+
+// Calculates and renders the same charts from several threads at once, and
+// compares every result to the output of a single threaded run. Both the
+// SVG and the cairo renderer are checked. The ephemeris cache is cleared
+// before every round, so the threads really calculate at the same time.
+//
+// By default, a few hundred charts are rendered, so `make check` stays
+// quick. With `-m slow`, more threads render thousands of them.
+
+#define TEST_IMAGE_SIZE 200
+
+typedef struct {
+    gint    year;
+    gint    month;
+    gint    day;
+    gint    hour;
+    gint    minute;
+    gdouble timezone;
+    gdouble longitude;
+    gdouble latitude;
+} TestChart;
+
+static const TestChart test_charts[] = {
+    { 1983,  3,  7, 11, 54, 1.0,  19.081599, 47.462485 },
+    { 1969,  7, 20, 20, 17, 0.0, -95.611420, 29.560380 },
+    { 2000,  1,  1,  0,  0, 0.0,  -0.127758, 51.507351 },
+    { 1955, 11, 12, 22,  4, 9.0, 139.691706, 35.689487 },
+};
+
+typedef struct {
+    AgDisplayTheme *theme;
+    guint          n_charts;
+    guint          iterations;
+    gchar          **svg;
+    GBytes         **pixels;
+    volatile gint  count;
+    volatile gint  mismatches;
+} TestData;
+
+/*
+ * test_new_chart:
+ *
+ * Create the @index-th test chart. Every round over test_charts moves the
+ * time a bit, so all the charts are different.
+ */
+static AgChart *
+test_new_chart(guint index)
+{
+    const TestChart *data;
+    guint           shift;
+    GsweTimestamp   *timestamp;
+
+    data  = &(test_charts[index % G_N_ELEMENTS(test_charts)]);
+    shift = index / G_N_ELEMENTS(test_charts);
+
+    timestamp = gswe_timestamp_new_from_gregorian_full(
+            data->year, data->month, data->day,
+            (data->hour + shift) % 24, (data->minute + shift * 7) % 60, 0, 0,
+            data->timezone
+        );
+
+    return ag_chart_new_full(
+            timestamp,
+            data->longitude,
+            data->latitude,
+            280.0,
+            GSWE_HOUSE_SYSTEM_PLACIDUS
+        );
+}
+
+/*
+ * test_render_chart:
+ *
+ * Calculate the @index-th test chart, and render it both as SVG and with
+ * cairo.
+ *
+ * Returns: %TRUE if both renderings succeeded
+ */
+static gboolean
+test_render_chart(guint          index,
+                  AgDisplayTheme *theme,
+                  gchar          **svg,
+                  GBytes         **pixels)
+{
+    AgChart   *chart;
+    GdkPixbuf *pixbuf;
+    guchar    *pixel_data;
+    guint     pixel_length;
+    GError    *err = NULL;
+
+    chart = test_new_chart(index);
+
+    if ((*svg = ag_chart_create_svg(
+                chart,
+                NULL,
+                TRUE,
+                theme,
+                0, 0,
+                &err
+            )) == NULL) {
+        g_test_message(
+                "SVG generation failed: %s",
+                (err) ? err->message : "unknown error"
+            );
+        g_clear_error(&err);
+        g_object_unref(chart);
+        *pixels = NULL;
+
+        return FALSE;
+    }
+
+    if ((pixbuf = ag_chart_get_pixbuf(
+                chart,
+                TEST_IMAGE_SIZE,
+                0,
+                theme,
+                &err
+            )) == NULL) {
+        g_test_message(
+                "cairo rendering failed: %s",
+                (err) ? err->message : "unknown error"
+            );
+        g_clear_error(&err);
+        g_object_unref(chart);
+        *pixels = NULL;
+
+        return FALSE;
+    }
+
+    pixel_data = gdk_pixbuf_get_pixels_with_length(pixbuf, &pixel_length);
+    *pixels    = g_bytes_new(pixel_data, pixel_length);
+
+    g_object_unref(pixbuf);
+    g_object_unref(chart);
+
+    return TRUE;
+}
+
+static gpointer
+test_thread(TestData *data)
+{
+    guint i,
+          j;
+
+    for (i = 0; i < data->iterations; i++) {
+        for (j = 0; j < data->n_charts; j++) {
+            gchar  *svg;
+            GBytes *pixels;
+
+            if (!test_render_chart(
+                        j,
+                        data->theme,
+                        &svg,
+                        &pixels
+                    )) {
+                g_atomic_int_inc(&(data->mismatches));
+
+                continue;
+            }
+
+            if ((g_strcmp0(svg, data->svg[j]) != 0)
+                || !g_bytes_equal(pixels, data->pixels[j])) {
+                g_atomic_int_inc(&(data->mismatches));
+            }
+
+            g_free(svg);
+            g_bytes_unref(pixels);
+            g_atomic_int_inc(&(data->count));
+        }
+
+        ag_chart_clear_ephemeris_cache();
+    }
+
+    return NULL;
+}
+
+static void
+test_render_threads(void)
+{
+    TestData data = { 0, };
+    GThread  **thread_list;
+    guint    n_threads,
+             i;
+
+    if (g_test_slow()) {
+        n_threads       = 8;
+        data.n_charts   = 64;
+        data.iterations = 16;
+    } else {
+        n_threads       = 4;
+        data.n_charts   = 16;
+        data.iterations = 5;
+    }
+
+    data.theme  = ag_display_theme_get_by_id(AG_DISPLAY_THEME_ALL);
+    data.svg    = g_new0(gchar *, data.n_charts);
+    data.pixels = g_new0(GBytes *, data.n_charts);
+
+    for (i = 0; i < data.n_charts; i++) {
+        g_assert_true(test_render_chart(
+                i,
+                data.theme,
+                &(data.svg[i]),
+                &(data.pixels[i])
+            ));
+    }
+
+    ag_chart_clear_ephemeris_cache();
+
+    thread_list = g_new0(GThread *, n_threads);
+
+    for (i = 0; i < n_threads; i++) {
+        thread_list[i] = g_thread_new(
+                "test-render",
+                (GThreadFunc)test_thread,
+                &data
+            );
+    }
+
+    for (i = 0; i < n_threads; i++) {
+        g_thread_join(thread_list[i]);
+    }
+
+    g_test_message(
+            "%d charts rendered from %u threads",
+            data.count,
+            n_threads
+        );
+    g_assert_cmpint(data.mismatches, ==, 0);
+    g_assert_cmpint(
+            data.count,
+            ==,
+            n_threads * data.n_charts * data.iterations
+        );
+
+    for (i = 0; i < data.n_charts; i++) {
+        g_free(data.svg[i]);
+        g_bytes_unref(data.pixels[i]);
+    }
+
+    g_free(data.svg);
+    g_free(data.pixels);
+    g_free(thread_list);
+}
+
+int
+main(int argc, char *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    ag_init();
+
+    g_test_add_func("/render/threads", test_render_threads);
+
+    return g_test_run();
+}